@@ -275,10 +275,18 @@
     getbufsize as getbufsize,
     seterrcall as seterrcall,
     geterrcall as geterrcall,
+    setparallel as setparallel,
+    getparallel as getparallel,
+    setallocator as setallocator,
+    getallocator as getallocator,
+    setmempool as setmempool,
+    getmempool as getmempool,
+    mempoolstats as mempoolstats,
     _SupportsWrite,
     _ErrKind,
     _ErrFunc,
     _ErrDictOptional,
+    _ParallelDictOptional,
 )
 
 from numpy.core.arrayprint import (
@@ -3731,6 +3739,36 @@ def __exit__(
         __traceback: Optional[TracebackType],
     ) -> None: ...
 
+class parallelstate(ContextDecorator):
+    kwargs: _ParallelDictOptional
+
+    # Expand `**kwargs` into explicit keyword-only arguments
+    def __init__(
+        self,
+        *,
+        threads: Optional[int] = ...,
+        threshold: Optional[int] = ...,
+        linalg: Optional[bool] = ...,
+    ) -> None: ...
+    def __enter__(self) -> None: ...
+    def __exit__(
+        self,
+        __exc_type: Optional[Type[BaseException]],
+        __exc_value: Optional[BaseException],
+        __traceback: Optional[TracebackType],
+    ) -> None: ...
+
+class allocatorstate(ContextDecorator):
+    policy: Any
+    def __init__(self, policy: Any) -> None: ...
+    def __enter__(self) -> None: ...
+    def __exit__(
+        self,
+        __exc_type: Optional[Type[BaseException]],
+        __exc_value: Optional[BaseException],
+        __traceback: Optional[TracebackType],
+    ) -> None: ...
+
 class ndenumerate(Generic[_ScalarType]):
     iter: flatiter[NDArray[_ScalarType]]
     @overload
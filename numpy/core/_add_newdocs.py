@@ -4697,6 +4697,86 @@
     See `global_state` for more information.
     """)
 
+add_newdoc('numpy.core.multiarray', '_set_parallel_state',
+    """
+    _set_parallel_state(threads: int, threshold: int, linalg: bool) -> None
+
+    Set the number of threads, the minimum number of elements and whether
+    stacks of matrices are split for parallel execution. Use
+    `numpy.setparallel` instead.
+    See `global_state` for more information.
+    """)
+
+add_newdoc('numpy.core.multiarray', '_get_parallel_state',
+    """
+    _get_parallel_state() -> tuple[int, int, bool]
+
+    Return the current ``(threads, threshold, linalg)`` used for parallel
+    execution.
+    """)
+
+add_newdoc('numpy.core.multiarray', '_set_default_allocator',
+    """
+    _set_default_allocator(policy: str | PyCapsule) -> str | PyCapsule
+
+    Set the memory allocator used for new arrays by all threads which did
+    not select one using `numpy.allocatorstate`. Returns the previous
+    allocator. Use `numpy.setallocator` instead.
+    See `global_state` for more information.
+    """)
+
+add_newdoc('numpy.core.multiarray', '_get_allocator_handler',
+    """
+    _get_allocator_handler(policy: str | PyCapsule) -> PyCapsule
+
+    Return the ``mem_handler`` capsule of a built-in allocator given by name,
+    or validate and return a capsule.
+    """)
+
+add_newdoc('numpy.core.multiarray', '_set_mem_pool',
+    """
+    _set_mem_pool(max_block: int, max_bytes: int, idle_time: float) -> None
+
+    Set the limits of the pool of the default allocator. Use
+    `numpy.setmempool` instead.
+    """)
+
+add_newdoc('numpy.core.multiarray', '_get_mem_pool',
+    """
+    _get_mem_pool() -> tuple[int, int, float]
+
+    Return the current ``(max_block, max_bytes, idle_time)`` of the pool of
+    the default allocator.
+    """)
+
+add_newdoc('numpy.core.multiarray', '_get_mem_pool_stats',
+    """
+    _get_mem_pool_stats() -> dict
+
+    Return the statistics of the pool of the default allocator. Use
+    `numpy.mempoolstats` instead.
+    """)
+
+add_newdoc('numpy.core.multiarray', 'get_handler_name',
+    """
+    get_handler_name(a: ndarray) -> str | None
+
+    Return the name of the memory handler used by `a`. If not provided, return
+    the name of the memory handler that will be used to allocate data for the
+    next `ndarray` in this context. May return None if `a` does not own its
+    memory, in which case you can traverse ``a.base`` for a memory handler.
+    """)
+
+add_newdoc('numpy.core.multiarray', 'get_handler_version',
+    """
+    get_handler_version(a: ndarray) -> int | None
+
+    Return the version of the memory handler used by `a`. If not provided,
+    return the version of the memory handler that will be used to allocate data
+    for the next `ndarray` in this context. May return None if `a` does not own
+    its memory, in which case you can traverse ``a.base`` for a memory handler.
+    """)
+
 add_newdoc('numpy.core._multiarray_tests', 'format_float_OSprintf_g',
     """
     format_float_OSprintf_g(val, precision)
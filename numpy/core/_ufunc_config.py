@@ -5,6 +5,8 @@
 """
 import collections.abc
 import contextlib
+import operator
+import os
 
 from .overrides import set_module
 from .umath import (
@@ -13,10 +15,17 @@
     SHIFT_DIVIDEBYZERO, SHIFT_OVERFLOW, SHIFT_UNDERFLOW, SHIFT_INVALID,
 )
 from . import umath
+from .multiarray import (
+    _get_parallel_state, _set_parallel_state, _set_default_allocator,
+    _get_allocator_handler, _current_allocator, get_handler_name,
+    _set_mem_pool, _get_mem_pool, _get_mem_pool_stats,
+)
 
 __all__ = [
     "seterr", "geterr", "setbufsize", "getbufsize", "seterrcall", "geterrcall",
-    "errstate",
+    "errstate", "setparallel", "getparallel", "parallelstate",
+    "setallocator", "getallocator", "allocatorstate",
+    "setmempool", "getmempool", "mempoolstats",
 ]
 
 _errdict = {"ignore": ERR_IGNORE,
@@ -437,6 +446,445 @@ def __exit__(self, *exc_info):
             seterrcall(self.oldcall)
 
 
+@set_module('numpy')
+def setparallel(threads=None, threshold=None, linalg=None):
+    """
+    Set how many threads NumPy uses to execute operations in parallel.
+
+    By default NumPy executes every operation on the calling thread.  When
+    more than one thread is requested, the elementwise loops of ufuncs
+    operating on at least `threshold` elements are split into chunks
+    which are executed concurrently by a pool of worker threads.  The
+    results are bit-identical to serial execution.  Reductions over all
+    elements or over the last axis are split into parts which do not
+    depend on the number of threads, sorts work on several lanes (or
+    parts of a single large lane) at once and large texts are parsed in
+    chunks by `loadtxt`, `fromfile` and `fromstring` (see
+    :ref:`parallel_execution`).  Stacks of matrices in `numpy.linalg` are
+    only split when `linalg` is enabled.
+
+    .. versionadded:: 1.22.0
+
+    Parameters
+    ----------
+    threads : int, optional
+        The number of threads to use, including the calling thread.  ``1``
+        (the default) disables parallel execution.  Use `os.cpu_count` to
+        use all cores of the machine.
+    threshold : int, optional
+        The minimum number of elements an operation has to process before
+        it is executed in parallel.  Splitting small operations costs more
+        than it gains.
+    linalg : bool, optional
+        Whether the functions of `numpy.linalg` may split stacks of
+        matrices across the threads (the default is ``False``).  This needs
+        a reentrant LAPACK library which does not use threads of its own,
+        it has no effect when NumPy uses its bundled ``lapack_lite``.
+
+    Returns
+    -------
+    old_settings : dict
+        Dictionary containing the old settings.
+
+    See Also
+    --------
+    getparallel, parallelstate
+
+    Notes
+    -----
+    The settings are global to the process (unlike the error handling
+    set by `seterr`, which is per thread).  Only one operation at a time
+    runs in parallel; if several Python threads run NumPy operations at
+    the same time, all but one of them execute serially.
+
+    Ufunc loops which require the Python API (e.g. for object arrays) are
+    always executed serially.
+
+    Examples
+    --------
+    >>> old_settings = np.setparallel(threads=4)
+    >>> np.getparallel()['threads']
+    4
+    >>> np.setparallel(**old_settings)
+    {'threads': 4, 'threshold': 65536, 'linalg': False}
+
+    """
+    old = getparallel()
+    if threads is None:
+        threads = old['threads']
+    if threshold is None:
+        threshold = old['threshold']
+    if linalg is None:
+        linalg = old['linalg']
+    _set_parallel_state(operator.index(threads), operator.index(threshold),
+                        bool(linalg))
+    return old
+
+
+@set_module('numpy')
+def getparallel():
+    """
+    Get the settings used for executing operations in parallel.
+
+    .. versionadded:: 1.22.0
+
+    Returns
+    -------
+    res : dict
+        A dictionary with the keys ``"threads"`` (the number of threads,
+        including the calling thread), ``"threshold"`` (the minimum
+        number of elements for going parallel) and ``"linalg"`` (whether
+        stacks of matrices are split).
+
+    See Also
+    --------
+    setparallel, parallelstate
+
+    Examples
+    --------
+    >>> np.getparallel()
+    {'threads': 1, 'threshold': 65536, 'linalg': False}
+
+    """
+    threads, threshold, linalg = _get_parallel_state()
+    return {'threads': threads, 'threshold': threshold, 'linalg': linalg}
+
+
+@set_module('numpy')
+class parallelstate(contextlib.ContextDecorator):
+    """
+    parallelstate(**kwargs)
+
+    Context manager for parallel execution of NumPy operations.
+
+    Upon entering the context the settings are changed with `setparallel`
+    and upon exiting they are reset to what they were before.  Can also be
+    used as a function decorator.
+
+    .. versionadded:: 1.22.0
+
+    Parameters
+    ----------
+    kwargs : {threads, threshold, linalg}
+        Keyword arguments as accepted by `setparallel`.
+
+    See Also
+    --------
+    setparallel, getparallel
+
+    Notes
+    -----
+    The parallel settings are global to the process, entering the context
+    changes them for all threads.
+
+    Examples
+    --------
+    >>> a = np.arange(10**6, dtype=np.float64)
+    >>> with np.parallelstate(threads=4, threshold=10000):
+    ...     b = np.exp(a / 10**6)
+    >>> np.getparallel()['threads']
+    1
+
+    """
+
+    def __init__(self, **kwargs):
+        self.kwargs = kwargs
+
+    def __enter__(self):
+        self.oldstate = setparallel(**self.kwargs)
+
+    def __exit__(self, *exc_info):
+        setparallel(**self.oldstate)
+
+
+@set_module('numpy')
+def setallocator(policy):
+    """
+    Set the memory allocator used for the data of new arrays.
+
+    The allocator is used by all threads which did not select one with
+    `allocatorstate`.  Arrays keep using the allocator which allocated
+    their data to free it, so the allocator can be changed at any time.
+
+    .. versionadded:: 1.22.0
+
+    Parameters
+    ----------
+    policy : str or PyCapsule
+        The name of a built-in allocator (see Notes) or a ``"mem_handler"``
+        PyCapsule containing a ``PyDataMem_Handler`` provided by a C
+        extension.
+
+    Returns
+    -------
+    old_policy : str or PyCapsule
+        The previous allocator, the name of a built-in one or a PyCapsule.
+
+    See Also
+    --------
+    getallocator, allocatorstate
+
+    Notes
+    -----
+    The built-in allocators are:
+
+    ``"default_allocator"``
+        ``malloc``, with a cache for small blocks.
+    ``"aligned_allocator"``
+        Data aligned to 64 bytes (a cache line).
+    ``"hugepage_allocator"``
+        Blocks of 2 MiB or more are mapped with huge pages, which saves page
+        faults and TLB misses.  Pages reserved by the system administrator
+        (``MAP_HUGETLB``) are used if available, otherwise transparent huge
+        pages are requested.
+    ``"numa_local_allocator"``, ``"numa_interleave_allocator"``
+        The pages of blocks of 1 MiB or more are placed on the NUMA node of
+        the thread which touches them first, or interleaved across all
+        nodes.  Zeroed arrays (e.g. from `zeros`) are not touched when
+        allocating, so that the threads working on them (see `setparallel`)
+        place their pages.
+    ``"arena_allocator"``
+        Blocks of up to 16 MiB are carved out of 64 MiB chunks by bumping a
+        pointer, a chunk is reused once all of its blocks are freed.  This
+        avoids page faults for short lived temporaries, but a single array
+        kept alive keeps its chunk alive.
+
+    All but the default allocator align the data to 64 bytes.  Huge pages
+    and NUMA placement are only available on Linux, on other systems these
+    allocators behave like ``"aligned_allocator"``.
+
+    Examples
+    --------
+    >>> old = np.setallocator("hugepage_allocator")
+    >>> np.getallocator()
+    'hugepage_allocator'
+    >>> np.setallocator(old)
+    'hugepage_allocator'
+
+    """
+    return _set_default_allocator(policy)
+
+
+@set_module('numpy')
+def getallocator():
+    """
+    Get the name of the memory allocator used for the data of new arrays.
+
+    .. versionadded:: 1.22.0
+
+    Returns
+    -------
+    name : str
+        The name of the allocator selected by `setallocator` or
+        `allocatorstate`.
+
+    See Also
+    --------
+    setallocator, allocatorstate
+
+    Examples
+    --------
+    >>> np.getallocator()
+    'default_allocator'
+
+    """
+    return get_handler_name()
+
+
+@set_module('numpy')
+class allocatorstate(contextlib.ContextDecorator):
+    """
+    allocatorstate(policy)
+
+    Context manager for the memory allocator used for new arrays.
+
+    Upon entering the context the allocator is changed and upon exiting it
+    is reset to what it was before.  Unlike `setallocator` this only affects
+    the current thread (or asynchronous task), as the allocator is stored in
+    a `contextvars.ContextVar`.  Can also be used as a function decorator.
+
+    .. versionadded:: 1.22.0
+
+    Parameters
+    ----------
+    policy : str or PyCapsule
+        The allocator, as accepted by `setallocator`.
+
+    See Also
+    --------
+    setallocator, getallocator
+
+    Examples
+    --------
+    >>> with np.allocatorstate("arena_allocator"):
+    ...     a = np.ones(1000)
+    ...     np.getallocator()
+    'arena_allocator'
+    >>> np.getallocator()
+    'default_allocator'
+
+    """
+
+    def __init__(self, policy):
+        self.policy = policy
+
+    def __enter__(self):
+        self.token = _current_allocator.set(
+            _get_allocator_handler(self.policy))
+
+    def __exit__(self, *exc_info):
+        _current_allocator.reset(self.token)
+
+
+@set_module('numpy')
+def setmempool(max_block=None, max_bytes=None, idle_time=None):
+    """
+    Set how the default allocator caches freed blocks of memory.
+
+    Freeing the data of a large array normally returns its memory to the
+    system, and the next array of that size has to fault in and zero fresh
+    pages.  The default allocator can instead keep freed blocks of 1 KiB up
+    to `max_block` bytes in a pool and use them again for new arrays.  The
+    pool is disabled by default, setting `max_bytes` enables it.  While it
+    is enabled, arrays of these sizes get a block of the next power of two
+    bytes.
+
+    .. versionadded:: 1.22.0
+
+    Parameters
+    ----------
+    max_block : int, optional
+        The largest block which is cached, at most 64 MiB (the default).
+        ``0`` disables the pool.
+    max_bytes : int, optional
+        The total size of the cached blocks.  ``0`` (the default) disables
+        the pool.
+    idle_time : float, optional
+        Blocks which were not used again for this many seconds (1 by
+        default) are returned to the system.  Use ``np.inf`` to keep them.
+
+    Returns
+    -------
+    old_settings : dict
+        Dictionary containing the old settings.
+
+    See Also
+    --------
+    getmempool, mempoolstats, setallocator
+
+    Notes
+    -----
+    The pool is shared by all threads and does not need the GIL.  Each
+    thread keeps a few blocks of up to 4 MiB for itself, which are moved to
+    the shared pool when it exits.  Idle blocks are only looked for while
+    the pool is in use, a program which stops using NumPy keeps its cached
+    blocks.  Lowering the limits releases the blocks exceeding them, except
+    for those kept by other threads.  Disabling the pool releases all
+    blocks of the shared pool and of the calling thread.
+
+    Only blocks allocated while the pool is enabled are cached, blocks
+    resized or freed by the legacy ``PyDataMem_RENEW`` or ``PyDataMem_FREE``
+    C functions are not.
+
+    Only the ``"default_allocator"`` (see `setallocator`) uses the pool.
+
+    Examples
+    --------
+    >>> old_settings = np.setmempool(max_bytes=2**28)  # cache up to 256 MiB
+    >>> np.getmempool()['max_bytes']
+    268435456
+    >>> np.setmempool(**old_settings)  # disable the pool again
+    {'max_block': 67108864, 'max_bytes': 268435456, 'idle_time': 1.0}
+
+    """
+    old = getmempool()
+    if max_block is None:
+        max_block = old['max_block']
+    if max_bytes is None:
+        max_bytes = old['max_bytes']
+    if idle_time is None:
+        idle_time = old['idle_time']
+    _set_mem_pool(operator.index(max_block), operator.index(max_bytes),
+                  float(idle_time))
+    return old
+
+
+@set_module('numpy')
+def getmempool():
+    """
+    Get the settings of the pool of the default allocator.
+
+    .. versionadded:: 1.22.0
+
+    Returns
+    -------
+    res : dict
+        A dictionary with the keys ``"max_block"``, ``"max_bytes"`` and
+        ``"idle_time"``, see `setmempool`.
+
+    See Also
+    --------
+    setmempool, mempoolstats
+
+    Examples
+    --------
+    >>> np.getmempool()
+    {'max_block': 67108864, 'max_bytes': 0, 'idle_time': 1.0}
+
+    """
+    max_block, max_bytes, idle_time = _get_mem_pool()
+    return {'max_block': max_block, 'max_bytes': max_bytes,
+            'idle_time': idle_time}
+
+
+@set_module('numpy')
+def mempoolstats():
+    """
+    Get statistics of the pool of the default allocator.
+
+    .. versionadded:: 1.22.0
+
+    Returns
+    -------
+    res : dict
+        A dictionary with the keys
+
+        - ``"hits"``: the number of allocations using a cached block.
+        - ``"misses"``: the number of allocations of a cached size which
+          found no block.
+        - ``"released"``: the number of freed blocks which were not cached
+          because the pool was full.
+        - ``"trimmed"``: the number of cached blocks released because they
+          were idle or exceeded the limits.
+        - ``"cached_bytes"``: the total size of the cached blocks.
+        - ``"cached_blocks"``: a dictionary mapping block sizes to the
+          number of cached blocks of that size.
+
+        The counters include all threads, they are approximate while other
+        threads allocate memory.
+
+    See Also
+    --------
+    setmempool, getmempool
+
+    Examples
+    --------
+    >>> old_settings = np.setmempool(max_bytes=2**28)
+    >>> a = np.ones(100000)
+    >>> del a
+    >>> np.mempoolstats()['cached_blocks']  # doctest: +SKIP
+    {1048576: 1}
+    >>> np.setmempool(**old_settings)  # doctest: +SKIP
+
+    """
+    return _get_mem_pool_stats()
+
+
+def _reinit_parallel():
+    # Worker threads do not survive a fork, start them again in the child
+    _set_parallel_state(*_get_parallel_state())
+
+
 def _setdef():
     defval = [UFUNC_BUFSIZE_DEFAULT, ERR_DEFAULT, None]
     umath.seterrobj(defval)
@@ -444,3 +892,6 @@ def _setdef():
 
 # set the default values
 _setdef()
+
+if hasattr(os, 'register_at_fork'):
+    os.register_at_fork(after_in_child=_reinit_parallel)
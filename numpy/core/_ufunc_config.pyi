@@ -1,5 +1,5 @@
 import sys
-from typing import Optional, Union, Callable, Any
+from typing import Optional, Union, Callable, Any, Dict
 
 if sys.version_info >= (3, 8):
     from typing import Literal, Protocol, TypedDict
@@ -25,6 +25,29 @@ class _ErrDictOptional(TypedDict, total=False):
     under: Optional[_ErrKind]
     invalid: Optional[_ErrKind]
 
+class _ParallelDict(TypedDict):
+    threads: int
+    threshold: int
+    linalg: bool
+
+class _ParallelDictOptional(TypedDict, total=False):
+    threads: Optional[int]
+    threshold: Optional[int]
+    linalg: Optional[bool]
+
+class _MemPoolDict(TypedDict):
+    max_block: int
+    max_bytes: int
+    idle_time: float
+
+class _MemPoolStatsDict(TypedDict):
+    hits: int
+    misses: int
+    released: int
+    trimmed: int
+    cached_bytes: int
+    cached_blocks: Dict[int, int]
+
 def seterr(
     all: Optional[_ErrKind] = ...,
     divide: Optional[_ErrKind] = ...,
@@ -39,5 +62,23 @@ def seterrcall(
     func: Union[None, _ErrFunc, _SupportsWrite]
 ) -> Union[None, _ErrFunc, _SupportsWrite]: ...
 def geterrcall() -> Union[None, _ErrFunc, _SupportsWrite]: ...
+def setparallel(
+    threads: Optional[int] = ...,
+    threshold: Optional[int] = ...,
+    linalg: Optional[bool] = ...,
+) -> _ParallelDict: ...
+def getparallel() -> _ParallelDict: ...
+
+# The policy is the name of a built-in allocator or a "mem_handler" PyCapsule
+def setallocator(policy: Any) -> Any: ...
+def getallocator() -> str: ...
+def setmempool(
+    max_block: Optional[int] = ...,
+    max_bytes: Optional[int] = ...,
+    idle_time: Optional[float] = ...,
+) -> _MemPoolDict: ...
+def getmempool() -> _MemPoolDict: ...
+def mempoolstats() -> _MemPoolStatsDict: ...
 
-# See `numpy/__init__.pyi` for the `errstate` class
+# See `numpy/__init__.pyi` for the `errstate`, `parallelstate` and
+# `allocatorstate` classes
@@ -716,6 +716,12 @@ typedef struct tagPyArrayObject_fields {
     /* For weak references */
     PyObject *weakreflist;
     void *_buffer_info;  /* private buffer info, tagged to allow warning */
+    /*
+     * For arrays owning their data, the `PyDataMem_Handler` capsule used
+     * to allocate it (NULL if the data was allocated by other means).
+     * Added in NumPy 1.22, use PyArray_HANDLER to access it.
+     */
+    PyObject *mem_handler;
 } PyArrayObject_fields;
 
 /*
@@ -1578,6 +1584,12 @@ PyArray_CHKFLAGS(const PyArrayObject *arr, int flags)
     return (PyArray_FLAGS(arr) & flags) == flags;
 }
 
+static NPY_INLINE NPY_RETURNS_BORROWED_REF PyObject *
+PyArray_HANDLER(PyArrayObject *arr)
+{
+    return ((PyArrayObject_fields *)arr)->mem_handler;
+}
+
 static NPY_INLINE PyObject *
 PyArray_GETITEM(const PyArrayObject *arr, const char *itemptr)
 {
@@ -1615,6 +1627,7 @@ PyArray_SETITEM(PyArrayObject *arr, char *itemptr, PyObject *v)
                     (((PyArrayObject_fields *)(obj))->descr->elsize)
 #define PyArray_TYPE(obj) \
                     (((PyArrayObject_fields *)(obj))->descr->type_num)
+#define PyArray_HANDLER(obj) (((PyArrayObject_fields *)(obj))->mem_handler)
 #define PyArray_GETITEM(obj,itemptr) \
         PyArray_DESCR(obj)->f->getitem((char *)(itemptr), \
                                      (PyArrayObject *)(obj))
@@ -1848,6 +1861,29 @@ typedef struct {
 typedef void (PyDataMem_EventHookFunc)(void *inp, void *outp, size_t size,
                                        void *user_data);
 
+/*
+ * Memory handler for array data, see PyDataMem_SetHandler.  All functions
+ * may be called without holding the GIL and must be thread-safe.  Unlike
+ * for PyMemAllocatorEx, `free` is also passed the size of the block.
+ */
+typedef struct {
+    void *ctx;
+    void* (*malloc) (void *ctx, size_t size);
+    void* (*calloc) (void *ctx, size_t nelem, size_t elsize);
+    void* (*realloc) (void *ctx, void *ptr, size_t new_size);
+    void (*free) (void *ctx, void *ptr, size_t size);
+    /*
+     * This is the end of the version=1 struct. Only add new fields after
+     * this line
+     */
+} PyDataMemAllocator;
+
+typedef struct {
+    char name[127];  /* multiple of 64 to keep the struct aligned */
+    npy_uint8 version; /* currently 1 */
+    PyDataMemAllocator allocator;
+} PyDataMem_Handler;
+
 
 /*
  * PyArray_DTypeMeta related definitions.
@@ -16,6 +16,9 @@
 from ._multiarray_umath import (
     _fastCopyAndTranspose, _flagdict, _insert, _reconstruct, _vec_string,
     _ARRAY_API, _monotonicity, _get_ndarray_c_version, _set_madvise_hugepage,
+    _get_parallel_state, _set_parallel_state, _unique_hash,
+    _isin_hash, _histogram, _set_default_allocator, _get_allocator_handler,
+    _current_allocator, _set_mem_pool, _get_mem_pool, _get_mem_pool_stats,
     )
 
 __all__ = [
@@ -727,6 +727,9 @@ def get_mathlib_info(*args):
             join('src', 'common', 'npy_import.h'),
             join('src', 'common', 'npy_hashtable.h'),
             join('src', 'common', 'npy_longdouble.h'),
+            join('src', 'common', 'npy_parallel.h'),
+            join('src', 'common', 'npy_ryu.h'),
+            join('src', 'common', 'npy_strtod.h'),
             join('src', 'common', 'templ_common.h.src'),
             join('src', 'common', 'ucsnarrow.h'),
             join('src', 'common', 'ufunc_override.h'),
@@ -742,6 +745,9 @@ def get_mathlib_info(*args):
             join('src', 'common', 'npy_argparse.c'),
             join('src', 'common', 'npy_hashtable.c'),
             join('src', 'common', 'npy_longdouble.c'),
+            join('src', 'common', 'npy_parallel.c'),
+            join('src', 'common', 'npy_ryu.c'),
+            join('src', 'common', 'npy_strtod.c'),
             join('src', 'common', 'templ_common.h.src'),
             join('src', 'common', 'ucsnarrow.c'),
             join('src', 'common', 'ufunc_override.c'),
@@ -783,6 +789,7 @@ def get_mathlib_info(*args):
             join('src', 'multiarray', 'common_dtype.h'),
             join('src', 'multiarray', 'convert_datatype.h'),
             join('src', 'multiarray', 'convert.h'),
+            join('src', 'multiarray', 'compress.h'),
             join('src', 'multiarray', 'conversion_utils.h'),
             join('src', 'multiarray', 'ctors.h'),
             join('src', 'multiarray', 'descriptor.h'),
@@ -791,7 +798,9 @@ def get_mathlib_info(*args):
             join('src', 'multiarray', 'dragon4.h'),
             join('src', 'multiarray', 'einsum_debug.h'),
             join('src', 'multiarray', 'einsum_sumprod.h'),
+            join('src', 'multiarray', 'gather.h'),
             join('src', 'multiarray', 'getset.h'),
+            join('src', 'multiarray', 'histogram.h'),
             join('src', 'multiarray', 'hashdescr.h'),
             join('src', 'multiarray', 'iterators.h'),
             join('src', 'multiarray', 'legacy_dtype_implementation.h'),
@@ -801,11 +810,20 @@ def get_mathlib_info(*args):
             join('src', 'multiarray', 'nditer_impl.h'),
             join('src', 'multiarray', 'number.h'),
             join('src', 'multiarray', 'refcount.h'),
+            join('src', 'multiarray', 'savetxt.h'),
             join('src', 'multiarray', 'scalartypes.h'),
             join('src', 'multiarray', 'sequence.h'),
             join('src', 'multiarray', 'shape.h'),
             join('src', 'multiarray', 'strfuncs.h'),
+            join('src', 'multiarray', 'textreading', 'conversions.h'),
+            join('src', 'multiarray', 'textreading', 'parser_config.h'),
+            join('src', 'multiarray', 'textreading', 'readtext.h'),
+            join('src', 'multiarray', 'textreading', 'rows.h'),
+            join('src', 'multiarray', 'textreading', 'stream.h'),
+            join('src', 'multiarray', 'textreading', 'stream_pyobject.h'),
+            join('src', 'multiarray', 'textreading', 'tokenize.h'),
             join('src', 'multiarray', 'typeinfo.h'),
+            join('src', 'multiarray', 'unique.h'),
             join('src', 'multiarray', 'usertypes.h'),
             join('src', 'multiarray', 'vdot.h'),
             join('include', 'numpy', 'arrayobject.h'),
@@ -832,6 +850,7 @@ def get_mathlib_info(*args):
     multiarray_src = [
             join('src', 'multiarray', 'abstractdtypes.c'),
             join('src', 'multiarray', 'alloc.c'),
+            join('src', 'multiarray', 'alloc_policies.c'),
             join('src', 'multiarray', 'arrayobject.c'),
             join('src', 'multiarray', 'arraytypes.c.src'),
             join('src', 'multiarray', 'array_coercion.c'),
@@ -846,6 +865,9 @@ def get_mathlib_info(*args):
             join('src', 'multiarray', 'common_dtype.c'),
             join('src', 'multiarray', 'convert.c'),
             join('src', 'multiarray', 'convert_datatype.c'),
+            join('src', 'multiarray', 'contig_cast.h.src'),
+            join('src', 'multiarray', 'contig_cast.dispatch.c.src'),
+            join('src', 'multiarray', 'compress.dispatch.c.src'),
             join('src', 'multiarray', 'conversion_utils.c'),
             join('src', 'multiarray', 'ctors.c'),
             join('src', 'multiarray', 'datetime.c'),
@@ -859,8 +881,10 @@ def get_mathlib_info(*args):
             join('src', 'multiarray', 'einsum.c.src'),
             join('src', 'multiarray', 'einsum_sumprod.c.src'),
             join('src', 'multiarray', 'flagsobject.c'),
+            join('src', 'multiarray', 'gather.dispatch.c.src'),
             join('src', 'multiarray', 'getset.c'),
             join('src', 'multiarray', 'hashdescr.c'),
+            join('src', 'multiarray', 'histogram.c.src'),
             join('src', 'multiarray', 'item_selection.c'),
             join('src', 'multiarray', 'iterators.c'),
             join('src', 'multiarray', 'legacy_dtype_implementation.c'),
@@ -874,21 +898,30 @@ def get_mathlib_info(*args):
             join('src', 'multiarray', 'nditer_pywrap.c'),
             join('src', 'multiarray', 'number.c'),
             join('src', 'multiarray', 'refcount.c'),
+            join('src', 'multiarray', 'savetxt.c'),
             join('src', 'multiarray', 'sequence.c'),
             join('src', 'multiarray', 'shape.c'),
             join('src', 'multiarray', 'scalarapi.c'),
             join('src', 'multiarray', 'scalartypes.c.src'),
             join('src', 'multiarray', 'strfuncs.c'),
             join('src', 'multiarray', 'temp_elide.c'),
+            join('src', 'multiarray', 'textreading', 'conversions.c'),
+            join('src', 'multiarray', 'textreading', 'readtext.c'),
+            join('src', 'multiarray', 'textreading', 'rows.c'),
+            join('src', 'multiarray', 'textreading', 'stream_pyobject.c'),
+            join('src', 'multiarray', 'textreading', 'tokenize.c'),
             join('src', 'multiarray', 'typeinfo.c'),
+            join('src', 'multiarray', 'unique.c.src'),
             join('src', 'multiarray', 'usertypes.c'),
             join('src', 'multiarray', 'vdot.c'),
             join('src', 'common', 'npy_sort.h.src'),
             join('src', 'npysort', 'quicksort.c.src'),
+            join('src', 'npysort', 'simd_qsort.dispatch.c.src'),
             join('src', 'npysort', 'mergesort.c.src'),
             join('src', 'npysort', 'timsort.c.src'),
             join('src', 'npysort', 'heapsort.c.src'),
             join('src', 'npysort', 'radixsort.c.src'),
+            join('src', 'npysort', 'parallel_sort.c.src'),
             join('src', 'common', 'npy_partition.h.src'),
             join('src', 'npysort', 'selection.c.src'),
             join('src', 'common', 'npy_binsearch.h.src'),
@@ -926,6 +959,8 @@ def generate_umath_c(ext, build_dir):
             join('src', 'umath', 'loops_exponent_log.dispatch.c.src'),
             join('src', 'umath', 'matmul.h.src'),
             join('src', 'umath', 'matmul.c.src'),
+            join('src', 'umath', 'gemm.dispatch.c.src'),
+            join('src', 'umath', 'gemm.c'),
             join('src', 'umath', 'clip.h.src'),
             join('src', 'umath', 'clip.c.src'),
             join('src', 'umath', 'dispatching.c'),
@@ -948,6 +983,7 @@ def generate_umath_c(ext, build_dir):
             join('src', 'common', 'templ_common.h.src'),
             join('src', 'umath', 'simd.inc.src'),
             join('src', 'umath', 'override.h'),
+            join('src', 'umath', 'gemm.h'),
             join(codegen_dir, 'generate_ufunc_api.py'),
             ]
 
@@ -0,0 +1,389 @@
+/*
+ * A minimal persistent thread pool for splitting GIL-free work across
+ * several cores, see `npy_parallel.h` for the interface.
+ *
+ * The pool only uses the portable thread primitives provided by Python
+ * (`PyThread_start_new_thread` and `PyThread_type_lock`), locks are used as
+ * binary semaphores:
+ *
+ *   - every worker owns a `wakeup` lock which is held while the worker is
+ *     idle.  Releasing it starts the worker on the current job.
+ *   - `finished` is held while a job is executing and released by the last
+ *     worker finishing its share of the job.
+ *   - `busy` is held by the thread running a job, so that only a single
+ *     job runs at any time.  Other callers (and nested calls from within a
+ *     task) simply run all tasks serially.
+ *
+ * Worker threads never touch Python objects and never acquire the GIL.
+ * Threads are started when the number of threads is raised and are kept
+ * alive (idle) afterwards.  After a fork, the pool of the child process is
+ * set up anew (see `numpy/core/_ufunc_config.py`), until then the child
+ * executes everything serially.
+ */
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#define _MULTIARRAYMODULE
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "pythread.h"
+
+#include "numpy/npy_common.h"
+#include "numpy/npy_math.h"
+
+#include "npy_config.h"
+#include "npy_parallel.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+
+typedef struct {
+    PyThread_type_lock wakeup;
+    /* index of the worker thread, the calling thread has index 0 */
+    int ithread;
+} parallel_worker;
+
+
+typedef struct {
+    /* Configuration, only modified while holding the GIL and `busy` */
+    int num_threads;
+    npy_intp threshold;
+    /* whether numpy.linalg may split stacks of matrices */
+    int linalg;
+
+    /* Started worker threads (the calling thread is not included) */
+    int nworkers;
+    parallel_worker *workers[NPY_PARALLEL_MAX_THREADS - 1];
+
+    PyThread_type_lock busy;
+    PyThread_type_lock finished;
+    PyThread_type_lock mutex;  /* protects `pending`, `result`, `fpstatus` */
+
+    /* The job which is currently executing */
+    npy_parallel_task_func *func;
+    void *data;
+    npy_intp ntasks;
+    int nthreads;
+    int pending;
+    int result;
+    int fpstatus;
+
+#ifndef _WIN32
+    /* The process which owns the worker threads */
+    pid_t pid;
+#endif
+} parallel_pool;
+
+
+static parallel_pool pool = {1, NPY_PARALLEL_DEFAULT_THRESHOLD, 0};
+
+
+NPY_NO_EXPORT int
+npy_parallel_get_num_threads(void)
+{
+    return pool.num_threads;
+}
+
+
+NPY_NO_EXPORT npy_intp
+npy_parallel_get_threshold(void)
+{
+    return pool.threshold;
+}
+
+
+NPY_NO_EXPORT int
+npy_parallel_get_linalg(void)
+{
+    return pool.linalg;
+}
+
+
+NPY_NO_EXPORT int
+npy_parallel_threads_for_size(npy_intp size)
+{
+    int num_threads = pool.num_threads;
+
+    if (num_threads <= 1 || size < pool.threshold || size < 2) {
+        return 1;
+    }
+    if (size < num_threads) {
+        return (int)size;
+    }
+    return num_threads;
+}
+
+
+/*
+ * Runs the share of thread `ithread` of the current job.
+ */
+static int
+run_tasks(npy_parallel_task_func *func, void *data,
+          npy_intp ntasks, int ithread, int nthreads)
+{
+    for (npy_intp itask = ithread; itask < ntasks; itask += nthreads) {
+        int res = func(data, itask, ithread);
+        if (res != 0) {
+            return res;
+        }
+    }
+    return 0;
+}
+
+
+static void
+worker_main(void *arg)
+{
+    parallel_worker *worker = (parallel_worker *)arg;
+
+    for (;;) {
+        int res, fpstatus, last;
+
+        /* Sleep until the next job is started */
+        PyThread_acquire_lock(worker->wakeup, WAIT_LOCK);
+
+        npy_clear_floatstatus_barrier((char *)worker);
+        res = run_tasks(pool.func, pool.data,
+                        pool.ntasks, worker->ithread, pool.nthreads);
+        fpstatus = npy_get_floatstatus_barrier((char *)worker);
+
+        PyThread_acquire_lock(pool.mutex, WAIT_LOCK);
+        pool.fpstatus |= fpstatus;
+        if (res != 0 && pool.result == 0) {
+            pool.result = res;
+        }
+        last = (--pool.pending == 0);
+        PyThread_release_lock(pool.mutex);
+
+        if (last) {
+            PyThread_release_lock(pool.finished);
+        }
+    }
+}
+
+
+/*
+ * Checks whether the pool belongs to this process.  The worker threads do
+ * not survive a fork, so the child has to set up the pool again.
+ */
+static int
+pool_is_alive(void)
+{
+#ifndef _WIN32
+    return pool.busy != NULL && pool.pid == getpid();
+#else
+    return pool.busy != NULL;
+#endif
+}
+
+
+/*
+ * (Re-)initializes the locks of the pool.  Locks and workers of a pool
+ * inherited from the parent process are leaked intentionally, since their
+ * state is undefined after a fork.
+ */
+static int
+pool_init(void)
+{
+    pool.nworkers = 0;
+    pool.busy = PyThread_allocate_lock();
+    pool.finished = PyThread_allocate_lock();
+    pool.mutex = PyThread_allocate_lock();
+    if (pool.busy == NULL || pool.finished == NULL || pool.mutex == NULL) {
+        pool.busy = NULL;
+        PyErr_NoMemory();
+        return -1;
+    }
+    /* `finished` is only released by the last worker of a job */
+    PyThread_acquire_lock(pool.finished, WAIT_LOCK);
+#ifndef _WIN32
+    pool.pid = getpid();
+#endif
+    return 0;
+}
+
+
+/*
+ * Starts worker threads until there are `nworkers` of them.  Must be called
+ * with the GIL and the `busy` lock held.
+ */
+static int
+pool_start_workers(int nworkers)
+{
+    while (pool.nworkers < nworkers) {
+        parallel_worker *worker = PyMem_RawMalloc(sizeof(parallel_worker));
+        if (worker == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        worker->ithread = pool.nworkers + 1;
+        worker->wakeup = PyThread_allocate_lock();
+        if (worker->wakeup == NULL) {
+            PyMem_RawFree(worker);
+            PyErr_NoMemory();
+            return -1;
+        }
+        /* The worker sleeps until the lock is released */
+        PyThread_acquire_lock(worker->wakeup, WAIT_LOCK);
+
+        if (PyThread_start_new_thread(worker_main, worker)
+                == PYTHREAD_INVALID_THREAD_ID) {
+            PyThread_free_lock(worker->wakeup);
+            PyMem_RawFree(worker);
+            PyErr_SetString(PyExc_RuntimeError,
+                    "could not start NumPy worker thread");
+            return -1;
+        }
+        pool.workers[pool.nworkers] = worker;
+        pool.nworkers++;
+    }
+    return 0;
+}
+
+
+NPY_NO_EXPORT int
+npy_parallel_run(npy_intp ntasks, int nthreads,
+                 npy_parallel_task_func *func, void *data)
+{
+    int res;
+
+    if (nthreads > ntasks) {
+        nthreads = (int)ntasks;
+    }
+    if (nthreads > 1 && (!pool_is_alive() ||
+            !PyThread_acquire_lock(pool.busy, NOWAIT_LOCK))) {
+        /* The pool is in use (or not set up); run everything serially */
+        nthreads = 1;
+    }
+    if (nthreads <= 1) {
+        return run_tasks(func, data, ntasks, 0, 1);
+    }
+    if (nthreads > pool.nworkers + 1) {
+        nthreads = pool.nworkers + 1;
+    }
+
+    pool.func = func;
+    pool.data = data;
+    pool.ntasks = ntasks;
+    pool.nthreads = nthreads;
+    pool.pending = nthreads - 1;
+    pool.result = 0;
+    pool.fpstatus = 0;
+
+    for (int i = 0; i < nthreads - 1; i++) {
+        PyThread_release_lock(pool.workers[i]->wakeup);
+    }
+    res = run_tasks(func, data, ntasks, 0, nthreads);
+
+    /* Wait for the workers; `pending` reaching zero releases the lock */
+    PyThread_acquire_lock(pool.finished, WAIT_LOCK);
+
+    if (res == 0) {
+        res = pool.result;
+    }
+    /* Raise the floating point exceptions of the workers on this thread */
+    if (pool.fpstatus & NPY_FPE_DIVIDEBYZERO) {
+        npy_set_floatstatus_divbyzero();
+    }
+    if (pool.fpstatus & NPY_FPE_OVERFLOW) {
+        npy_set_floatstatus_overflow();
+    }
+    if (pool.fpstatus & NPY_FPE_UNDERFLOW) {
+        npy_set_floatstatus_underflow();
+    }
+    if (pool.fpstatus & NPY_FPE_INVALID) {
+        npy_set_floatstatus_invalid();
+    }
+
+    PyThread_release_lock(pool.busy);
+    return res;
+}
+
+
+static npy_parallel_api parallel_api = {
+    &npy_parallel_threads_for_size,
+    &npy_parallel_run,
+    &npy_parallel_get_linalg,
+};
+
+
+NPY_NO_EXPORT PyObject *
+npy_parallel_api_capsule(void)
+{
+    return PyCapsule_New(&parallel_api, NPY_PARALLEL_API_NAME, NULL);
+}
+
+
+/*
+ * Sets the number of threads, the size threshold and the linalg flag used
+ * for parallel execution.  Exposed as `numpy.core.multiarray._set_parallel_state` and
+ * wrapped by `np.setparallel`.  Calling it in a forked child process sets
+ * up a new pool.
+ */
+NPY_NO_EXPORT PyObject *
+_set_parallel_state(PyObject *NPY_UNUSED(self), PyObject *args)
+{
+    int num_threads;
+    npy_intp threshold;
+    int linalg;
+    int res = 0;
+
+    if (!PyArg_ParseTuple(args, "inp:_set_parallel_state",
+                          &num_threads, &threshold, &linalg)) {
+        return NULL;
+    }
+    if (num_threads < 1 || num_threads > NPY_PARALLEL_MAX_THREADS) {
+        PyErr_Format(PyExc_ValueError,
+                "number of threads must be between 1 and %d, got %d",
+                NPY_PARALLEL_MAX_THREADS, num_threads);
+        return NULL;
+    }
+    if (threshold < 0) {
+        PyErr_SetString(PyExc_ValueError,
+                "parallel threshold must not be negative");
+        return NULL;
+    }
+
+    if (!pool_is_alive()) {
+        if (num_threads == 1) {
+            /* Nothing to set up, the pool is started lazily */
+            pool.num_threads = 1;
+            pool.threshold = threshold;
+            pool.linalg = linalg;
+            Py_RETURN_NONE;
+        }
+        if (pool_init() < 0) {
+            return NULL;
+        }
+    }
+
+    /* Wait for running jobs, they may need the GIL to finish */
+    Py_BEGIN_ALLOW_THREADS;
+    PyThread_acquire_lock(pool.busy, WAIT_LOCK);
+    Py_END_ALLOW_THREADS;
+
+    res = pool_start_workers(num_threads - 1);
+    /* If starting threads failed, use the ones we have */
+    pool.num_threads = res < 0 ? pool.nworkers + 1 : num_threads;
+    pool.threshold = threshold;
+    pool.linalg = linalg;
+
+    PyThread_release_lock(pool.busy);
+
+    if (res < 0) {
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+
+/*
+ * Returns the tuple `(num_threads, threshold, linalg)`.
+ */
+NPY_NO_EXPORT PyObject *
+_get_parallel_state(PyObject *NPY_UNUSED(self), PyObject *NPY_UNUSED(args))
+{
+    return Py_BuildValue("inN", pool.num_threads, pool.threshold,
+                         PyBool_FromLong(pool.linalg));
+}
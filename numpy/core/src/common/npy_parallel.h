@@ -0,0 +1,150 @@
+#ifndef _NPY_NPY_PARALLEL_H_
+#define _NPY_NPY_PARALLEL_H_
+
+#include <Python.h>
+
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#include "numpy/ndarraytypes.h"
+
+/*
+ * Intra-operation thread pool.
+ *
+ * Work which runs without the GIL (inner loops, reductions, sorting, ...)
+ * may be split into independent tasks which are executed by a small
+ * persistent pool of worker threads and the calling thread.  Parallel
+ * execution is opt-in: by default NumPy uses a single thread and the pool
+ * is only started once the number of threads is raised (from Python through
+ * `np.setparallel` or `np.parallelstate`).
+ *
+ * Only one parallel job runs at a time.  If the pool is busy (because
+ * another Python thread is using it or because a task tries to start a
+ * nested job), `npy_parallel_run` executes all tasks on the calling thread.
+ * Floating point exceptions raised on worker threads are merged into the
+ * floating point status of the calling thread once the job finishes.
+ */
+
+/* Upper limit for the number of threads (including the calling thread) */
+#define NPY_PARALLEL_MAX_THREADS 1024
+
+/* Default minimum problem size (in elements) for going parallel */
+#define NPY_PARALLEL_DEFAULT_THRESHOLD 65536
+
+/*
+ * A single task of a parallel job.  `itask` is the index of the task in
+ * `[0, ntasks)` and `ithread` the index of the executing thread in
+ * `[0, nthreads)`.  The calling thread always has index 0, so that `ithread`
+ * can be used to select per-thread scratch space.  Any non-zero return
+ * value is reported back as result of `npy_parallel_run`.
+ */
+typedef int (npy_parallel_task_func)(void *data, npy_intp itask, int ithread);
+
+/* The number of threads configured by the user (always >= 1) */
+NPY_NO_EXPORT int
+npy_parallel_get_num_threads(void);
+
+/* The minimum problem size configured by the user */
+NPY_NO_EXPORT npy_intp
+npy_parallel_get_threshold(void);
+
+/*
+ * Whether the user allowed numpy.linalg to split stacks of matrices, which
+ * is only safe with a reentrant LAPACK.
+ */
+NPY_NO_EXPORT int
+npy_parallel_get_linalg(void);
+
+/*
+ * Returns the number of threads that should be used for a problem of
+ * `size` elements (1 means the work should be done serially).
+ */
+NPY_NO_EXPORT int
+npy_parallel_threads_for_size(npy_intp size);
+
+/*
+ * Execute `ntasks` tasks using up to `nthreads` threads.  Tasks are
+ * assigned statically, thread `i` executes tasks `i, i + nthreads, ...`.
+ * This function does not require the GIL and should normally be called
+ * after releasing it.
+ *
+ * Returns 0 on success, otherwise the non-zero return value of a failing
+ * task.  After a task fails, the remaining tasks of that thread are skipped.
+ */
+NPY_NO_EXPORT int
+npy_parallel_run(npy_intp ntasks, int nthreads,
+                 npy_parallel_task_func *func, void *data);
+
+/*
+ * Splits `n` items into `nchunks` consecutive chunks and returns the bounds
+ * of chunk `ichunk`.  Chunk boundaries are multiples of `align` (except the
+ * last one), which helps avoiding false sharing of cache lines.
+ */
+static NPY_INLINE void
+npy_parallel_chunk_bounds(npy_intp n, npy_intp nchunks, npy_intp ichunk,
+                          npy_intp align, npy_intp *start, npy_intp *stop)
+{
+    npy_intp chunk = (n + nchunks - 1) / nchunks;
+    if (align > 1) {
+        chunk = (chunk + align - 1) / align * align;
+    }
+    *start = chunk * ichunk;
+    *stop = *start + chunk;
+    if (*start > n) {
+        *start = n;
+    }
+    if (*stop > n) {
+        *stop = n;
+    }
+}
+
+/*
+ * The thread pool is shared with the other extension modules of NumPy
+ * (which cannot link against the functions above) through this table of
+ * functions.  It is stored as capsule `numpy.core._multiarray_umath.
+ * _parallel_api`, use `npy_parallel_import_api` to fetch it.
+ */
+typedef struct {
+    int (*threads_for_size)(npy_intp size);
+    int (*run)(npy_intp ntasks, int nthreads,
+               npy_parallel_task_func *func, void *data);
+    int (*get_linalg)(void);
+} npy_parallel_api;
+
+#define NPY_PARALLEL_API_NAME "numpy.core._multiarray_umath._parallel_api"
+
+/* Returns a new capsule holding the function table */
+NPY_NO_EXPORT PyObject *
+npy_parallel_api_capsule(void);
+
+/*
+ * Fetches the function table from `numpy.core._multiarray_umath`, returns
+ * NULL with an exception set on failure.  Meant to be called once when
+ * initializing an extension module.
+ */
+static NPY_INLINE npy_parallel_api *
+npy_parallel_import_api(void)
+{
+    PyObject *capsule;
+    npy_parallel_api *api;
+
+    capsule = PyImport_ImportModule("numpy.core._multiarray_umath");
+    if (capsule == NULL) {
+        return NULL;
+    }
+    Py_SETREF(capsule, PyObject_GetAttrString(capsule, "_parallel_api"));
+    if (capsule == NULL) {
+        return NULL;
+    }
+    api = PyCapsule_GetPointer(capsule, NPY_PARALLEL_API_NAME);
+    /* The table is static, so it stays valid */
+    Py_DECREF(capsule);
+    return api;
+}
+
+/* Python-exposed functions, set up as `numpy.core.multiarray._*` */
+NPY_NO_EXPORT PyObject *
+_set_parallel_state(PyObject *NPY_UNUSED(self), PyObject *args);
+
+NPY_NO_EXPORT PyObject *
+_get_parallel_state(PyObject *NPY_UNUSED(self), PyObject *NPY_UNUSED(args));
+
+#endif  /* _NPY_NPY_PARALLEL_H_ */
@@ -0,0 +1,31 @@
+#ifndef _NPY_NPY_RYU_H_
+#define _NPY_NPY_RYU_H_
+
+#include "numpy/ndarraytypes.h"
+
+/* Maximum number of digits written by `npy_ryu_shortest_digits` */
+#define NPY_RYU_MAX_DIGITS 17
+
+/*
+ * Shortest decimal digits which uniquely identify the binary floating point
+ * value `mantissa * 2**exponent`, using the Ryu algorithm.  Among several
+ * shortest candidates the one closest to the exact value is chosen (ties
+ * round to an even digit), so the digits are identical to the ones produced
+ * by Dragon4 in `DigitMode_Unique` without a cutoff.
+ *
+ * The mantissa must be non-zero and fit into 53 bits and the exponent must
+ * lie in the binary64 range [-1074, 971], so float16, float32 and float64
+ * values are all supported (with the margins of their own type).
+ * `unequal_margins` is set if the gap to the next smaller value is half the
+ * gap to the next larger one (a power of two which is not subnormal).
+ *
+ * The digits (without NUL termination) are written to `buffer`, which must
+ * hold at least NPY_RYU_MAX_DIGITS characters, and their number is returned.
+ * `exp10` receives the base 10 exponent of the first digit.
+ */
+NPY_NO_EXPORT int
+npy_ryu_shortest_digits(npy_uint64 mantissa, npy_int32 exponent,
+                        npy_bool unequal_margins, char *buffer,
+                        npy_int32 *exp10);
+
+#endif  /* _NPY_NPY_RYU_H_ */
@@ -0,0 +1,30 @@
+#ifndef _NPY_NPY_STRTOD_H_
+#define _NPY_NPY_STRTOD_H_
+
+#include "numpy/ndarraytypes.h"
+
+/*
+ * Correctly rounded (round half to even) conversion of decimal strings to
+ * float64 and float32 which does not need the GIL.
+ *
+ * Both functions parse the longest prefix of `s` matching
+ *
+ *     [+-] digits [. digits] [(e|E) [+-] digits]
+ *
+ * where at least one mantissa digit is required.  Leading whitespace and
+ * the inf/nan spellings are not accepted, callers handle those.  On success
+ * 0 is returned and `endptr` points behind the number.  If there is no
+ * number at the start of `s`, -1 is returned and neither `endptr` nor
+ * `result` are touched.  Values which are too large for the type give +-inf,
+ * values which are too small give (signed) zero.
+ *
+ * Float32 results are rounded once from the decimal value, so they can differ
+ * from first parsing to float64 and then casting (which rounds twice).
+ */
+NPY_NO_EXPORT int
+npy_strtod_decimal(const char *s, char **endptr, double *result);
+
+NPY_NO_EXPORT int
+npy_strtof_decimal(const char *s, char **endptr, float *result);
+
+#endif  /* _NPY_NPY_STRTOD_H_ */
@@ -12,6 +12,7 @@
 #include "npy_config.h"
 
 #include "npy_pycompat.h"
+#include "npy_strtod.h"
 
 #ifdef HAVE_STRTOLD_L
 #include <stdlib.h>
@@ -408,7 +409,7 @@ NumPyOS_ascii_tolower(int c)
  *
  * Same as strncasecmp under C locale
  */
-static int
+NPY_NO_EXPORT int
 NumPyOS_ascii_strncasecmp(const char* s1, const char* s2, size_t len)
 {
     while (len > 0 && *s1 != '\0' && *s2 != '\0') {
@@ -450,29 +451,17 @@ NumPyOS_ascii_strtod_plain(const char *s, char** endptr)
 }
 
 /*
- * NumPyOS_ascii_strtod:
- *
- * Work around bugs in PyOS_ascii_strtod
+ * Recognize POSIX inf/nan representations on all platforms.  Returns 0 and
+ * sets `result` and `endptr` if `s` starts with one, -1 otherwise.
  */
-NPY_NO_EXPORT double
-NumPyOS_ascii_strtod(const char *s, char** endptr)
+static int
+NumPyOS_ascii_strtod_special(const char *s, char **endptr, double *result)
 {
-    const char *p;
-    double result;
+    const char *p = s;
+    double sign = 1.0;
 
-    while (NumPyOS_ascii_isspace(*s)) {
-        ++s;
-    }
-
-    /*
-     * ##1
-     *
-     * Recognize POSIX inf/nan representations on all platforms.
-     */
-    p = s;
-    result = 1.0;
     if (*p == '-') {
-        result = -1.0;
+        sign = -1.0;
         ++p;
     }
     else if (*p == '+') {
@@ -489,26 +478,77 @@ NumPyOS_ascii_strtod(const char *s, char** endptr)
                 ++p;
             }
         }
-        if (endptr != NULL) {
-            *endptr = (char*)p;
-        }
-        return NPY_NAN;
+        *endptr = (char*)p;
+        *result = NPY_NAN;
+        return 0;
     }
     else if (NumPyOS_ascii_strncasecmp(p, "inf", 3) == 0) {
         p += 3;
         if (NumPyOS_ascii_strncasecmp(p, "inity", 5) == 0) {
             p += 5;
         }
+        *endptr = (char*)p;
+        *result = sign*NPY_INFINITY;
+        return 0;
+    }
+    return -1;
+}
+
+/*
+ * NumPyOS_ascii_strtod:
+ *
+ * Work around bugs in PyOS_ascii_strtod.  Decimal numbers are converted
+ * (correctly rounded) without taking the GIL, so this may be used from
+ * worker threads.
+ */
+NPY_NO_EXPORT double
+NumPyOS_ascii_strtod(const char *s, char** endptr)
+{
+    char *p;
+    double result;
+
+    while (NumPyOS_ascii_isspace(*s)) {
+        ++s;
+    }
+    if (NumPyOS_ascii_strtod_special(s, &p, &result) == 0 ||
+            npy_strtod_decimal(s, &p, &result) == 0) {
         if (endptr != NULL) {
-            *endptr = (char*)p;
+            *endptr = p;
         }
-        return result*NPY_INFINITY;
+        return result;
     }
-    /* End of ##1 */
-
+    /* Not a number, the Python parser takes care of reporting that */
     return NumPyOS_ascii_strtod_plain(s, endptr);
 }
 
+/*
+ * NumPyOS_ascii_strtof:
+ *
+ * Like NumPyOS_ascii_strtod, but rounds decimal numbers directly to float
+ * (rounding to double and then to float may give a different result).
+ */
+NPY_NO_EXPORT float
+NumPyOS_ascii_strtof(const char *s, char** endptr)
+{
+    char *p;
+    double special;
+    float result;
+
+    while (NumPyOS_ascii_isspace(*s)) {
+        ++s;
+    }
+    if (NumPyOS_ascii_strtod_special(s, &p, &special) == 0) {
+        result = (float)special;
+    }
+    else if (npy_strtof_decimal(s, &p, &result) < 0) {
+        return (float)NumPyOS_ascii_strtod_plain(s, endptr);
+    }
+    if (endptr != NULL) {
+        *endptr = p;
+    }
+    return result;
+}
+
 NPY_NO_EXPORT long double
 NumPyOS_ascii_strtold(const char *s, char** endptr)
 {
@@ -754,6 +794,22 @@ NumPyOS_ascii_ftolf(FILE *fp, double *value)
     return r;
 }
 
+NPY_NO_EXPORT int
+NumPyOS_ascii_ftof(FILE *fp, float *value)
+{
+    char buffer[FLOAT_FORMATBUFLEN + 1];
+    char *p;
+    int r;
+
+    r = read_numberlike_string(fp, buffer, FLOAT_FORMATBUFLEN+1);
+
+    if (r != EOF && r != 0) {
+        *value = NumPyOS_ascii_strtof(buffer, &p);
+        r = (p == buffer) ? 0 : 1;
+    }
+    return r;
+}
+
 NPY_NO_EXPORT int
 NumPyOS_ascii_ftoLf(FILE *fp, long double *value)
 {
@@ -19,18 +19,27 @@ NumPyOS_ascii_formatl(char *buffer, size_t buf_size,
 NPY_NO_EXPORT double
 NumPyOS_ascii_strtod(const char *s, char** endptr);
 
+NPY_NO_EXPORT float
+NumPyOS_ascii_strtof(const char *s, char** endptr);
+
 NPY_NO_EXPORT long double
 NumPyOS_ascii_strtold(const char *s, char** endptr);
 
 NPY_NO_EXPORT int
 NumPyOS_ascii_ftolf(FILE *fp, double *value);
 
+NPY_NO_EXPORT int
+NumPyOS_ascii_ftof(FILE *fp, float *value);
+
 NPY_NO_EXPORT int
 NumPyOS_ascii_ftoLf(FILE *fp, long double *value);
 
 NPY_NO_EXPORT int
 NumPyOS_ascii_isspace(int c);
 
+NPY_NO_EXPORT int
+NumPyOS_ascii_strncasecmp(const char* s1, const char* s2, size_t len);
+
 /* Convert a string to an int in an arbitrary base */
 NPY_NO_EXPORT npy_longlong
 NumPyOS_strtoll(const char *str, char **endptr, int base);
@@ -17,8 +17,10 @@
 #include "npy_config.h"
 #include "alloc.h"
 
+#include <pythread.h>
 
 #include <assert.h>
+#include <time.h>
 
 #ifdef NPY_OS_LINUX
 #include <sys/mman.h>
@@ -44,6 +46,9 @@ static cache_bucket dimcache[NBUCKETS_DIM];
 
 static int _madvise_hugepage = 1;
 
+/* The legacy functions may resize blocks of the pool, see below */
+static int record_pop(void *ptr);
+
 
 /*
  * This function enables or disables the use of `MADV_HUGEPAGE` on Linux
@@ -68,6 +73,24 @@ _set_madvise_hugepage(PyObject *NPY_UNUSED(self), PyObject *enabled_obj)
 }
 
 
+static NPY_INLINE void
+indicate_hugepages(void *p, size_t size)
+{
+#ifdef NPY_OS_LINUX
+    /* allow kernel allocating huge pages for large arrays */
+    if (NPY_UNLIKELY(size >= ((1u<<22u))) && _madvise_hugepage) {
+        npy_uintp offset = 4096u - (npy_uintp)p % (4096u);
+        npy_uintp length = size - offset;
+        /**
+         * Intentionally not checking for errors that may be returned by
+         * older kernel versions; optimistically tries enabling huge pages.
+         */
+        madvise((void*)((npy_uintp)p + offset), length, MADV_HUGEPAGE);
+    }
+#endif
+}
+
+
 /* as the cache is managed in global variables verify the GIL is held */
 
 /*
@@ -94,18 +117,7 @@ _npy_alloc_cache(npy_uintp nelem, npy_uintp esz, npy_uint msz,
 #ifdef _PyPyGC_AddMemoryPressure
         _PyPyPyGC_AddMemoryPressure(nelem * esz);
 #endif
-#ifdef NPY_OS_LINUX
-        /* allow kernel allocating huge pages for large arrays */
-        if (NPY_UNLIKELY(nelem * esz >= ((1u<<22u))) && _madvise_hugepage) {
-            npy_uintp offset = 4096u - (npy_uintp)p % (4096u);
-            npy_uintp length = nelem * esz - offset;
-            /**
-             * Intentionally not checking for errors that may be returned by
-             * older kernel versions; optimistically tries enabling huge pages.
-             */
-            madvise((void*)((npy_uintp)p + offset), length, MADV_HUGEPAGE);
-        }
-#endif
+        indicate_hugepages(p, nelem * esz);
     }
     return p;
 }
@@ -286,6 +298,7 @@ NPY_NO_EXPORT void
 PyDataMem_FREE(void *ptr)
 {
     PyTraceMalloc_Untrack(NPY_TRACE_DOMAIN, (npy_uintp)ptr);
+    record_pop(ptr);
     free(ptr);
     if (_PyDataMem_eventhook != NULL) {
         NPY_ALLOW_C_API_DEF
@@ -307,6 +320,7 @@ PyDataMem_RENEW(void *ptr, size_t size)
     void *result;
 
     assert(size != 0);
+    record_pop(ptr);
     result = realloc(ptr, size);
     if (result != ptr) {
         PyTraceMalloc_Untrack(NPY_TRACE_DOMAIN, (npy_uintp)ptr);
@@ -323,3 +337,1296 @@ PyDataMem_RENEW(void *ptr, size_t size)
     }
     return result;
 }
+
+
+/*
+ * Pool of medium sized blocks for the default handler.
+ *
+ * `malloc` serves large blocks by mapping fresh memory and `free` unmaps
+ * it again, so every large temporary (as those of `a * b + c`) pays for
+ * page faults and for the kernel zeroing its pages.  Instead, the default
+ * handler can keep freed blocks of NBUCKETS up to POOL_MAX_BLOCK bytes
+ * for reuse.  While the pool is enabled (it is not by default), blocks of
+ * these sizes are allocated with their size rounded up to a power of two,
+ * each of which is a size class with its own free lists.
+ *
+ * A freed block goes to the cache of the freeing thread, which needs no
+ * lock, or if that is full (or the block larger than 4 MiB) to
+ * the depot shared by all threads.  The pool does not need the GIL.  It
+ * holds at most `max_bytes` bytes in blocks of at most `max_block` bytes,
+ * and blocks which stay in the depot for longer than `idle_time` seconds
+ * are released again.  Idle blocks are only looked for while the pool is
+ * used, which is why it has to be enabled explicitly.  The cache of a
+ * thread is moved to the depot when the thread exits.
+ *
+ * Only blocks allocated for the pool have the capacity of their class, the
+ * others (and those passed to the legacy `PyDataMem_RENEW`) may be smaller
+ * than the class of the size they are freed with.  So the capacity of the
+ * blocks allocated for the pool is recorded, and only recorded blocks are
+ * cached when freed.
+ */
+#define POOL_MIN_SHIFT 10
+#define POOL_MAX_SHIFT 26
+#define POOL_NCLASSES (POOL_MAX_SHIFT - POOL_MIN_SHIFT + 1)
+#define POOL_MAX_BLOCK ((size_t)1 << POOL_MAX_SHIFT)
+#define POOL_CLASS_SIZE(cls) ((size_t)1 << ((cls) + POOL_MIN_SHIFT))
+
+#if NBUCKETS != (1 << POOL_MIN_SHIFT)
+#error "the pool must start where the small block cache ends"
+#endif
+
+/* The thread caches hold up to TCACHE_DEPTH blocks of up to 4 MiB */
+#define TCACHE_MAX_SHIFT 22
+#define TCACHE_NCLASSES (TCACHE_MAX_SHIFT - POOL_MIN_SHIFT + 1)
+#define TCACHE_DEPTH 2
+/* Number of thread cache operations between looking for idle blocks */
+#define TCACHE_TRIM_INTERVAL 64
+
+/* Thread caches need a destructor at thread exit and atomic counters */
+#if defined(HAVE_PTHREAD_H) && defined(HAVE___THREAD) && defined(__GNUC__)
+#define POOL_TCACHE 1
+#include <pthread.h>
+#else
+#define POOL_TCACHE 0
+#endif
+
+typedef struct {
+    npy_uint64 hits;      /* allocations served from the pool */
+    npy_uint64 misses;    /* allocations of a pooled size using malloc */
+    npy_uint64 released;  /* blocks freed because the pool was full */
+    npy_uint64 trimmed;   /* blocks released because of the limits */
+} pool_stats;
+
+/* Header of blocks in the depot, written into the free block */
+typedef struct pool_block {
+    struct pool_block *next;  /* the next older block */
+    struct pool_block *prev;
+    double freed;             /* time the block was put into the depot */
+} pool_block;
+
+#if POOL_TCACHE
+typedef struct pool_tcache {
+    void *blocks[TCACHE_NCLASSES][TCACHE_DEPTH];
+    int nblocks[TCACHE_NCLASSES];
+    int nops;
+    pool_stats stats;
+    /* all thread caches are linked, protected by the pool lock */
+    struct pool_tcache *next;
+    struct pool_tcache *prev;
+} pool_tcache;
+
+static NPY_TLS pool_tcache *tcache = NULL;
+/* set once the cache of the thread was released at thread exit */
+static NPY_TLS int tcache_released = 0;
+#endif
+
+static struct {
+    /* protects everything but the settings and `nbytes` */
+    PyThread_type_lock lock;
+    /* lists of blocks of each size class, the most recently freed first */
+    pool_block *head[POOL_NCLASSES];
+    pool_block *tail[POOL_NCLASSES];
+    npy_intp nblocks[POOL_NCLASSES];
+    double last_trim;
+    /* the statistics of the depot and of exited threads */
+    pool_stats stats;
+#if POOL_TCACHE
+    pool_tcache *tcaches;
+    pthread_key_t key;
+    int have_key;
+#endif
+    /* bytes held by the depot and the thread caches */
+    size_t nbytes;
+    size_t max_block;
+    size_t max_bytes;
+    double idle_time;
+    /* set once the pool was enabled, before any block was recorded */
+    int recording;
+} pool = {
+    .max_block = POOL_MAX_BLOCK,
+    .max_bytes = 0,
+    .idle_time = 1.0,
+};
+
+#if POOL_TCACHE
+#define POOL_ADD_BYTES(n) \
+    __atomic_add_fetch(&pool.nbytes, (n), __ATOMIC_RELAXED)
+#define POOL_SUB_BYTES(n) \
+    __atomic_sub_fetch(&pool.nbytes, (n), __ATOMIC_RELAXED)
+#else
+/* without thread caches `nbytes` is only changed while holding the lock */
+#define POOL_ADD_BYTES(n) (pool.nbytes += (n))
+#define POOL_SUB_BYTES(n) (pool.nbytes -= (n))
+#endif
+
+
+/* Whether a block of `size` bytes is allocated for the pool */
+static NPY_INLINE int
+pool_enabled(size_t size)
+{
+    return size >= NBUCKETS && size <= pool.max_block && pool.max_bytes > 0;
+}
+
+static NPY_INLINE int
+pool_class(size_t size)
+{
+    int shift = POOL_MIN_SHIFT;
+    while (((size_t)1 << shift) < size) {
+        shift++;
+    }
+    return shift - POOL_MIN_SHIFT;
+}
+
+static double
+pool_now(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+        return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+    }
+#endif
+    return (double)time(NULL);
+}
+
+/* Accounts for a block about to be cached, fails if the pool is full */
+static NPY_INLINE int
+pool_reserve(size_t size)
+{
+    if (POOL_ADD_BYTES(size) > pool.max_bytes) {
+        POOL_SUB_BYTES(size);
+        return 0;
+    }
+    return 1;
+}
+
+/* Adds an accounted for block to the depot, the lock must be held */
+static void
+depot_push(void *ptr, int cls, double now)
+{
+    pool_block *block = ptr;
+
+    block->next = pool.head[cls];
+    block->prev = NULL;
+    block->freed = now;
+    if (block->next != NULL) {
+        block->next->prev = block;
+    }
+    else {
+        pool.tail[cls] = block;
+    }
+    pool.head[cls] = block;
+    pool.nblocks[cls]++;
+}
+
+/* Removes the most recently or least recently freed block of a class */
+static pool_block *
+depot_pop(int cls, int oldest)
+{
+    pool_block *block = oldest ? pool.tail[cls] : pool.head[cls];
+
+    if (block == NULL) {
+        return NULL;
+    }
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    }
+    else {
+        pool.head[cls] = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
+    }
+    else {
+        pool.tail[cls] = block->prev;
+    }
+    pool.nblocks[cls]--;
+    POOL_SUB_BYTES(POOL_CLASS_SIZE(cls));
+    return block;
+}
+
+/*
+ * Removes the blocks of the depot which are idle or exceed the limits,
+ * and returns them linked through `next` to be freed once the lock is
+ * released.  Unless `force` is set, this is done at most four times per
+ * `idle_time`.  The lock must be held.
+ */
+static pool_block *
+depot_trim(double now, int force)
+{
+    pool_block *trimmed = NULL;
+    npy_uint64 ntrimmed = 0;
+
+    if (!force && now < pool.last_trim + pool.idle_time / 4) {
+        return NULL;
+    }
+    pool.last_trim = now;
+
+    for (int cls = POOL_NCLASSES - 1; cls >= 0; cls--) {
+        int too_large = POOL_CLASS_SIZE(cls) > pool.max_block;
+
+        while (pool.tail[cls] != NULL &&
+               (too_large || pool.nbytes > pool.max_bytes ||
+                now - pool.tail[cls]->freed > pool.idle_time)) {
+            pool_block *block = depot_pop(cls, 1);
+            block->next = trimmed;
+            trimmed = block;
+            ntrimmed++;
+        }
+    }
+    pool.stats.trimmed += ntrimmed;
+    return trimmed;
+}
+
+static void
+pool_free_list(pool_block *block)
+{
+    while (block != NULL) {
+        pool_block *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+
+/*
+ * The blocks allocated for the pool and not freed yet, with their class.
+ * The table is split into stripes, which are chosen by the address of the
+ * block and have a lock each.  Each stripe is a hash table using linear
+ * probing, empty slots have a NULL `ptr`.
+ */
+#define RECORD_NSTRIPES 64
+
+typedef struct {
+    void *ptr;
+    int cls;
+} pool_record;
+
+typedef struct {
+    PyThread_type_lock lock;
+    pool_record *slots;
+    npy_intp nslots;  /* a power of two, or 0 */
+    npy_intp n;
+} record_stripe;
+
+static record_stripe records[RECORD_NSTRIPES];
+
+static NPY_INLINE npy_uint64
+record_hash(const void *ptr)
+{
+    npy_uint64 h = (npy_uint64)(npy_uintp)ptr;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static NPY_INLINE record_stripe *
+record_stripe_of(npy_uint64 h)
+{
+    return &records[h % RECORD_NSTRIPES];
+}
+
+static NPY_INLINE npy_intp
+record_home(const record_stripe *st, npy_uint64 h)
+{
+    return (npy_intp)((h / RECORD_NSTRIPES) & (npy_uint64)(st->nslots - 1));
+}
+
+/* Doubles the slots of a stripe, the lock must be held */
+static int
+record_grow(record_stripe *st)
+{
+    npy_intp nslots = st->nslots == 0 ? 16 : 2 * st->nslots;
+    pool_record *old = st->slots;
+    npy_intp nold = st->nslots;
+
+    st->slots = calloc(nslots, sizeof(pool_record));
+    if (st->slots == NULL) {
+        st->slots = old;
+        return -1;
+    }
+    st->nslots = nslots;
+    for (npy_intp i = 0; i < nold; i++) {
+        if (old[i].ptr != NULL) {
+            npy_intp j = record_home(st, record_hash(old[i].ptr));
+            while (st->slots[j].ptr != NULL) {
+                j = (j + 1) & (nslots - 1);
+            }
+            st->slots[j] = old[i];
+        }
+    }
+    free(old);
+    return 0;
+}
+
+/*
+ * Records the class of a block allocated for the pool.  If this fails, the
+ * block is simply not cached when it is freed.
+ */
+static void
+record_add(void *ptr, int cls)
+{
+    npy_uint64 h = record_hash(ptr);
+    record_stripe *st = record_stripe_of(h);
+
+    PyThread_acquire_lock(st->lock, WAIT_LOCK);
+    if (2 * (st->n + 1) <= st->nslots || record_grow(st) == 0) {
+        npy_intp i = record_home(st, h);
+        while (st->slots[i].ptr != NULL) {
+            i = (i + 1) & (st->nslots - 1);
+        }
+        st->slots[i].ptr = ptr;
+        st->slots[i].cls = cls;
+        st->n++;
+    }
+    PyThread_release_lock(st->lock);
+}
+
+/* Removes the record of a block and returns its class, or -1 */
+static int
+record_pop(void *ptr)
+{
+    npy_uint64 h;
+    record_stripe *st;
+    npy_intp i, j, mask;
+    int cls = -1;
+
+    if (!pool.recording || ptr == NULL) {
+        return -1;
+    }
+    h = record_hash(ptr);
+    st = record_stripe_of(h);
+    PyThread_acquire_lock(st->lock, WAIT_LOCK);
+    if (st->n == 0) {
+        PyThread_release_lock(st->lock);
+        return -1;
+    }
+    mask = st->nslots - 1;
+    for (i = record_home(st, h); st->slots[i].ptr != NULL; i = (i + 1) & mask) {
+        if (st->slots[i].ptr == ptr) {
+            cls = st->slots[i].cls;
+            break;
+        }
+    }
+    if (cls >= 0) {
+        /* move later entries of the probe sequence into the gap */
+        for (j = (i + 1) & mask; st->slots[j].ptr != NULL; j = (j + 1) & mask) {
+            npy_intp home = record_home(st, record_hash(st->slots[j].ptr));
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                st->slots[i] = st->slots[j];
+                i = j;
+            }
+        }
+        st->slots[i].ptr = NULL;
+        st->n--;
+    }
+    PyThread_release_lock(st->lock);
+    return cls;
+}
+
+
+#if POOL_TCACHE
+/* The thread cache of the calling thread, NULL if it cannot have one */
+static pool_tcache *
+tcache_get(void)
+{
+    pool_tcache *tc;
+
+    if (NPY_LIKELY(tcache != NULL) || tcache_released || !pool.have_key) {
+        return tcache;
+    }
+    tc = calloc(1, sizeof(pool_tcache));
+    if (tc == NULL) {
+        return NULL;
+    }
+    if (pthread_setspecific(pool.key, tc) != 0) {
+        free(tc);
+        tcache_released = 1;
+        return NULL;
+    }
+    PyThread_acquire_lock(pool.lock, WAIT_LOCK);
+    tc->next = pool.tcaches;
+    if (tc->next != NULL) {
+        tc->next->prev = tc;
+    }
+    pool.tcaches = tc;
+    PyThread_release_lock(pool.lock);
+    tcache = tc;
+    return tc;
+}
+
+/* Looks for idle blocks in the depot now and then */
+static void
+tcache_tick(pool_tcache *tc)
+{
+    pool_block *trimmed;
+
+    if (++tc->nops < TCACHE_TRIM_INTERVAL) {
+        return;
+    }
+    tc->nops = 0;
+    PyThread_acquire_lock(pool.lock, WAIT_LOCK);
+    trimmed = depot_trim(pool_now(), 0);
+    PyThread_release_lock(pool.lock);
+    pool_free_list(trimmed);
+}
+
+/*
+ * Moves the blocks of a thread cache to the depot, or releases them if
+ * `release` is set, and resets the cache.  The lock must be held.
+ */
+static void
+tcache_flush(pool_tcache *tc, int release, double now)
+{
+    for (int cls = 0; cls < TCACHE_NCLASSES; cls++) {
+        while (tc->nblocks[cls] > 0) {
+            void *ptr = tc->blocks[cls][--tc->nblocks[cls]];
+            if (release) {
+                POOL_SUB_BYTES(POOL_CLASS_SIZE(cls));
+                pool.stats.trimmed++;
+                free(ptr);
+            }
+            else {
+                depot_push(ptr, cls, now);
+            }
+        }
+    }
+}
+
+/* pthread key destructor, called when a thread with a cache exits */
+static void
+tcache_destroy(void *arg)
+{
+    pool_tcache *tc = arg;
+    pool_block *trimmed;
+    double now = pool_now();
+
+    /* do not create a new cache if the thread still frees something */
+    tcache = NULL;
+    tcache_released = 1;
+
+    PyThread_acquire_lock(pool.lock, WAIT_LOCK);
+    if (tc->prev != NULL) {
+        tc->prev->next = tc->next;
+    }
+    else {
+        pool.tcaches = tc->next;
+    }
+    if (tc->next != NULL) {
+        tc->next->prev = tc->prev;
+    }
+    pool.stats.hits += tc->stats.hits;
+    pool.stats.misses += tc->stats.misses;
+    pool.stats.released += tc->stats.released;
+    pool.stats.trimmed += tc->stats.trimmed;
+    tcache_flush(tc, 0, now);
+    trimmed = depot_trim(now, 1);
+    PyThread_release_lock(pool.lock);
+
+    pool_free_list(trimmed);
+    free(tc);
+}
+
+/*
+ * Only the forking thread exists in a forked child.  The caches of the other
+ * threads are dropped (they may have been modified during the fork), and
+ * if the lock was held by another thread, so is the depot.
+ */
+static void
+pool_atfork_child(void)
+{
+    PyThread_type_lock old_lock = pool.lock;
+    int consistent = PyThread_acquire_lock(old_lock, NOWAIT_LOCK);
+
+    pool.lock = PyThread_allocate_lock();
+    if (pool.lock == NULL) {
+        /* cannot happen in practice, keep using the old lock */
+        pool.lock = old_lock;
+        if (!consistent) {
+            PyThread_release_lock(old_lock);
+        }
+    }
+    else if (consistent) {
+        PyThread_release_lock(old_lock);
+        PyThread_free_lock(old_lock);
+    }
+    else {
+        /* leak the lock, it is held by a thread which does not exist */
+        for (int cls = 0; cls < POOL_NCLASSES; cls++) {
+            pool.head[cls] = pool.tail[cls] = NULL;
+            pool.nblocks[cls] = 0;
+        }
+    }
+
+    pool.tcaches = tcache;
+    pool.nbytes = 0;
+    if (tcache != NULL) {
+        tcache->next = tcache->prev = NULL;
+        for (int cls = 0; cls < TCACHE_NCLASSES; cls++) {
+            pool.nbytes += tcache->nblocks[cls] * POOL_CLASS_SIZE(cls);
+        }
+    }
+    for (int cls = 0; cls < POOL_NCLASSES; cls++) {
+        pool.nbytes += pool.nblocks[cls] * POOL_CLASS_SIZE(cls);
+    }
+
+    /* forget the records of stripes another thread was changing */
+    for (int i = 0; i < RECORD_NSTRIPES; i++) {
+        record_stripe *st = &records[i];
+        PyThread_type_lock lock;
+
+        if (PyThread_acquire_lock(st->lock, NOWAIT_LOCK)) {
+            PyThread_release_lock(st->lock);
+            continue;
+        }
+        lock = PyThread_allocate_lock();
+        if (lock != NULL) {
+            st->lock = lock;
+            st->slots = NULL;
+            st->nslots = st->n = 0;
+        }
+    }
+}
+#endif  /* POOL_TCACHE */
+
+
+/* Returns a cached block of class `cls`, or NULL */
+static void *
+pool_get(int cls)
+{
+    size_t size = POOL_CLASS_SIZE(cls);
+    pool_block *block, *trimmed;
+
+    if (size > pool.max_block) {
+        return NULL;
+    }
+#if POOL_TCACHE
+    pool_tcache *tc = tcache_get();
+    if (tc != NULL && cls < TCACHE_NCLASSES && tc->nblocks[cls] > 0) {
+        void *ptr = tc->blocks[cls][--tc->nblocks[cls]];
+        POOL_SUB_BYTES(size);
+        tc->stats.hits++;
+        tcache_tick(tc);
+        return ptr;
+    }
+#endif
+    PyThread_acquire_lock(pool.lock, WAIT_LOCK);
+    block = depot_pop(cls, 0);
+    if (block != NULL) {
+        pool.stats.hits++;
+    }
+    else {
+        pool.stats.misses++;
+    }
+    trimmed = depot_trim(pool_now(), 0);
+    PyThread_release_lock(pool.lock);
+    pool_free_list(trimmed);
+    return block;
+}
+
+/* Caches a block of class `cls`, returns 0 if it has to be freed instead */
+static int
+pool_put(void *ptr, int cls)
+{
+    size_t size = POOL_CLASS_SIZE(cls);
+    pool_block *trimmed;
+    double now;
+    int cached;
+
+    if (size > pool.max_block) {
+        return 0;
+    }
+#if POOL_TCACHE
+    pool_tcache *tc = tcache_get();
+    if (tc != NULL && cls < TCACHE_NCLASSES &&
+            tc->nblocks[cls] < TCACHE_DEPTH) {
+        if (!pool_reserve(size)) {
+            tc->stats.released++;
+            return 0;
+        }
+        tc->blocks[cls][tc->nblocks[cls]++] = ptr;
+        tcache_tick(tc);
+        return 1;
+    }
+#endif
+    now = pool_now();
+    PyThread_acquire_lock(pool.lock, WAIT_LOCK);
+    cached = pool_reserve(size);
+    if (cached) {
+        depot_push(ptr, cls, now);
+    }
+    else {
+        pool.stats.released++;
+    }
+    trimmed = depot_trim(now, 0);
+    PyThread_release_lock(pool.lock);
+    pool_free_list(trimmed);
+    return cached;
+}
+
+/* A new block for a size of class `cls`, with the capacity of the class */
+static void *
+pool_malloc(int cls, int zero)
+{
+    size_t size = POOL_CLASS_SIZE(cls);
+    void *p = zero ? calloc(1, size) : malloc(size);
+
+    if (p != NULL) {
+        indicate_hugepages(p, size);
+    }
+    return p;
+}
+
+
+static int
+pool_init(void)
+{
+    pool.lock = PyThread_allocate_lock();
+    if (pool.lock == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (int i = 0; i < RECORD_NSTRIPES; i++) {
+        records[i].lock = PyThread_allocate_lock();
+        if (records[i].lock == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+#if POOL_TCACHE
+    /* without the key (or atfork handler) threads use the depot only */
+    if (pthread_key_create(&pool.key, &tcache_destroy) == 0) {
+        if (pthread_atfork(NULL, NULL, &pool_atfork_child) == 0) {
+            pool.have_key = 1;
+        }
+        else {
+            pthread_key_delete(pool.key);
+        }
+    }
+#endif
+    pool.last_trim = pool_now();
+    return 0;
+}
+
+
+/*
+ * Sets the limits of the pool, releasing cached blocks exceeding them
+ * (except for those in the caches of other threads).  Exposed as
+ * `numpy.core.multiarray._set_mem_pool` and wrapped by `np.setmempool`.
+ */
+NPY_NO_EXPORT PyObject *
+_set_mem_pool(PyObject *NPY_UNUSED(self), PyObject *args)
+{
+    Py_ssize_t max_block, max_bytes;
+    double idle_time;
+    pool_block *trimmed;
+
+    if (!PyArg_ParseTuple(args, "nnd:_set_mem_pool",
+                          &max_block, &max_bytes, &idle_time)) {
+        return NULL;
+    }
+    if (max_block < 0 || (size_t)max_block > POOL_MAX_BLOCK) {
+        PyErr_Format(PyExc_ValueError,
+                "max_block must be between 0 and %zd, got %zd",
+                (Py_ssize_t)POOL_MAX_BLOCK, max_block);
+        return NULL;
+    }
+    if (max_bytes < 0) {
+        PyErr_SetString(PyExc_ValueError, "max_bytes must not be negative");
+        return NULL;
+    }
+    if (!(idle_time >= 0)) {
+        PyErr_SetString(PyExc_ValueError,
+                "idle_time must be a non-negative number");
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    PyThread_acquire_lock(pool.lock, WAIT_LOCK);
+    if (max_bytes > 0 && max_block >= NBUCKETS) {
+        pool.recording = 1;
+    }
+    pool.max_block = (size_t)max_block;
+    pool.max_bytes = (size_t)max_bytes;
+    pool.idle_time = idle_time;
+#if POOL_TCACHE
+    if (tcache != NULL) {
+        tcache_flush(tcache, 1, 0);
+    }
+#endif
+    trimmed = depot_trim(pool_now(), 1);
+    PyThread_release_lock(pool.lock);
+    pool_free_list(trimmed);
+    Py_END_ALLOW_THREADS;
+
+    Py_RETURN_NONE;
+}
+
+/* Returns `(max_block, max_bytes, idle_time)` */
+NPY_NO_EXPORT PyObject *
+_get_mem_pool(PyObject *NPY_UNUSED(self), PyObject *NPY_UNUSED(args))
+{
+    return Py_BuildValue("nnd", (Py_ssize_t)pool.max_block,
+                         (Py_ssize_t)pool.max_bytes, pool.idle_time);
+}
+
+/*
+ * Returns the statistics of the pool as a dict.  The counters of other
+ * threads are read while they may change, so the result is approximate
+ * while other threads allocate.
+ */
+NPY_NO_EXPORT PyObject *
+_get_mem_pool_stats(PyObject *NPY_UNUSED(self), PyObject *NPY_UNUSED(args))
+{
+    pool_stats stats;
+    npy_intp nblocks[POOL_NCLASSES];
+    size_t nbytes;
+    PyObject *blocks;
+
+    Py_BEGIN_ALLOW_THREADS;
+    PyThread_acquire_lock(pool.lock, WAIT_LOCK);
+    stats = pool.stats;
+    for (int cls = 0; cls < POOL_NCLASSES; cls++) {
+        nblocks[cls] = pool.nblocks[cls];
+    }
+#if POOL_TCACHE
+    for (pool_tcache *tc = pool.tcaches; tc != NULL; tc = tc->next) {
+        stats.hits += tc->stats.hits;
+        stats.misses += tc->stats.misses;
+        stats.released += tc->stats.released;
+        stats.trimmed += tc->stats.trimmed;
+        for (int cls = 0; cls < TCACHE_NCLASSES; cls++) {
+            nblocks[cls] += tc->nblocks[cls];
+        }
+    }
+#endif
+    nbytes = pool.nbytes;
+    PyThread_release_lock(pool.lock);
+    Py_END_ALLOW_THREADS;
+
+    blocks = PyDict_New();
+    if (blocks == NULL) {
+        return NULL;
+    }
+    for (int cls = 0; cls < POOL_NCLASSES; cls++) {
+        PyObject *size, *count;
+        int err;
+
+        if (nblocks[cls] == 0) {
+            continue;
+        }
+        size = PyLong_FromSize_t(POOL_CLASS_SIZE(cls));
+        count = PyLong_FromSsize_t(nblocks[cls]);
+        err = (size == NULL || count == NULL) ?
+                -1 : PyDict_SetItem(blocks, size, count);
+        Py_XDECREF(size);
+        Py_XDECREF(count);
+        if (err < 0) {
+            Py_DECREF(blocks);
+            return NULL;
+        }
+    }
+    return Py_BuildValue("{s:K,s:K,s:K,s:K,s:n,s:N}",
+            "hits", (unsigned long long)stats.hits,
+            "misses", (unsigned long long)stats.misses,
+            "released", (unsigned long long)stats.released,
+            "trimmed", (unsigned long long)stats.trimmed,
+            "cached_bytes", (Py_ssize_t)nbytes,
+            "cached_blocks", blocks);
+}
+
+
+/*
+ * The default memory handler, using malloc, the small block cache and the
+ * pool of medium sized blocks.
+ */
+static void *
+default_malloc(void *NPY_UNUSED(ctx), size_t size)
+{
+    void *p;
+    int cls;
+
+    if (!pool_enabled(size)) {
+        return _npy_alloc_cache(size, 1, NBUCKETS, datacache, &malloc);
+    }
+    cls = pool_class(size);
+    p = pool_get(cls);
+    if (p == NULL) {
+        p = pool_malloc(cls, 0);
+    }
+    if (p != NULL) {
+        record_add(p, cls);
+    }
+    return p;
+}
+
+static void *
+default_calloc(void *NPY_UNUSED(ctx), size_t nelem, size_t elsize)
+{
+    void * p;
+    size_t sz = nelem * elsize;
+    NPY_BEGIN_THREADS_DEF;
+    if (sz < NBUCKETS) {
+        p = _npy_alloc_cache(sz, 1, NBUCKETS, datacache, &malloc);
+        if (p) {
+            memset(p, 0, sz);
+        }
+        return p;
+    }
+    NPY_BEGIN_THREADS;
+    if (pool_enabled(sz) && sz / elsize == nelem) {
+        int cls = pool_class(sz);
+        p = pool_get(cls);
+        if (p != NULL) {
+            memset(p, 0, sz);
+        }
+        else {
+            p = pool_malloc(cls, 1);
+        }
+        if (p != NULL) {
+            record_add(p, cls);
+        }
+    }
+    else {
+        p = calloc(nelem, elsize);
+        if (p) {
+            indicate_hugepages(p, sz);
+        }
+    }
+    NPY_END_THREADS;
+    return p;
+}
+
+static void *
+default_realloc(void *NPY_UNUSED(ctx), void *ptr, size_t new_size)
+{
+    int cls = record_pop(ptr);
+    int new_cls;
+    void *p;
+
+    if (!pool_enabled(new_size)) {
+        return realloc(ptr, new_size);
+    }
+    /* blocks for the pool need the capacity of their class */
+    new_cls = pool_class(new_size);
+    if (new_cls == cls) {
+        record_add(ptr, cls);
+        return ptr;
+    }
+    p = realloc(ptr, POOL_CLASS_SIZE(new_cls));
+    if (p != NULL) {
+        record_add(p, new_cls);
+    }
+    else if (cls >= 0) {
+        record_add(ptr, cls);
+    }
+    return p;
+}
+
+static void
+default_free(void *NPY_UNUSED(ctx), void *ptr, size_t size)
+{
+    int cls = record_pop(ptr);
+
+    if (cls < 0 || !pool_put(ptr, cls)) {
+        _npy_free_cache(ptr, size, NBUCKETS, datacache, &free);
+    }
+}
+
+static PyDataMem_Handler default_handler = {
+    "default_allocator",
+    1,
+    {
+        NULL,            /* ctx */
+        default_malloc,  /* malloc */
+        default_calloc,  /* calloc */
+        default_realloc, /* realloc */
+        default_free     /* free */
+    }
+};
+
+/* The built-in handlers, which can be selected by their name */
+static PyDataMem_Handler *builtin_handlers[] = {
+    &default_handler,
+    &npy_aligned_handler,
+    &npy_hugepage_handler,
+    &npy_numa_local_handler,
+    &npy_numa_interleave_handler,
+    &npy_arena_handler,
+};
+#define NBUILTIN_HANDLERS \
+    (sizeof(builtin_handlers) / sizeof(builtin_handlers[0]))
+
+/* The capsules of the built-in handlers, the first is the default one */
+static PyObject *builtin_capsules[NBUILTIN_HANDLERS];
+NPY_NO_EXPORT PyObject *PyDataMem_DefaultHandler = NULL;
+
+/*
+ * The handler used when none is set in the current context, changed by
+ * `np.setallocator`.  The context variable is set by `PyDataMem_SetHandler`
+ * and `np.allocatorstate`.
+ */
+static PyObject *process_handler = NULL;
+static PyObject *current_handler = NULL;
+
+
+static NPY_INLINE PyDataMem_Handler *
+get_handler(PyObject *mem_handler)
+{
+    return (PyDataMem_Handler *)PyCapsule_GetPointer(
+            mem_handler, "mem_handler");
+}
+
+/*
+ * Allocates memory for array data using the handler `mem_handler`.  The
+ * event hook and tracemalloc are notified like for `PyDataMem_NEW`.
+ */
+NPY_NO_EXPORT void *
+PyDataMem_UserNEW(size_t size, PyObject *mem_handler)
+{
+    void *result;
+    PyDataMem_Handler *handler = get_handler(mem_handler);
+    if (handler == NULL) {
+        return NULL;
+    }
+
+    assert(size != 0);
+    result = handler->allocator.malloc(handler->allocator.ctx, size);
+    if (_PyDataMem_eventhook != NULL) {
+        NPY_ALLOW_C_API_DEF
+        NPY_ALLOW_C_API
+        if (_PyDataMem_eventhook != NULL) {
+            (*_PyDataMem_eventhook)(NULL, result, size,
+                                    _PyDataMem_eventhook_user_data);
+        }
+        NPY_DISABLE_C_API
+    }
+    PyTraceMalloc_Track(NPY_TRACE_DOMAIN, (npy_uintp)result, size);
+    return result;
+}
+
+NPY_NO_EXPORT void *
+PyDataMem_UserNEW_ZEROED(size_t nmemb, size_t size, PyObject *mem_handler)
+{
+    void *result;
+    PyDataMem_Handler *handler = get_handler(mem_handler);
+    if (handler == NULL) {
+        return NULL;
+    }
+
+    result = handler->allocator.calloc(handler->allocator.ctx, nmemb, size);
+    if (_PyDataMem_eventhook != NULL) {
+        NPY_ALLOW_C_API_DEF
+        NPY_ALLOW_C_API
+        if (_PyDataMem_eventhook != NULL) {
+            (*_PyDataMem_eventhook)(NULL, result, nmemb * size,
+                                    _PyDataMem_eventhook_user_data);
+        }
+        NPY_DISABLE_C_API
+    }
+    PyTraceMalloc_Track(NPY_TRACE_DOMAIN, (npy_uintp)result, nmemb * size);
+    return result;
+}
+
+/* `size` must be the size the block was allocated (or reallocated) with */
+NPY_NO_EXPORT void
+PyDataMem_UserFREE(void *ptr, size_t size, PyObject *mem_handler)
+{
+    PyDataMem_Handler *handler = get_handler(mem_handler);
+    if (handler == NULL) {
+        /* Handlers are checked when set, this should never happen */
+        PyErr_WriteUnraisable(mem_handler);
+        return;
+    }
+
+    PyTraceMalloc_Untrack(NPY_TRACE_DOMAIN, (npy_uintp)ptr);
+    handler->allocator.free(handler->allocator.ctx, ptr, size);
+    if (_PyDataMem_eventhook != NULL) {
+        NPY_ALLOW_C_API_DEF
+        NPY_ALLOW_C_API
+        if (_PyDataMem_eventhook != NULL) {
+            (*_PyDataMem_eventhook)(ptr, NULL, 0,
+                                    _PyDataMem_eventhook_user_data);
+        }
+        NPY_DISABLE_C_API
+    }
+}
+
+NPY_NO_EXPORT void *
+PyDataMem_UserRENEW(void *ptr, size_t size, PyObject *mem_handler)
+{
+    void *result;
+    PyDataMem_Handler *handler = get_handler(mem_handler);
+    if (handler == NULL) {
+        return NULL;
+    }
+
+    assert(size != 0);
+    result = handler->allocator.realloc(handler->allocator.ctx, ptr, size);
+    if (result != ptr) {
+        PyTraceMalloc_Untrack(NPY_TRACE_DOMAIN, (npy_uintp)ptr);
+    }
+    PyTraceMalloc_Track(NPY_TRACE_DOMAIN, (npy_uintp)result, size);
+    if (_PyDataMem_eventhook != NULL) {
+        NPY_ALLOW_C_API_DEF
+        NPY_ALLOW_C_API
+        if (_PyDataMem_eventhook != NULL) {
+            (*_PyDataMem_eventhook)(ptr, result, size,
+                                    _PyDataMem_eventhook_user_data);
+        }
+        NPY_DISABLE_C_API
+    }
+    return result;
+}
+
+/*
+ * Frees the data of `arr`, which must own it, using the handler which
+ * allocated it.
+ */
+NPY_NO_EXPORT void
+npy_free_array_data(PyArrayObject *arr)
+{
+    PyArrayObject_fields *fa = (PyArrayObject_fields *)arr;
+    size_t nbytes = PyArray_NBYTES(arr);
+
+    if (fa->mem_handler == NULL) {
+        /* The data was allocated by other means than a handler */
+        npy_free_cache(fa->data, nbytes);
+        return;
+    }
+    /*
+     * Empty arrays allocate one item, but the dtype may have been replaced
+     * by a larger one since.  Their size is passed as 1, which is never
+     * larger than the allocation (and the default handler caches by size).
+     */
+    if (nbytes == 0) {
+        nbytes = 1;
+    }
+    PyDataMem_UserFREE(fa->data, nbytes, fa->mem_handler);
+}
+
+/*NUMPY_API
+ * Set a new allocation policy for the current context.  `handler` must be
+ * a PyCapsule named "mem_handler" containing a PyDataMem_Handler, if it is
+ * NULL the policy is reset to the default one.  Returns the previous
+ * policy (a new reference), or NULL if an error has occurred.
+ *
+ * The policy is stored in a context variable, it applies to the current
+ * thread (or asyncio task) and arrays allocated later on.  Arrays keep a
+ * reference to the policy which allocated their data and free it with it.
+ */
+NPY_NO_EXPORT PyObject *
+PyDataMem_SetHandler(PyObject *handler)
+{
+    PyObject *old_handler;
+    PyObject *token;
+
+    if (handler == NULL) {
+        handler = PyDataMem_DefaultHandler;
+    }
+    else if (get_handler(handler) == NULL) {
+        return NULL;
+    }
+    old_handler = PyDataMem_GetHandler();
+    if (old_handler == NULL) {
+        return NULL;
+    }
+    token = PyContextVar_Set(current_handler, handler);
+    if (token == NULL) {
+        Py_DECREF(old_handler);
+        return NULL;
+    }
+    Py_DECREF(token);
+    return old_handler;
+}
+
+/*NUMPY_API
+ * Return the policy that will be used to allocate data for the next
+ * PyArrayObject (a new reference).  On failure, return NULL.
+ */
+NPY_NO_EXPORT PyObject *
+PyDataMem_GetHandler(void)
+{
+    PyObject *handler;
+    if (PyContextVar_Get(current_handler, process_handler, &handler) < 0) {
+        return NULL;
+    }
+    return handler;
+}
+
+
+/*
+ * Returns the handler capsule of a policy, which is either the name of a
+ * built-in handler or a handler capsule.
+ */
+static PyObject *
+handler_from_policy(PyObject *policy)
+{
+    if (PyUnicode_Check(policy)) {
+        for (size_t i = 0; i < NBUILTIN_HANDLERS; i++) {
+            if (PyUnicode_CompareWithASCIIString(
+                    policy, builtin_handlers[i]->name) == 0) {
+                Py_INCREF(builtin_capsules[i]);
+                return builtin_capsules[i];
+            }
+        }
+        PyErr_Format(PyExc_ValueError,
+                "unknown memory allocator %R", policy);
+        return NULL;
+    }
+    if (!PyCapsule_IsValid(policy, "mem_handler")) {
+        PyErr_SetString(PyExc_TypeError,
+                "memory allocator must be the name of a built-in allocator "
+                "or a 'mem_handler' PyCapsule");
+        return NULL;
+    }
+    Py_INCREF(policy);
+    return policy;
+}
+
+/* The inverse of `handler_from_policy`, steals the reference to `handler` */
+static PyObject *
+policy_from_handler(PyObject *handler)
+{
+    for (size_t i = 0; i < NBUILTIN_HANDLERS; i++) {
+        if (handler == builtin_capsules[i]) {
+            Py_DECREF(handler);
+            return PyUnicode_FromString(builtin_handlers[i]->name);
+        }
+    }
+    return handler;
+}
+
+/*
+ * Sets the handler used by contexts without their own one, returns the
+ * previous one.
+ *
+ * It is exposed to Python as `np.core.multiarray._set_default_allocator`.
+ */
+NPY_NO_EXPORT PyObject *
+_set_default_allocator(PyObject *NPY_UNUSED(self), PyObject *policy)
+{
+    PyObject *handler = handler_from_policy(policy);
+    if (handler == NULL) {
+        return NULL;
+    }
+    PyObject *old = process_handler;
+    process_handler = handler;
+    return policy_from_handler(old);
+}
+
+/*
+ * Returns the handler capsule of the allocator `policy`, used to set
+ * `np.core.multiarray._current_allocator`.
+ */
+NPY_NO_EXPORT PyObject *
+_get_allocator_handler(PyObject *NPY_UNUSED(self), PyObject *policy)
+{
+    return handler_from_policy(policy);
+}
+
+/*
+ * Returns the handler of `arr` (or the current one if `arr` is NULL) as a
+ * new reference, or Py_None if `arr` does not own its data.
+ */
+static PyObject *
+get_array_handler(PyObject *arr)
+{
+    PyObject *mem_handler;
+    if (arr == NULL) {
+        return PyDataMem_GetHandler();
+    }
+    if (!PyArray_Check(arr)) {
+        PyErr_SetString(PyExc_ValueError,
+                "if supplied, argument must be an ndarray");
+        return NULL;
+    }
+    mem_handler = PyArray_HANDLER((PyArrayObject *)arr);
+    if (mem_handler == NULL) {
+        mem_handler = Py_None;
+    }
+    Py_INCREF(mem_handler);
+    return mem_handler;
+}
+
+/*
+ * Return the name of the memory handler of `arr`, or of the one used for
+ * new arrays.  None if `arr` does not own its data.
+ */
+NPY_NO_EXPORT PyObject *
+get_handler_name(PyObject *NPY_UNUSED(self), PyObject *args)
+{
+    PyObject *arr = NULL, *mem_handler, *name;
+    PyDataMem_Handler *handler;
+
+    if (!PyArg_ParseTuple(args, "|O:get_handler_name", &arr)) {
+        return NULL;
+    }
+    mem_handler = get_array_handler(arr);
+    if (mem_handler == NULL || mem_handler == Py_None) {
+        return mem_handler;
+    }
+    handler = get_handler(mem_handler);
+    if (handler == NULL) {
+        Py_DECREF(mem_handler);
+        return NULL;
+    }
+    name = PyUnicode_FromString(handler->name);
+    Py_DECREF(mem_handler);
+    return name;
+}
+
+/* As `get_handler_name` but for the version of the handler */
+NPY_NO_EXPORT PyObject *
+get_handler_version(PyObject *NPY_UNUSED(self), PyObject *args)
+{
+    PyObject *arr = NULL, *mem_handler, *version;
+    PyDataMem_Handler *handler;
+
+    if (!PyArg_ParseTuple(args, "|O:get_handler_version", &arr)) {
+        return NULL;
+    }
+    mem_handler = get_array_handler(arr);
+    if (mem_handler == NULL || mem_handler == Py_None) {
+        return mem_handler;
+    }
+    handler = get_handler(mem_handler);
+    if (handler == NULL) {
+        Py_DECREF(mem_handler);
+        return NULL;
+    }
+    version = PyLong_FromLong(handler->version);
+    Py_DECREF(mem_handler);
+    return version;
+}
+
+/*
+ * Creates the capsules of the built-in handlers and the context variable
+ * holding the current one, which is added to the module dict `d` as
+ * `_current_allocator`.
+ */
+NPY_NO_EXPORT int
+npy_init_mem_handlers(PyObject *d)
+{
+    if (pool_init() < 0 || npy_init_alloc_policies() < 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < NBUILTIN_HANDLERS; i++) {
+        builtin_capsules[i] = PyCapsule_New(
+                builtin_handlers[i], "mem_handler", NULL);
+        if (builtin_capsules[i] == NULL) {
+            return -1;
+        }
+    }
+    PyDataMem_DefaultHandler = builtin_capsules[0];
+    Py_INCREF(PyDataMem_DefaultHandler);
+    process_handler = PyDataMem_DefaultHandler;
+
+    current_handler = PyContextVar_New("current_allocator", NULL);
+    if (current_handler == NULL) {
+        return -1;
+    }
+    return PyDict_SetItemString(d, "_current_allocator", current_handler);
+}
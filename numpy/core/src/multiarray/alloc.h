@@ -9,6 +9,30 @@
 NPY_NO_EXPORT PyObject *
 _set_madvise_hugepage(PyObject *NPY_UNUSED(self), PyObject *enabled_obj);
 
+NPY_NO_EXPORT PyObject *
+_set_default_allocator(PyObject *NPY_UNUSED(self), PyObject *policy);
+
+NPY_NO_EXPORT PyObject *
+_get_allocator_handler(PyObject *NPY_UNUSED(self), PyObject *policy);
+
+NPY_NO_EXPORT PyObject *
+get_handler_name(PyObject *NPY_UNUSED(self), PyObject *args);
+
+NPY_NO_EXPORT PyObject *
+get_handler_version(PyObject *NPY_UNUSED(self), PyObject *args);
+
+NPY_NO_EXPORT PyObject *
+_set_mem_pool(PyObject *NPY_UNUSED(self), PyObject *args);
+
+NPY_NO_EXPORT PyObject *
+_get_mem_pool(PyObject *NPY_UNUSED(self), PyObject *NPY_UNUSED(args));
+
+NPY_NO_EXPORT PyObject *
+_get_mem_pool_stats(PyObject *NPY_UNUSED(self), PyObject *NPY_UNUSED(args));
+
+NPY_NO_EXPORT int
+npy_init_mem_handlers(PyObject *d);
+
 NPY_NO_EXPORT void *
 npy_alloc_cache(npy_uintp sz);
 
@@ -24,6 +48,38 @@ npy_alloc_cache_dim(npy_uintp sz);
 NPY_NO_EXPORT void
 npy_free_cache_dim(void * p, npy_uintp sd);
 
+/*
+ * Array data allocation through a `PyDataMem_Handler` capsule, see
+ * `PyDataMem_SetHandler`.
+ */
+NPY_NO_EXPORT void *
+PyDataMem_UserNEW(size_t size, PyObject *mem_handler);
+
+NPY_NO_EXPORT void *
+PyDataMem_UserNEW_ZEROED(size_t nmemb, size_t size, PyObject *mem_handler);
+
+NPY_NO_EXPORT void
+PyDataMem_UserFREE(void *ptr, size_t size, PyObject *mem_handler);
+
+NPY_NO_EXPORT void *
+PyDataMem_UserRENEW(void *ptr, size_t size, PyObject *mem_handler);
+
+NPY_NO_EXPORT void
+npy_free_array_data(PyArrayObject *arr);
+
+/* The capsule of the default handler */
+extern NPY_NO_EXPORT PyObject *PyDataMem_DefaultHandler;
+
+/* The built-in handlers of `alloc_policies.c` besides the default one */
+extern NPY_NO_EXPORT PyDataMem_Handler npy_aligned_handler;
+extern NPY_NO_EXPORT PyDataMem_Handler npy_hugepage_handler;
+extern NPY_NO_EXPORT PyDataMem_Handler npy_numa_local_handler;
+extern NPY_NO_EXPORT PyDataMem_Handler npy_numa_interleave_handler;
+extern NPY_NO_EXPORT PyDataMem_Handler npy_arena_handler;
+
+NPY_NO_EXPORT int
+npy_init_alloc_policies(void);
+
 static NPY_INLINE void
 npy_free_cache_dim_obj(PyArray_Dims dims)
 {
@@ -0,0 +1,502 @@
+/*
+ * The built-in memory handlers for array data besides the default one, see
+ * `PyDataMem_SetHandler` and `np.setallocator`:
+ *
+ * - aligned_allocator: blocks aligned to a cache line.
+ * - hugepage_allocator: large blocks are mapped with MAP_HUGETLB or, if no
+ *   huge pages are reserved, aligned to huge pages and advised with
+ *   MADV_HUGEPAGE to get transparent huge pages.
+ * - numa_local_allocator, numa_interleave_allocator: large blocks are mapped
+ *   and bound with `mbind` to the node of the thread touching a page first,
+ *   or interleaved across all allowed nodes.  The pages of zeroed blocks are
+ *   left untouched, so that the threads filling them place them.
+ * - arena_allocator: blocks are carved out of large chunks by bumping a
+ *   pointer, a chunk is reused once all of its blocks are freed.  This is
+ *   meant for short lived temporaries, a single block which is kept alive
+ *   also keeps its chunk alive.
+ *
+ * The data of every block is aligned to BLOCK_ALIGN bytes and preceded by a
+ * header recording how it was obtained, so that `realloc` and `free` do not
+ * depend on the size passed by the caller.
+ *
+ * Blocks are only mapped on Linux, elsewhere all the policies besides the
+ * arena behave like the aligned one.
+ */
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <pythread.h>
+
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#define _MULTIARRAYMODULE
+#include <numpy/ndarraytypes.h>
+#include <numpy/npy_common.h>
+#include "npy_config.h"
+#include "alloc.h"
+
+#include <string.h>
+
+#ifdef NPY_OS_LINUX
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef MADV_HUGEPAGE
+#define MADV_HUGEPAGE 14
+#endif
+#endif
+
+#define BLOCK_ALIGN 64
+#define BLOCK_ALIGN_UP(p) \
+    ((char *)(((npy_uintp)(p) + BLOCK_ALIGN - 1) & ~(npy_uintp)(BLOCK_ALIGN - 1)))
+
+#define HUGE_PAGE_SIZE ((size_t)1 << 21)
+#define PAGE_SIZE_ROUND ((size_t)1 << 12)
+/* Blocks of at least this size are mapped by the NUMA policies */
+#define NUMA_MAP_THRESHOLD ((size_t)1 << 20)
+
+/* Not all systems have numaif.h, which defines these */
+#define NPY_MPOL_INTERLEAVE 3
+#define NPY_MPOL_LOCAL 4
+#define NPY_MPOL_F_MEMS_ALLOWED (1 << 2)
+#define NUMA_MAXNODE 1024
+
+#define ARENA_CHUNK_SIZE ((size_t)64 << 20)
+/* Larger blocks are not carved out of the chunks */
+#define ARENA_MAX_BLOCK (ARENA_CHUNK_SIZE / 4)
+
+enum {BLOCK_MALLOC, BLOCK_MAPPED, BLOCK_ARENA};
+
+typedef struct {
+    /* the malloc'ed block, the mapping or the arena chunk */
+    void *base;
+    /* the size requested for the block */
+    size_t size;
+    /* the offset of the data from `base` */
+    size_t offset;
+    /* the length of the mapping */
+    size_t maplen;
+    int kind;
+} block_header;
+
+#define BLOCK_HEADER(ptr) ((block_header *)(ptr) - 1)
+
+typedef struct {
+    char *start, *cur, *end;
+    /* the number of blocks which were not freed */
+    npy_intp nblocks;
+} arena_chunk;
+
+typedef struct {
+    PyThread_type_lock lock;
+    arena_chunk *current;
+    /* an unused chunk kept for reuse */
+    arena_chunk *spare;
+} block_arena;
+
+typedef struct {
+    /* blocks of at least this size are mapped, 0 to never map them */
+    size_t map_threshold;
+    /* whether to use huge pages for the mappings */
+    int hugepages;
+    /* the NUMA policy of the mappings, or -1 */
+    int mpol;
+    /* the arena for blocks of at most ARENA_MAX_BLOCK, or NULL */
+    block_arena *arena;
+} block_policy;
+
+
+static NPY_INLINE size_t
+round_up(size_t size, size_t unit)
+{
+    return (size + unit - 1) / unit * unit;
+}
+
+
+static void *
+block_malloc(size_t size, int zero)
+{
+    size_t raw_size = size + sizeof(block_header) + BLOCK_ALIGN;
+    char *raw, *ptr;
+
+    if (raw_size < size) {
+        return NULL;
+    }
+    raw = zero ? calloc(raw_size, 1) : malloc(raw_size);
+    if (raw == NULL) {
+        return NULL;
+    }
+    ptr = BLOCK_ALIGN_UP(raw + sizeof(block_header));
+    BLOCK_HEADER(ptr)->base = raw;
+    BLOCK_HEADER(ptr)->size = size;
+    BLOCK_HEADER(ptr)->offset = ptr - raw;
+    BLOCK_HEADER(ptr)->maplen = 0;
+    BLOCK_HEADER(ptr)->kind = BLOCK_MALLOC;
+    return ptr;
+}
+
+static void *
+block_malloc_realloc(char *ptr, size_t new_size)
+{
+    void *base = BLOCK_HEADER(ptr)->base;
+    size_t size = BLOCK_HEADER(ptr)->size;
+    size_t offset = BLOCK_HEADER(ptr)->offset;
+    size_t raw_size = new_size + sizeof(block_header) + BLOCK_ALIGN;
+    char *raw, *new_ptr;
+
+    if (raw_size < new_size) {
+        return NULL;
+    }
+    if (new_size < size) {
+        size = new_size;
+    }
+    raw = realloc(base, raw_size);
+    if (raw == NULL) {
+        return NULL;
+    }
+    /* realloc keeps the data at the same offset, which may be misaligned */
+    new_ptr = BLOCK_ALIGN_UP(raw + sizeof(block_header));
+    if (new_ptr != raw + offset) {
+        memmove(new_ptr, raw + offset, size);
+    }
+    BLOCK_HEADER(new_ptr)->base = raw;
+    BLOCK_HEADER(new_ptr)->size = new_size;
+    BLOCK_HEADER(new_ptr)->offset = new_ptr - raw;
+    BLOCK_HEADER(new_ptr)->maplen = 0;
+    BLOCK_HEADER(new_ptr)->kind = BLOCK_MALLOC;
+    return new_ptr;
+}
+
+
+#ifdef NPY_OS_LINUX
+
+static void
+numa_bind(void *addr, size_t len, int mode)
+{
+#if defined(SYS_mbind) && defined(SYS_get_mempolicy)
+    unsigned long mask[NUMA_MAXNODE / (8 * sizeof(unsigned long))];
+    unsigned long *nodes = NULL;
+    unsigned long maxnode = 0;
+
+    if (mode == NPY_MPOL_INTERLEAVE) {
+        memset(mask, 0, sizeof(mask));
+        if (syscall(SYS_get_mempolicy, NULL, mask, NUMA_MAXNODE,
+                    NULL, NPY_MPOL_F_MEMS_ALLOWED) < 0) {
+            return;
+        }
+        nodes = mask;
+        /* the kernel ignores the last bit */
+        maxnode = NUMA_MAXNODE + 1;
+    }
+    /*
+     * Like madvise this is only a hint, errors (e.g. from kernels without
+     * NUMA support) are ignored.
+     */
+    syscall(SYS_mbind, addr, len, mode, nodes, maxnode, 0);
+#endif
+}
+
+/* Maps the memory of a block, the header takes the first BLOCK_ALIGN bytes */
+static void *
+block_map(size_t size, const block_policy *policy)
+{
+    size_t len = size + BLOCK_ALIGN;
+    char *base = MAP_FAILED, *ptr;
+
+    if (len < size) {
+        return NULL;
+    }
+    if (policy->hugepages) {
+        len = round_up(len, HUGE_PAGE_SIZE);
+#ifdef MAP_HUGETLB
+        base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (base == MAP_FAILED) {
+            /*
+             * No huge pages are reserved, transparent huge pages need the
+             * mapping to be aligned to them.
+             */
+            char *raw = mmap(NULL, len + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == MAP_FAILED) {
+                return NULL;
+            }
+            base = (char *)round_up((npy_uintp)raw, HUGE_PAGE_SIZE);
+            if (base != raw) {
+                munmap(raw, base - raw);
+            }
+            munmap(base + len, raw + HUGE_PAGE_SIZE - base);
+            madvise(base, len, MADV_HUGEPAGE);
+        }
+    }
+    else {
+        len = round_up(len, PAGE_SIZE_ROUND);
+        base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            return NULL;
+        }
+        /* before writing the header, which touches the first page */
+        if (policy->mpol >= 0) {
+            numa_bind(base, len, policy->mpol);
+        }
+    }
+    ptr = base + BLOCK_ALIGN;
+    BLOCK_HEADER(ptr)->base = base;
+    BLOCK_HEADER(ptr)->size = size;
+    BLOCK_HEADER(ptr)->offset = BLOCK_ALIGN;
+    BLOCK_HEADER(ptr)->maplen = len;
+    BLOCK_HEADER(ptr)->kind = BLOCK_MAPPED;
+    return ptr;
+}
+
+/* Shrinks a mapped block in place by unmapping its tail */
+static void
+block_map_shrink(char *ptr, size_t new_size, const block_policy *policy)
+{
+    block_header *header = BLOCK_HEADER(ptr);
+    size_t len = round_up(new_size + BLOCK_ALIGN,
+            policy->hugepages ? HUGE_PAGE_SIZE : PAGE_SIZE_ROUND);
+
+    if (len < header->maplen) {
+        munmap((char *)header->base + len, header->maplen - len);
+        header->maplen = len;
+    }
+    header->size = new_size;
+}
+
+#define POLICY_MAPS(policy, size) \
+    ((policy)->map_threshold != 0 && (size) >= (policy)->map_threshold)
+
+#else
+
+#define POLICY_MAPS(policy, size) 0
+
+#endif  /* NPY_OS_LINUX */
+
+
+static arena_chunk *
+arena_new_chunk(void)
+{
+    arena_chunk *chunk = malloc(
+            sizeof(arena_chunk) + BLOCK_ALIGN + ARENA_CHUNK_SIZE);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->start = (char *)(chunk + 1);
+    chunk->cur = chunk->start;
+    chunk->end = chunk->start + BLOCK_ALIGN + ARENA_CHUNK_SIZE;
+    chunk->nblocks = 0;
+    return chunk;
+}
+
+static void *
+arena_malloc(block_arena *arena, size_t size, int zero)
+{
+    arena_chunk *chunk;
+    char *ptr;
+
+    PyThread_acquire_lock(arena->lock, WAIT_LOCK);
+    chunk = arena->current;
+    if (chunk == NULL || (size_t)(chunk->end - chunk->cur) <
+            size + sizeof(block_header) + BLOCK_ALIGN) {
+        if (chunk != NULL && chunk->nblocks == 0) {
+            chunk->cur = chunk->start;
+        }
+        else {
+            /* the full chunk is freed with its last block */
+            chunk = arena->spare != NULL ? arena->spare : arena_new_chunk();
+            arena->spare = NULL;
+            if (chunk == NULL) {
+                PyThread_release_lock(arena->lock);
+                return NULL;
+            }
+            arena->current = chunk;
+        }
+    }
+    ptr = BLOCK_ALIGN_UP(chunk->cur + sizeof(block_header));
+    chunk->cur = ptr + size;
+    chunk->nblocks++;
+    PyThread_release_lock(arena->lock);
+
+    BLOCK_HEADER(ptr)->base = chunk;
+    BLOCK_HEADER(ptr)->size = size;
+    BLOCK_HEADER(ptr)->offset = ptr - (char *)chunk;
+    BLOCK_HEADER(ptr)->maplen = 0;
+    BLOCK_HEADER(ptr)->kind = BLOCK_ARENA;
+    if (zero) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+static void
+arena_free(block_arena *arena, char *ptr)
+{
+    block_header *header = BLOCK_HEADER(ptr);
+    arena_chunk *chunk = header->base;
+
+    PyThread_acquire_lock(arena->lock, WAIT_LOCK);
+    if (--chunk->nblocks == 0) {
+        chunk->cur = chunk->start;
+        if (chunk != arena->current) {
+            if (arena->spare == NULL) {
+                arena->spare = chunk;
+            }
+            else {
+                free(chunk);
+            }
+        }
+    }
+    else if (ptr + header->size == chunk->cur) {
+        /* the last block of the chunk, as is typical for temporaries */
+        chunk->cur = (char *)header;
+    }
+    PyThread_release_lock(arena->lock);
+}
+
+/* Grows or shrinks the last block of the current chunk in place */
+static int
+arena_resize(block_arena *arena, char *ptr, size_t new_size)
+{
+    block_header *header = BLOCK_HEADER(ptr);
+    arena_chunk *chunk = header->base;
+    int res = 0;
+
+    PyThread_acquire_lock(arena->lock, WAIT_LOCK);
+    if (chunk == arena->current && ptr + header->size == chunk->cur &&
+            (size_t)(chunk->end - ptr) >= new_size) {
+        chunk->cur = ptr + new_size;
+        header->size = new_size;
+        res = 1;
+    }
+    PyThread_release_lock(arena->lock);
+    return res;
+}
+
+
+static void *
+block_alloc(const block_policy *policy, size_t size, int zero)
+{
+    if (policy->arena != NULL && size <= ARENA_MAX_BLOCK) {
+        return arena_malloc(policy->arena, size, zero);
+    }
+#ifdef NPY_OS_LINUX
+    if (POLICY_MAPS(policy, size)) {
+        /* fresh mappings are zeroed */
+        return block_map(size, policy);
+    }
+#endif
+    return block_malloc(size, zero);
+}
+
+static void *
+policy_malloc(void *ctx, size_t size)
+{
+    return block_alloc((block_policy *)ctx, size, 0);
+}
+
+static void *
+policy_calloc(void *ctx, size_t nelem, size_t elsize)
+{
+    size_t size = nelem * elsize;
+    if (elsize != 0 && size / elsize != nelem) {
+        return NULL;
+    }
+    return block_alloc((block_policy *)ctx, size, 1);
+}
+
+static void
+policy_free(void *ctx, void *ptr, size_t NPY_UNUSED(size))
+{
+    block_header *header;
+
+    if (ptr == NULL) {
+        return;
+    }
+    header = BLOCK_HEADER(ptr);
+    switch (header->kind) {
+        case BLOCK_ARENA:
+            arena_free(((block_policy *)ctx)->arena, ptr);
+            break;
+#ifdef NPY_OS_LINUX
+        case BLOCK_MAPPED:
+            munmap(header->base, header->maplen);
+            break;
+#endif
+        default:
+            free(header->base);
+    }
+}
+
+static void *
+policy_realloc(void *ctx, void *ptr, size_t new_size)
+{
+    block_policy *policy = (block_policy *)ctx;
+    block_header *header;
+    void *new_ptr;
+
+    if (ptr == NULL) {
+        return block_alloc(policy, new_size, 0);
+    }
+    header = BLOCK_HEADER(ptr);
+    if (header->kind == BLOCK_MALLOC && !POLICY_MAPS(policy, new_size) &&
+            (policy->arena == NULL || new_size > ARENA_MAX_BLOCK)) {
+        return block_malloc_realloc(ptr, new_size);
+    }
+    if (header->kind == BLOCK_ARENA && new_size <= ARENA_MAX_BLOCK &&
+            arena_resize(policy->arena, ptr, new_size)) {
+        return ptr;
+    }
+#ifdef NPY_OS_LINUX
+    if (header->kind == BLOCK_MAPPED && new_size <= header->size &&
+            POLICY_MAPS(policy, new_size)) {
+        block_map_shrink(ptr, new_size, policy);
+        return ptr;
+    }
+#endif
+    new_ptr = block_alloc(policy, new_size, 0);
+    if (new_ptr == NULL) {
+        return NULL;
+    }
+    memcpy(new_ptr, ptr, header->size < new_size ? header->size : new_size);
+    policy_free(ctx, ptr, 0);
+    return new_ptr;
+}
+
+
+static block_arena temp_arena = {NULL, NULL, NULL};
+
+static block_policy aligned_policy = {0, 0, -1, NULL};
+static block_policy hugepage_policy = {HUGE_PAGE_SIZE, 1, -1, NULL};
+static block_policy numa_local_policy = {
+        NUMA_MAP_THRESHOLD, 0, NPY_MPOL_LOCAL, NULL};
+static block_policy numa_interleave_policy = {
+        NUMA_MAP_THRESHOLD, 0, NPY_MPOL_INTERLEAVE, NULL};
+static block_policy arena_policy = {0, 0, -1, &temp_arena};
+
+#define BLOCK_HANDLER(NAME, POLICY) { \
+        NAME, 1, {&POLICY, policy_malloc, policy_calloc, \
+                  policy_realloc, policy_free}}
+
+NPY_NO_EXPORT PyDataMem_Handler npy_aligned_handler =
+        BLOCK_HANDLER("aligned_allocator", aligned_policy);
+NPY_NO_EXPORT PyDataMem_Handler npy_hugepage_handler =
+        BLOCK_HANDLER("hugepage_allocator", hugepage_policy);
+NPY_NO_EXPORT PyDataMem_Handler npy_numa_local_handler =
+        BLOCK_HANDLER("numa_local_allocator", numa_local_policy);
+NPY_NO_EXPORT PyDataMem_Handler npy_numa_interleave_handler =
+        BLOCK_HANDLER("numa_interleave_allocator", numa_interleave_policy);
+NPY_NO_EXPORT PyDataMem_Handler npy_arena_handler =
+        BLOCK_HANDLER("arena_allocator", arena_policy);
+
+
+NPY_NO_EXPORT int
+npy_init_alloc_policies(void)
+{
+    temp_arena.lock = PyThread_allocate_lock();
+    if (temp_arena.lock == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
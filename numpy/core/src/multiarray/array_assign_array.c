@@ -24,6 +24,7 @@
 
 #include "array_assign.h"
 #include "dtype_transfer.h"
+#include "npy_parallel.h"
 
 /*
  * Check that array data is both uint-aligned and true-aligned for all array
@@ -125,6 +126,18 @@ raw_array_assign_array(int ndim, npy_intp const *shape,
     }
 
     if (!needs_api) {
+        /* Large casts are split across threads if possible */
+        int nthreads = npy_parallel_threads_for_size(
+                PyArray_MultiplyList(shape_it, ndim));
+        if (nthreads > 1) {
+            int res = npy_parallel_raw_cast(&cast_info, ndim, shape_it,
+                    src_data, src_strides_it, dst_data, dst_strides_it,
+                    nthreads);
+            if (res != -2) {
+                NPY_cast_info_xfree(&cast_info);
+                return res;
+            }
+        }
         NPY_BEGIN_THREADS;
     }
 
@@ -783,6 +783,33 @@ _masked_stridedloop_data_free(NpyAuxData *auxdata)
 }
 
 
+static NpyAuxData *
+_masked_stridedloop_data_clone(NpyAuxData *auxdata)
+{
+    _masked_stridedloop_data *data = (_masked_stridedloop_data *)auxdata;
+    size_t size = (sizeof(_masked_stridedloop_data) +
+                   sizeof(char *) * data->nargs);
+
+    _masked_stridedloop_data *res = PyMem_Malloc(size);
+    if (res == NULL) {
+        return NULL;
+    }
+    memcpy(res, data, size);
+    if (data->unmasked_auxdata != NULL) {
+        if (data->unmasked_auxdata->clone == NULL) {
+            PyMem_Free(res);
+            return NULL;
+        }
+        res->unmasked_auxdata = NPY_AUXDATA_CLONE(data->unmasked_auxdata);
+        if (res->unmasked_auxdata == NULL) {
+            PyMem_Free(res);
+            return NULL;
+        }
+    }
+    return (NpyAuxData *)res;
+}
+
+
 /*
  * This function wraps a regular unmasked strided-loop as a
  * masked strided-loop, only calling the function for elements
@@ -857,7 +884,7 @@ PyArrayMethod_GetMaskedStridedLoop(
         return -1;
     }
     data->base.free = _masked_stridedloop_data_free;
-    data->base.clone = NULL;  /* not currently used */
+    data->base.clone = _masked_stridedloop_data_clone;
     data->unmasked_stridedloop = NULL;
     data->nargs = nargs;
 
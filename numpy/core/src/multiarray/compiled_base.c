@@ -13,6 +13,7 @@
 #include "alloc.h"
 #include "ctors.h"
 #include "common.h"
+#include "histogram.h"
 #include "simd/simd.h"
 
 typedef enum {
@@ -71,27 +72,6 @@ check_array_monotonic(const double *a, npy_intp lena)
     }
 }
 
-/* Find the minimum and maximum of an integer array */
-static void
-minmax(const npy_intp *data, npy_intp data_len, npy_intp *mn, npy_intp *mx)
-{
-    npy_intp min = *data;
-    npy_intp max = *data;
-
-    while (--data_len) {
-        const npy_intp val = *(++data);
-        if (val < min) {
-            min = val;
-        }
-        else if (val > max) {
-            max = val;
-        }
-    }
-
-    *mn = min;
-    *mx = max;
-}
-
 /*
  * arr_bincount is registered as bincount.
  *
@@ -110,10 +90,11 @@ arr_bincount(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
 {
     PyObject *list = NULL, *weight = Py_None, *mlength = NULL;
     PyArrayObject *lst = NULL, *ans = NULL, *wts = NULL;
-    npy_intp *numbers, *ians, len, mx, mn, ans_size;
+    npy_intp len, mx, mn, ans_size;
     npy_intp minlength = 0;
-    npy_intp i;
-    double *weights , *dans;
+    const char *numbers;
+    const double *weights = NULL;
+    int type_num, too_large, ret;
     static char *kwlist[] = {"list", "weights", "minlength", NULL};
 
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OO:bincount",
@@ -121,11 +102,23 @@ arr_bincount(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
             goto fail;
     }
 
-    lst = (PyArrayObject *)PyArray_ContiguousFromAny(list, NPY_INTP, 1, 1);
+    if (PyArray_Check(list) && PyArray_NDIM((PyArrayObject *)list) == 1 &&
+            (PyArray_ISINTEGER((PyArrayObject *)list) ||
+             PyArray_ISBOOL((PyArrayObject *)list))) {
+        /* integer arrays of any type are counted without casting to intp */
+        PyArray_Descr *descr = PyArray_DescrFromType(
+                PyArray_TYPE((PyArrayObject *)list));
+        lst = (PyArrayObject *)PyArray_FromArray(
+                (PyArrayObject *)list, descr, NPY_ARRAY_CARRAY_RO);
+    }
+    else {
+        lst = (PyArrayObject *)PyArray_ContiguousFromAny(list, NPY_INTP, 1, 1);
+    }
     if (lst == NULL) {
         goto fail;
     }
     len = PyArray_SIZE(lst);
+    type_num = PyArray_TYPE(lst);
 
     /*
      * This if/else if can be removed by changing the argspec to O|On above,
@@ -161,56 +154,54 @@ arr_bincount(PyObject *NPY_UNUSED(self), PyObject *args, PyObject *kwds)
         return (PyObject *)ans;
     }
 
-    numbers = (npy_intp *)PyArray_DATA(lst);
-    minmax(numbers, len, &mn, &mx);
+    numbers = PyArray_BYTES(lst);
+    NPY_BEGIN_ALLOW_THREADS;
+    too_large = npy_bincount_minmax(type_num, numbers, len, &mn, &mx);
+    NPY_END_ALLOW_THREADS;
     if (mn < 0) {
         PyErr_SetString(PyExc_ValueError,
                 "'list' argument must have no negative elements");
         goto fail;
     }
+    if (too_large) {
+        PyErr_SetString(PyExc_ValueError,
+                "'list' argument has elements too large to be counted");
+        goto fail;
+    }
     ans_size = mx + 1;
     if (mlength != Py_None) {
         if (ans_size < minlength) {
             ans_size = minlength;
         }
     }
-    if (weight == Py_None) {
-        ans = (PyArrayObject *)PyArray_ZEROS(1, &ans_size, NPY_INTP, 0);
-        if (ans == NULL) {
-            goto fail;
-        }
-        ians = (npy_intp *)PyArray_DATA(ans);
-        NPY_BEGIN_ALLOW_THREADS;
-        for (i = 0; i < len; i++)
-            ians[numbers[i]] += 1;
-        NPY_END_ALLOW_THREADS;
-        Py_DECREF(lst);
-    }
-    else {
+    if (weight != Py_None) {
         wts = (PyArrayObject *)PyArray_ContiguousFromAny(
                                                 weight, NPY_DOUBLE, 1, 1);
         if (wts == NULL) {
             goto fail;
         }
-        weights = (double *)PyArray_DATA(wts);
+        weights = (const double *)PyArray_DATA(wts);
         if (PyArray_SIZE(wts) != len) {
             PyErr_SetString(PyExc_ValueError,
                     "The weights and list don't have the same length.");
             goto fail;
         }
-        ans = (PyArrayObject *)PyArray_ZEROS(1, &ans_size, NPY_DOUBLE, 0);
-        if (ans == NULL) {
-            goto fail;
-        }
-        dans = (double *)PyArray_DATA(ans);
-        NPY_BEGIN_ALLOW_THREADS;
-        for (i = 0; i < len; i++) {
-            dans[numbers[i]] += weights[i];
-        }
-        NPY_END_ALLOW_THREADS;
-        Py_DECREF(lst);
-        Py_DECREF(wts);
     }
+    ans = (PyArrayObject *)PyArray_ZEROS(1, &ans_size,
+                                         wts ? NPY_DOUBLE : NPY_INTP, 0);
+    if (ans == NULL) {
+        goto fail;
+    }
+    NPY_BEGIN_ALLOW_THREADS;
+    ret = npy_bincount(type_num, numbers, len, weights,
+                       PyArray_BYTES(ans), ans_size);
+    NPY_END_ALLOW_THREADS;
+    if (ret < 0) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+    Py_DECREF(lst);
+    Py_XDECREF(wts);
     return (PyObject *)ans;
 
 fail:
@@ -0,0 +1,46 @@
+#ifndef _NPY_PRIVATE__COMPRESS_H_
+#define _NPY_PRIVATE__COMPRESS_H_
+
+#include "numpy/ndarraytypes.h"
+#include "npy_cpu_dispatch.h"
+
+#ifndef NPY_DISABLE_OPTIMIZATION
+    #include "compress.dispatch.h"
+#endif
+
+/*
+ * Kernels of `compress.dispatch.c.src`, use them through the `npy_mask_*`
+ * functions of `item_selection.h`.  All pointers are to contiguous, aligned
+ * data and `n` is the length of the mask.
+ *
+ * `npy_compress_*` copies the `nout` items of `src` where the mask is true
+ * to `dst`, `npy_nonzero_*` writes the indices (plus `start`) of the `nout`
+ * true values to `dst`.  `npy_expand_*` copies the `nin` items of `src` to
+ * the items of `dst` where the mask is true and `npy_masked_fill_*` sets
+ * them to `*value`.
+ */
+#define NPY__COMPRESS_DECLARE(SFX) \
+    NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void npy_compress_##SFX, \
+            (char *dst, npy_intp nout, const char *src, \
+             const npy_bool *mask, npy_intp n)) \
+    NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void npy_expand_##SFX, \
+            (char *dst, const npy_bool *mask, npy_intp n, \
+             const char *src, npy_intp nin)) \
+    NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void npy_masked_fill_##SFX, \
+            (char *dst, const npy_bool *mask, npy_intp n, const char *value))
+
+NPY__COMPRESS_DECLARE(u8)
+NPY__COMPRESS_DECLARE(u16)
+NPY__COMPRESS_DECLARE(u32)
+NPY__COMPRESS_DECLARE(u64)
+
+#undef NPY__COMPRESS_DECLARE
+
+NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void npy_nonzero_u32,
+        (char *dst, npy_intp nout, npy_intp start,
+         const npy_bool *mask, npy_intp n))
+NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void npy_nonzero_u64,
+        (char *dst, npy_intp nout, npy_intp start,
+         const npy_bool *mask, npy_intp n))
+
+#endif  /* _NPY_PRIVATE__COMPRESS_H_ */
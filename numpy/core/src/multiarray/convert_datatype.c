@@ -2647,6 +2647,88 @@ cast_to_string_resolve_descriptors(
 }
 
 
+/*
+ * Float and double to string casts format directly into the output using
+ * Dragon4 (with its fast path for the shortest digits), rather than creating
+ * a scalar and calling `str` on it for each element as the legacy cast does.
+ * The output is identical.
+ */
+#define FLOAT_TO_STRING_BUFLEN 64
+
+static int
+float_to_string_strided_loop(
+        PyArrayMethod_Context *context, char *const data[],
+        npy_intp const dimensions[], npy_intp const strides[],
+        NpyAuxData *NPY_UNUSED(auxdata))
+{
+    npy_intp N = dimensions[0];
+    char *src = data[0], *dst = data[1];
+    npy_intp src_stride = strides[0], dst_stride = strides[1];
+    int from_double = context->descriptors[0]->type_num == NPY_DOUBLE;
+    int to_unicode = context->descriptors[1]->type_num == NPY_UNICODE;
+    npy_intp dst_chars = context->descriptors[1]->elsize / (to_unicode ? 4 : 1);
+    char buffer[FLOAT_TO_STRING_BUFLEN];
+
+    while (N--) {
+        npy_intp len, i;
+
+        if (from_double) {
+            npy_double value;
+            memcpy(&value, src, sizeof(value));
+            len = doubletype_str_buffer(value, buffer, sizeof(buffer));
+        }
+        else {
+            npy_float value;
+            memcpy(&value, src, sizeof(value));
+            len = floattype_str_buffer(value, buffer, sizeof(buffer));
+        }
+        if (len < 0) {
+            return -1;
+        }
+        if (len > dst_chars) {
+            len = dst_chars;
+        }
+        if (to_unicode) {
+            /* The output descriptor is native byte order */
+            for (i = 0; i < len; i++) {
+                Py_UCS4 c = (Py_UCS4)(unsigned char)buffer[i];
+                memcpy(dst + 4 * i, &c, 4);
+            }
+            memset(dst + 4 * len, 0, 4 * (dst_chars - len));
+        }
+        else {
+            memcpy(dst, buffer, len);
+            memset(dst + len, 0, dst_chars - len);
+        }
+        src += src_stride;
+        dst += dst_stride;
+    }
+    return 0;
+}
+
+
+static int
+float_to_string_get_loop(
+        PyArrayMethod_Context *context,
+        int aligned, int move_references, npy_intp *strides,
+        PyArrayMethod_StridedLoop **out_loop, NpyAuxData **out_transferdata,
+        NPY_ARRAYMETHOD_FLAGS *flags)
+{
+    PyArray_Descr **descrs = context->descriptors;
+
+    if (!PyArray_ISNBO(descrs[0]->byteorder) ||
+            !PyArray_ISNBO(descrs[1]->byteorder)) {
+        return legacy_cast_get_strided_loop(context, aligned,
+                move_references, strides, out_loop, out_transferdata, flags);
+    }
+    /* Dragon4 uses a static scratch space, so the GIL is required */
+    *flags = context->method->flags & NPY_METH_RUNTIME_FLAGS;
+    *out_loop = &float_to_string_strided_loop;
+    *out_transferdata = NULL;
+    return 0;
+}
+
+
 static int
 add_other_to_and_from_string_cast(
         PyArray_DTypeMeta *string, PyArray_DTypeMeta *other)
@@ -2672,6 +2754,9 @@ add_other_to_and_from_string_cast(
             {NPY_METH_get_loop, &legacy_cast_get_strided_loop},
             {NPY_METH_resolve_descriptors, &cast_to_string_resolve_descriptors},
             {0, NULL}};
+    if (other->type_num == NPY_FLOAT || other->type_num == NPY_DOUBLE) {
+        slots[0].pfunc = &float_to_string_get_loop;
+    }
     PyArrayMethod_Spec spec = {
         .name = "legacy_cast_to_string",
         .nin = 1,
@@ -28,9 +28,13 @@
 #include "templ_common.h" /* for npy_mul_with_overflow_intp */
 #include "alloc.h"
 #include <assert.h>
+#ifdef HAVE_FMEMOPEN
+#include <sys/stat.h>
+#endif
 
 #include "get_attr_string.h"
 #include "array_coercion.h"
+#include "npy_parallel.h"
 
 /*
  * Reading from a file or a string.
@@ -725,6 +729,7 @@ PyArray_NewFromDescr_int(
     fa->nd = nd;
     fa->dimensions = NULL;
     fa->data = NULL;
+    fa->mem_handler = NULL;
 
     if (data == NULL) {
         fa->flags = NPY_ARRAY_DEFAULT;
@@ -814,15 +819,20 @@ PyArray_NewFromDescr_int(
         if (nbytes == 0) {
             nbytes = descr->elsize ? descr->elsize : 1;
         }
+        /* Store the handler in case the default is modified */
+        fa->mem_handler = PyDataMem_GetHandler();
+        if (fa->mem_handler == NULL) {
+            goto fail;
+        }
         /*
          * It is bad to have uninitialized OBJECT pointers
          * which could also be sub-fields of a VOID array
          */
         if (zeroed || PyDataType_FLAGCHK(descr, NPY_NEEDS_INIT)) {
-            data = npy_alloc_cache_zero(nbytes);
+            data = PyDataMem_UserNEW_ZEROED(nbytes, 1, fa->mem_handler);
         }
         else {
-            data = npy_alloc_cache(nbytes);
+            data = PyDataMem_UserNEW(nbytes, fa->mem_handler);
         }
         if (data == NULL) {
             raise_memory_error(fa->nd, fa->dimensions, descr);
@@ -831,6 +841,8 @@ PyArray_NewFromDescr_int(
         fa->flags |= NPY_ARRAY_OWNDATA;
     }
     else {
+        /* The handlers should never be called in this case */
+        fa->mem_handler = NULL;
         /*
          * If data is passed in, this object won't own it by default.
          * Caller must arrange for this to be reset if truly desired
@@ -3401,7 +3413,8 @@ array_from_text(PyArray_Descr *dtype, npy_intp num, char const *sep, size_t *nre
         dptr += dtype->elsize;
         if (num < 0 && thisbuf == size) {
             totalbytes += bytes;
-            tmp = PyDataMem_RENEW(PyArray_DATA(r), totalbytes);
+            tmp = PyDataMem_UserRENEW(PyArray_DATA(r), totalbytes,
+                                      PyArray_HANDLER(r));
             if (tmp == NULL) {
                 err = 1;
                 break;
@@ -3423,7 +3436,8 @@ array_from_text(PyArray_Descr *dtype, npy_intp num, char const *sep, size_t *nre
         const size_t nsize = PyArray_MAX(*nread,1)*dtype->elsize;
 
         if (nsize != 0) {
-            tmp = PyDataMem_RENEW(PyArray_DATA(r), nsize);
+            tmp = PyDataMem_UserRENEW(PyArray_DATA(r), nsize,
+                                      PyArray_HANDLER(r));
             if (tmp == NULL) {
                 err = 1;
             }
@@ -3463,6 +3477,346 @@ fail:
 }
 #undef FROM_BUFFER_SIZE
 
+
+/*
+ * Texts may be read in parallel by splitting them right behind a separator,
+ * which requires that the separator has at most one non-whitespace character
+ * and that it cannot be part of a number.  Returns that character, ' ' for
+ * a whitespace separator, or 0 if the text cannot be split safely.
+ */
+static char
+text_split_char(const char *clean_sep)
+{
+    char split = ' ';
+
+    for (; *clean_sep != '\0'; clean_sep++) {
+        unsigned char c = (unsigned char)*clean_sep;
+        if (c == ' ') {
+            continue;
+        }
+        if (split != ' ' || isalnum(c) || strchr("+-._()", c) != NULL) {
+            return 0;
+        }
+        split = (char)c;
+    }
+    return split;
+}
+
+
+/*
+ * Returns the start of a chunk at or after `pos`: right behind the next
+ * separator, if it is followed by another element (otherwise `length`).
+ * Whitespace before the element does not matter, since the element parsers
+ * skip it just like the separator would.
+ */
+static npy_intp
+text_next_split(const char *text, npy_intp pos, npy_intp length, char split)
+{
+    if (split == ' ') {
+        while (pos < length && !isspace((unsigned char)text[pos])) {
+            pos++;
+        }
+        while (pos < length && isspace((unsigned char)text[pos])) {
+            pos++;
+        }
+        return pos;
+    }
+    while (pos < length && text[pos] != split) {
+        pos++;
+    }
+    if (pos == length) {
+        return length;
+    }
+    npy_intp start = ++pos;
+    while (pos < length && isspace((unsigned char)text[pos])) {
+        pos++;
+    }
+    return pos < length ? start : length;
+}
+
+
+/*
+ * The number of threads to use for reading a text of `length` bytes with
+ * `array_from_text_parallel`.  Only simple numbers are supported, their
+ * parsers do not need the GIL.
+ */
+static int
+text_parallel_threads(PyArray_Descr *dtype, npy_intp num, const char *sep,
+                      npy_intp length)
+{
+    int type_num = dtype->type_num;
+    int nthreads;
+    char *clean_sep;
+
+    if (num >= 0 || !(PyTypeNum_ISBOOL(type_num) ||
+                      PyTypeNum_ISINTEGER(type_num) || type_num == NPY_HALF ||
+                      type_num == NPY_FLOAT || type_num == NPY_DOUBLE)) {
+        return 1;
+    }
+    nthreads = npy_parallel_threads_for_size(length);
+    if (nthreads <= 1) {
+        return 1;
+    }
+    clean_sep = swab_separator(sep);
+    if (clean_sep == NULL) {
+        PyErr_Clear();
+        return 1;
+    }
+    if (text_split_char(clean_sep) == 0) {
+        nthreads = 1;
+    }
+    free(clean_sep);
+    return nthreads;
+}
+
+
+/* The result of reading one chunk of a text in parallel */
+typedef struct {
+    char *data;
+    npy_intp nread;
+    /* As in `array_from_text`, -3 means that memory ran out */
+    int stop_reading_flag;
+    /* The number of bytes consumed, when reading like a file */
+    long consumed;
+} text_chunk_result;
+
+
+typedef struct {
+    PyArray_Descr *dtype;
+    const char *clean_sep;
+    char *text;
+    npy_intp *bounds;
+    int from_file;
+    text_chunk_result *results;
+} parallel_text_data;
+
+
+/*
+ * Reads one chunk of the text, exactly like `array_from_text` reads the
+ * whole text.
+ */
+static int
+text_chunk_task(void *data, npy_intp itask, int NPY_UNUSED(ithread))
+{
+    parallel_text_data *d = (parallel_text_data *)data;
+    text_chunk_result *res = &d->results[itask];
+    char *start = d->text + d->bounds[itask];
+    char *end = d->text + d->bounds[itask + 1];
+    npy_intp elsize = d->dtype->elsize;
+    npy_intp size = 0;
+    next_element next = (next_element)fromstr_next_element;
+    skip_separator skip_sep = (skip_separator)fromstr_skip_separator;
+    void *stream = start;
+    void *stream_data = end;
+
+    res->stop_reading_flag = -1;
+    if (start == end) {
+        return 0;
+    }
+    if (d->from_file) {
+#ifdef HAVE_FMEMOPEN
+        /* Use the file parsers, which do not behave quite the same */
+        stream = fmemopen(start, end - start, "r");
+#else
+        stream = NULL;
+#endif
+        if (stream == NULL) {
+            res->stop_reading_flag = -3;
+            return 0;
+        }
+        next = (next_element)fromfile_next_element;
+        skip_sep = (skip_separator)fromfile_skip_separator;
+        stream_data = NULL;
+    }
+
+    while (1) {
+        if (res->nread == size) {
+            char *tmp;
+            size = (size == 0) ? 4096 : 2 * size;
+            tmp = PyDataMem_RENEW(res->data, size * elsize);
+            if (tmp == NULL) {
+                res->stop_reading_flag = -3;
+                break;
+            }
+            res->data = tmp;
+        }
+        res->stop_reading_flag = next(&stream, res->data + res->nread * elsize,
+                                      d->dtype, stream_data);
+        if (res->stop_reading_flag < 0) {
+            break;
+        }
+        res->nread++;
+        res->stop_reading_flag = skip_sep(&stream, d->clean_sep, stream_data);
+        if (res->stop_reading_flag < 0) {
+            break;
+        }
+    }
+    if (d->from_file) {
+        res->consumed = ftell((FILE *)stream);
+        fclose((FILE *)stream);
+    }
+    return 0;
+}
+
+
+/*
+ * Reads all elements of `text` (of `length` bytes) using multiple threads,
+ * see `text_parallel_threads`.  The text is split into chunks right behind
+ * separators, each thread reads a chunk into its own buffer, these are
+ * concatenated in order up to the first chunk that stopped early.  The
+ * result (including the deprecation for unmatched data) is thus the same
+ * as reading it serially with `array_from_text`.
+ *
+ * If `from_file` is set, the text is read with the parsers used for files.
+ * `*consumed` is then set to the number of bytes read.
+ */
+static PyArrayObject *
+array_from_text_parallel(PyArray_Descr *dtype, char const *sep, size_t *nread,
+                         char *text, npy_intp length, int nthreads,
+                         int from_file, npy_intp *consumed)
+{
+    PyArrayObject *r = NULL;
+    npy_intp *bounds = NULL;
+    text_chunk_result *results = NULL;
+    npy_intp i, nchunks, total = 0;
+    int stop_reading_flag = -1;
+    char *clean_sep, *dptr;
+
+    clean_sep = swab_separator(sep);
+    if (clean_sep == NULL) {
+        return NULL;
+    }
+    bounds = PyMem_Malloc((nthreads + 1) * sizeof(npy_intp));
+    results = PyMem_Calloc(nthreads, sizeof(text_chunk_result));
+    if (bounds == NULL || results == NULL) {
+        PyErr_NoMemory();
+        goto finish;
+    }
+    bounds[0] = 0;
+    for (i = 1; i < nthreads; i++) {
+        npy_intp pos = length / nthreads * i;
+        if (pos < bounds[i - 1]) {
+            pos = bounds[i - 1];
+        }
+        bounds[i] = text_next_split(text, pos, length,
+                                    text_split_char(clean_sep));
+    }
+    bounds[nthreads] = length;
+
+    parallel_text_data d = {dtype, clean_sep, text, bounds, from_file, results};
+    NPY_BEGIN_THREADS_DEF;
+    NPY_BEGIN_THREADS;
+    npy_parallel_run(nthreads, nthreads, &text_chunk_task, &d);
+    NPY_END_THREADS;
+
+    /* Everything behind a chunk that stopped early is ignored */
+    for (nchunks = 0; nchunks < nthreads; nchunks++) {
+        total += results[nchunks].nread;
+        stop_reading_flag = results[nchunks].stop_reading_flag;
+        if (stop_reading_flag != -1) {
+            nchunks++;
+            break;
+        }
+    }
+    if (stop_reading_flag == -3) {
+        PyErr_NoMemory();
+        goto finish;
+    }
+    if (from_file) {
+        *consumed = length;
+        if (stop_reading_flag == -2) {
+            *consumed = bounds[nchunks - 1] + results[nchunks - 1].consumed;
+        }
+    }
+
+    Py_INCREF(dtype);
+    r = (PyArrayObject *)PyArray_NewFromDescr(&PyArray_Type, dtype, 1, &total,
+                                              NULL, NULL, 0, NULL);
+    if (r == NULL) {
+        goto finish;
+    }
+    dptr = PyArray_DATA(r);
+    for (i = 0; i < nchunks; i++) {
+        memcpy(dptr, results[i].data, results[i].nread * dtype->elsize);
+        dptr += results[i].nread * dtype->elsize;
+    }
+    *nread = total;
+
+    if (stop_reading_flag == -2) {
+        /* 2019-09-12, NumPy 1.18 */
+        if (DEPRECATE(
+                "string or file could not be read to its end due to unmatched "
+                "data; this will raise a ValueError in the future.") < 0) {
+            Py_CLEAR(r);
+        }
+    }
+
+  finish:
+    if (results != NULL) {
+        for (i = 0; i < nthreads; i++) {
+            PyDataMem_FREE(results[i].data);
+        }
+    }
+    PyMem_FREE(results);
+    PyMem_FREE(bounds);
+    free(clean_sep);
+    return r;
+}
+
+
+#ifdef HAVE_FMEMOPEN
+/*
+ * Returns the number of bytes left in a regular file, or -1 if unknown.
+ */
+static npy_intp
+file_remaining_bytes(FILE *fp)
+{
+    struct stat st;
+    npy_off_t pos;
+
+    if (fstat(fileno(fp), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return -1;
+    }
+    pos = npy_ftell(fp);
+    if (pos < 0 || st.st_size < pos || st.st_size - pos > NPY_MAX_INTP) {
+        return -1;
+    }
+    return (npy_intp)(st.st_size - pos);
+}
+
+
+/*
+ * Reads the rest of a regular file into memory, to read it in parallel with
+ * `array_from_text_parallel`.  Afterwards, the file position is set behind
+ * the data that was read, as the serial reading would.
+ */
+static PyArrayObject *
+array_fromfile_text_parallel(FILE *fp, PyArray_Descr *dtype, char const *sep,
+                             size_t *nread, npy_intp length, int nthreads)
+{
+    PyArrayObject *r;
+    npy_off_t start = npy_ftell(fp);
+    npy_intp consumed;
+    char *text = PyMem_RawMalloc(length + 1);
+
+    if (text == NULL) {
+        return (PyArrayObject *)PyErr_NoMemory();
+    }
+    NPY_BEGIN_ALLOW_THREADS;
+    length = fread(text, 1, length, fp);
+    NPY_END_ALLOW_THREADS;
+    text[length] = '\0';
+
+    r = array_from_text_parallel(dtype, sep, nread, text, length, nthreads,
+                                 1, &consumed);
+    PyMem_RawFree(text);
+    if (r != NULL && consumed < length) {
+        npy_fseek(fp, start + consumed, SEEK_SET);
+    }
+    return r;
+}
+#endif
+
 /*NUMPY_API
  *
  * Given a ``FILE *`` pointer ``fp``, and a ``PyArray_Descr``, return an
@@ -3512,9 +3866,23 @@ PyArray_FromFile(FILE *fp, PyArray_Descr *dtype, npy_intp num, char *sep)
             Py_DECREF(dtype);
             return NULL;
         }
-        ret = array_from_text(dtype, num, sep, &nread, fp,
-                (next_element) fromfile_next_element,
-                (skip_separator) fromfile_skip_separator, NULL);
+#ifdef HAVE_FMEMOPEN
+        npy_intp length = file_remaining_bytes(fp);
+        int nthreads = 1;
+        if (length >= 0) {
+            nthreads = text_parallel_threads(dtype, num, sep, length);
+        }
+        if (nthreads > 1) {
+            ret = array_fromfile_text_parallel(fp, dtype, sep, &nread,
+                                               length, nthreads);
+        }
+        else
+#endif
+        {
+            ret = array_from_text(dtype, num, sep, &nread, fp,
+                    (next_element) fromfile_next_element,
+                    (skip_separator) fromfile_skip_separator, NULL);
+        }
     }
     if (ret == NULL) {
         Py_DECREF(dtype);
@@ -3528,7 +3896,8 @@ PyArray_FromFile(FILE *fp, PyArray_Descr *dtype, npy_intp num, char *sep)
         const size_t nsize = PyArray_MAX(nread,1) * dtype->elsize;
         char *tmp;
 
-        if ((tmp = PyDataMem_RENEW(PyArray_DATA(ret), nsize)) == NULL) {
+        if ((tmp = PyDataMem_UserRENEW(PyArray_DATA(ret), nsize,
+                                       PyArray_HANDLER(ret))) == NULL) {
             Py_DECREF(dtype);
             Py_DECREF(ret);
             return PyErr_NoMemory();
@@ -3727,6 +4096,8 @@ PyArray_FromString(char *data, npy_intp slen, PyArray_Descr *dtype,
         /* read from character-based string */
         size_t nread = 0;
         char *end;
+        npy_intp length;
+        int nthreads;
 
         if (dtype->f->fromstr == NULL) {
             PyErr_SetString(PyExc_ValueError,
@@ -3742,11 +4113,19 @@ PyArray_FromString(char *data, npy_intp slen, PyArray_Descr *dtype,
         else {
             end = data + slen;
         }
-        ret = array_from_text(dtype, num, sep, &nread,
-                              data,
-                              (next_element) fromstr_next_element,
-                              (skip_separator) fromstr_skip_separator,
-                              end);
+        length = (end == NULL) ? (npy_intp)strlen(data) : slen;
+        nthreads = text_parallel_threads(dtype, num, sep, length);
+        if (nthreads > 1) {
+            ret = array_from_text_parallel(dtype, sep, &nread, data, length,
+                                           nthreads, 0, NULL);
+        }
+        else {
+            ret = array_from_text(dtype, num, sep, &nread,
+                                  data,
+                                  (next_element) fromstr_next_element,
+                                  (skip_separator) fromstr_skip_separator,
+                                  end);
+        }
         Py_DECREF(dtype);
     }
     return (PyObject *)ret;
@@ -3812,7 +4191,8 @@ PyArray_FromIter(PyObject *obj, PyArray_Descr *dtype, npy_intp count)
             */
             elcount = (i >> 1) + (i < 4 ? 4 : 2) + i;
             if (!npy_mul_with_overflow_intp(&nbytes, elcount, elsize)) {
-                new_data = PyDataMem_RENEW(PyArray_DATA(ret), nbytes);
+                new_data = PyDataMem_UserRENEW(
+                        PyArray_DATA(ret), nbytes, PyArray_HANDLER(ret));
             }
             else {
                 new_data = NULL;
@@ -3850,10 +4230,11 @@ PyArray_FromIter(PyObject *obj, PyArray_Descr *dtype, npy_intp count)
      * (assuming realloc is reasonably good about reusing space...)
      */
     if (i == 0 || elsize == 0) {
-        /* The size cannot be zero for PyDataMem_RENEW. */
+        /* The size cannot be zero for realloc. */
         goto done;
     }
-    new_data = PyDataMem_RENEW(PyArray_DATA(ret), i * elsize);
+    new_data = PyDataMem_UserRENEW(
+            PyArray_DATA(ret), i * elsize, PyArray_HANDLER(ret));
     if (new_data == NULL) {
         PyErr_SetString(PyExc_MemoryError,
                 "cannot allocate array memory");
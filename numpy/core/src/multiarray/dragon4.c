@@ -31,6 +31,7 @@
  */
 
 #include "dragon4.h"
+#include "npy_ryu.h"
 #include <numpy/npy_common.h>
 #include <math.h>
 #include <stdio.h>
@@ -186,6 +187,20 @@ free_dragon4_bigint_scratch(Dragon4_Scratch *mem){
     _bigint_static_in_use = 0;
 }
 
+/* Get the value of a BigInt which fits into 64 bits */
+static npy_uint64
+BigInt_Get_uint64(const BigInt *i)
+{
+    DEBUG_ASSERT(i->length <= 2);
+    if (i->length == 0) {
+        return 0;
+    }
+    if (i->length == 1) {
+        return i->blocks[0];
+    }
+    return ((npy_uint64)i->blocks[1] << 32) | i->blocks[0];
+}
+
 /* Copy integer */
 static void
 BigInt_Copy(BigInt *dst, const BigInt *src)
@@ -1076,6 +1091,35 @@ BigInt_ShiftLeft(BigInt *result, npy_uint32 shift)
 }
 
 
+/*
+ * Checks whether the shortest unique digits of a value, found by
+ * `npy_ryu_shortest_digits`, are also what Dragon4 prints in
+ * `DigitMode_Unique` with the given cutoffs.  That is the case unless the
+ * `cutoff_max` digit comes before the last unique digit (so Dragon4 rounds
+ * there) or `cutoff_min` asks for digits after it.
+ *
+ * `exponent` is the exponent of the first of the `numDigits` digits. A single
+ * digit may have been found by rounding up a 9 at the next lower exponent
+ * (e.g. "1e-7" for 9.99...e-8), in which case Dragon4 stops at that lower
+ * exponent, so for the fractional cutoff both positions must be fine.
+ */
+static npy_bool
+Dragon4_RyuWithinCutoffs(npy_int32 numDigits, npy_int32 exponent,
+                         const CutoffMode cutoffMode, npy_int32 cutoff_max,
+                         npy_int32 cutoff_min)
+{
+    npy_int32 lastExponent, lowestExponent;
+
+    if (cutoffMode == CutoffMode_TotalLength) {
+        return (cutoff_max < 0 || numDigits <= cutoff_max) &&
+               (cutoff_min < 0 || numDigits >= cutoff_min);
+    }
+    lastExponent = exponent - numDigits + 1;
+    lowestExponent = numDigits == 1 ? exponent - 1 : lastExponent;
+    return (cutoff_max < 0 || lowestExponent >= -cutoff_max) &&
+           (cutoff_min < 0 || lastExponent <= -cutoff_min);
+}
+
 /*
  * This is an implementation the Dragon4 algorithm to convert a binary number in
  * floating point format to a decimal number in string format. The function
@@ -1123,6 +1167,11 @@ BigInt_ShiftLeft(BigInt *result, npy_uint32 shift)
  *     implementation did not implement "IEEE unbiased rounding", except in the
  *     last digit. This has been added back, following the Burger & Dybvig
  *     code, using the isEven variable.
+ *  5. In the unique digit mode, values of up to 53 bits in the binary64
+ *     exponent range (float16, float32 and float64) are handed to the much
+ *     faster Ryu algorithm, which finds the same digits without BigInts.
+ *     The BigInt code remains for longer types, for the exact digit mode and
+ *     whenever a cutoff changes the result.
  *
  * Arguments:
  *   * bigints - memory to store all bigints needed (7) for dragon4 computation.
@@ -1189,6 +1238,21 @@ Dragon4(BigInt *bigints, const npy_int32 exponent,
         return 1;
     }
 
+    if (digitMode == DigitMode_Unique && mantissaBit <= 52 &&
+            exponent >= -1074 && exponent <= 971 &&
+            bufferSize >= NPY_RYU_MAX_DIGITS) {
+        npy_int32 ryuExponent;
+        npy_int32 numDigits = npy_ryu_shortest_digits(
+                BigInt_Get_uint64(mantissa), exponent, hasUnequalMargins,
+                pOutBuffer, &ryuExponent);
+
+        if (Dragon4_RyuWithinCutoffs(numDigits, ryuExponent, cutoffMode,
+                                     cutoff_max, cutoff_min)) {
+            *pOutExponent = ryuExponent;
+            return numDigits;
+        }
+    }
+
     BigInt_Copy(scaledValue, mantissa);
 
     if (hasUnequalMargins) {
@@ -1584,42 +1648,6 @@ Dragon4(BigInt *bigints, const npy_int32 exponent,
  * from the 64 bit version. The python interface functions are new.
  */
 
-
-/* Options struct for easy passing of Dragon4 options.
- *
- *   scientific - boolean controlling whether scientific notation is used
- *   digit_mode - whether to use unique or fixed fractional output
- *   cutoff_mode - whether 'precision' refers to all digits, or digits past
- *                 the decimal point.
- *   precision - When negative, prints as many digits as needed for a unique
- *               number. When positive specifies the maximum number of
- *               significant digits to print.
- *   sign - whether to always show sign
- *   trim_mode - how to treat trailing 0s and '.'. See TrimMode comments.
- *   digits_left - pad characters to left of decimal point. -1 for no padding
- *   digits_right - pad characters to right of decimal point. -1 for no padding.
- *                  Padding adds whitespace until there are the specified
- *                  number characters to sides of decimal point. Applies after
- *                  trim_mode characters were removed. If digits_right is
- *                  positive and the decimal point was trimmed, decimal point
- *                  will be replaced by a whitespace character.
- *   exp_digits - Only affects scientific output. If positive, pads the
- *                exponent with 0s until there are this many digits. If
- *                negative, only use sufficient digits.
- */
-typedef struct Dragon4_Options {
-    npy_bool scientific;
-    DigitMode digit_mode;
-    CutoffMode cutoff_mode;
-    npy_int32 precision;
-    npy_int32 min_digits;
-    npy_bool sign;
-    TrimMode trim_mode;
-    npy_int32 digits_left;
-    npy_int32 digits_right;
-    npy_int32 exp_digits;
-} Dragon4_Options;
-
 /*
  * Outputs the positive number with positional notation: ddddd.dddd
  * The output is always NUL terminated and the output length (not including the
@@ -3185,7 +3213,36 @@ Dragon4_Scientific_##Type(npy_type *val, DigitMode digit_mode, int precision,\
     return Dragon4_Scientific_##Type##_opt(val, &opt);\
 }
 
+/*
+ * The same without creating a Python string, the output is copied to
+ * `buffer` instead.  Returns the length, or -1 with an error set if the
+ * output (plus the terminating NUL) does not fit into `size` characters.
+ */
+#define make_dragon4_formatfunc_inner(Type, npy_type, format) \
+\
+npy_intp \
+Dragon4_Format_##Type(npy_type *val, Dragon4_Options *opt,\
+                      char *buffer, npy_intp size)\
+{\
+    npy_uint32 len;\
+    Dragon4_Scratch *scratch = get_dragon4_bigint_scratch();\
+    if (scratch == NULL) {\
+        return -1;\
+    }\
+    len = Dragon4_PrintFloat_##format(scratch, val, opt);\
+    if ((npy_intp)len >= size) {\
+        free_dragon4_bigint_scratch(scratch);\
+        PyErr_SetString(PyExc_RuntimeError,\
+                "formatted float does not fit into the buffer");\
+        return -1;\
+    }\
+    memcpy(buffer, scratch->repr, len + 1);\
+    free_dragon4_bigint_scratch(scratch);\
+    return len;\
+}
+
 #define make_dragon4_typefuncs(Type, npy_type, format) \
+        make_dragon4_formatfunc_inner(Type, npy_type, format) \
         make_dragon4_typefuncs_inner(Type, npy_type, format)
 
 make_dragon4_typefuncs(Half, npy_half, NPY_HALF_BINFMT_NAME)
@@ -3195,6 +3252,7 @@ make_dragon4_typefuncs(LongDouble, npy_longdouble, NPY_LONGDOUBLE_BINFMT_NAME)
 
 #undef make_dragon4_typefuncs
 #undef make_dragon4_typefuncs_inner
+#undef make_dragon4_formatfunc_inner
 
 PyObject *
 Dragon4_Positional(PyObject *obj, DigitMode digit_mode, CutoffMode cutoff_mode,
@@ -34,6 +34,7 @@
 #include "dtypemeta.h"
 #include "array_method.h"
 #include "array_coercion.h"
+#include "npy_parallel.h"
 
 #define NPY_LOWLEVEL_BUFFER_BLOCKSIZE  128
 
@@ -3545,6 +3546,136 @@ PyArray_GetMaskedDTypeTransferFunction(int aligned,
     return NPY_SUCCEED;
 }
 
+/* Chunk boundaries of one dimensional casts are multiples of this */
+#define CAST_PARALLEL_ALIGN 64
+
+typedef struct {
+    NPY_cast_info *cast_info;
+    /* Copies of `cast_info` for the threads other than the calling one */
+    NPY_cast_info *copies;
+    int ndim;
+    npy_intp const *shape;
+    char *src, *dst;
+    npy_intp const *src_strides, *dst_strides;
+    int nchunks;
+} _parallel_cast_data;
+
+
+static int
+_parallel_cast_task(void *data, npy_intp ichunk, int ithread)
+{
+    _parallel_cast_data *d = data;
+    NPY_cast_info *cast_info = ithread == 0 ? d->cast_info :
+                                              &d->copies[ithread - 1];
+    int idim, ndim = d->ndim;
+    npy_intp shape[NPY_MAXDIMS], coord[NPY_MAXDIMS];
+    npy_intp start, stop;
+    npy_intp strides[2] = {d->src_strides[0], d->dst_strides[0]};
+
+    memcpy(shape, d->shape, ndim * sizeof(npy_intp));
+    npy_parallel_chunk_bounds(shape[ndim - 1], d->nchunks, ichunk,
+                              ndim == 1 ? CAST_PARALLEL_ALIGN : 1,
+                              &start, &stop);
+    if (start >= stop) {
+        return 0;
+    }
+    shape[ndim - 1] = stop - start;
+    char *src = d->src + start * d->src_strides[ndim - 1];
+    char *dst = d->dst + start * d->dst_strides[ndim - 1];
+
+    NPY_RAW_ITER_START(idim, ndim, coord, shape) {
+        char *args[2] = {src, dst};
+        if (cast_info->func(&cast_info->context,
+                args, &shape[0], strides, cast_info->auxdata) < 0) {
+            return -1;
+        }
+    } NPY_RAW_ITER_TWO_NEXT(idim, ndim, coord, shape,
+                            src, d->src_strides, dst, d->dst_strides);
+    return 0;
+}
+
+
+/* Lowest and (one past the) highest address of a raw array iteration */
+static void
+_raw_array_extents(int ndim, npy_intp const *shape, char *data,
+                   npy_intp const *strides, npy_intp itemsize,
+                   char **low, char **high)
+{
+    *low = data;
+    *high = data + itemsize;
+    for (int idim = 0; idim < ndim; idim++) {
+        npy_intp offset = (shape[idim] - 1) * strides[idim];
+        if (offset < 0) {
+            *low += offset;
+        }
+        else {
+            *high += offset;
+        }
+    }
+}
+
+
+NPY_NO_EXPORT int
+npy_parallel_raw_cast(NPY_cast_info *cast_info, int ndim,
+        npy_intp const *shape, char *src, npy_intp const *src_strides,
+        char *dst, npy_intp const *dst_strides, int nthreads)
+{
+    char *src_low, *src_high, *dst_low, *dst_high;
+    int i, res = 0;
+
+    if (ndim < 1 || shape[ndim - 1] < 2 || (cast_info->auxdata != NULL &&
+                                            cast_info->auxdata->clone == NULL)) {
+        return -2;
+    }
+    /* Chunks must not write what other chunks still have to read */
+    _raw_array_extents(ndim, shape, src, src_strides,
+                       cast_info->descriptors[0]->elsize, &src_low, &src_high);
+    _raw_array_extents(ndim, shape, dst, dst_strides,
+                       cast_info->descriptors[1]->elsize, &dst_low, &dst_high);
+    if (src_low < dst_high && dst_low < src_high) {
+        return -2;
+    }
+    if (nthreads > shape[ndim - 1]) {
+        nthreads = (int)shape[ndim - 1];
+    }
+
+    _parallel_cast_data d = {
+        .cast_info = cast_info,
+        .ndim = ndim, .shape = shape,
+        .src = src, .src_strides = src_strides,
+        .dst = dst, .dst_strides = dst_strides,
+        .nchunks = nthreads,
+    };
+    d.copies = PyMem_Malloc((nthreads - 1) * sizeof(NPY_cast_info));
+    if (d.copies == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (i = 0; i < nthreads - 1; i++) {
+        if (NPY_cast_info_copy(&d.copies[i], cast_info) < 0) {
+            NPY_cast_info_xfree(&d.copies[i]);
+            PyErr_NoMemory();
+            res = -1;
+            goto finish;
+        }
+    }
+
+    NPY_BEGIN_THREADS_DEF;
+    NPY_BEGIN_THREADS;
+    if (npy_parallel_run(nthreads, nthreads, &_parallel_cast_task, &d) != 0) {
+        res = -1;
+    }
+    NPY_END_THREADS;
+
+  finish:
+    while (i-- > 0) {
+        NPY_cast_info_xfree(&d.copies[i]);
+    }
+    PyMem_Free(d.copies);
+    return res;
+}
+
+
 NPY_NO_EXPORT int
 PyArray_CastRawArrays(npy_intp count,
                       char *src, char *dst,
@@ -3585,7 +3716,16 @@ PyArray_CastRawArrays(npy_intp count,
         return NPY_FAIL;
     }
 
-    /* Cast */
+    /* Cast, large casts which do not need the API are split across threads */
+    int nthreads = needs_api ? 1 : npy_parallel_threads_for_size(count);
+    if (nthreads > 1) {
+        int res = npy_parallel_raw_cast(&cast_info, 1, &count,
+                src, &src_stride, dst, &dst_stride, nthreads);
+        if (res != -2) {
+            NPY_cast_info_xfree(&cast_info);
+            return res < 0 ? NPY_FAIL : NPY_SUCCEED;
+        }
+    }
     char *args[2] = {src, dst};
     npy_intp strides[2] = {src_stride, dst_stride};
     cast_info.func(&cast_info.context, args, &count, strides, cast_info.auxdata);
@@ -115,6 +115,22 @@ NPY_cast_info_copy(NPY_cast_info *cast_info, NPY_cast_info *original)
 }
 
 
+/*
+ * Casts a raw array iteration (as prepared by PyArray_PrepareTwoRawArrayIter)
+ * with `nthreads` threads, each thread casts a consecutive block of the
+ * outermost dimension using its own copy of `cast_info`.  Must be called
+ * with the GIL held, it is released while casting.
+ *
+ * Returns 0 on success and -1 on failure.  Returns -2 (before doing
+ * anything) if the cast cannot be split, because the cast data cannot be
+ * copied or because the source and destination overlap.
+ */
+NPY_NO_EXPORT int
+npy_parallel_raw_cast(NPY_cast_info *cast_info, int ndim,
+        npy_intp const *shape, char *src, npy_intp const *src_strides,
+        char *dst, npy_intp const *dst_strides, int nthreads);
+
+
 NPY_NO_EXPORT int
 _strided_to_strided_move_references(
         PyArrayMethod_Context *NPY_UNUSED(context), char *const *args,
@@ -0,0 +1,42 @@
+#ifndef _NPY_PRIVATE__GATHER_H_
+#define _NPY_PRIVATE__GATHER_H_
+
+#include "numpy/ndarraytypes.h"
+#include "npy_cpu_dispatch.h"
+
+#ifndef NPY_DISABLE_OPTIMIZATION
+    #include "gather.dispatch.h"
+#endif
+
+/*
+ * Kernels of `gather.dispatch.c.src`, use them through `npy_gather` and
+ * `npy_scatter` of `item_selection.h`.
+ *
+ * `npy_index_minmax_*` finds the minimum and maximum of `n > 0` indices.
+ * `npy_gather_*` copies `src[ind[i]]` to `dst[i]` and `npy_scatter_*`
+ * copies `src[i]` to `dst[ind[i]]`, negative indices are wrapped by adding
+ * the length of the indexed array.  The indices are not checked.
+ */
+#define NPY__GATHER_DECLARE(ISFX, ESFX) \
+    NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void npy_gather_##ISFX##_##ESFX, \
+            (char *dst, npy_intp dst_stride, \
+             const char *src, npy_intp src_stride, npy_intp src_len, \
+             const void *ind, npy_intp n)) \
+    NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void npy_scatter_##ISFX##_##ESFX, \
+            (char *dst, npy_intp dst_stride, npy_intp dst_len, \
+             const char *src, npy_intp src_stride, \
+             const void *ind, npy_intp n))
+
+NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void npy_index_minmax_s32,
+        (const void *ind, npy_intp n, npy_intp *mn, npy_intp *mx))
+NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void npy_index_minmax_s64,
+        (const void *ind, npy_intp n, npy_intp *mn, npy_intp *mx))
+
+NPY__GATHER_DECLARE(s32, u32)
+NPY__GATHER_DECLARE(s32, u64)
+NPY__GATHER_DECLARE(s64, u32)
+NPY__GATHER_DECLARE(s64, u64)
+
+#undef NPY__GATHER_DECLARE
+
+#endif  /* _NPY_PRIVATE__GATHER_H_ */
@@ -384,8 +384,10 @@ array_data_set(PyArrayObject *self, PyObject *op, void *NPY_UNUSED(ignored))
     }
     if (PyArray_FLAGS(self) & NPY_ARRAY_OWNDATA) {
         PyArray_XDECREF(self);
-        PyDataMem_FREE(PyArray_DATA(self));
+        npy_free_array_data(self);
     }
+    /* The new data is not owned */
+    Py_CLEAR(((PyArrayObject_fields *)self)->mem_handler);
     if (PyArray_BASE(self)) {
         if ((PyArray_FLAGS(self) & NPY_ARRAY_WRITEBACKIFCOPY) ||
             (PyArray_FLAGS(self) & NPY_ARRAY_UPDATEIFCOPY)) {
@@ -0,0 +1,27 @@
+#ifndef _NPY_PRIVATE__HISTOGRAM_H_
+#define _NPY_PRIVATE__HISTOGRAM_H_
+#include <numpy/ndarraytypes.h>
+
+NPY_NO_EXPORT PyObject *
+arr_histogram(PyObject *, PyObject *, PyObject *);
+
+/*
+ * Minimum and maximum of the contiguous integer (or bool) array `data` of
+ * type `type_num`.  Returns -1 if the maximum is not smaller than
+ * NPY_MAX_INTP.  Does not need the GIL.
+ */
+NPY_NO_EXPORT int
+npy_bincount_minmax(int type_num, const char *data, npy_intp n,
+                    npy_intp *mn, npy_intp *mx);
+
+/*
+ * Adds the number of occurrences (or the sum of the double `weights`) of
+ * every value of `data` (in `[0, ans_size)`) to `ans`, an array of
+ * `ans_size` intp (or double) values.  Returns -1 if out of memory.
+ * Does not need the GIL.
+ */
+NPY_NO_EXPORT int
+npy_bincount(int type_num, const char *data, npy_intp n,
+             const double *weights, char *ans, npy_intp ans_size);
+
+#endif
@@ -25,10 +25,147 @@
 #include "npy_sort.h"
 #include "npy_partition.h"
 #include "npy_binsearch.h"
+#include "npy_parallel.h"
 #include "alloc.h"
 #include "arraytypes.h"
 #include "array_coercion.h"
 #include "simd/simd.h"
+#include "item_selection.h"
+#include "gather.h"
+#include "compress.h"
+
+NPY_NO_EXPORT int
+npy_gather_supported(npy_intp itemsize, npy_intp ind_size)
+{
+    return (itemsize == 4 || itemsize == 8) &&
+           (ind_size == 4 || ind_size == sizeof(npy_intp));
+}
+
+
+/*
+ * Both `gather.h` and `compress.h` are included, the dispatch header of
+ * the kernels called has to be re-included before the calls.
+ */
+#ifndef NPY_DISABLE_OPTIMIZATION
+    #include "gather.dispatch.h"
+#endif
+
+NPY_NO_EXPORT int
+npy_index_in_bounds(const char *ind, npy_intp ind_size, npy_intp n,
+                    npy_intp len, int wrap_negative)
+{
+    npy_intp mn, mx;
+
+    if (n == 0) {
+        return 1;
+    }
+#if NPY_SIZEOF_INTP == 8
+    if (ind_size == 8) {
+        NPY_CPU_DISPATCH_CALL(npy_index_minmax_s64, (ind, n, &mn, &mx));
+    }
+    else
+#endif
+    {
+        NPY_CPU_DISPATCH_CALL(npy_index_minmax_s32, (ind, n, &mn, &mx));
+    }
+    return mx < len && mn >= (wrap_negative ? -len : 0);
+}
+
+
+NPY_NO_EXPORT void
+npy_gather(char *dst, npy_intp dst_stride,
+           const char *src, npy_intp src_stride, npy_intp src_len,
+           const char *ind, npy_intp ind_size, npy_intp n, npy_intp itemsize)
+{
+#if NPY_SIZEOF_INTP == 8
+    if (ind_size == 8) {
+        if (itemsize == 8) {
+            NPY_CPU_DISPATCH_CALL(npy_gather_s64_u64,
+                    (dst, dst_stride, src, src_stride, src_len, ind, n));
+        }
+        else {
+            NPY_CPU_DISPATCH_CALL(npy_gather_s64_u32,
+                    (dst, dst_stride, src, src_stride, src_len, ind, n));
+        }
+        return;
+    }
+#endif
+    if (itemsize == 8) {
+        NPY_CPU_DISPATCH_CALL(npy_gather_s32_u64,
+                (dst, dst_stride, src, src_stride, src_len, ind, n));
+    }
+    else {
+        NPY_CPU_DISPATCH_CALL(npy_gather_s32_u32,
+                (dst, dst_stride, src, src_stride, src_len, ind, n));
+    }
+}
+
+
+NPY_NO_EXPORT void
+npy_scatter(char *dst, npy_intp dst_stride, npy_intp dst_len,
+            const char *src, npy_intp src_stride,
+            const char *ind, npy_intp ind_size, npy_intp n, npy_intp itemsize)
+{
+#if NPY_SIZEOF_INTP == 8
+    if (ind_size == 8) {
+        if (itemsize == 8) {
+            NPY_CPU_DISPATCH_CALL(npy_scatter_s64_u64,
+                    (dst, dst_stride, dst_len, src, src_stride, ind, n));
+        }
+        else {
+            NPY_CPU_DISPATCH_CALL(npy_scatter_s64_u32,
+                    (dst, dst_stride, dst_len, src, src_stride, ind, n));
+        }
+        return;
+    }
+#endif
+    if (itemsize == 8) {
+        NPY_CPU_DISPATCH_CALL(npy_scatter_s32_u64,
+                (dst, dst_stride, dst_len, src, src_stride, ind, n));
+    }
+    else {
+        NPY_CPU_DISPATCH_CALL(npy_scatter_s32_u32,
+                (dst, dst_stride, dst_len, src, src_stride, ind, n));
+    }
+}
+
+
+/*
+ * Fast path of take for 4 and 8 byte items using the gather kernels.
+ * The kernels copy the items as unsigned integers, so `src` and `dest`
+ * must be uint aligned (`is_aligned`).
+ * Returns 0, without touching `dest`, if it does not apply or if any index
+ * is out of bounds, the generic loop then wraps, clips or reports them.
+ */
+static int
+npy_fasttake_gather(
+        char *dest, char *src, const char *indices, npy_intp ind_size,
+        npy_intp n, npy_intp m, npy_intp max_item, npy_intp nelem,
+        NPY_CLIPMODE clipmode, npy_intp itemsize, int needs_refcounting,
+        int is_aligned)
+{
+    int in_bounds;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (needs_refcounting || nelem != 1 || !is_aligned ||
+            !npy_gather_supported(itemsize, ind_size)) {
+        return 0;
+    }
+    NPY_BEGIN_THREADS_THRESHOLDED(n * m);
+    in_bounds = npy_index_in_bounds(indices, ind_size, m, max_item,
+                                    clipmode != NPY_CLIP);
+    if (in_bounds) {
+        for (npy_intp i = 0; i < n; i++) {
+            npy_gather(dest, itemsize, src, itemsize, max_item,
+                       indices, ind_size, m, itemsize);
+            dest += m * itemsize;
+            src += max_item * itemsize;
+        }
+    }
+    NPY_END_THREADS;
+    return in_bounds;
+}
+
 
 static NPY_GCC_OPT_3 NPY_INLINE int
 npy_fasttake_impl(
@@ -205,11 +342,24 @@ PyArray_TakeFrom(PyArrayObject *self0, PyObject *indices0, int axis,
     if (self == NULL) {
         return NULL;
     }
-    indices = (PyArrayObject *)PyArray_ContiguousFromAny(indices0,
-                                                         NPY_INTP,
-                                                         0, 0);
-    if (indices == NULL) {
-        goto fail;
+    if (PyArray_Check(indices0) &&
+            PyArray_ISSIGNED((PyArrayObject *)indices0) &&
+            PyArray_ITEMSIZE((PyArrayObject *)indices0) == 4 &&
+            PyArray_ISCARRAY_RO((PyArrayObject *)indices0) &&
+            PyArray_ISNOTSWAPPED((PyArrayObject *)indices0) &&
+            npy_gather_supported(PyArray_ITEMSIZE(self), 4) &&
+            IsUintAligned(self)) {
+        /* int32 indices are cast only if the gather kernels cannot be used */
+        indices = (PyArrayObject *)indices0;
+        Py_INCREF(indices);
+    }
+    else {
+        indices = (PyArrayObject *)PyArray_ContiguousFromAny(indices0,
+                                                             NPY_INTP,
+                                                             0, 0);
+        if (indices == NULL) {
+            goto fail;
+        }
     }
 
     n = m = chunk = 1;
@@ -281,7 +431,6 @@ PyArray_TakeFrom(PyArrayObject *self0, PyObject *indices0, int axis,
     char *src = PyArray_DATA(self);
     char *dest = PyArray_DATA(obj);
     needs_refcounting = PyDataType_REFCHK(PyArray_DESCR(self));
-    npy_intp *indices_data = (npy_intp *)PyArray_DATA(indices);
 
     if ((max_item == 0) && (PyArray_SIZE(obj) != 0)) {
         /* Index error, since that is the usual error for raise mode */
@@ -290,12 +439,28 @@ PyArray_TakeFrom(PyArrayObject *self0, PyObject *indices0, int axis,
         goto fail;
     }
 
+    if (npy_fasttake_gather(
+            dest, src, PyArray_BYTES(indices), PyArray_ITEMSIZE(indices),
+            n, m, max_item, nelem, clipmode, itemsize, needs_refcounting,
+            IsUintAligned(self) && IsUintAligned(obj))) {
+        goto finish;
+    }
+    if (PyArray_TYPE(indices) != NPY_INTP) {
+        Py_SETREF(indices, (PyArrayObject *)PyArray_FromArray(
+                indices, PyArray_DescrFromType(NPY_INTP), NPY_ARRAY_CARRAY_RO));
+        if (indices == NULL) {
+            goto fail;
+        }
+    }
+    npy_intp *indices_data = (npy_intp *)PyArray_DATA(indices);
+
     if (npy_fasttake(
             dest, src, indices_data, n, m, max_item, nelem, chunk,
             clipmode, itemsize, needs_refcounting, dtype, axis) < 0) {
         goto fail;
     }
 
+ finish:
     Py_XDECREF(indices);
     Py_XDECREF(self);
     if (out != NULL && out != obj) {
@@ -928,6 +1093,203 @@ PyArray_Choose(PyArrayObject *ip, PyObject *op, PyArrayObject *out,
     return NULL;
 }
 
+/*
+ * Whether the sort and partition functions of a dtype may run concurrently
+ * on different lanes.  This is only known for the builtin types without
+ * references (for example, comparing structured dtypes temporarily modifies
+ * the array).
+ */
+static int
+_sort_is_thread_safe(PyArray_Descr *descr)
+{
+    int type = descr->type_num;
+
+    return !PyDataType_REFCHK(descr) &&
+           (PyTypeNum_ISNUMBER(type) || PyTypeNum_ISSTRING(type) ||
+            PyTypeNum_ISDATETIME(type));
+}
+
+
+/*
+ * Chooses how to use the parallel thread pool for sorting `nlanes` lanes of
+ * `N` elements.  Returns the number of threads sorting different lanes
+ * concurrently and sets `lane_threads` to the number of threads used for
+ * each single lane, at least one of them is 1.  Single lanes are only split
+ * if `split` is set, since that requires a temporary copy of the lane.
+ */
+static int
+_sort_threads(PyArrayObject *op, npy_intp N, npy_intp nlanes, int split,
+              int *lane_threads)
+{
+    int nthreads = npy_parallel_threads_for_size(N * nlanes);
+
+    *lane_threads = 1;
+    if (nthreads <= 1 || !_sort_is_thread_safe(PyArray_DESCR(op))) {
+        return 1;
+    }
+    if (nlanes < nthreads && split &&
+            npy_parallel_sort_supported(PyArray_TYPE(op))) {
+        *lane_threads = nthreads;
+        return 1;
+    }
+    return nlanes < nthreads ? (int)nlanes : nthreads;
+}
+
+
+/*
+ * Returns the data pointers of all positions of the iterator, which is
+ * reset afterwards.
+ */
+static char **
+_lane_pointers(PyArrayIterObject *it)
+{
+    char **lanes = PyArray_malloc(it->size * sizeof(char *));
+    npy_intp i;
+
+    if (lanes == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    for (i = 0; i < it->size; i++) {
+        lanes[i] = it->dataptr;
+        PyArray_ITER_NEXT(it);
+    }
+    PyArray_ITER_RESET(it);
+    return lanes;
+}
+
+
+typedef struct {
+    PyArrayObject *op;
+    PyArray_SortFunc *sort;
+    PyArray_PartitionFunc *part;
+    npy_intp const *kth;
+    npy_intp nkth;
+    npy_intp N;
+    npy_intp astride;
+    int swap;
+    int needcopy;
+    int hasrefs;
+    /* Number of threads sorting each single lane */
+    int lane_threads;
+    /* Lanes sorted concurrently, with one buffer of N items per thread */
+    char **lanes;
+    npy_intp nlanes;
+    int nthreads;
+    char *buffers;
+} sortlike_data;
+
+
+/* Sorts or partitions a single lane, `buffer` is used if a copy is needed */
+static int
+_sort_lane(sortlike_data *d, char *dataptr, char *buffer)
+{
+    PyArrayObject *op = d->op;
+    npy_intp N = d->N;
+    npy_intp elsize = (npy_intp)PyArray_ITEMSIZE(op);
+    npy_intp astride = d->astride;
+    int swap = d->swap;
+    PyArray_CopySwapNFunc *copyswapn = PyArray_DESCR(op)->f->copyswapn;
+    char *bufptr = dataptr;
+    int ret = 0;
+
+    if (d->needcopy) {
+        if (d->hasrefs) {
+            /*
+             * For dtype's with objects, copyswapn Py_XINCREF's src
+             * and Py_XDECREF's dst. This would crash if called on
+             * an uninitialized buffer, or leak a reference to each
+             * object if initialized.
+             *
+             * So, first do the copy with no refcounting...
+             */
+            _unaligned_strided_byte_copy(buffer, elsize,
+                                         dataptr, astride, N, elsize);
+            /* ...then swap in-place if needed */
+            if (swap) {
+                copyswapn(buffer, elsize, NULL, 0, N, swap, op);
+            }
+        }
+        else {
+            copyswapn(buffer, elsize, dataptr, astride, N, swap, op);
+        }
+        bufptr = buffer;
+    }
+    /*
+     * TODO: If the input array is byte-swapped but contiguous and
+     * aligned, it could be swapped (and later unswapped) in-place
+     * rather than after copying to the buffer. Care would have to
+     * be taken to ensure that, if there is an error in the call to
+     * sort or part, the unswapping is still done before returning.
+     */
+
+    if (d->part == NULL) {
+        if (d->lane_threads > 1) {
+            ret = npy_parallel_sort(bufptr, N, op, d->sort, d->lane_threads);
+        }
+        else {
+            ret = d->sort(bufptr, N, op);
+        }
+        if (d->hasrefs && PyErr_Occurred()) {
+            ret = -1;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    else {
+        npy_intp pivots[NPY_MAX_PIVOT_STACK];
+        npy_intp npiv = 0;
+        npy_intp i;
+        for (i = 0; i < d->nkth; ++i) {
+            ret = d->part(bufptr, N, d->kth[i], pivots, &npiv, op);
+            if (d->hasrefs && PyErr_Occurred()) {
+                ret = -1;
+            }
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+
+    if (d->needcopy) {
+        if (d->hasrefs) {
+            if (swap) {
+                copyswapn(buffer, elsize, NULL, 0, N, swap, op);
+            }
+            _unaligned_strided_byte_copy(dataptr, astride,
+                                         buffer, elsize, N, elsize);
+        }
+        else {
+            copyswapn(dataptr, astride, buffer, elsize, N, swap, op);
+        }
+    }
+    return 0;
+}
+
+
+static int
+_sort_lanes_task(void *data, npy_intp itask, int ithread)
+{
+    sortlike_data *d = data;
+    char *buffer = NULL;
+    npy_intp start, stop, i;
+
+    if (d->buffers != NULL) {
+        buffer = d->buffers + ithread * d->N * PyArray_ITEMSIZE(d->op);
+    }
+    npy_parallel_chunk_bounds(d->nlanes, d->nthreads, itask, 1,
+                              &start, &stop);
+    for (i = start; i < stop; i++) {
+        int ret = _sort_lane(d, d->lanes[i], buffer);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+
 /*
  * These algorithms use special sorting.  They are not called unless the
  * underlying sort function for the type is available.  Note that axis is
@@ -935,23 +1297,24 @@ PyArray_Choose(PyArrayObject *ip, PyObject *op, PyArrayObject *out,
  * data.  Therefore, a copy will be made of the data if needed before handing
  * it to the sorting routine.  An iterator is constructed and adjusted to walk
  * over all but the desired sorting axis.
+ *
+ * Large arrays are sorted using the parallel thread pool, either by sorting
+ * lanes concurrently or, if there are fewer lanes than threads and `split`
+ * is set, by a parallel merge sort of each lane.
  */
 static int
 _new_sortlike(PyArrayObject *op, int axis, PyArray_SortFunc *sort,
-              PyArray_PartitionFunc *part, npy_intp const *kth, npy_intp nkth)
+              PyArray_PartitionFunc *part, npy_intp const *kth, npy_intp nkth,
+              int split)
 {
     npy_intp N = PyArray_DIM(op, axis);
     npy_intp elsize = (npy_intp)PyArray_ITEMSIZE(op);
-    npy_intp astride = PyArray_STRIDE(op, axis);
-    int swap = PyArray_ISBYTESWAPPED(op);
-    int needcopy = !IsAligned(op) || swap || astride != elsize;
-    int hasrefs = PyDataType_REFCHK(PyArray_DESCR(op));
-
-    PyArray_CopySwapNFunc *copyswapn = PyArray_DESCR(op)->f->copyswapn;
+    sortlike_data d;
     char *buffer = NULL;
 
     PyArrayIterObject *it;
     npy_intp size;
+    int nthreads = 1;
 
     int ret = 0;
 
@@ -968,92 +1331,59 @@ _new_sortlike(PyArrayObject *op, int axis, PyArray_SortFunc *sort,
     }
     size = it->size;
 
-    if (needcopy) {
-        buffer = npy_alloc_cache(N * elsize);
+    d.op = op;
+    d.sort = sort;
+    d.part = part;
+    d.kth = kth;
+    d.nkth = nkth;
+    d.N = N;
+    d.astride = PyArray_STRIDE(op, axis);
+    d.swap = PyArray_ISBYTESWAPPED(op);
+    d.needcopy = !IsAligned(op) || d.swap || d.astride != elsize;
+    d.hasrefs = PyDataType_REFCHK(PyArray_DESCR(op));
+    d.lanes = NULL;
+
+    nthreads = _sort_threads(op, N, size, split && part == NULL,
+                             &d.lane_threads);
+    if (nthreads > 1) {
+        d.lanes = _lane_pointers(it);
+        if (d.lanes == NULL) {
+            nthreads = 1;
+            ret = -1;
+            goto fail;
+        }
+        d.nlanes = size;
+        d.nthreads = nthreads;
+    }
+
+    if (d.needcopy) {
+        buffer = npy_alloc_cache(nthreads * N * elsize);
         if (buffer == NULL) {
             ret = -1;
             goto fail;
         }
     }
+    d.buffers = buffer;
 
     NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(op));
 
-    while (size--) {
-        char *bufptr = it->dataptr;
-
-        if (needcopy) {
-            if (hasrefs) {
-                /*
-                 * For dtype's with objects, copyswapn Py_XINCREF's src
-                 * and Py_XDECREF's dst. This would crash if called on
-                 * an uninitialized buffer, or leak a reference to each
-                 * object if initialized.
-                 *
-                 * So, first do the copy with no refcounting...
-                 */
-                _unaligned_strided_byte_copy(buffer, elsize,
-                                             it->dataptr, astride, N, elsize);
-                /* ...then swap in-place if needed */
-                if (swap) {
-                    copyswapn(buffer, elsize, NULL, 0, N, swap, op);
-                }
-            }
-            else {
-                copyswapn(buffer, elsize, it->dataptr, astride, N, swap, op);
-            }
-            bufptr = buffer;
-        }
-        /*
-         * TODO: If the input array is byte-swapped but contiguous and
-         * aligned, it could be swapped (and later unswapped) in-place
-         * rather than after copying to the buffer. Care would have to
-         * be taken to ensure that, if there is an error in the call to
-         * sort or part, the unswapping is still done before returning.
-         */
-
-        if (part == NULL) {
-            ret = sort(bufptr, N, op);
-            if (hasrefs && PyErr_Occurred()) {
-                ret = -1;
-            }
+    if (nthreads > 1) {
+        ret = npy_parallel_run(nthreads, nthreads, &_sort_lanes_task, &d);
+    }
+    else {
+        while (size--) {
+            ret = _sort_lane(&d, it->dataptr, buffer);
             if (ret < 0) {
                 goto fail;
             }
+            PyArray_ITER_NEXT(it);
         }
-        else {
-            npy_intp pivots[NPY_MAX_PIVOT_STACK];
-            npy_intp npiv = 0;
-            npy_intp i;
-            for (i = 0; i < nkth; ++i) {
-                ret = part(bufptr, N, kth[i], pivots, &npiv, op);
-                if (hasrefs && PyErr_Occurred()) {
-                    ret = -1;
-                }
-                if (ret < 0) {
-                    goto fail;
-                }
-            }
-        }
-
-        if (needcopy) {
-            if (hasrefs) {
-                if (swap) {
-                    copyswapn(buffer, elsize, NULL, 0, N, swap, op);
-                }
-                _unaligned_strided_byte_copy(it->dataptr, astride,
-                                             buffer, elsize, N, elsize);
-            }
-            else {
-                copyswapn(it->dataptr, astride, buffer, elsize, N, swap, op);
-            }
-        }
-
-        PyArray_ITER_NEXT(it);
     }
 
 fail:
     NPY_END_THREADS_DESCR(PyArray_DESCR(op));
-    npy_free_cache(buffer, N * elsize);
+    npy_free_cache(buffer, nthreads * N * elsize);
+    PyArray_free(d.lanes);
     if (ret < 0 && !PyErr_Occurred()) {
         /* Out of memory during sorting or buffer creation */
         PyErr_NoMemory();
@@ -1063,28 +1393,174 @@ fail:
     return ret;
 }
 
+
+typedef struct {
+    PyArrayObject *op;
+    PyArray_ArgSortFunc *argsort;
+    PyArray_ArgPartitionFunc *argpart;
+    npy_intp const *kth;
+    npy_intp nkth;
+    npy_intp N;
+    npy_intp astride;
+    npy_intp rstride;
+    int swap;
+    int needcopy;
+    int needidxbuffer;
+    int hasrefs;
+    /* Number of threads sorting each single lane */
+    int lane_threads;
+    /*
+     * Lanes of the values and the result sorted concurrently, with one
+     * buffer of N items per thread
+     */
+    char **lanes;
+    char **rlanes;
+    npy_intp nlanes;
+    int nthreads;
+    char *valbuffers;
+    npy_intp *idxbuffers;
+} argsortlike_data;
+
+
+/*
+ * Argsorts or argpartitions a single lane into `idxdata`, the buffers are
+ * used if copies are needed.
+ */
+static int
+_argsort_lane(argsortlike_data *d, char *valdata, char *idxdata,
+              char *valbuffer, npy_intp *idxbuffer)
+{
+    PyArrayObject *op = d->op;
+    npy_intp N = d->N;
+    npy_intp elsize = (npy_intp)PyArray_ITEMSIZE(op);
+    npy_intp astride = d->astride;
+    int swap = d->swap;
+    PyArray_CopySwapNFunc *copyswapn = PyArray_DESCR(op)->f->copyswapn;
+    char *valptr = valdata;
+    npy_intp *idxptr = (npy_intp *)idxdata;
+    npy_intp *iptr, i;
+    int ret = 0;
+
+    if (d->needcopy) {
+        if (d->hasrefs) {
+            /*
+             * For dtype's with objects, copyswapn Py_XINCREF's src
+             * and Py_XDECREF's dst. This would crash if called on
+             * an uninitialized valbuffer, or leak a reference to
+             * each object item if initialized.
+             *
+             * So, first do the copy with no refcounting...
+             */
+             _unaligned_strided_byte_copy(valbuffer, elsize,
+                                          valdata, astride, N, elsize);
+            /* ...then swap in-place if needed */
+            if (swap) {
+                copyswapn(valbuffer, elsize, NULL, 0, N, swap, op);
+            }
+        }
+        else {
+            copyswapn(valbuffer, elsize, valdata, astride, N, swap, op);
+        }
+        valptr = valbuffer;
+    }
+
+    if (d->needidxbuffer) {
+        idxptr = idxbuffer;
+    }
+
+    iptr = idxptr;
+    for (i = 0; i < N; ++i) {
+        *iptr++ = i;
+    }
+
+    if (d->argpart == NULL) {
+        if (d->lane_threads > 1) {
+            ret = npy_parallel_argsort(valptr, idxptr, N, op, d->argsort,
+                                       d->lane_threads);
+        }
+        else {
+            ret = d->argsort(valptr, idxptr, N, op);
+        }
+        /* Object comparisons may raise an exception in Python 3 */
+        if (d->hasrefs && PyErr_Occurred()) {
+            ret = -1;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    else {
+        npy_intp pivots[NPY_MAX_PIVOT_STACK];
+        npy_intp npiv = 0;
+
+        for (i = 0; i < d->nkth; ++i) {
+            ret = d->argpart(valptr, idxptr, N, d->kth[i], pivots, &npiv, op);
+            /* Object comparisons may raise an exception in Python 3 */
+            if (d->hasrefs && PyErr_Occurred()) {
+                ret = -1;
+            }
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+
+    if (d->needidxbuffer) {
+        char *rptr = idxdata;
+        iptr = idxbuffer;
+
+        for (i = 0; i < N; ++i) {
+            *(npy_intp *)rptr = *iptr++;
+            rptr += d->rstride;
+        }
+    }
+    return 0;
+}
+
+
+static int
+_argsort_lanes_task(void *data, npy_intp itask, int ithread)
+{
+    argsortlike_data *d = data;
+    char *valbuffer = NULL;
+    npy_intp *idxbuffer = NULL;
+    npy_intp start, stop, i;
+
+    if (d->valbuffers != NULL) {
+        valbuffer = d->valbuffers + ithread * d->N * PyArray_ITEMSIZE(d->op);
+    }
+    if (d->idxbuffers != NULL) {
+        idxbuffer = d->idxbuffers + ithread * d->N;
+    }
+    npy_parallel_chunk_bounds(d->nlanes, d->nthreads, itask, 1,
+                              &start, &stop);
+    for (i = start; i < stop; i++) {
+        int ret = _argsort_lane(d, d->lanes[i], d->rlanes[i],
+                                valbuffer, idxbuffer);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+
 static PyObject*
 _new_argsortlike(PyArrayObject *op, int axis, PyArray_ArgSortFunc *argsort,
                  PyArray_ArgPartitionFunc *argpart,
-                 npy_intp const *kth, npy_intp nkth)
+                 npy_intp const *kth, npy_intp nkth, int split)
 {
     npy_intp N = PyArray_DIM(op, axis);
     npy_intp elsize = (npy_intp)PyArray_ITEMSIZE(op);
-    npy_intp astride = PyArray_STRIDE(op, axis);
-    int swap = PyArray_ISBYTESWAPPED(op);
-    int needcopy = !IsAligned(op) || swap || astride != elsize;
-    int hasrefs = PyDataType_REFCHK(PyArray_DESCR(op));
-    int needidxbuffer;
-
-    PyArray_CopySwapNFunc *copyswapn = PyArray_DESCR(op)->f->copyswapn;
+    argsortlike_data d;
     char *valbuffer = NULL;
     npy_intp *idxbuffer = NULL;
 
     PyArrayObject *rop;
-    npy_intp rstride;
 
     PyArrayIterObject *it, *rit;
     npy_intp size;
+    int nthreads = 1;
 
     int ret = 0;
 
@@ -1097,8 +1573,6 @@ _new_argsortlike(PyArrayObject *op, int axis, PyArray_ArgSortFunc *argsort,
     if (rop == NULL) {
         return NULL;
     }
-    rstride = PyArray_STRIDE(rop, axis);
-    needidxbuffer = rstride != sizeof(npy_intp);
 
     /* Check if there is any argsorting to do */
     if (N <= 1 || PyArray_SIZE(op) == 0) {
@@ -1106,6 +1580,21 @@ _new_argsortlike(PyArrayObject *op, int axis, PyArray_ArgSortFunc *argsort,
         return (PyObject *)rop;
     }
 
+    d.op = op;
+    d.argsort = argsort;
+    d.argpart = argpart;
+    d.kth = kth;
+    d.nkth = nkth;
+    d.N = N;
+    d.astride = PyArray_STRIDE(op, axis);
+    d.rstride = PyArray_STRIDE(rop, axis);
+    d.swap = PyArray_ISBYTESWAPPED(op);
+    d.needcopy = !IsAligned(op) || d.swap || d.astride != elsize;
+    d.needidxbuffer = d.rstride != sizeof(npy_intp);
+    d.hasrefs = PyDataType_REFCHK(PyArray_DESCR(op));
+    d.lanes = NULL;
+    d.rlanes = NULL;
+
     it = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)op, &axis);
     rit = (PyArrayIterObject *)PyArray_IterAllButAxis((PyObject *)rop, &axis);
     if (it == NULL || rit == NULL) {
@@ -1114,106 +1603,62 @@ _new_argsortlike(PyArrayObject *op, int axis, PyArray_ArgSortFunc *argsort,
     }
     size = it->size;
 
-    if (needcopy) {
-        valbuffer = npy_alloc_cache(N * elsize);
+    nthreads = _sort_threads(op, N, size, split && argpart == NULL,
+                             &d.lane_threads);
+    if (nthreads > 1) {
+        d.lanes = _lane_pointers(it);
+        d.rlanes = _lane_pointers(rit);
+        if (d.lanes == NULL || d.rlanes == NULL) {
+            nthreads = 1;
+            ret = -1;
+            goto fail;
+        }
+        d.nlanes = size;
+        d.nthreads = nthreads;
+    }
+
+    if (d.needcopy) {
+        valbuffer = npy_alloc_cache(nthreads * N * elsize);
         if (valbuffer == NULL) {
             ret = -1;
             goto fail;
         }
     }
 
-    if (needidxbuffer) {
-        idxbuffer = (npy_intp *)npy_alloc_cache(N * sizeof(npy_intp));
+    if (d.needidxbuffer) {
+        idxbuffer = (npy_intp *)npy_alloc_cache(
+                nthreads * N * sizeof(npy_intp));
         if (idxbuffer == NULL) {
             ret = -1;
             goto fail;
         }
     }
+    d.valbuffers = valbuffer;
+    d.idxbuffers = idxbuffer;
 
     NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(op));
 
-    while (size--) {
-        char *valptr = it->dataptr;
-        npy_intp *idxptr = (npy_intp *)rit->dataptr;
-        npy_intp *iptr, i;
-
-        if (needcopy) {
-            if (hasrefs) {
-                /*
-                 * For dtype's with objects, copyswapn Py_XINCREF's src
-                 * and Py_XDECREF's dst. This would crash if called on
-                 * an uninitialized valbuffer, or leak a reference to
-                 * each object item if initialized.
-                 *
-                 * So, first do the copy with no refcounting...
-                 */
-                 _unaligned_strided_byte_copy(valbuffer, elsize,
-                                              it->dataptr, astride, N, elsize);
-                /* ...then swap in-place if needed */
-                if (swap) {
-                    copyswapn(valbuffer, elsize, NULL, 0, N, swap, op);
-                }
-            }
-            else {
-                copyswapn(valbuffer, elsize,
-                          it->dataptr, astride, N, swap, op);
-            }
-            valptr = valbuffer;
-        }
-
-        if (needidxbuffer) {
-            idxptr = idxbuffer;
-        }
-
-        iptr = idxptr;
-        for (i = 0; i < N; ++i) {
-            *iptr++ = i;
-        }
-
-        if (argpart == NULL) {
-            ret = argsort(valptr, idxptr, N, op);
-            /* Object comparisons may raise an exception in Python 3 */
-            if (hasrefs && PyErr_Occurred()) {
-                ret = -1;
-            }
+    if (nthreads > 1) {
+        ret = npy_parallel_run(nthreads, nthreads, &_argsort_lanes_task, &d);
+    }
+    else {
+        while (size--) {
+            ret = _argsort_lane(&d, it->dataptr, rit->dataptr,
+                                valbuffer, idxbuffer);
             if (ret < 0) {
                 goto fail;
             }
+            PyArray_ITER_NEXT(it);
+            PyArray_ITER_NEXT(rit);
         }
-        else {
-            npy_intp pivots[NPY_MAX_PIVOT_STACK];
-            npy_intp npiv = 0;
-
-            for (i = 0; i < nkth; ++i) {
-                ret = argpart(valptr, idxptr, N, kth[i], pivots, &npiv, op);
-                /* Object comparisons may raise an exception in Python 3 */
-                if (hasrefs && PyErr_Occurred()) {
-                    ret = -1;
-                }
-                if (ret < 0) {
-                    goto fail;
-                }
-            }
-        }
-
-        if (needidxbuffer) {
-            char *rptr = rit->dataptr;
-            iptr = idxbuffer;
-
-            for (i = 0; i < N; ++i) {
-                *(npy_intp *)rptr = *iptr++;
-                rptr += rstride;
-            }
-        }
-
-        PyArray_ITER_NEXT(it);
-        PyArray_ITER_NEXT(rit);
     }
 
 fail:
     NPY_END_THREADS_DESCR(PyArray_DESCR(op));
-    npy_free_cache(valbuffer, N * elsize);
-    npy_free_cache(idxbuffer, N * sizeof(npy_intp));
+    npy_free_cache(valbuffer, nthreads * N * elsize);
+    npy_free_cache(idxbuffer, nthreads * N * sizeof(npy_intp));
+    PyArray_free(d.lanes);
+    PyArray_free(d.rlanes);
     if (ret < 0) {
         if (!PyErr_Occurred()) {
             /* Out of memory during sorting or buffer creation */
@@ -1275,7 +1720,8 @@ PyArray_Sort(PyArrayObject *op, int axis, NPY_SORTKIND which)
         }
     }
 
-    return _new_sortlike(op, axis, sort, NULL, NULL, 0);
+    return _new_sortlike(op, axis, sort, NULL, NULL, 0,
+                         which != NPY_HEAPSORT);
 }
 
 
@@ -1379,7 +1825,7 @@ PyArray_Partition(PyArrayObject *op, PyArrayObject * ktharray, int axis,
     }
 
     ret = _new_sortlike(op, axis, sort, part,
-                        PyArray_DATA(kthrvl), PyArray_SIZE(kthrvl));
+                        PyArray_DATA(kthrvl), PyArray_SIZE(kthrvl), 0);
 
     Py_DECREF(kthrvl);
 
@@ -1426,7 +1872,8 @@ PyArray_ArgSort(PyArrayObject *op, int axis, NPY_SORTKIND which)
         return NULL;
     }
 
-    ret = _new_argsortlike(op2, axis, argsort, NULL, NULL, 0);
+    ret = _new_argsortlike(op2, axis, argsort, NULL, NULL, 0,
+                           which != NPY_HEAPSORT);
 
     Py_DECREF(op2);
     return ret;
@@ -1481,7 +1928,7 @@ PyArray_ArgPartition(PyArrayObject *op, PyArrayObject *ktharray, int axis,
     }
 
     ret = _new_argsortlike(op2, axis, argsort, argpart,
-                           PyArray_DATA(kthrvl), PyArray_SIZE(kthrvl));
+                           PyArray_DATA(kthrvl), PyArray_SIZE(kthrvl), 0);
 
     Py_DECREF(kthrvl);
     Py_DECREF(op2);
@@ -2369,6 +2816,188 @@ count_boolean_trues(int ndim, char *data, npy_intp const *ashape, npy_intp const
     return count_nonzero_int(ndim, data, ashape, astrides, 1);
 }
 
+
+/*
+ * Boolean mask compaction and expansion.  The mask is split into chunks
+ * which are counted first, so that the chunks know where their output (or
+ * input) starts and can be compacted (or expanded) in parallel.
+ */
+
+NPY_NO_EXPORT int
+npy_mask_supported(npy_intp itemsize)
+{
+    return itemsize == 1 || itemsize == 2 || itemsize == 4 || itemsize == 8;
+}
+
+
+static int
+_mask_count_task(void *data, npy_intp ichunk, int NPY_UNUSED(ithread))
+{
+    npy_mask_chunks *chunks = data;
+    npy_intp start, stop;
+
+    npy_parallel_chunk_bounds(chunks->n, chunks->nchunks, ichunk, 64,
+                              &start, &stop);
+    chunks->offsets[ichunk + 1] = count_nonzero_u8(
+            (const char *)chunks->mask + start, 1, stop - start);
+    return 0;
+}
+
+
+NPY_NO_EXPORT npy_intp
+npy_mask_count(npy_mask_chunks *chunks, const npy_bool *mask, npy_intp n)
+{
+    npy_intp i;
+
+    chunks->mask = mask;
+    chunks->n = n;
+    chunks->nthreads = npy_parallel_threads_for_size(n);
+    chunks->nchunks = chunks->nthreads < NPY_MASK_MAX_CHUNKS ?
+                      chunks->nthreads : NPY_MASK_MAX_CHUNKS;
+    npy_parallel_run(chunks->nchunks, chunks->nthreads,
+                     &_mask_count_task, chunks);
+    chunks->offsets[0] = 0;
+    for (i = 0; i < chunks->nchunks; i++) {
+        chunks->offsets[i + 1] += chunks->offsets[i];
+    }
+    return chunks->offsets[chunks->nchunks];
+}
+
+
+typedef struct {
+    const npy_mask_chunks *chunks;
+    char *dst;
+    const char *src;
+    npy_intp src_stride;
+    npy_intp itemsize;
+    enum {MASK_COMPRESS, MASK_EXPAND, MASK_NONZERO} kind;
+} _mask_task_data;
+
+
+#ifndef NPY_DISABLE_OPTIMIZATION
+    #include "compress.dispatch.h"
+#endif
+
+static int
+_mask_task(void *data, npy_intp ichunk, int NPY_UNUSED(ithread))
+{
+    _mask_task_data *d = data;
+    const npy_mask_chunks *chunks = d->chunks;
+    const npy_bool *mask;
+    npy_intp start, stop, offset, count, itemsize = d->itemsize;
+
+    npy_parallel_chunk_bounds(chunks->n, chunks->nchunks, ichunk, 64,
+                              &start, &stop);
+    mask = chunks->mask + start;
+    stop -= start;
+    offset = chunks->offsets[ichunk];
+    count = chunks->offsets[ichunk + 1] - offset;
+
+    if (d->kind == MASK_NONZERO) {
+#if NPY_SIZEOF_INTP == 8
+        NPY_CPU_DISPATCH_CALL(npy_nonzero_u64,
+                (d->dst + offset * itemsize, count, start, mask, stop));
+#else
+        NPY_CPU_DISPATCH_CALL(npy_nonzero_u32,
+                (d->dst + offset * itemsize, count, start, mask, stop));
+#endif
+        return 0;
+    }
+    if (d->kind == MASK_COMPRESS) {
+        char *dst = d->dst + offset * itemsize;
+        const char *src = d->src + start * itemsize;
+        switch (itemsize) {
+            case 1:
+                NPY_CPU_DISPATCH_CALL(npy_compress_u8,
+                                      (dst, count, src, mask, stop));
+                break;
+            case 2:
+                NPY_CPU_DISPATCH_CALL(npy_compress_u16,
+                                      (dst, count, src, mask, stop));
+                break;
+            case 4:
+                NPY_CPU_DISPATCH_CALL(npy_compress_u32,
+                                      (dst, count, src, mask, stop));
+                break;
+            case 8:
+                NPY_CPU_DISPATCH_CALL(npy_compress_u64,
+                                      (dst, count, src, mask, stop));
+                break;
+        }
+        return 0;
+    }
+
+    char *dst = d->dst + start * itemsize;
+    if (d->src_stride == 0) {
+        switch (itemsize) {
+            case 1:
+                NPY_CPU_DISPATCH_CALL(npy_masked_fill_u8,
+                                      (dst, mask, stop, d->src));
+                break;
+            case 2:
+                NPY_CPU_DISPATCH_CALL(npy_masked_fill_u16,
+                                      (dst, mask, stop, d->src));
+                break;
+            case 4:
+                NPY_CPU_DISPATCH_CALL(npy_masked_fill_u32,
+                                      (dst, mask, stop, d->src));
+                break;
+            case 8:
+                NPY_CPU_DISPATCH_CALL(npy_masked_fill_u64,
+                                      (dst, mask, stop, d->src));
+                break;
+        }
+        return 0;
+    }
+    const char *src = d->src + offset * itemsize;
+    switch (itemsize) {
+        case 1:
+            NPY_CPU_DISPATCH_CALL(npy_expand_u8,
+                                  (dst, mask, stop, src, count));
+            break;
+        case 2:
+            NPY_CPU_DISPATCH_CALL(npy_expand_u16,
+                                  (dst, mask, stop, src, count));
+            break;
+        case 4:
+            NPY_CPU_DISPATCH_CALL(npy_expand_u32,
+                                  (dst, mask, stop, src, count));
+            break;
+        case 8:
+            NPY_CPU_DISPATCH_CALL(npy_expand_u64,
+                                  (dst, mask, stop, src, count));
+            break;
+    }
+    return 0;
+}
+
+
+NPY_NO_EXPORT void
+npy_mask_compress(const npy_mask_chunks *chunks, char *dst,
+                  const char *src, npy_intp itemsize)
+{
+    _mask_task_data d = {chunks, dst, src, itemsize, itemsize, MASK_COMPRESS};
+    npy_parallel_run(chunks->nchunks, chunks->nthreads, &_mask_task, &d);
+}
+
+
+NPY_NO_EXPORT void
+npy_mask_expand(const npy_mask_chunks *chunks, char *dst,
+                const char *src, npy_intp src_stride, npy_intp itemsize)
+{
+    _mask_task_data d = {chunks, dst, src, src_stride, itemsize, MASK_EXPAND};
+    npy_parallel_run(chunks->nchunks, chunks->nthreads, &_mask_task, &d);
+}
+
+
+NPY_NO_EXPORT void
+npy_mask_nonzero(const npy_mask_chunks *chunks, npy_intp *dst)
+{
+    _mask_task_data d = {chunks, (char *)dst, NULL, 0, sizeof(npy_intp),
+                         MASK_NONZERO};
+    npy_parallel_run(chunks->nchunks, chunks->nthreads, &_mask_task, &d);
+}
+
 /*NUMPY_API
  * Counts the number of non-zero elements in the array.
  *
@@ -2563,6 +3192,33 @@ PyArray_Nonzero(PyArrayObject *self)
         return ret_tuple;
     }
 
+    is_bool = PyArray_ISBOOL(self);
+
+    /* Contiguous one dimensional boolean arrays use the mask kernels */
+    if (ndim == 1 && is_bool && PyArray_STRIDE(self, 0) == 1) {
+        npy_mask_chunks chunks;
+        NPY_BEGIN_THREADS_DEF;
+
+        NPY_BEGIN_THREADS_THRESHOLDED(PyArray_DIM(self, 0));
+        nonzero_count = npy_mask_count(&chunks, PyArray_DATA(self),
+                                       PyArray_DIM(self, 0));
+        NPY_END_THREADS;
+
+        ret_dims[0] = nonzero_count;
+        ret_dims[1] = 1;
+        ret = (PyArrayObject *)PyArray_NewFromDescr(
+                &PyArray_Type, PyArray_DescrFromType(NPY_INTP),
+                2, ret_dims, NULL, NULL,
+                0, NULL);
+        if (ret == NULL) {
+            return NULL;
+        }
+        NPY_BEGIN_THREADS_THRESHOLDED(PyArray_DIM(self, 0));
+        npy_mask_nonzero(&chunks, (npy_intp *)PyArray_DATA(ret));
+        NPY_END_THREADS;
+        goto finish;
+    }
+
     /*
      * First count the number of non-zeros in 'self'.
      */
@@ -2571,8 +3227,6 @@ PyArray_Nonzero(PyArrayObject *self)
         return NULL;
     }
 
-    is_bool = PyArray_ISBOOL(self);
-
     /* Allocate the result as a 2D array */
     ret_dims[0] = nonzero_count;
     ret_dims[1] = ndim;
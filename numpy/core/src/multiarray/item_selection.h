@@ -10,6 +10,51 @@
 NPY_NO_EXPORT npy_intp
 count_boolean_trues(int ndim, char *data, npy_intp const *ashape, npy_intp const *astrides);
 
+/* Upper limit for the number of chunks of a boolean mask */
+#define NPY_MASK_MAX_CHUNKS 64
+
+/*
+ * A contiguous boolean mask split into chunks for parallel compaction,
+ * `offsets[i]` is the number of true values before chunk `i` and
+ * `offsets[nchunks]` the total.  Filled in by `npy_mask_count`.
+ */
+typedef struct {
+    const npy_bool *mask;
+    npy_intp n;
+    npy_intp nchunks;
+    int nthreads;
+    npy_intp offsets[NPY_MASK_MAX_CHUNKS + 1];
+} npy_mask_chunks;
+
+/* Whether the `npy_mask_*` functions handle items of `itemsize` bytes */
+NPY_NO_EXPORT int
+npy_mask_supported(npy_intp itemsize);
+
+/*
+ * Splits the `n` values of `mask` into chunks and counts their true values,
+ * returns the total.  The following functions (which all work on
+ * contiguous and aligned data) use the result, none of them needs the GIL:
+ *
+ * `npy_mask_compress` copies the items of `src` where the mask is true to
+ * `dst` (`arr[mask]`).  `npy_mask_expand` copies consecutive items of
+ * `src` to the items of `dst` where the mask is true, or only `src[0]` if
+ * `src_stride` is 0 (`arr[mask] = values`).  `npy_mask_nonzero` writes the
+ * indices of the true values to `dst`.
+ */
+NPY_NO_EXPORT npy_intp
+npy_mask_count(npy_mask_chunks *chunks, const npy_bool *mask, npy_intp n);
+
+NPY_NO_EXPORT void
+npy_mask_compress(const npy_mask_chunks *chunks, char *dst,
+                  const char *src, npy_intp itemsize);
+
+NPY_NO_EXPORT void
+npy_mask_expand(const npy_mask_chunks *chunks, char *dst,
+                const char *src, npy_intp src_stride, npy_intp itemsize);
+
+NPY_NO_EXPORT void
+npy_mask_nonzero(const npy_mask_chunks *chunks, npy_intp *dst);
+
 /*
  * Gets a single item from the array, based on a single multi-index
  * array of values, which must be of length PyArray_NDIM(self).
@@ -27,4 +72,39 @@ NPY_NO_EXPORT int
 PyArray_MultiIndexSetItem(PyArrayObject *self, const npy_intp *multi_index,
                                                 PyObject *obj);
 
+/*
+ * Whether `npy_gather` and `npy_scatter` handle items of `itemsize` bytes
+ * indexed by integers of `ind_size` bytes (int32 and intp).
+ */
+NPY_NO_EXPORT int
+npy_gather_supported(npy_intp itemsize, npy_intp ind_size);
+
+/*
+ * Checks that all `n` indices of a contiguous index array are valid for an
+ * axis of length `len`.  Negative indices are only valid if `wrap_negative`
+ * is set.  Does not need the GIL.
+ */
+NPY_NO_EXPORT int
+npy_index_in_bounds(const char *ind, npy_intp ind_size, npy_intp n,
+                    npy_intp len, int wrap_negative);
+
+/*
+ * Copies `src[ind[i]]` to `dst[i]` for `n` indices which have been checked
+ * with `npy_index_in_bounds`.  Does not need the GIL.
+ */
+NPY_NO_EXPORT void
+npy_gather(char *dst, npy_intp dst_stride,
+           const char *src, npy_intp src_stride, npy_intp src_len,
+           const char *ind, npy_intp ind_size, npy_intp n, npy_intp itemsize);
+
+/*
+ * Copies `src[i]` to `dst[ind[i]]` for `n` indices which have been checked
+ * with `npy_index_in_bounds`, the last of repeated indices wins.
+ * Does not need the GIL.
+ */
+NPY_NO_EXPORT void
+npy_scatter(char *dst, npy_intp dst_stride, npy_intp dst_len,
+            const char *src, npy_intp src_stride,
+            const char *ind, npy_intp ind_size, npy_intp n, npy_intp itemsize);
+
 #endif
@@ -1006,6 +1006,26 @@ get_view_from_index(PyArrayObject *self, PyArrayObject **view,
 }
 
 
+/*
+ * Whether boolean indexing of `self` with `bmask` can use the mask
+ * compaction kernels, which need both to be contiguous in iteration order
+ * and items which can be copied as unsigned integers.
+ */
+static int
+mask_kernels_usable(PyArrayObject *self, PyArrayObject *bmask,
+                    NPY_ORDER order)
+{
+    return PyArray_IS_C_CONTIGUOUS(self) && PyArray_IS_C_CONTIGUOUS(bmask) &&
+           (order != NPY_FORTRANORDER || PyArray_NDIM(self) <= 1) &&
+           PyArray_NDIM(self) == PyArray_NDIM(bmask) &&
+           PyArray_SIZE(self) == PyArray_SIZE(bmask) &&
+           PyArray_TYPE(bmask) == NPY_BOOL &&
+           npy_mask_supported(PyArray_ITEMSIZE(self)) &&
+           IsUintAligned(self) &&
+           !PyDataType_REFCHK(PyArray_DESCR(self));
+}
+
+
 /*
  * Implements boolean indexing. This produces a one-dimensional
  * array which picks out all of the elements of 'self' for which
@@ -1025,9 +1045,20 @@ array_boolean_subscript(PyArrayObject *self,
     PyArray_Descr *dtype;
     PyArrayObject *ret;
     int needs_api = 0;
+    npy_mask_chunks chunks;
+    int use_mask_kernels = mask_kernels_usable(self, bmask, order);
 
-    size = count_boolean_trues(PyArray_NDIM(bmask), PyArray_DATA(bmask),
-                                PyArray_DIMS(bmask), PyArray_STRIDES(bmask));
+    if (use_mask_kernels) {
+        NPY_BEGIN_THREADS_DEF;
+        NPY_BEGIN_THREADS_THRESHOLDED(PyArray_SIZE(bmask));
+        size = npy_mask_count(&chunks, PyArray_DATA(bmask),
+                              PyArray_SIZE(bmask));
+        NPY_END_THREADS;
+    }
+    else {
+        size = count_boolean_trues(PyArray_NDIM(bmask), PyArray_DATA(bmask),
+                                   PyArray_DIMS(bmask), PyArray_STRIDES(bmask));
+    }
 
     /* Allocate the output of the boolean indexing */
     dtype = PyArray_DESCR(self);
@@ -1041,8 +1072,14 @@ array_boolean_subscript(PyArrayObject *self,
     itemsize = dtype->elsize;
     ret_data = PyArray_DATA(ret);
 
+    if (size > 0 && use_mask_kernels) {
+        NPY_BEGIN_THREADS_DEF;
+        NPY_BEGIN_THREADS_THRESHOLDED(PyArray_SIZE(bmask));
+        npy_mask_compress(&chunks, ret_data, PyArray_DATA(self), itemsize);
+        NPY_END_THREADS;
+    }
     /* Create an iterator for the data */
-    if (size > 0) {
+    else if (size > 0) {
         NpyIter *iter;
         PyArrayObject *op[2] = {self, bmask};
         npy_uint32 flags, op_flags[2];
@@ -1180,6 +1217,8 @@ array_assign_boolean_subscript(PyArrayObject *self,
     char *v_data;
     int needs_api = 0;
     npy_intp bmask_size;
+    npy_mask_chunks chunks;
+    int use_mask_kernels;
 
     if (PyArray_DESCR(bmask)->type_num != NPY_BOOL) {
         PyErr_SetString(PyExc_TypeError,
@@ -1204,8 +1243,23 @@ array_assign_boolean_subscript(PyArrayObject *self,
         return -1;
     }
 
-    size = count_boolean_trues(PyArray_NDIM(bmask), PyArray_DATA(bmask),
-                                PyArray_DIMS(bmask), PyArray_STRIDES(bmask));
+    use_mask_kernels = (
+            mask_kernels_usable(self, bmask, order) &&
+            PyArray_EquivTypes(PyArray_DESCR(self), PyArray_DESCR(v)) &&
+            (PyArray_NDIM(v) == 0 || PyArray_DIMS(v)[0] == 1 ||
+             PyArray_STRIDES(v)[0] == PyArray_ITEMSIZE(v)) &&
+            IsUintAligned(v) && !arrays_overlap(self, v));
+    if (use_mask_kernels) {
+        NPY_BEGIN_THREADS_DEF;
+        NPY_BEGIN_THREADS_THRESHOLDED(PyArray_SIZE(bmask));
+        size = npy_mask_count(&chunks, PyArray_DATA(bmask),
+                              PyArray_SIZE(bmask));
+        NPY_END_THREADS;
+    }
+    else {
+        size = count_boolean_trues(PyArray_NDIM(bmask), PyArray_DATA(bmask),
+                                   PyArray_DIMS(bmask), PyArray_STRIDES(bmask));
+    }
     /* Correction factor for broadcasting 'bmask' to 'self' */
     bmask_size = PyArray_SIZE(bmask);
     if (bmask_size > 0) {
@@ -1230,9 +1284,16 @@ array_assign_boolean_subscript(PyArrayObject *self,
 
     v_data = PyArray_DATA(v);
 
-    /* Create an iterator for the data */
     int res = 0;
-    if (size > 0) {
+    if (size > 0 && use_mask_kernels) {
+        NPY_BEGIN_THREADS_DEF;
+        NPY_BEGIN_THREADS_THRESHOLDED(PyArray_SIZE(bmask));
+        npy_mask_expand(&chunks, PyArray_DATA(self), v_data, v_stride,
+                        PyArray_ITEMSIZE(self));
+        NPY_END_THREADS;
+    }
+    /* Create an iterator for the data */
+    else if (size > 0) {
         NpyIter *iter;
         PyArrayObject *op[2] = {self, bmask};
         npy_uint32 flags, op_flags[2];
@@ -66,8 +66,14 @@ NPY_NO_EXPORT int NPY_NUMUSERTYPES = 0;
 #include "vdot.h"
 #include "templ_common.h" /* for npy_mul_with_overflow_intp */
 #include "compiled_base.h"
+#include "unique.h"
+#include "histogram.h"
 #include "mem_overlap.h"
+#include "npy_parallel.h"
+#include "gemm.h"
 #include "typeinfo.h"
+#include "textreading/readtext.h"
+#include "savetxt.h"
 
 #include "get_attr_string.h"
 
@@ -1056,6 +1062,29 @@ PyArray_MatrixProduct2(PyObject *op1, PyObject *op2, PyArrayObject* out)
         memset(PyArray_DATA(out_buf), 0, PyArray_NBYTES(out_buf));
     }
 
+    /*
+     * Matrix products use the blocked gemm kernels, npy_gemm rejects
+     * matrix-vector and other thin products
+     */
+    if (PyArray_NDIM(ap1) <= 2 && PyArray_NDIM(ap2) <= 2) {
+        int nd1 = PyArray_NDIM(ap1), nd2 = PyArray_NDIM(ap2);
+        int res;
+
+        NPY_BEGIN_THREADS_DESCR(PyArray_DESCR(ap2));
+        res = npy_gemm(typenum,
+                PyArray_BYTES(ap1), nd1 == 2 ? PyArray_STRIDES(ap1)[0] : 0, is1,
+                PyArray_BYTES(ap2), is2, nd2 == 2 ? PyArray_STRIDES(ap2)[1] : 0,
+                PyArray_BYTES(out_buf),
+                nd1 == 2 ? PyArray_STRIDES(out_buf)[0] : 0,
+                nd2 == 2 ? PyArray_STRIDES(out_buf)[nd - 1] : 0,
+                nd1 == 2 ? PyArray_DIMS(ap1)[0] : 1, l,
+                nd2 == 2 ? PyArray_DIMS(ap2)[1] : 1);
+        NPY_END_THREADS_DESCR(PyArray_DESCR(ap2));
+        if (res == 0) {
+            goto finish;
+        }
+    }
+
     dot = PyArray_DESCR(out_buf)->f->dotfunc;
     if (dot == NULL) {
         PyErr_SetString(PyExc_ValueError,
@@ -1094,6 +1123,8 @@ PyArray_MatrixProduct2(PyObject *op1, PyObject *op2, PyArrayObject* out)
         /* only for OBJECT arrays */
         goto fail;
     }
+
+finish:
     Py_DECREF(ap1);
     Py_DECREF(ap2);
 
@@ -4335,6 +4366,12 @@ static struct PyMethodDef array_module_methods[] = {
     {"fromfile",
         (PyCFunction)array_fromfile,
         METH_VARARGS | METH_KEYWORDS, NULL},
+    {"_load_from_filelike",
+        (PyCFunction)_load_from_filelike,
+        METH_FASTCALL | METH_KEYWORDS, NULL},
+    {"_format_float_rows",
+        (PyCFunction)_format_float_rows,
+        METH_FASTCALL | METH_KEYWORDS, NULL},
     {"can_cast",
         (PyCFunction)array_can_cast_safely,
         METH_VARARGS | METH_KEYWORDS, NULL},
@@ -4393,6 +4430,12 @@ static struct PyMethodDef array_module_methods[] = {
         METH_VARARGS | METH_KEYWORDS, NULL},
     {"_monotonicity", (PyCFunction)arr__monotonicity,
         METH_VARARGS | METH_KEYWORDS, NULL},
+    {"_unique_hash", (PyCFunction)arr_unique_hash,
+        METH_VARARGS | METH_KEYWORDS, NULL},
+    {"_isin_hash", (PyCFunction)arr_isin_hash,
+        METH_VARARGS | METH_KEYWORDS, NULL},
+    {"_histogram", (PyCFunction)arr_histogram,
+        METH_VARARGS | METH_KEYWORDS, NULL},
     {"implement_array_function",
         (PyCFunction)array_implement_array_function,
         METH_VARARGS, NULL},
@@ -4434,6 +4477,26 @@ static struct PyMethodDef array_module_methods[] = {
         get_sfloat_dtype, METH_NOARGS, NULL},
     {"_set_madvise_hugepage", (PyCFunction)_set_madvise_hugepage,
         METH_O, NULL},
+    {"_set_default_allocator", (PyCFunction)_set_default_allocator,
+        METH_O, NULL},
+    {"_get_allocator_handler", (PyCFunction)_get_allocator_handler,
+        METH_O, NULL},
+    {"_set_mem_pool", (PyCFunction)_set_mem_pool,
+        METH_VARARGS, NULL},
+    {"_get_mem_pool", (PyCFunction)_get_mem_pool,
+        METH_NOARGS, NULL},
+    {"_get_mem_pool_stats", (PyCFunction)_get_mem_pool_stats,
+        METH_NOARGS, NULL},
+    {"get_handler_name",
+        (PyCFunction) get_handler_name,
+        METH_VARARGS, NULL},
+    {"get_handler_version",
+        (PyCFunction) get_handler_version,
+        METH_VARARGS, NULL},
+    {"_set_parallel_state", (PyCFunction)_set_parallel_state,
+        METH_VARARGS, NULL},
+    {"_get_parallel_state", (PyCFunction)_get_parallel_state,
+        METH_NOARGS, NULL},
     {"_reload_guard", (PyCFunction)_reload_guard,
         METH_NOARGS,
         "Give a warning on reload and big warning in sub-interpreters."},
@@ -4771,6 +4834,13 @@ PyMODINIT_FUNC PyInit__multiarray_umath(void) {
     }
     PyDict_SetItemString(d, "_UFUNC_API", c_api);
     Py_DECREF(c_api);
+
+    c_api = npy_parallel_api_capsule();
+    if (c_api == NULL) {
+        goto err;
+    }
+    PyDict_SetItemString(d, "_parallel_api", c_api);
+    Py_DECREF(c_api);
     if (PyErr_Occurred()) {
         goto err;
     }
@@ -4902,6 +4972,11 @@ PyMODINIT_FUNC PyInit__multiarray_umath(void) {
         goto err;
     }
 
+    /* The built-in memory handlers and the context variable of the current */
+    if (npy_init_mem_handlers(d) < 0) {
+        goto err;
+    }
+
     if (initumath(m) != 0) {
         goto err;
     }
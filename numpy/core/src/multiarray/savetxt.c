@@ -0,0 +1,356 @@
+/*
+ * The C formatter used by `np.savetxt` for float32 and float64 arrays when
+ * all columns use the same simple format, exposed as
+ * `np.core._multiarray_umath._format_float_rows`.  The Python function opens
+ * the file, writes header and footer and passes the rows in chunks; this
+ * module turns a chunk of rows into a single string without creating a
+ * Python object for each element.
+ *
+ * The output is identical to `(delimiter.join([fmt] * ncols) % tuple(row)
+ * + newline)` for each row.  Supported formats are `%s` (the `str` of the
+ * scalar, i.e. the shortest repr found by Dragon4/Ryu) and the printf-style
+ * float formats `%[flags][width][.precision](e|E|f|F|g|G)`, which are
+ * formatted by `PyOS_double_to_string` exactly like the `%` operator does.
+ */
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#define _MULTIARRAYMODULE
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/arrayobject.h"
+#include "npy_argparse.h"
+#include "scalartypes.h"
+
+#include "savetxt.h"
+
+
+/* Flags of a printf-style format, named like in CPython */
+#define F_LJUST 0x01
+#define F_SIGN  0x02
+#define F_BLANK 0x04
+#define F_ALT   0x08
+#define F_ZERO  0x10
+
+typedef struct {
+    int flags;
+    Py_ssize_t width;      /* -1 if not given */
+    int precision;         /* -1 if not given */
+    char type;             /* one of "eEfFgGs" */
+} float_format;
+
+/* Size of the buffer for `%s` formatted floats */
+#define STR_BUFLEN 64
+
+
+static int
+parse_float_format(const char *fmt, float_format *format)
+{
+    const char *p = fmt;
+
+    format->flags = 0;
+    format->width = -1;
+    format->precision = -1;
+
+    if (*p++ != '%') {
+        goto fail;
+    }
+    for (;; p++) {
+        if (*p == '-') {
+            format->flags |= F_LJUST;
+        }
+        else if (*p == '+') {
+            format->flags |= F_SIGN;
+        }
+        else if (*p == ' ') {
+            format->flags |= F_BLANK;
+        }
+        else if (*p == '#') {
+            format->flags |= F_ALT;
+        }
+        else if (*p == '0') {
+            format->flags |= F_ZERO;
+        }
+        else {
+            break;
+        }
+    }
+    if (*p >= '0' && *p <= '9') {
+        format->width = 0;
+        for (; *p >= '0' && *p <= '9'; p++) {
+            if (format->width > 100000) {
+                goto fail;
+            }
+            format->width = format->width * 10 + (*p - '0');
+        }
+    }
+    if (*p == '.') {
+        p++;
+        if (!(*p >= '0' && *p <= '9')) {
+            goto fail;
+        }
+        format->precision = 0;
+        for (; *p >= '0' && *p <= '9'; p++) {
+            if (format->precision > 100000) {
+                goto fail;
+            }
+            format->precision = format->precision * 10 + (*p - '0');
+        }
+    }
+    if (*p == '\0' || strchr("eEfFgGs", *p) == NULL || p[1] != '\0') {
+        goto fail;
+    }
+    format->type = *p;
+    if (format->type == 's' && (format->flags != 0 ||
+            format->width != -1 || format->precision != -1)) {
+        goto fail;
+    }
+    return 0;
+
+  fail:
+    PyErr_Format(PyExc_ValueError,
+            "unsupported format for _format_float_rows: '%s'", fmt);
+    return -1;
+}
+
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t allocated;
+} output_buffer;
+
+
+/* Make room for `n` more characters */
+static int
+output_reserve(output_buffer *out, size_t n)
+{
+    if (out->len + n > out->allocated) {
+        size_t new_size = out->allocated * 2;
+        char *new_data;
+
+        if (new_size < out->len + n) {
+            new_size = out->len + n;
+        }
+        new_data = PyMem_Realloc(out->data, new_size);
+        if (new_data == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        out->data = new_data;
+        out->allocated = new_size;
+    }
+    return 0;
+}
+
+
+static int
+output_append(output_buffer *out, const char *str, size_t n)
+{
+    if (output_reserve(out, n) < 0) {
+        return -1;
+    }
+    memcpy(out->data + out->len, str, n);
+    out->len += n;
+    return 0;
+}
+
+
+static int
+output_fill(output_buffer *out, char c, size_t n)
+{
+    if (output_reserve(out, n) < 0) {
+        return -1;
+    }
+    memset(out->data + out->len, c, n);
+    out->len += n;
+    return 0;
+}
+
+
+/*
+ * Formats a single value with a printf-style format, mirroring the handling
+ * of sign, width and fill character of `str.__mod__`.
+ */
+static int
+append_printf_float(output_buffer *out, double value,
+                    const float_format *format)
+{
+    char sign = '\0';
+    char *str, *digits;
+    size_t len, pad = 0;
+    int res = -1;
+
+    str = PyOS_double_to_string(value, format->type,
+            format->precision < 0 ? 6 : format->precision,
+            format->flags & F_ALT ? Py_DTSF_ALT : 0, NULL);
+    if (str == NULL) {
+        return -1;
+    }
+    digits = str;
+    len = strlen(str);
+    if (*digits == '-') {
+        sign = '-';
+        digits++;
+        len--;
+    }
+    else if (format->flags & F_SIGN) {
+        sign = '+';
+    }
+    else if (format->flags & F_BLANK) {
+        sign = ' ';
+    }
+    if (format->width > 0 && (size_t)format->width > len + (sign != '\0')) {
+        pad = format->width - len - (sign != '\0');
+    }
+
+    if (pad > 0 && !(format->flags & (F_LJUST | F_ZERO))) {
+        if (output_fill(out, ' ', pad) < 0) {
+            goto finish;
+        }
+    }
+    if (sign != '\0' && output_append(out, &sign, 1) < 0) {
+        goto finish;
+    }
+    if (pad > 0 && !(format->flags & F_LJUST) && (format->flags & F_ZERO)) {
+        if (output_fill(out, '0', pad) < 0) {
+            goto finish;
+        }
+    }
+    if (output_append(out, digits, len) < 0) {
+        goto finish;
+    }
+    if (pad > 0 && (format->flags & F_LJUST)) {
+        if (output_fill(out, ' ', pad) < 0) {
+            goto finish;
+        }
+    }
+    res = 0;
+
+  finish:
+    PyMem_Free(str);
+    return res;
+}
+
+
+static int
+append_float(output_buffer *out, const char *item, int type_num,
+             const float_format *format)
+{
+    double value;
+
+    if (type_num == NPY_DOUBLE) {
+        npy_double v;
+        memcpy(&v, item, sizeof(v));
+        value = v;
+    }
+    else {
+        npy_float v;
+        memcpy(&v, item, sizeof(v));
+        value = v;
+    }
+
+    if (format->type == 's') {
+        char buffer[STR_BUFLEN];
+        npy_intp len;
+
+        if (type_num == NPY_DOUBLE) {
+            len = doubletype_str_buffer((npy_double)value,
+                                        buffer, sizeof(buffer));
+        }
+        else {
+            len = floattype_str_buffer((npy_float)value,
+                                       buffer, sizeof(buffer));
+        }
+        if (len < 0) {
+            return -1;
+        }
+        return output_append(out, buffer, len);
+    }
+    return append_printf_float(out, value, format);
+}
+
+
+NPY_NO_EXPORT PyObject *
+_format_float_rows(PyObject *NPY_UNUSED(mod),
+        PyObject *const *args, Py_ssize_t len_args, PyObject *kwnames)
+{
+    PyObject *arr_obj, *fmt_obj, *delimiter_obj, *newline_obj;
+    PyArrayObject *arr;
+    const char *fmt, *delimiter, *newline;
+    Py_ssize_t delimiter_len, newline_len;
+    float_format format;
+    output_buffer out = {NULL, 0, 0};
+    npy_intp nrows, ncols, i, j;
+    int type_num;
+    PyObject *result = NULL;
+    NPY_PREPARE_ARGPARSER;
+
+    if (npy_parse_arguments("_format_float_rows", args, len_args, kwnames,
+            "arr", NULL, &arr_obj,
+            "fmt", NULL, &fmt_obj,
+            "delimiter", NULL, &delimiter_obj,
+            "newline", NULL, &newline_obj,
+            NULL, NULL, NULL) < 0) {
+        return NULL;
+    }
+    if (!PyArray_Check(arr_obj) || PyArray_NDIM((PyArrayObject *)arr_obj) != 2
+            || !PyArray_ISNBO(PyArray_DESCR((PyArrayObject *)arr_obj)->byteorder)
+            || (PyArray_TYPE((PyArrayObject *)arr_obj) != NPY_FLOAT &&
+                PyArray_TYPE((PyArrayObject *)arr_obj) != NPY_DOUBLE)) {
+        PyErr_SetString(PyExc_TypeError,
+                "_format_float_rows() requires a 2-D float32 or float64 "
+                "array in native byte order");
+        return NULL;
+    }
+    arr = (PyArrayObject *)arr_obj;
+    if (!PyUnicode_Check(fmt_obj) || !PyUnicode_Check(delimiter_obj) ||
+            !PyUnicode_Check(newline_obj)) {
+        PyErr_SetString(PyExc_TypeError,
+                "fmt, delimiter and newline must be strings");
+        return NULL;
+    }
+    fmt = PyUnicode_AsUTF8(fmt_obj);
+    if (fmt == NULL || parse_float_format(fmt, &format) < 0) {
+        return NULL;
+    }
+    delimiter = PyUnicode_AsUTF8AndSize(delimiter_obj, &delimiter_len);
+    if (delimiter == NULL) {
+        return NULL;
+    }
+    newline = PyUnicode_AsUTF8AndSize(newline_obj, &newline_len);
+    if (newline == NULL) {
+        return NULL;
+    }
+
+    type_num = PyArray_TYPE(arr);
+    nrows = PyArray_DIM(arr, 0);
+    ncols = PyArray_DIM(arr, 1);
+    /* A guess which is usually right for the default "%.18e" */
+    if (output_reserve(&out,
+            nrows * (ncols * (25 + delimiter_len) + newline_len)) < 0) {
+        return NULL;
+    }
+
+    for (i = 0; i < nrows; i++) {
+        const char *row = PyArray_BYTES(arr) + i * PyArray_STRIDE(arr, 0);
+
+        for (j = 0; j < ncols; j++) {
+            if (j > 0 && output_append(&out, delimiter, delimiter_len) < 0) {
+                goto finish;
+            }
+            if (append_float(&out, row + j * PyArray_STRIDE(arr, 1),
+                             type_num, &format) < 0) {
+                goto finish;
+            }
+        }
+        if (output_append(&out, newline, newline_len) < 0) {
+            goto finish;
+        }
+    }
+    result = PyUnicode_DecodeUTF8(out.data, out.len, NULL);
+
+  finish:
+    PyMem_Free(out.data);
+    return result;
+}
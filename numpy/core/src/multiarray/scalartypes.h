@@ -31,4 +31,10 @@ _typenum_fromtypeobj(PyObject *type, int user);
 NPY_NO_EXPORT void *
 scalar_value(PyObject *scalar, PyArray_Descr *descr);
 
+NPY_NO_EXPORT npy_intp
+floattype_str_buffer(npy_float val, char *buffer, npy_intp size);
+
+NPY_NO_EXPORT npy_intp
+doubletype_str_buffer(npy_double val, char *buffer, npy_intp size);
+
 #endif
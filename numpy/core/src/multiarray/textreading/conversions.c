@@ -0,0 +1,489 @@
+/*
+ * Fast parsers for the common field types of `loadtxt`.  Anything they do
+ * not understand is left to the Python converters (see conversions.h).
+ */
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#define _MULTIARRAYMODULE
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/arrayobject.h"
+#include "numpy/halffloat.h"
+#include "numpy/npy_math.h"
+
+#include "numpyos.h"
+#include "npy_strtod.h"
+
+#include "textreading/conversions.h"
+
+
+/* Longer numbers are left to Python */
+#define ASCII_BUFFER_SIZE 128
+
+
+static NPY_INLINE void
+strip_whitespace(const Py_UCS4 **str, const Py_UCS4 **end)
+{
+    while (*str < *end && Py_UNICODE_ISSPACE(**str)) {
+        (*str)++;
+    }
+    while (*end > *str && Py_UNICODE_ISSPACE((*end)[-1])) {
+        (*end)--;
+    }
+}
+
+
+/*
+ * Copies the (ASCII only) string into `buffer`.  If `fix_plus_minus` is
+ * set, a `+` directly followed by a `-` is dropped, as `loadtxt` has always
+ * done for complex numbers.
+ */
+static int
+copy_to_ascii(const Py_UCS4 *str, const Py_UCS4 *end, char *buffer,
+        int fix_plus_minus)
+{
+    if (end - str >= ASCII_BUFFER_SIZE) {
+        return -1;
+    }
+    char *out = buffer;
+    for (; str < end; str++) {
+        if (*str >= 128) {
+            return -1;
+        }
+        if (fix_plus_minus && *str == '+' && str + 1 < end && str[1] == '-') {
+            continue;
+        }
+        *out++ = (char)*str;
+    }
+    *out = '\0';
+    return 0;
+}
+
+
+/* Parses "inf", "infinity" and "nan" (with optional sign) like `float` */
+static int
+parse_special_prefix(const char *str, char **endptr, double *result)
+{
+    const char *p = str;
+    int negative = 0;
+
+    if (*p == '+' || *p == '-') {
+        negative = (*p == '-');
+        p++;
+    }
+    if (NumPyOS_ascii_strncasecmp(p, "inf", 3) == 0) {
+        p += 3;
+        if (NumPyOS_ascii_strncasecmp(p, "inity", 5) == 0) {
+            p += 5;
+        }
+        *result = negative ? -NPY_INFINITY : NPY_INFINITY;
+        *endptr = (char *)p;
+        return 0;
+    }
+    if (NumPyOS_ascii_strncasecmp(p, "nan", 3) == 0) {
+        *result = negative ? -NPY_NAN : NPY_NAN;
+        *endptr = (char *)p + 3;
+        return 0;
+    }
+    return -1;
+}
+
+
+/*
+ * Parses a float at the start of `str` with the rules of Python's `float`
+ * (except for underscores and non-ASCII digits, which are left to Python).
+ */
+static int
+parse_double_prefix(const char *str, char **endptr, double *result)
+{
+    if (parse_special_prefix(str, endptr, result) == 0) {
+        return 0;
+    }
+    return npy_strtod_decimal(str, endptr, result);
+}
+
+
+NPY_NO_EXPORT int
+double_from_ucs4(const Py_UCS4 *str, const Py_UCS4 *end, double *result)
+{
+    char buffer[ASCII_BUFFER_SIZE];
+    char *stop;
+
+    strip_whitespace(&str, &end);
+    if (str == end || copy_to_ascii(str, end, buffer, 0) < 0) {
+        return -1;
+    }
+    if (parse_double_prefix(buffer, &stop, result) < 0 || *stop != '\0') {
+        return -1;
+    }
+    return 0;
+}
+
+
+/* Like `double_from_ucs4`, but rounds decimals directly to float32 */
+static int
+float_from_ucs4(const Py_UCS4 *str, const Py_UCS4 *end, float *result)
+{
+    char buffer[ASCII_BUFFER_SIZE];
+    char *stop;
+    double special;
+
+    strip_whitespace(&str, &end);
+    if (str == end || copy_to_ascii(str, end, buffer, 0) < 0) {
+        return -1;
+    }
+    if (parse_special_prefix(buffer, &stop, &special) == 0) {
+        *result = (float)special;
+    }
+    else if (npy_strtof_decimal(buffer, &stop, result) < 0) {
+        return -1;
+    }
+    return *stop == '\0' ? 0 : -1;
+}
+
+
+/*
+ * Parses the plain decimal integers accepted by Python's `int`.  Fails for
+ * values out of range, `is_unsigned` rejects negative values.
+ */
+static int
+integer_from_ucs4(const Py_UCS4 *str, const Py_UCS4 *end,
+        int is_unsigned, npy_uint64 *result, int *negative)
+{
+    npy_uint64 limit = is_unsigned ? NPY_MAX_UINT64 : (npy_uint64)NPY_MAX_INT64;
+    npy_uint64 value = 0;
+
+    strip_whitespace(&str, &end);
+    *negative = 0;
+    if (str < end && (*str == '+' || *str == '-')) {
+        if (*str == '-') {
+            if (is_unsigned) {
+                return -1;
+            }
+            *negative = 1;
+            limit += 1;
+        }
+        str++;
+    }
+    if (str == end) {
+        return -1;
+    }
+    for (; str < end; str++) {
+        if (*str < '0' || *str > '9') {
+            return -1;
+        }
+        npy_uint64 digit = *str - '0';
+        if (value > (limit - digit) / 10) {
+            return -1;
+        }
+        value = value * 10 + digit;
+    }
+    *result = value;
+    return 0;
+}
+
+
+static int
+int64_from_ucs4(const Py_UCS4 *str, const Py_UCS4 *end, npy_int64 *result)
+{
+    npy_uint64 value;
+    int negative;
+
+    if (integer_from_ucs4(str, end, 0, &value, &negative) < 0) {
+        return -1;
+    }
+    *result = negative ? (npy_int64)(0 - value) : (npy_int64)value;
+    return 0;
+}
+
+
+static NPY_INLINE void
+store_swapped(PyArray_Descr *descr, char *dataptr, const void *value, int size)
+{
+    memcpy(dataptr, value, size);
+    if (!PyArray_ISNBO(descr->byteorder)) {
+        for (int i = 0; i < size / 2; i++) {
+            char tmp = dataptr[i];
+            dataptr[i] = dataptr[size - 1 - i];
+            dataptr[size - 1 - i] = tmp;
+        }
+    }
+}
+
+
+static int
+to_bool(PyArray_Descr *NPY_UNUSED(descr),
+        const Py_UCS4 *str, const Py_UCS4 *end, char *dataptr)
+{
+    npy_int64 value;
+
+    /* `bool(int(x))` */
+    if (int64_from_ucs4(str, end, &value) < 0) {
+        return -1;
+    }
+    *(npy_bool *)dataptr = value != 0;
+    return 0;
+}
+
+
+/*
+ * Signed integers and unsigned integers smaller than 64 bits.  64 bit
+ * integers are parsed strictly (`np.int64(x)`), smaller ones follow
+ * `int(float(x))` and wrap around when stored, as the Python code did.
+ */
+static int
+to_int(PyArray_Descr *descr,
+        const Py_UCS4 *str, const Py_UCS4 *end, char *dataptr)
+{
+    npy_int64 value;
+
+    if (int64_from_ucs4(str, end, &value) < 0) {
+        double dvalue;
+        if (descr->elsize == 8 || double_from_ucs4(str, end, &dvalue) < 0) {
+            return -1;
+        }
+        /* Also rejects NaN; out of range values are left to Python */
+        if (!(dvalue >= -9223372036854775808.0 &&
+              dvalue < 9223372036854775808.0)) {
+            return -1;
+        }
+        value = (npy_int64)dvalue;
+    }
+    switch (descr->elsize) {
+        case 1: {
+            npy_uint8 v = (npy_uint8)value;
+            store_swapped(descr, dataptr, &v, 1);
+            break;
+        }
+        case 2: {
+            npy_uint16 v = (npy_uint16)value;
+            store_swapped(descr, dataptr, &v, 2);
+            break;
+        }
+        case 4: {
+            npy_uint32 v = (npy_uint32)value;
+            store_swapped(descr, dataptr, &v, 4);
+            break;
+        }
+        default: {
+            store_swapped(descr, dataptr, &value, 8);
+            break;
+        }
+    }
+    return 0;
+}
+
+
+static int
+to_uint64(PyArray_Descr *descr,
+        const Py_UCS4 *str, const Py_UCS4 *end, char *dataptr)
+{
+    npy_uint64 value;
+    int negative;
+
+    if (integer_from_ucs4(str, end, 1, &value, &negative) < 0) {
+        return -1;
+    }
+    store_swapped(descr, dataptr, &value, 8);
+    return 0;
+}
+
+
+static int
+to_float(PyArray_Descr *descr,
+        const Py_UCS4 *str, const Py_UCS4 *end, char *dataptr)
+{
+    double value;
+
+    if (descr->elsize == 4) {
+        float v;
+        if (float_from_ucs4(str, end, &v) < 0) {
+            return -1;
+        }
+        store_swapped(descr, dataptr, &v, 4);
+        return 0;
+    }
+    if (double_from_ucs4(str, end, &value) < 0) {
+        return -1;
+    }
+    switch (descr->elsize) {
+        case 2: {
+            npy_half v = npy_double_to_half(value);
+            store_swapped(descr, dataptr, &v, 2);
+            break;
+        }
+        default: {
+            store_swapped(descr, dataptr, &value, 8);
+            break;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Parses the forms accepted by Python's `complex`: "1", "1j", "1+2j",
+ * "-j", optionally surrounded by parentheses.
+ */
+static int
+complex_from_ucs4(const Py_UCS4 *str, const Py_UCS4 *end,
+        double *real, double *imag)
+{
+    char buffer[ASCII_BUFFER_SIZE];
+    char *p, *stop;
+    double value;
+    int paren = 0;
+
+    strip_whitespace(&str, &end);
+    if (str == end || copy_to_ascii(str, end, buffer, 1) < 0) {
+        return -1;
+    }
+    p = buffer;
+    if (*p == '(') {
+        paren = 1;
+        p++;
+        while (*p == ' ' || (*p >= '\t' && *p <= '\r')) {
+            p++;
+        }
+    }
+    *real = 0;
+    *imag = 0;
+    if (parse_double_prefix(p, &stop, &value) == 0) {
+        p = stop;
+        if (*p == '+' || *p == '-') {
+            *real = value;
+            if (parse_double_prefix(p, &stop, &value) == 0) {
+                *imag = value;
+                p = stop;
+            }
+            else {
+                *imag = *p == '-' ? -1.0 : 1.0;
+                p++;
+            }
+            if (*p != 'j' && *p != 'J') {
+                return -1;
+            }
+            p++;
+        }
+        else if (*p == 'j' || *p == 'J') {
+            *imag = value;
+            p++;
+        }
+        else {
+            *real = value;
+        }
+    }
+    else {
+        /* "j", "+j" or "-j" */
+        double sign = 1.0;
+        if (*p == '+' || *p == '-') {
+            sign = *p == '-' ? -1.0 : 1.0;
+            p++;
+        }
+        if (*p != 'j' && *p != 'J') {
+            return -1;
+        }
+        *imag = sign;
+        p++;
+    }
+    if (paren) {
+        while (*p == ' ' || (*p >= '\t' && *p <= '\r')) {
+            p++;
+        }
+        if (*p != ')') {
+            return -1;
+        }
+        p++;
+    }
+    return *p == '\0' ? 0 : -1;
+}
+
+
+static int
+to_complex(PyArray_Descr *descr,
+        const Py_UCS4 *str, const Py_UCS4 *end, char *dataptr)
+{
+    double real, imag;
+
+    if (complex_from_ucs4(str, end, &real, &imag) < 0) {
+        return -1;
+    }
+    if (descr->elsize == 8) {
+        float v[2] = {(float)real, (float)imag};
+        store_swapped(descr, dataptr, &v[0], 4);
+        store_swapped(descr, dataptr + 4, &v[1], 4);
+    }
+    else {
+        store_swapped(descr, dataptr, &real, 8);
+        store_swapped(descr, dataptr + 8, &imag, 8);
+    }
+    return 0;
+}
+
+
+/* `asbytes(x)`: encode as latin1 and truncate */
+static int
+to_bytes(PyArray_Descr *descr,
+        const Py_UCS4 *str, const Py_UCS4 *end, char *dataptr)
+{
+    npy_intp length = end - str;
+    if (length > descr->elsize) {
+        length = descr->elsize;
+    }
+    for (npy_intp i = 0; i < end - str; i++) {
+        /* The whole string must be encodable, even the truncated part */
+        if (str[i] > 255) {
+            return -1;
+        }
+    }
+    for (npy_intp i = 0; i < length; i++) {
+        dataptr[i] = (char)str[i];
+    }
+    memset(dataptr + length, 0, descr->elsize - length);
+    return 0;
+}
+
+
+static int
+to_unicode(PyArray_Descr *descr,
+        const Py_UCS4 *str, const Py_UCS4 *end, char *dataptr)
+{
+    npy_intp size = descr->elsize / 4;
+    npy_intp length = end - str;
+    if (length > size) {
+        length = size;
+    }
+    for (npy_intp i = 0; i < length; i++) {
+        store_swapped(descr, dataptr + 4*i, &str[i], 4);
+    }
+    memset(dataptr + 4*length, 0, 4*(size - length));
+    return 0;
+}
+
+
+NPY_NO_EXPORT set_from_ucs4_function *
+get_from_ucs4_function(PyArray_Descr *descr)
+{
+    switch (descr->type_num) {
+        case NPY_BOOL:
+            return &to_bool;
+        case NPY_BYTE: case NPY_SHORT: case NPY_INT: case NPY_LONG:
+        case NPY_LONGLONG:
+        case NPY_UBYTE: case NPY_USHORT: case NPY_UINT:
+            return &to_int;
+        case NPY_ULONG: case NPY_ULONGLONG:
+            return descr->elsize == 8 ? &to_uint64 : &to_int;
+        case NPY_HALF: case NPY_FLOAT: case NPY_DOUBLE:
+            return &to_float;
+        case NPY_CFLOAT: case NPY_CDOUBLE:
+            return &to_complex;
+        case NPY_STRING:
+            return &to_bytes;
+        case NPY_UNICODE:
+            return &to_unicode;
+        default:
+            /* longdouble, datetimes, objects, ... use Python */
+            return NULL;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef _NPY_TEXTREADING_CONVERSIONS_H
+#define _NPY_TEXTREADING_CONVERSIONS_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/ndarraytypes.h"
+
+
+/*
+ * Parse a field of text and store the result at `dataptr` (which may be
+ * unaligned and use a non-native byte order, as given by `descr`).
+ *
+ * These functions never set a Python error: they return -1 whenever the
+ * string is not in the simple form they understand (or is out of range),
+ * the caller then falls back to the Python converter, which either
+ * handles the more unusual spelling or raises the appropriate error.
+ * They do not need the GIL, so that worker threads can use them.
+ */
+typedef int (set_from_ucs4_function)(
+        PyArray_Descr *descr, const Py_UCS4 *str, const Py_UCS4 *end,
+        char *dataptr);
+
+
+/* Returns the fast parser for the dtype, or NULL if there is none */
+NPY_NO_EXPORT set_from_ucs4_function *
+get_from_ucs4_function(PyArray_Descr *descr);
+
+
+NPY_NO_EXPORT int
+double_from_ucs4(const Py_UCS4 *str, const Py_UCS4 *end, double *result);
+
+
+#endif  /* _NPY_TEXTREADING_CONVERSIONS_H */
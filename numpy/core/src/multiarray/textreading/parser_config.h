@@ -0,0 +1,42 @@
+#ifndef _NPY_TEXTREADING_PARSER_CONFIG_H
+#define _NPY_TEXTREADING_PARSER_CONFIG_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdbool.h>
+
+#include "numpy/npy_common.h"
+
+
+/*
+ * The settings controlling how `loadtxt` splits the text into fields.
+ * All strings are stored as UCS4, the tokenizer works on UCS4 buffers.
+ */
+typedef struct {
+    /*
+     * The field delimiter.  When `delimiter` is NULL, fields are separated
+     * by runs of whitespace and leading/trailing whitespace is ignored
+     * (the behaviour of `str.split()`).
+     */
+    Py_UCS4 *delimiter;
+    npy_intp delimiter_len;
+
+    /*
+     * Everything from the first occurrence of any of the comment strings
+     * to the end of the line is ignored.
+     */
+    npy_intp num_comments;
+    Py_UCS4 **comments;
+    npy_intp *comment_lens;
+
+    /*
+     * The quote character; inside quotes delimiters, comments and newlines
+     * are part of the field.  A doubled quote inside quotes is a literal
+     * quote.  Quoting is disabled when `has_quote` is false.
+     */
+    bool has_quote;
+    Py_UCS4 quote;
+} parser_config;
+
+
+#endif  /* _NPY_TEXTREADING_PARSER_CONFIG_H */
@@ -0,0 +1,261 @@
+/*
+ * The C implementation behind `np.loadtxt`, exposed as
+ * `np.core._multiarray_umath._load_from_filelike`.  The Python function
+ * prepares the dtype, the default converters (`np.lib.npyio._getconv`) and
+ * the user converters and does the final reshaping, this module reads the
+ * text and fills the array.
+ */
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#define _MULTIARRAYMODULE
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/arrayobject.h"
+#include "npy_argparse.h"
+#include "common.h"
+#include "conversion_utils.h"
+
+#include "textreading/parser_config.h"
+#include "textreading/stream_pyobject.h"
+#include "textreading/rows.h"
+#include "textreading/readtext.h"
+
+
+/* Number of characters requested from `file.read()` at a time */
+#define READ_CHUNKSIZE (1 << 16)
+
+
+static int
+intp_converter(PyObject *obj, npy_intp *value)
+{
+    *value = PyArray_PyIntAsIntp(obj);
+    if (error_converting(*value)) {
+        return 0;
+    }
+    return 1;
+}
+
+
+static int
+ucs4_from_string(PyObject *obj, const char *name,
+        Py_UCS4 **str, npy_intp *length)
+{
+    if (!PyUnicode_Check(obj)) {
+        PyErr_Format(PyExc_TypeError, "%s must be a string or None", name);
+        return -1;
+    }
+    *str = PyUnicode_AsUCS4Copy(obj);
+    if (*str == NULL) {
+        return -1;
+    }
+    *length = PyUnicode_GET_LENGTH(obj);
+    return 0;
+}
+
+
+static void
+parser_config_clear(parser_config *config)
+{
+    PyMem_FREE(config->delimiter);
+    for (npy_intp i = 0; i < config->num_comments; i++) {
+        PyMem_FREE(config->comments[i]);
+    }
+    PyMem_FREE(config->comments);
+    PyMem_FREE(config->comment_lens);
+}
+
+
+static int
+parser_config_init(parser_config *config,
+        PyObject *delimiter, PyObject *comments, PyObject *quote)
+{
+    memset(config, 0, sizeof(*config));
+
+    if (delimiter != Py_None) {
+        if (ucs4_from_string(delimiter, "delimiter",
+                &config->delimiter, &config->delimiter_len) < 0) {
+            return -1;
+        }
+        if (config->delimiter_len == 0) {
+            PyErr_SetString(PyExc_ValueError, "empty delimiter");
+            return -1;
+        }
+    }
+    if (comments != Py_None) {
+        PyObject *seq = PySequence_Fast(comments, "comments must be a sequence");
+        if (seq == NULL) {
+            return -1;
+        }
+        npy_intp n = PySequence_Fast_GET_SIZE(seq);
+        config->comments = PyMem_Calloc(n + 1, sizeof(Py_UCS4 *));
+        config->comment_lens = PyMem_Calloc(n + 1, sizeof(npy_intp));
+        if (config->comments == NULL || config->comment_lens == NULL) {
+            Py_DECREF(seq);
+            PyErr_NoMemory();
+            return -1;
+        }
+        for (npy_intp i = 0; i < n; i++) {
+            if (ucs4_from_string(PySequence_Fast_GET_ITEM(seq, i), "comments",
+                    &config->comments[i], &config->comment_lens[i]) < 0) {
+                Py_DECREF(seq);
+                return -1;
+            }
+            config->num_comments++;
+        }
+        Py_DECREF(seq);
+    }
+    if (quote != Py_None) {
+        if (!PyUnicode_Check(quote) || PyUnicode_GetLength(quote) != 1) {
+            PyErr_SetString(PyExc_TypeError,
+                    "quotechar must be a single character or None");
+            return -1;
+        }
+        config->has_quote = true;
+        config->quote = PyUnicode_ReadChar(quote, 0);
+    }
+    return 0;
+}
+
+
+NPY_NO_EXPORT PyObject *
+_load_from_filelike(PyObject *NPY_UNUSED(mod),
+        PyObject *const *args, Py_ssize_t len_args, PyObject *kwnames)
+{
+    PyObject *file;
+    PyObject *delimiter = Py_None, *comments = Py_None, *quote = Py_None;
+    PyObject *usecols_obj = Py_None, *fields = NULL;
+    PyObject *converters = Py_None, *encoding_obj = Py_None;
+    npy_intp skiplines = 0, max_rows = -1, chunksize = 50000;
+    PyArray_Descr *dtype = NULL;
+    npy_bool homogeneous = NPY_TRUE, filelike = NPY_TRUE;
+    NPY_PREPARE_ARGPARSER;
+
+    if (npy_parse_arguments("_load_from_filelike", args, len_args, kwnames,
+            "file", NULL, &file,
+            "$delimiter", NULL, &delimiter,
+            "$comments", NULL, &comments,
+            "$quote", NULL, &quote,
+            "$usecols", NULL, &usecols_obj,
+            "$skiplines", &intp_converter, &skiplines,
+            "$max_rows", &intp_converter, &max_rows,
+            "$dtype", &PyArray_DescrConverter, &dtype,
+            "$fields", NULL, &fields,
+            "$homogeneous", &PyArray_BoolConverter, &homogeneous,
+            "$converters", NULL, &converters,
+            "$encoding", NULL, &encoding_obj,
+            "$filelike", &PyArray_BoolConverter, &filelike,
+            "$chunksize", &intp_converter, &chunksize,
+            NULL, NULL, NULL) < 0) {
+        return NULL;
+    }
+
+    PyObject *result = NULL;
+    parser_config config;
+    npy_intp num_usecols = 0, *usecols = NULL;
+    npy_intp num_field_types = 0;
+    field_type *field_types = NULL;
+    const char *encoding = NULL;
+    stream *s = NULL;
+
+    memset(&config, 0, sizeof(config));
+    if (dtype == NULL || fields == NULL) {
+        PyErr_SetString(PyExc_TypeError,
+                "_load_from_filelike() requires `dtype` and `fields`");
+        goto finish;
+    }
+    if (parser_config_init(&config, delimiter, comments, quote) < 0) {
+        goto finish;
+    }
+    if (encoding_obj != Py_None) {
+        encoding = PyUnicode_AsUTF8(encoding_obj);
+        if (encoding == NULL) {
+            goto finish;
+        }
+    }
+    if (converters == Py_None) {
+        converters = NULL;
+    }
+    else if (!PyDict_Check(converters)) {
+        PyErr_SetString(PyExc_TypeError, "converters must be a dict or None");
+        goto finish;
+    }
+
+    if (usecols_obj != Py_None) {
+        PyObject *seq = PySequence_Fast(usecols_obj,
+                "usecols must be a sequence of integers");
+        if (seq == NULL) {
+            goto finish;
+        }
+        num_usecols = PySequence_Fast_GET_SIZE(seq);
+        usecols = PyMem_Malloc((num_usecols + 1) * sizeof(npy_intp));
+        if (usecols == NULL) {
+            Py_DECREF(seq);
+            PyErr_NoMemory();
+            goto finish;
+        }
+        for (npy_intp i = 0; i < num_usecols; i++) {
+            usecols[i] = PyArray_PyIntAsIntp(PySequence_Fast_GET_ITEM(seq, i));
+            if (error_converting(usecols[i])) {
+                Py_DECREF(seq);
+                goto finish;
+            }
+        }
+        Py_DECREF(seq);
+    }
+
+    /* fields is a sequence of (dtype, offset, converter) */
+    PyObject *fields_seq = PySequence_Fast(fields, "fields must be a sequence");
+    if (fields_seq == NULL) {
+        goto finish;
+    }
+    num_field_types = PySequence_Fast_GET_SIZE(fields_seq);
+    if (num_field_types == 0 || (homogeneous && num_field_types != 1)) {
+        Py_DECREF(fields_seq);
+        PyErr_SetString(PyExc_ValueError, "invalid fields for loadtxt");
+        goto finish;
+    }
+    field_types = PyMem_Calloc(num_field_types, sizeof(field_type));
+    if (field_types == NULL) {
+        Py_DECREF(fields_seq);
+        PyErr_NoMemory();
+        goto finish;
+    }
+    for (npy_intp i = 0; i < num_field_types; i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(fields_seq, i);
+        PyArray_Descr *descr;
+        if (!PyArg_ParseTuple(item, "O!nO:fields", &PyArrayDescr_Type,
+                &descr, &field_types[i].offset, &field_types[i].converter)) {
+            Py_DECREF(fields_seq);
+            goto finish;
+        }
+        field_types[i].descr = descr;
+        field_types[i].set_from_ucs4 = get_from_ucs4_function(descr);
+    }
+
+    if (filelike) {
+        s = stream_python_file(file, encoding, READ_CHUNKSIZE);
+    }
+    else {
+        s = stream_python_iterable(file, encoding);
+    }
+    if (s == NULL) {
+        Py_DECREF(fields_seq);
+        goto finish;
+    }
+    /* The borrowed references in `field_types` are kept alive by `fields` */
+    result = read_rows(s, &config, skiplines, max_rows,
+            num_usecols, usecols, dtype, homogeneous,
+            num_field_types, field_types, converters, chunksize);
+    Py_DECREF(fields_seq);
+    if (stream_close(s) < 0) {
+        Py_CLEAR(result);
+    }
+
+  finish:
+    PyMem_FREE(field_types);
+    PyMem_FREE(usecols);
+    parser_config_clear(&config);
+    Py_XDECREF(dtype);
+    return result;
+}
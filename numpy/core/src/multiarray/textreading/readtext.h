@@ -0,0 +1,11 @@
+#ifndef _NPY_TEXTREADING_READTEXT_H
+#define _NPY_TEXTREADING_READTEXT_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+NPY_NO_EXPORT PyObject *
+_load_from_filelike(PyObject *NPY_UNUSED(mod),
+        PyObject *const *args, Py_ssize_t len_args, PyObject *kwnames);
+
+#endif  /* _NPY_TEXTREADING_READTEXT_H */
@@ -0,0 +1,650 @@
+/*
+ * The main loop of `loadtxt`: tokenizes the lines of a stream and parses
+ * the fields directly into a growing buffer, which becomes the result.
+ *
+ * When multiple threads are enabled (see `np.setparallel`), files are read
+ * in large blocks of text which are split at newlines into one chunk per
+ * thread.  The chunks are tokenized and converted concurrently into
+ * separate buffers, which are then appended to the result in order.
+ */
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#define _MULTIARRAYMODULE
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/arrayobject.h"
+
+#include "alloc.h"
+#include "array_coercion.h"
+#include "npy_parallel.h"
+#include "templ_common.h"
+
+#include "textreading/rows.h"
+#include "textreading/tokenize.h"
+
+
+/* Upper limit for the size of the first allocation of rows */
+#define INITIAL_BUFFER_BYTES (1 << 20)
+
+/* Number of characters that are split among the threads at once */
+#define PARALLEL_BLOCK_CHARS (1 << 20)
+
+
+/* How the fields are stored, fixed once the first row was read */
+typedef struct {
+    parser_config *config;
+    npy_intp *usecols;
+    npy_intp ncols;
+    npy_intp ncols_used;
+    field_type *columns;
+    npy_intp row_size;
+    npy_intp initial_rows;
+    int needs_init;
+} row_layout;
+
+
+typedef struct {
+    char *data;
+    npy_intp nrows;
+    npy_intp rows_allocated;
+} row_buffer;
+
+
+/* A newline-aligned part of the text, read by a worker thread */
+typedef struct {
+    Py_UCS4 *start;
+    Py_UCS4 *end;
+    row_buffer rows;
+    /* Number of lines read and the first line that needs the GIL */
+    npy_intp nlines;
+    Py_UCS4 *stop;
+} text_chunk;
+
+
+typedef struct {
+    const row_layout *layout;
+    text_chunk *chunks;
+} parallel_rows_data;
+
+
+static int
+convert_with_python(PyObject *converter, PyArray_Descr *descr,
+        const Py_UCS4 *str, npy_intp length, char *dataptr)
+{
+    PyObject *string = PyUnicode_FromKindAndData(
+            PyUnicode_4BYTE_KIND, str, length);
+    if (string == NULL) {
+        return -1;
+    }
+    PyObject *value = PyObject_CallFunctionObjArgs(converter, string, NULL);
+    Py_DECREF(string);
+    if (value == NULL) {
+        return -1;
+    }
+    int res = PyArray_Pack(descr, dataptr, value);
+    Py_DECREF(value);
+    return res;
+}
+
+
+/*
+ * Wraps the rows into an array which owns the data (and thus also cleans
+ * up any references stored in it).
+ */
+static PyObject *
+rows_to_array(char *data, PyArray_Descr *dtype, int homogeneous,
+        npy_intp nrows, npy_intp ncols)
+{
+    npy_intp dims[2] = {nrows, ncols};
+
+    Py_INCREF(dtype);
+    PyObject *arr = PyArray_NewFromDescr(
+            &PyArray_Type, dtype, homogeneous ? 2 : 1, dims, NULL,
+            data, NPY_ARRAY_DEFAULT, NULL);
+    if (arr == NULL) {
+        return NULL;
+    }
+    PyArray_ENABLEFLAGS((PyArrayObject *)arr, NPY_ARRAY_OWNDATA);
+    return arr;
+}
+
+
+/*
+ * Sets up the field type of each result column once the number of columns
+ * is known.  User converters replace the default parsing.
+ */
+static field_type *
+create_columns(npy_intp ncols, int homogeneous,
+        npy_intp num_field_types, field_type *field_types,
+        PyObject *user_converters)
+{
+    field_type *columns = PyMem_Malloc(ncols * sizeof(field_type));
+    if (columns == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    for (npy_intp i = 0; i < ncols; i++) {
+        if (homogeneous) {
+            columns[i] = field_types[0];
+            columns[i].offset = i * field_types[0].descr->elsize;
+        }
+        else {
+            columns[i] = field_types[i];
+        }
+        if (user_converters == NULL) {
+            continue;
+        }
+        /* Negative keys count from the end, like list indices */
+        for (int negative = 0; negative < 2; negative++) {
+            PyObject *key = PyLong_FromSsize_t(negative ? i - ncols : i);
+            if (key == NULL) {
+                PyMem_FREE(columns);
+                return NULL;
+            }
+            PyObject *conv = PyDict_GetItemWithError(user_converters, key);
+            Py_DECREF(key);
+            if (conv != NULL) {
+                columns[i].converter = conv;
+                columns[i].set_from_ucs4 = NULL;
+                break;
+            }
+            else if (PyErr_Occurred()) {
+                PyMem_FREE(columns);
+                return NULL;
+            }
+        }
+    }
+    return columns;
+}
+
+
+/*
+ * Makes room for `n` more rows.  With `nogil` set, no exception is set on
+ * failure.
+ */
+static int
+ensure_rows(const row_layout *layout, row_buffer *rows, npy_intp n, int nogil)
+{
+    npy_intp needed = rows->nrows + n;
+    npy_intp new_rows, nbytes;
+
+    if (needed <= rows->rows_allocated) {
+        return 0;
+    }
+    if (rows->rows_allocated == 0) {
+        new_rows = layout->initial_rows;
+    }
+    else {
+        new_rows = rows->rows_allocated + (rows->rows_allocated + 1) / 2;
+    }
+    if (new_rows < needed) {
+        new_rows = needed;
+    }
+    if (npy_mul_with_overflow_intp(&nbytes, new_rows, layout->row_size)) {
+        goto fail;
+    }
+    char *new_data = PyDataMem_RENEW(rows->data, nbytes > 0 ? nbytes : 1);
+    if (new_data == NULL) {
+        goto fail;
+    }
+    rows->data = new_data;
+    if (layout->needs_init) {
+        memset(rows->data + rows->rows_allocated * layout->row_size, 0,
+               (new_rows - rows->rows_allocated) * layout->row_size);
+    }
+    rows->rows_allocated = new_rows;
+    return 0;
+
+  fail:
+    if (!nogil) {
+        PyErr_NoMemory();
+    }
+    return -1;
+}
+
+
+/*
+ * Stores the fields of the tokenized line as the row at `row`.  With `nogil`
+ * set, -1 is returned without an exception for every line that would need
+ * Python, either for a converter or to report an error.
+ */
+static int
+store_row(const row_layout *layout, tokenizer_state *ts, npy_intp lineno,
+        char *row, int nogil)
+{
+    npy_intp *usecols = layout->usecols;
+
+    if (usecols == NULL && ts->num_fields != layout->ncols) {
+        if (!nogil) {
+            PyErr_Format(PyExc_ValueError,
+                    "Wrong number of columns at line %zd", lineno);
+        }
+        return -1;
+    }
+    for (npy_intp i = 0; i < layout->ncols_used; i++) {
+        npy_intp col = i;
+        if (usecols != NULL) {
+            col = usecols[i];
+            if (col < 0) {
+                col += ts->num_fields;
+            }
+            if (col < 0 || col >= ts->num_fields) {
+                if (!nogil) {
+                    PyErr_Format(PyExc_IndexError,
+                            "invalid column index %zd at line %zd with %zd "
+                            "columns", usecols[i], lineno, ts->num_fields);
+                }
+                return -1;
+            }
+        }
+        const Py_UCS4 *str = ts->line + ts->fields[col].offset;
+        npy_intp length = ts->fields[col].length;
+        field_type *column = &layout->columns[i];
+        char *dataptr = row + column->offset;
+
+        if (column->set_from_ucs4 != NULL && column->set_from_ucs4(
+                column->descr, str, str + length, dataptr) == 0) {
+            continue;
+        }
+        if (nogil || convert_with_python(column->converter, column->descr,
+                                         str, length, dataptr) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Reads the rows of the lines in `[start, end)`, which must not end within
+ * a line (unless at the end of the file).  `*lineno` is the number of lines
+ * before `start` and is incremented for every line read.
+ *
+ * If `stop` is passed, this runs without the GIL: reading ends at the first
+ * line that needs it, `*stop` is then set to the start of that line.
+ */
+static int
+rows_from_text(const row_layout *layout, Py_UCS4 *start, Py_UCS4 *end,
+        row_buffer *rows, npy_intp *lineno, Py_UCS4 **stop)
+{
+    int nogil = (stop != NULL);
+    tokenizer_state ts;
+    int res;
+
+    tokenizer_init(&ts);
+    ts.nogil = nogil;
+    ts.pos = start;
+    ts.end = end;
+    ts.buf_kind = BUFFER_IS_FILEEND;
+    if (nogil) {
+        *stop = NULL;
+    }
+
+    while (1) {
+        Py_UCS4 *line_start = ts.pos;
+
+        /* The stream is never used, since the buffer ends the file */
+        res = tokenize(NULL, &ts, layout->config);
+        if (res == 1) {
+            res = 0;
+            break;
+        }
+        if (res == 0 && ts.num_fields > 0) {
+            res = ensure_rows(layout, rows, 1, nogil);
+            if (res == 0) {
+                res = store_row(layout, &ts, *lineno + 1,
+                        rows->data + rows->nrows * layout->row_size, nogil);
+            }
+            if (res == 0) {
+                rows->nrows++;
+            }
+        }
+        if (res < 0) {
+            if (nogil) {
+                *stop = line_start;
+                res = 0;
+            }
+            break;
+        }
+        (*lineno)++;
+    }
+    tokenizer_clear(&ts);
+    return res;
+}
+
+
+static int
+text_chunk_task(void *data, npy_intp itask, int NPY_UNUSED(ithread))
+{
+    parallel_rows_data *d = (parallel_rows_data *)data;
+    text_chunk *chunk = &d->chunks[itask];
+
+    return rows_from_text(d->layout, chunk->start, chunk->end,
+                          &chunk->rows, &chunk->nlines, &chunk->stop);
+}
+
+
+/*
+ * Reads the rows of the complete lines in `text`, split into one chunk per
+ * thread.  Whatever a worker cannot handle without the GIL (Python
+ * converters, errors) is left to the calling thread, which reads the rest
+ * of that chunk serially.  Thus the errors are the same as when reading
+ * serially.
+ */
+static int
+rows_from_text_parallel(const row_layout *layout,
+        Py_UCS4 *text, npy_intp length, row_buffer *rows, npy_intp *lineno)
+{
+    int nthreads = npy_parallel_threads_for_size(length);
+    int res = 0;
+
+    if (nthreads <= 1) {
+        return rows_from_text(layout, text, text + length, rows, lineno, NULL);
+    }
+
+    text_chunk *chunks = PyMem_Calloc(nthreads, sizeof(text_chunk));
+    if (chunks == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    npy_intp prev = 0;
+    for (int i = 0; i < nthreads; i++) {
+        npy_intp start, stop;
+        npy_parallel_chunk_bounds(length, nthreads, i, 1, &start, &stop);
+        /* Move the end behind the next newline */
+        if (stop < prev) {
+            stop = prev;
+        }
+        while (stop > 0 && stop < length && text[stop - 1] != '\n') {
+            stop++;
+        }
+        chunks[i].start = text + prev;
+        chunks[i].end = text + stop;
+        prev = stop;
+    }
+
+    parallel_rows_data d = {layout, chunks};
+    NPY_BEGIN_THREADS_DEF;
+    NPY_BEGIN_THREADS;
+    npy_parallel_run(nthreads, nthreads, &text_chunk_task, &d);
+    NPY_END_THREADS;
+
+    for (int i = 0; i < nthreads; i++) {
+        text_chunk *chunk = &chunks[i];
+        if (res == 0 && chunk->rows.nrows > 0) {
+            res = ensure_rows(layout, rows, chunk->rows.nrows, 0);
+            if (res == 0) {
+                memcpy(rows->data + rows->nrows * layout->row_size,
+                       chunk->rows.data, chunk->rows.nrows * layout->row_size);
+                rows->nrows += chunk->rows.nrows;
+            }
+        }
+        if (res == 0) {
+            *lineno += chunk->nlines;
+            if (chunk->stop != NULL) {
+                res = rows_from_text(layout, chunk->stop, chunk->end,
+                                     rows, lineno, NULL);
+            }
+        }
+        PyDataMem_FREE(chunk->rows.data);
+    }
+    PyMem_FREE(chunks);
+    return res;
+}
+
+
+/*
+ * Reads the remaining rows of the stream in large blocks of complete lines,
+ * each of which is read by multiple threads.
+ */
+static int
+read_rows_parallel(stream *s, tokenizer_state *ts, const row_layout *layout,
+        row_buffer *rows, npy_intp *lineno)
+{
+    Py_UCS4 *block = NULL;
+    npy_intp length = 0, size = 0, target = PARALLEL_BLOCK_CHARS;
+    int eof = 0, res = 0;
+
+    while (res == 0) {
+        /* Collect text until the block is full */
+        while (!eof && length < target) {
+            if (ts->pos >= ts->end) {
+                if (ts->buf_kind == BUFFER_IS_FILEEND) {
+                    eof = 1;
+                    break;
+                }
+                if (stream_nextbuf(s, &ts->pos, &ts->end, &ts->buf_kind) < 0) {
+                    res = -1;
+                    break;
+                }
+                continue;
+            }
+            npy_intp n = ts->end - ts->pos;
+            if (length + n > size) {
+                npy_intp new_size = 2 * size > length + n ? 2 * size : length + n;
+                Py_UCS4 *new_block = PyMem_Realloc(
+                        block, new_size * sizeof(Py_UCS4));
+                if (new_block == NULL) {
+                    PyErr_NoMemory();
+                    res = -1;
+                    break;
+                }
+                block = new_block;
+                size = new_size;
+            }
+            memcpy(block + length, ts->pos, n * sizeof(Py_UCS4));
+            length += n;
+            ts->pos = ts->end;
+        }
+        if (res < 0 || length == 0) {
+            break;
+        }
+        /* Keep an incomplete last line for the next block */
+        npy_intp used = length;
+        if (!eof) {
+            while (used > 0 && block[used - 1] != '\n') {
+                used--;
+            }
+            if (used == 0) {
+                /* The line is longer than the block */
+                target = 2 * length;
+                continue;
+            }
+        }
+        res = rows_from_text_parallel(layout, block, used, rows, lineno);
+        memmove(block, block + used, (length - used) * sizeof(Py_UCS4));
+        length -= used;
+        target = PARALLEL_BLOCK_CHARS;
+    }
+    PyMem_FREE(block);
+    return res;
+}
+
+
+/*
+ * Threads are only used for files (iterables are read line by line) and if
+ * the lines can be found without tokenizing, i.e. without quoting, as well
+ * as when there is no Python converter which has to be called in order.
+ */
+static int
+can_read_parallel(parser_config *config, tokenizer_state *ts,
+        npy_intp max_rows, const row_layout *layout)
+{
+    if (npy_parallel_get_num_threads() <= 1 || max_rows >= 0 ||
+            config->has_quote || ts->buf_kind == BUFFER_IS_LINEND) {
+        return 0;
+    }
+    for (npy_intp i = 0; i < layout->ncols_used; i++) {
+        if (layout->columns[i].set_from_ucs4 == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+NPY_NO_EXPORT PyObject *
+read_rows(stream *s, parser_config *config,
+        npy_intp skiplines, npy_intp max_rows,
+        npy_intp num_usecols, npy_intp *usecols,
+        PyArray_Descr *dtype, int homogeneous,
+        npy_intp num_field_types, field_type *field_types,
+        PyObject *user_converters, npy_intp chunksize)
+{
+    tokenizer_state ts;
+    row_layout layout;
+    row_buffer rows = {NULL, 0, 0};
+    npy_intp lineno = 0, lines_counted = 0;
+    int can_parallel = 0, parallel = 0;
+    PyObject *result = NULL;
+
+    memset(&layout, 0, sizeof(layout));
+    layout.config = config;
+    layout.usecols = usecols;
+    /* The number of result columns, known once the first row is read */
+    layout.ncols = -1;
+    layout.row_size = dtype->elsize;
+    layout.needs_init = PyDataType_FLAGCHK(dtype, NPY_NEEDS_INIT);
+
+    tokenizer_init(&ts);
+
+    for (npy_intp i = 0; i < skiplines; i++) {
+        int res = read_line(s, &ts, config, 1);
+        if (res < 0) {
+            goto error;
+        }
+        if (res == 1) {
+            break;
+        }
+        lineno++;
+    }
+
+    while (1) {
+        /*
+         * `max_rows` counts all lines starting with the first one that has
+         * data.  Check before reading, so that no extra line is consumed.
+         */
+        if (layout.ncols >= 0 && max_rows >= 0 && lines_counted >= max_rows) {
+            break;
+        }
+        if (parallel) {
+            if (read_rows_parallel(s, &ts, &layout, &rows, &lineno) < 0) {
+                goto error;
+            }
+            break;
+        }
+        int res = tokenize(s, &ts, config);
+        if (res < 0) {
+            goto error;
+        }
+        if (res == 1) {
+            break;
+        }
+        lineno++;
+        if (ts.num_fields == 0 && layout.ncols < 0) {
+            continue;
+        }
+
+        if (layout.ncols < 0) {
+            /* The first row defines the number of columns */
+            layout.ncols = usecols != NULL ? num_usecols : ts.num_fields;
+            if (homogeneous) {
+                layout.ncols_used = layout.ncols;
+                if (npy_mul_with_overflow_intp(&layout.row_size,
+                        layout.ncols, dtype->elsize)) {
+                    PyErr_NoMemory();
+                    goto error;
+                }
+            }
+            else {
+                layout.ncols_used = num_field_types;
+            }
+            layout.initial_rows = INITIAL_BUFFER_BYTES / (
+                    layout.row_size > 0 ? layout.row_size : 1);
+            if (layout.initial_rows > chunksize) {
+                layout.initial_rows = chunksize;
+            }
+            if (layout.initial_rows < 1) {
+                layout.initial_rows = 1;
+            }
+            layout.columns = create_columns(layout.ncols_used, homogeneous,
+                    num_field_types, field_types, user_converters);
+            if (layout.columns == NULL) {
+                goto error;
+            }
+            can_parallel = can_read_parallel(config, &ts, max_rows, &layout);
+        }
+        lines_counted++;
+        if (max_rows >= 0 && lines_counted > max_rows) {
+            break;
+        }
+        if (ts.num_fields == 0) {
+            continue;
+        }
+        if (layout.ncols < layout.ncols_used) {
+            PyErr_Format(PyExc_ValueError,
+                    "the dtype has %zd fields, but line %zd only has "
+                    "%zd columns", num_field_types, lineno, layout.ncols);
+            goto error;
+        }
+        if (ensure_rows(&layout, &rows, 1, 0) < 0) {
+            goto error;
+        }
+        if (store_row(&layout, &ts, lineno,
+                rows.data + rows.nrows * layout.row_size, 0) < 0) {
+            goto error;
+        }
+        rows.nrows++;
+        /* Once the first row is stored, the rest may be read in parallel */
+        parallel = can_parallel;
+    }
+
+    if (layout.ncols < 0) {
+        /* There was no data at all */
+        PyDataMem_FREE(rows.data);
+        Py_INCREF(Py_None);
+        result = Py_None;
+    }
+    else {
+        /* Shrink the buffer to the final size */
+        npy_intp nbytes = rows.nrows * layout.row_size;
+        char *new_data = PyDataMem_RENEW(rows.data, nbytes > 0 ? nbytes : 1);
+        if (new_data == NULL) {
+            PyErr_NoMemory();
+            goto error;
+        }
+        rows.data = new_data;
+        rows.rows_allocated = rows.nrows;
+        result = rows_to_array(rows.data, dtype, homogeneous,
+                               rows.nrows, layout.ncols);
+        if (result == NULL) {
+            goto error;
+        }
+    }
+    PyMem_FREE(layout.columns);
+    tokenizer_clear(&ts);
+    return result;
+
+  error:
+    if (rows.data != NULL) {
+        PyObject *arr = NULL;
+        if (PyDataType_REFCHK(dtype)) {
+            /* Let the array clean up the stored references */
+            PyObject *exc, *val, *tb;
+            PyErr_Fetch(&exc, &val, &tb);
+            arr = rows_to_array(rows.data, dtype, homogeneous,
+                                rows.rows_allocated, layout.ncols);
+            PyErr_Restore(exc, val, tb);
+        }
+        if (arr != NULL) {
+            Py_DECREF(arr);
+        }
+        else {
+            PyDataMem_FREE(rows.data);
+        }
+    }
+    PyMem_FREE(layout.columns);
+    tokenizer_clear(&ts);
+    return NULL;
+}
@@ -0,0 +1,50 @@
+#ifndef _NPY_TEXTREADING_ROWS_H
+#define _NPY_TEXTREADING_ROWS_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/ndarraytypes.h"
+
+#include "textreading/stream.h"
+#include "textreading/parser_config.h"
+#include "textreading/conversions.h"
+
+
+/*
+ * How a column is stored: its dtype, the byte offset within a row and the
+ * converters.  `set_from_ucs4` may be NULL, `converter` is the Python
+ * converter used when it is NULL or fails.
+ */
+typedef struct {
+    PyArray_Descr *descr;
+    npy_intp offset;
+    set_from_ucs4_function *set_from_ucs4;
+    PyObject *converter;
+} field_type;
+
+
+/*
+ * Reads all rows of the stream into a new array.
+ *
+ * If `homogeneous` is set, `field_types` holds a single entry which is used
+ * for every column and the result has the shape (rows, columns) with
+ * `dtype`.  Otherwise, there is one field type for each column (extra
+ * columns are ignored) and the result has the shape (rows,) of the
+ * (structured) `dtype`.
+ *
+ * `user_converters` (a dict or NULL) maps column indices (after applying
+ * `usecols`) to converters which replace the default parsing.
+ *
+ * Returns Py_None if no line with data was found at all.
+ */
+NPY_NO_EXPORT PyObject *
+read_rows(stream *s, parser_config *config,
+        npy_intp skiplines, npy_intp max_rows,
+        npy_intp num_usecols, npy_intp *usecols,
+        PyArray_Descr *dtype, int homogeneous,
+        npy_intp num_field_types, field_type *field_types,
+        PyObject *user_converters, npy_intp chunksize);
+
+
+#endif  /* _NPY_TEXTREADING_ROWS_H */
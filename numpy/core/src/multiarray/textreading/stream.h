@@ -0,0 +1,43 @@
+#ifndef _NPY_TEXTREADING_STREAM_H
+#define _NPY_TEXTREADING_STREAM_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/npy_common.h"
+
+
+/*
+ * The kind of buffer returned by `stream_nextbuf`:
+ *
+ * BUFFER_MAY_CONTAIN_NEWLINE: a chunk of the file, lines are split at `\n`
+ *     and may continue into the next buffer.
+ * BUFFER_IS_LINEND: the buffer holds exactly one line (used when reading
+ *     from an iterable of lines), the line ends with the buffer.
+ * BUFFER_IS_FILEEND: there is no more data, the buffer is empty.
+ */
+enum {
+    BUFFER_MAY_CONTAIN_NEWLINE = 0,
+    BUFFER_IS_LINEND = 1,
+    BUFFER_IS_FILEEND = 2,
+};
+
+
+/*
+ * A stream of text, handed out as UCS4 buffers.  The buffer stays valid
+ * until the next call to `stream_nextbuf` or `stream_close`.
+ * Both functions return -1 with a Python error set on failure.
+ */
+typedef struct _stream {
+    int (*stream_nextbuf)(struct _stream *strm,
+            Py_UCS4 **start, Py_UCS4 **end, int *kind);
+    int (*stream_close)(struct _stream *strm);
+} stream;
+
+
+#define stream_nextbuf(s, start, end, kind)  \
+        ((s)->stream_nextbuf((s), (start), (end), (kind)))
+#define stream_close(s)  ((s)->stream_close((s)))
+
+
+#endif  /* _NPY_TEXTREADING_STREAM_H */
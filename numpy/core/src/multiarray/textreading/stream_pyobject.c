@@ -0,0 +1,230 @@
+/*
+ * Streams reading text from a Python file-like object or iterable.
+ *
+ * File-like objects are read in chunks using `read(chunksize)`, iterables
+ * are assumed to yield one line per item (as a file iterator does).  Items
+ * may be `str` or `bytes`; bytes are decoded using the requested encoding.
+ */
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#define _MULTIARRAYMODULE
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/arrayobject.h"
+
+#include "textreading/stream.h"
+#include "textreading/stream_pyobject.h"
+
+
+typedef struct {
+    stream stream;
+    /* The file-like object's `read` method, or the iterator */
+    PyObject *source;
+    PyObject *chunksize;
+    /* Incremental decoder used for bytes returned by `read` */
+    PyObject *decoder;
+    const char *encoding;
+    /* The UCS4 copy of the current chunk */
+    Py_UCS4 *buffer;
+    Py_ssize_t buffer_size;
+} python_stream;
+
+
+/*
+ * Copies the unicode object into the UCS4 buffer (steals the reference).
+ */
+static int
+python_stream_set_buffer(python_stream *ps, PyObject *str,
+        Py_UCS4 **start, Py_UCS4 **end)
+{
+    if (PyUnicode_READY(str) < 0) {
+        Py_DECREF(str);
+        return -1;
+    }
+    Py_ssize_t length = PyUnicode_GET_LENGTH(str);
+    if (length >= ps->buffer_size) {
+        Py_ssize_t new_size = length + 1;
+        Py_UCS4 *new_buffer = PyMem_Realloc(
+                ps->buffer, new_size * sizeof(Py_UCS4));
+        if (new_buffer == NULL) {
+            Py_DECREF(str);
+            PyErr_NoMemory();
+            return -1;
+        }
+        ps->buffer = new_buffer;
+        ps->buffer_size = new_size;
+    }
+    if (PyUnicode_AsUCS4(str, ps->buffer, ps->buffer_size, 1) == NULL) {
+        Py_DECREF(str);
+        return -1;
+    }
+    Py_DECREF(str);
+    *start = ps->buffer;
+    *end = ps->buffer + length;
+    return 0;
+}
+
+
+static int
+python_file_nextbuf(python_stream *ps,
+        Py_UCS4 **start, Py_UCS4 **end, int *kind)
+{
+    PyObject *chunk = PyObject_CallFunctionObjArgs(
+            ps->source, ps->chunksize, NULL);
+    if (chunk == NULL) {
+        return -1;
+    }
+    if (PyBytes_Check(chunk)) {
+        int final = PyBytes_GET_SIZE(chunk) == 0;
+        if (ps->decoder == NULL) {
+            ps->decoder = PyCodec_IncrementalDecoder(
+                    ps->encoding != NULL ? ps->encoding : "latin1", NULL);
+            if (ps->decoder == NULL) {
+                Py_DECREF(chunk);
+                return -1;
+            }
+        }
+        PyObject *str = PyObject_CallMethod(
+                ps->decoder, "decode", "Oi", chunk, final);
+        Py_DECREF(chunk);
+        if (str == NULL) {
+            return -1;
+        }
+        if (!PyUnicode_Check(str)) {
+            PyErr_SetString(PyExc_TypeError,
+                    "decoder did not return a string while reading a file");
+            Py_DECREF(str);
+            return -1;
+        }
+        if (final && PyUnicode_GET_LENGTH(str) == 0) {
+            Py_DECREF(str);
+            *start = *end = ps->buffer;
+            *kind = BUFFER_IS_FILEEND;
+            return 0;
+        }
+        chunk = str;
+    }
+    else if (!PyUnicode_Check(chunk)) {
+        PyErr_SetString(PyExc_TypeError,
+                "non-string returned while reading data");
+        Py_DECREF(chunk);
+        return -1;
+    }
+    else if (PyUnicode_GET_LENGTH(chunk) == 0) {
+        Py_DECREF(chunk);
+        *start = *end = ps->buffer;
+        *kind = BUFFER_IS_FILEEND;
+        return 0;
+    }
+    *kind = BUFFER_MAY_CONTAIN_NEWLINE;
+    return python_stream_set_buffer(ps, chunk, start, end);
+}
+
+
+static int
+python_iterable_nextbuf(python_stream *ps,
+        Py_UCS4 **start, Py_UCS4 **end, int *kind)
+{
+    PyObject *line = PyIter_Next(ps->source);
+    if (line == NULL) {
+        if (PyErr_Occurred()) {
+            return -1;
+        }
+        *start = *end = ps->buffer;
+        *kind = BUFFER_IS_FILEEND;
+        return 0;
+    }
+    if (PyBytes_Check(line)) {
+        PyObject *str = PyUnicode_Decode(
+                PyBytes_AS_STRING(line), PyBytes_GET_SIZE(line),
+                ps->encoding != NULL ? ps->encoding : "latin1", NULL);
+        Py_DECREF(line);
+        if (str == NULL) {
+            return -1;
+        }
+        line = str;
+    }
+    else if (!PyUnicode_Check(line)) {
+        PyErr_SetString(PyExc_TypeError,
+                "non-string returned while reading data");
+        Py_DECREF(line);
+        return -1;
+    }
+    *kind = BUFFER_IS_LINEND;
+    return python_stream_set_buffer(ps, line, start, end);
+}
+
+
+static int
+python_stream_close(python_stream *ps)
+{
+    Py_XDECREF(ps->source);
+    Py_XDECREF(ps->chunksize);
+    Py_XDECREF(ps->decoder);
+    PyMem_FREE(ps->buffer);
+    PyMem_FREE(ps);
+    return 0;
+}
+
+
+static python_stream *
+python_stream_new(const char *encoding)
+{
+    python_stream *ps = PyMem_Calloc(1, sizeof(python_stream));
+    if (ps == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    ps->encoding = encoding;
+    ps->stream.stream_close = (int (*)(stream *))&python_stream_close;
+    return ps;
+}
+
+
+NPY_NO_EXPORT stream *
+stream_python_file(PyObject *file, const char *encoding, npy_intp chunksize)
+{
+    python_stream *ps = python_stream_new(encoding);
+    if (ps == NULL) {
+        return NULL;
+    }
+    ps->stream.stream_nextbuf = (int (*)(stream *,
+            Py_UCS4 **, Py_UCS4 **, int *))&python_file_nextbuf;
+
+    ps->source = PyObject_GetAttrString(file, "read");
+    if (ps->source == NULL) {
+        goto fail;
+    }
+    ps->chunksize = PyLong_FromSsize_t(chunksize);
+    if (ps->chunksize == NULL) {
+        goto fail;
+    }
+    return (stream *)ps;
+
+  fail:
+    python_stream_close(ps);
+    return NULL;
+}
+
+
+NPY_NO_EXPORT stream *
+stream_python_iterable(PyObject *iterable, const char *encoding)
+{
+    python_stream *ps = python_stream_new(encoding);
+    if (ps == NULL) {
+        return NULL;
+    }
+    ps->stream.stream_nextbuf = (int (*)(stream *,
+            Py_UCS4 **, Py_UCS4 **, int *))&python_iterable_nextbuf;
+
+    ps->source = PyObject_GetIter(iterable);
+    if (ps->source == NULL) {
+        goto fail;
+    }
+    return (stream *)ps;
+
+  fail:
+    python_stream_close(ps);
+    return NULL;
+}
@@ -0,0 +1,24 @@
+#ifndef _NPY_TEXTREADING_STREAM_PYOBJECT_H
+#define _NPY_TEXTREADING_STREAM_PYOBJECT_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "textreading/stream.h"
+
+
+/*
+ * Streams reading from Python objects.  `encoding` is used to decode
+ * `bytes` returned by the object (latin1 if NULL).
+ *
+ * `stream_python_file` calls `file.read(chunksize)` repeatedly,
+ * `stream_python_iterable` treats every item of `iterable` as one line.
+ */
+NPY_NO_EXPORT stream *
+stream_python_file(PyObject *file, const char *encoding, npy_intp chunksize);
+
+NPY_NO_EXPORT stream *
+stream_python_iterable(PyObject *iterable, const char *encoding);
+
+
+#endif  /* _NPY_TEXTREADING_STREAM_PYOBJECT_H */
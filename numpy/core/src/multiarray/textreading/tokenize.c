@@ -0,0 +1,331 @@
+/*
+ * The tokenizer of `loadtxt`.  It mirrors what the Python implementation
+ * did for each line:
+ *
+ *     line = comment_regex.split(line, maxsplit=1)[0]
+ *     line = line.strip('\r\n')
+ *     fields = line.split(delimiter) if line else []
+ *
+ * with the addition of (optional) quoting.  Reading a line and splitting
+ * it are separate steps, so that `skiprows` can skip lines cheaply.
+ */
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+#define _MULTIARRAYMODULE
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/arrayobject.h"
+
+#include "textreading/stream.h"
+#include "textreading/tokenize.h"
+
+
+NPY_NO_EXPORT void
+tokenizer_init(tokenizer_state *ts)
+{
+    memset(ts, 0, sizeof(*ts));
+    ts->buf_kind = BUFFER_MAY_CONTAIN_NEWLINE;
+}
+
+
+NPY_NO_EXPORT void
+tokenizer_clear(tokenizer_state *ts)
+{
+    PyMem_RawFree(ts->line);
+    PyMem_RawFree(ts->fields);
+    ts->line = NULL;
+    ts->fields = NULL;
+    ts->line_size = 0;
+    ts->fields_size = 0;
+}
+
+
+/*
+ * The buffers are allocated with the raw allocator, which is thread safe,
+ * only the exception requires the GIL.
+ */
+static int
+memory_error(tokenizer_state *ts)
+{
+    if (!ts->nogil) {
+        PyErr_NoMemory();
+    }
+    return -1;
+}
+
+
+/*
+ * Makes sure the line can hold `length` characters plus a NUL.
+ */
+static int
+ensure_line_size(tokenizer_state *ts, npy_intp length)
+{
+    if (length < ts->line_size) {
+        return 0;
+    }
+    npy_intp new_size = ts->line_size < 64 ? 64 : ts->line_size;
+    while (new_size <= length) {
+        if (new_size > NPY_MAX_INTP / 2 / (npy_intp)sizeof(Py_UCS4)) {
+            return memory_error(ts);
+        }
+        new_size *= 2;
+    }
+    Py_UCS4 *new_line = PyMem_RawRealloc(
+            ts->line, new_size * sizeof(Py_UCS4));
+    if (new_line == NULL) {
+        return memory_error(ts);
+    }
+    ts->line = new_line;
+    ts->line_size = new_size;
+    return 0;
+}
+
+
+static int
+append_to_line(tokenizer_state *ts, const Py_UCS4 *str, npy_intp length)
+{
+    if (ensure_line_size(ts, ts->line_length + length) < 0) {
+        return -1;
+    }
+    memcpy(ts->line + ts->line_length, str, length * sizeof(Py_UCS4));
+    ts->line_length += length;
+    ts->line[ts->line_length] = '\0';
+    return 0;
+}
+
+
+static NPY_INLINE int
+matches_comment(parser_config *config, const Py_UCS4 *pos, const Py_UCS4 *end)
+{
+    for (npy_intp i = 0; i < config->num_comments; i++) {
+        npy_intp len = config->comment_lens[i];
+        if (len <= end - pos && memcmp(pos, config->comments[i],
+                                       len * sizeof(Py_UCS4)) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * Updates the quote and comment state for `ts->line[*scanned:]`, used to
+ * decide whether a newline ends the line.
+ */
+static void
+scan_quotes(tokenizer_state *ts, parser_config *config,
+        npy_intp *scanned, int *in_quote, int *in_comment)
+{
+    const Py_UCS4 *end = ts->line + ts->line_length;
+    for (const Py_UCS4 *p = ts->line + *scanned; p < end && !*in_comment; p++) {
+        if (*p == config->quote) {
+            *in_quote = !*in_quote;
+        }
+        else if (!*in_quote && matches_comment(config, p, end)) {
+            *in_comment = 1;
+        }
+    }
+    *scanned = ts->line_length;
+}
+
+
+NPY_NO_EXPORT int
+read_line(stream *s, tokenizer_state *ts, parser_config *config, int raw)
+{
+    int track_quotes = !raw && config->has_quote;
+    int in_quote = 0, in_comment = 0;
+    npy_intp scanned = 0;
+    int started = 0;
+
+    ts->line_length = 0;
+    if (ensure_line_size(ts, 0) < 0) {
+        return -1;
+    }
+    ts->line[0] = '\0';
+
+    while (1) {
+        if (ts->pos >= ts->end) {
+            if (ts->buf_kind == BUFFER_IS_FILEEND) {
+                return started ? 0 : 1;
+            }
+            if (stream_nextbuf(s, &ts->pos, &ts->end, &ts->buf_kind) < 0) {
+                return -1;
+            }
+            if (ts->buf_kind == BUFFER_IS_LINEND) {
+                /* The whole buffer is one line (iterables yield lines) */
+                npy_intp length = ts->end - ts->pos;
+                ts->pos = ts->end;
+                return append_to_line(ts, ts->end - length, length);
+            }
+            continue;
+        }
+        started = 1;
+
+        const Py_UCS4 *stop = ts->pos;
+        while (stop < ts->end && *stop != '\n') {
+            stop++;
+        }
+        if (append_to_line(ts, ts->pos, stop - ts->pos) < 0) {
+            return -1;
+        }
+        ts->pos = (Py_UCS4 *)stop;
+        if (stop == ts->end) {
+            /* The line continues in the next buffer */
+            continue;
+        }
+        /* Found a newline, it only ends the line if it is not quoted */
+        ts->pos++;
+        if (track_quotes) {
+            scan_quotes(ts, config, &scanned, &in_quote, &in_comment);
+            if (in_quote && !in_comment) {
+                const Py_UCS4 newline = '\n';
+                if (append_to_line(ts, &newline, 1) < 0) {
+                    return -1;
+                }
+                scanned = ts->line_length;
+                continue;
+            }
+        }
+        return 0;
+    }
+}
+
+
+static int
+add_field(tokenizer_state *ts, npy_intp offset, npy_intp length)
+{
+    if (ts->num_fields == ts->fields_size) {
+        npy_intp new_size = ts->fields_size < 16 ? 16 : 2 * ts->fields_size;
+        field_info *new_fields = PyMem_RawRealloc(
+                ts->fields, new_size * sizeof(field_info));
+        if (new_fields == NULL) {
+            return memory_error(ts);
+        }
+        ts->fields = new_fields;
+        ts->fields_size = new_size;
+    }
+    ts->fields[ts->num_fields].offset = offset;
+    ts->fields[ts->num_fields].length = length;
+    ts->num_fields++;
+    return 0;
+}
+
+
+NPY_NO_EXPORT int
+tokenize_line(tokenizer_state *ts, parser_config *config)
+{
+    Py_UCS4 *line = ts->line;
+    npy_intp start = 0, end = ts->line_length;
+    int has_quote = config->has_quote;
+    Py_UCS4 quote = config->quote;
+
+    ts->num_fields = 0;
+
+    /* Cut off comments (quoted comment characters are not comments) */
+    if (config->num_comments > 0) {
+        int in_quote = 0;
+        for (npy_intp i = 0; i < end; i++) {
+            if (has_quote && line[i] == quote) {
+                in_quote = !in_quote;
+            }
+            else if (!in_quote && matches_comment(config, line + i, line + end)) {
+                end = i;
+                break;
+            }
+        }
+    }
+    /* Strip line endings on both sides */
+    while (start < end && (line[start] == '\r' || line[start] == '\n')) {
+        start++;
+    }
+    while (end > start && (line[end-1] == '\r' || line[end-1] == '\n')) {
+        end--;
+    }
+    if (start == end) {
+        return 0;
+    }
+
+    /*
+     * Split the line, the fields are written back into the line buffer,
+     * unquoted and NUL terminated.  This is possible since the write
+     * position never overtakes the read position.
+     */
+    npy_intp i = start, w = start;
+    Py_UCS4 *delimiter = config->delimiter;
+    npy_intp delimiter_len = config->delimiter_len;
+
+    if (delimiter == NULL) {
+        while (i < end && Py_UNICODE_ISSPACE(line[i])) {
+            i++;
+        }
+        if (i == end) {
+            return 0;
+        }
+    }
+    while (1) {
+        npy_intp offset = w;
+        int in_quote = 0;
+        while (i < end) {
+            Py_UCS4 c = line[i];
+            if (has_quote && c == quote) {
+                if (in_quote && i + 1 < end && line[i+1] == quote) {
+                    /* A doubled quote inside quotes is a literal quote */
+                    line[w++] = quote;
+                    i += 2;
+                    continue;
+                }
+                in_quote = !in_quote;
+                i++;
+                continue;
+            }
+            if (!in_quote) {
+                if (delimiter == NULL) {
+                    if (Py_UNICODE_ISSPACE(c)) {
+                        break;
+                    }
+                }
+                else if (c == delimiter[0] && delimiter_len <= end - i &&
+                         memcmp(line + i, delimiter,
+                                delimiter_len * sizeof(Py_UCS4)) == 0) {
+                    break;
+                }
+            }
+            line[w++] = c;
+            i++;
+        }
+        if (add_field(ts, offset, w - offset) < 0) {
+            return -1;
+        }
+        if (i == end) {
+            line[w] = '\0';
+            return 0;
+        }
+        /* Consume the delimiter before writing the NUL terminator */
+        if (delimiter == NULL) {
+            while (i < end && Py_UNICODE_ISSPACE(line[i])) {
+                i++;
+            }
+            line[w++] = '\0';
+            if (i == end) {
+                return 0;
+            }
+        }
+        else {
+            i += delimiter_len;
+            line[w++] = '\0';
+        }
+    }
+}
+
+
+NPY_NO_EXPORT int
+tokenize(stream *s, tokenizer_state *ts, parser_config *config)
+{
+    int res = read_line(s, ts, config, 0);
+    if (res != 0) {
+        ts->num_fields = 0;
+        return res;
+    }
+    return tokenize_line(ts, config);
+}
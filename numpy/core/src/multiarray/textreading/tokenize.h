@@ -0,0 +1,72 @@
+#ifndef _NPY_TEXTREADING_TOKENIZE_H
+#define _NPY_TEXTREADING_TOKENIZE_H
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "numpy/npy_common.h"
+
+#include "textreading/stream.h"
+#include "textreading/parser_config.h"
+
+
+typedef struct {
+    /* Offset of the field within `tokenizer_state.line` */
+    npy_intp offset;
+    npy_intp length;
+} field_info;
+
+
+typedef struct {
+    /* The unconsumed part of the buffer last returned by the stream */
+    Py_UCS4 *pos;
+    Py_UCS4 *end;
+    int buf_kind;
+    /*
+     * The current line.  After tokenizing, the fields are stored in it
+     * (unquoted and NUL terminated), described by `fields`.
+     */
+    Py_UCS4 *line;
+    npy_intp line_length;
+    npy_intp line_size;
+
+    npy_intp num_fields;
+    npy_intp fields_size;
+    field_info *fields;
+    /*
+     * Set when used by a worker thread without the GIL (and without a
+     * stream): errors are then returned without setting an exception.
+     */
+    int nogil;
+} tokenizer_state;
+
+
+NPY_NO_EXPORT void
+tokenizer_init(tokenizer_state *ts);
+
+NPY_NO_EXPORT void
+tokenizer_clear(tokenizer_state *ts);
+
+/*
+ * Reads the next line into `ts->line` (without the line ending).  When
+ * `raw` is false and quoting is enabled, newlines inside quotes do not end
+ * the line.  Returns 0 on success, 1 at the end of the input and -1 on
+ * error.
+ */
+NPY_NO_EXPORT int
+read_line(stream *s, tokenizer_state *ts, parser_config *config, int raw);
+
+/*
+ * Splits the current line into fields: removes comments, strips `\r` and
+ * `\n` from both ends and splits at the delimiter.  Lines without content
+ * have no fields.
+ */
+NPY_NO_EXPORT int
+tokenize_line(tokenizer_state *ts, parser_config *config);
+
+/* `read_line` followed by `tokenize_line` */
+NPY_NO_EXPORT int
+tokenize(stream *s, tokenizer_state *ts, parser_config *config);
+
+
+#endif  /* _NPY_TEXTREADING_TOKENIZE_H */
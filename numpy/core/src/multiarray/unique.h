@@ -0,0 +1,10 @@
+#ifndef _NPY_PRIVATE__UNIQUE_H_
+#define _NPY_PRIVATE__UNIQUE_H_
+#include <numpy/ndarraytypes.h>
+
+NPY_NO_EXPORT PyObject *
+arr_unique_hash(PyObject *, PyObject *, PyObject *);
+NPY_NO_EXPORT PyObject *
+arr_isin_hash(PyObject *, PyObject *, PyObject *);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef __NPY_SIMD_QSORT_H__
+#define __NPY_SIMD_QSORT_H__
+
+#include "numpy/npy_common.h"
+#include "npy_cpu_dispatch.h"
+
+#ifndef NPY_DISABLE_OPTIMIZATION
+    #include "simd_qsort.dispatch.h"
+#endif
+
+/*
+ * Quicksort and argsort kernels of `simd_qsort.dispatch.c.src`, defined for
+ * the fixed width suffixes s8, u8, s16, u16, s32, u32, s64, u64, f32 and f64.
+ *
+ * The argsort kernel needs a temporary buffer and returns -NPY_ENOMEM if it
+ * cannot be allocated (leaving `tosort` untouched), otherwise 0.
+ */
+#define NPY__SIMD_QSORT_DECLARE(SFX) \
+    NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT void simd_quicksort_##SFX, \
+                             (void *start, npy_intp num)) \
+    NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT int simd_aquicksort_##SFX, \
+                             (void *vv, npy_intp *tosort, npy_intp num))
+
+NPY__SIMD_QSORT_DECLARE(s8)
+NPY__SIMD_QSORT_DECLARE(u8)
+NPY__SIMD_QSORT_DECLARE(s16)
+NPY__SIMD_QSORT_DECLARE(u16)
+NPY__SIMD_QSORT_DECLARE(s32)
+NPY__SIMD_QSORT_DECLARE(u32)
+NPY__SIMD_QSORT_DECLARE(s64)
+NPY__SIMD_QSORT_DECLARE(u64)
+NPY__SIMD_QSORT_DECLARE(f32)
+NPY__SIMD_QSORT_DECLARE(f64)
+
+#undef NPY__SIMD_QSORT_DECLARE
+
+#endif  /* __NPY_SIMD_QSORT_H__ */
@@ -0,0 +1,321 @@
+/*
+ * Type dispatch and threading for the cache blocked matrix multiplication
+ * kernels of `gemm.dispatch.c.src`, see `gemm.h`.
+ */
+#define _UMATHMODULE
+#define _MULTIARRAYMODULE
+#define NPY_NO_DEPRECATED_API NPY_API_VERSION
+
+#include "Python.h"
+
+#include "npy_config.h"
+#include "numpy/npy_common.h"
+#include "numpy/ndarraytypes.h"
+#include "numpy/halffloat.h"
+#include "npy_parallel.h"
+
+#include "gemm.h"
+
+
+/*
+ * Matrix-vector products waste most of the micro tiles, leave them (and
+ * other very thin products) to the simple loops.
+ */
+#define GEMM_MIN_DIM 4
+
+
+typedef int (gemm_kernel)(const char *a, npy_intp as_m, npy_intp as_n,
+                          const char *b, npy_intp bs_n, npy_intp bs_p,
+                          char *c, npy_intp cs_m, npy_intp cs_p,
+                          npy_intp m, npy_intp n, npy_intp p, int flags);
+
+
+/*
+ * Returns the kernel for the type (for complex types the kernel of the
+ * real and imaginary parts), or NULL if there is none.
+ */
+static gemm_kernel *
+gemm_get_kernel(int type_num)
+{
+    gemm_kernel *kernel = NULL;
+
+    switch (type_num) {
+        case NPY_BYTE:
+        case NPY_UBYTE:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_u8);
+            break;
+        case NPY_SHORT:
+        case NPY_USHORT:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_u16);
+            break;
+        case NPY_INT:
+        case NPY_UINT:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_u32);
+            break;
+        case NPY_LONG:
+        case NPY_ULONG:
+#if NPY_SIZEOF_LONG == 8
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_u64);
+#else
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_u32);
+#endif
+            break;
+        case NPY_LONGLONG:
+        case NPY_ULONGLONG:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_u64);
+            break;
+        case NPY_HALF:
+        case NPY_FLOAT:
+        case NPY_CFLOAT:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_f32);
+            break;
+        case NPY_DOUBLE:
+        case NPY_CDOUBLE:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_f64);
+            break;
+    }
+    return kernel;
+}
+
+
+typedef struct {
+    gemm_kernel *kernel;
+    /* offset of the imaginary part for complex types, otherwise 0 */
+    npy_intp imag;
+    const char *a;
+    npy_intp as_m, as_n;
+    const char *b;
+    npy_intp bs_n, bs_p;
+    char *c;
+    npy_intp cs_m, cs_p;
+    npy_intp m, n, p;
+    /* parallel jobs split the rows (or else the columns) of C */
+    int split_rows;
+    npy_intp ntasks;
+} gemm_job;
+
+
+/* Computes rows [i0, i1) and columns [j0, j1) of C */
+static int
+gemm_block(const gemm_job *job, npy_intp i0, npy_intp i1,
+           npy_intp j0, npy_intp j1)
+{
+    gemm_kernel *kernel = job->kernel;
+    const char *a = job->a + i0*job->as_m;
+    const char *b = job->b + j0*job->bs_p;
+    char *c = job->c + i0*job->cs_m + j0*job->cs_p;
+    npy_intp m = i1 - i0, n = job->n, p = j1 - j0, im = job->imag;
+
+    if (im == 0) {
+        return kernel(a, job->as_m, job->as_n, b, job->bs_n, job->bs_p,
+                      c, job->cs_m, job->cs_p, m, n, p, 0);
+    }
+    /* re(C) = re(A) re(B) - im(A) im(B), im(C) = re(A) im(B) + im(A) re(B) */
+    if (kernel(a, job->as_m, job->as_n, b, job->bs_n, job->bs_p,
+               c, job->cs_m, job->cs_p, m, n, p, 0) < 0 ||
+        kernel(a + im, job->as_m, job->as_n, b + im, job->bs_n, job->bs_p,
+               c, job->cs_m, job->cs_p, m, n, p,
+               NPY_GEMM_ACCUMULATE | NPY_GEMM_NEGATE) < 0 ||
+        kernel(a, job->as_m, job->as_n, b + im, job->bs_n, job->bs_p,
+               c + im, job->cs_m, job->cs_p, m, n, p, 0) < 0 ||
+        kernel(a + im, job->as_m, job->as_n, b, job->bs_n, job->bs_p,
+               c + im, job->cs_m, job->cs_p, m, n, p,
+               NPY_GEMM_ACCUMULATE) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+
+static int
+gemm_task(void *data, npy_intp itask, int NPY_UNUSED(ithread))
+{
+    const gemm_job *job = (const gemm_job *)data;
+    npy_intp start, stop;
+
+    if (job->split_rows) {
+        npy_parallel_chunk_bounds(job->m, job->ntasks, itask, 1,
+                                  &start, &stop);
+        return gemm_block(job, start, stop, 0, job->p);
+    }
+    npy_parallel_chunk_bounds(job->p, job->ntasks, itask, 16,
+                              &start, &stop);
+    return gemm_block(job, 0, job->m, start, stop);
+}
+
+
+static int
+gemm_run(gemm_job *job)
+{
+    double work = (double)job->m * (double)job->n * (double)job->p;
+    int nthreads = npy_parallel_threads_for_size(
+            work < NPY_MAX_INTP ? (npy_intp)work : NPY_MAX_INTP);
+
+    job->split_rows = job->m >= job->p;
+    job->ntasks = job->split_rows ? job->m : job->p;
+    if (nthreads < job->ntasks) {
+        job->ntasks = nthreads;
+    }
+    if (job->ntasks <= 1) {
+        return gemm_block(job, 0, job->m, 0, job->p);
+    }
+    /* The kernels only fail if memory runs out */
+    return npy_parallel_run(job->ntasks, (int)job->ntasks, &gemm_task, job);
+}
+
+
+/*
+ * float16 is computed in float32, with operands and result converted
+ * into temporary contiguous buffers.
+ */
+static int
+gemm_half(gemm_job *job)
+{
+    npy_intp m = job->m, n = job->n, p = job->p, i, j;
+    float *af = malloc(m * n * sizeof(float));
+    float *bf = malloc(n * p * sizeof(float));
+    float *cf = malloc(m * p * sizeof(float));
+    gemm_job fjob = *job;
+    int res = -1;
+
+    if (af == NULL || bf == NULL || cf == NULL) {
+        goto finish;
+    }
+    for (i = 0; i < m; i++) {
+        for (j = 0; j < n; j++) {
+            af[i*n + j] = npy_half_to_float(*(const npy_half *)(
+                    job->a + i*job->as_m + j*job->as_n));
+        }
+    }
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < p; j++) {
+            bf[i*p + j] = npy_half_to_float(*(const npy_half *)(
+                    job->b + i*job->bs_n + j*job->bs_p));
+        }
+    }
+    fjob.a = (const char *)af;
+    fjob.as_m = n * sizeof(float);
+    fjob.as_n = sizeof(float);
+    fjob.b = (const char *)bf;
+    fjob.bs_n = p * sizeof(float);
+    fjob.bs_p = sizeof(float);
+    fjob.c = (char *)cf;
+    fjob.cs_m = p * sizeof(float);
+    fjob.cs_p = sizeof(float);
+    if (gemm_run(&fjob) < 0) {
+        goto finish;
+    }
+    for (i = 0; i < m; i++) {
+        for (j = 0; j < p; j++) {
+            *(npy_half *)(job->c + i*job->cs_m + j*job->cs_p) =
+                    npy_float_to_half(cf[i*p + j]);
+        }
+    }
+    res = 0;
+
+  finish:
+    free(af);
+    free(bf);
+    free(cf);
+    return res;
+}
+
+
+NPY_NO_EXPORT int
+npy_gemm(int type_num,
+         const char *a, npy_intp as_m, npy_intp as_n,
+         const char *b, npy_intp bs_n, npy_intp bs_p,
+         char *c, npy_intp cs_m, npy_intp cs_p,
+         npy_intp m, npy_intp n, npy_intp p)
+{
+    gemm_job job;
+
+    if ((double)m * (double)n * (double)p < NPY_GEMM_MIN_WORK ||
+            m < GEMM_MIN_DIM || p < GEMM_MIN_DIM) {
+        return -1;
+    }
+    /*
+     * The micro tiles have more columns than rows, compute C.T = B.T @ A.T
+     * if C has more rows than columns.
+     */
+    if (m > p) {
+        const char *tmp_ptr;
+        npy_intp tmp;
+
+        tmp_ptr = a; a = b; b = tmp_ptr;
+        tmp = as_m; as_m = bs_p; bs_p = tmp;
+        tmp = as_n; as_n = bs_n; bs_n = tmp;
+        tmp = cs_m; cs_m = cs_p; cs_p = tmp;
+        tmp = m; m = p; p = tmp;
+    }
+    job.kernel = gemm_get_kernel(type_num);
+    if (job.kernel == NULL) {
+        return -1;
+    }
+    job.imag = 0;
+    if (type_num == NPY_CFLOAT) {
+        job.imag = sizeof(npy_float);
+    }
+    else if (type_num == NPY_CDOUBLE) {
+        job.imag = sizeof(npy_double);
+    }
+    job.a = a;
+    job.as_m = as_m;
+    job.as_n = as_n;
+    job.b = b;
+    job.bs_n = bs_n;
+    job.bs_p = bs_p;
+    job.c = c;
+    job.cs_m = cs_m;
+    job.cs_p = cs_p;
+    job.m = m;
+    job.n = n;
+    job.p = p;
+
+    if (type_num == NPY_HALF) {
+        return gemm_half(&job);
+    }
+    return gemm_run(&job);
+}
+
+
+typedef int (gemm_small_kernel)(
+        const char *a, npy_intp as_b, npy_intp as_m, npy_intp as_n,
+        const char *b, npy_intp bs_b, npy_intp bs_n, npy_intp bs_p,
+        char *c, npy_intp cs_b, npy_intp cs_m, npy_intp cs_p,
+        npy_intp nbatch, npy_intp m, npy_intp n, npy_intp p);
+
+
+NPY_NO_EXPORT int
+npy_gemm_small(int type_num,
+               const char *a, npy_intp as_b, npy_intp as_m, npy_intp as_n,
+               const char *b, npy_intp bs_b, npy_intp bs_n, npy_intp bs_p,
+               char *c, npy_intp cs_b, npy_intp cs_m, npy_intp cs_p,
+               npy_intp nbatch, npy_intp m, npy_intp n, npy_intp p)
+{
+    gemm_small_kernel *kernel = NULL;
+
+    switch (type_num) {
+        case NPY_INT:
+        case NPY_UINT:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_small_u32);
+            break;
+#if NPY_SIZEOF_LONG == 4
+        case NPY_LONG:
+        case NPY_ULONG:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_small_u32);
+            break;
+#endif
+        case NPY_FLOAT:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_small_f32);
+            break;
+        case NPY_DOUBLE:
+            NPY_CPU_DISPATCH_CALL(kernel = npy_gemm_small_f64);
+            break;
+    }
+    if (kernel == NULL) {
+        return -1;
+    }
+    return kernel(a, as_b, as_m, as_n, b, bs_b, bs_n, bs_p,
+                  c, cs_b, cs_m, cs_p, nbatch, m, n, p);
+}
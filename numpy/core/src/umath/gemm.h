@@ -0,0 +1,109 @@
+#ifndef _NPY_UMATH_GEMM_H_
+#define _NPY_UMATH_GEMM_H_
+
+#include "numpy/ndarraytypes.h"
+#include "npy_cpu_dispatch.h"
+
+#ifndef NPY_DISABLE_OPTIMIZATION
+    #include "gemm.dispatch.h"
+#endif
+
+/* Flags of the gemm kernels */
+/* Add the product to C instead of overwriting it */
+#define NPY_GEMM_ACCUMULATE 0x01
+/* Use -A instead of A (floating point kernels only) */
+#define NPY_GEMM_NEGATE 0x02
+
+/*
+ * Cache blocked matrix multiplication kernels of `gemm.dispatch.c.src`,
+ * computing C[m, p] = A[m, n] @ B[n, p] for arbitrary byte strides.
+ * The kernels are defined for the suffixes u8, u16, u32, u64, f32 and f64,
+ * the unsigned kernels also serve the signed integer types (the products
+ * are computed modulo 2**bits, which is identical for both).
+ *
+ * Every element of C is summed in order of increasing n, so integer results
+ * are identical to a naive loop.  Returns -1 if the packing buffers cannot
+ * be allocated (C is left untouched), 0 otherwise.  The GIL is not needed.
+ */
+#define NPY__GEMM_DECLARE(SFX) \
+    NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT int npy_gemm_##SFX, \
+        (const char *a, npy_intp as_m, npy_intp as_n, \
+         const char *b, npy_intp bs_n, npy_intp bs_p, \
+         char *c, npy_intp cs_m, npy_intp cs_p, \
+         npy_intp m, npy_intp n, npy_intp p, int flags))
+
+NPY__GEMM_DECLARE(u8)
+NPY__GEMM_DECLARE(u16)
+NPY__GEMM_DECLARE(u32)
+NPY__GEMM_DECLARE(u64)
+NPY__GEMM_DECLARE(f32)
+NPY__GEMM_DECLARE(f64)
+
+#undef NPY__GEMM_DECLARE
+
+/* Largest dimension handled by the stacked small matrix kernels */
+#define NPY_GEMM_SMALL_MAX 8
+
+/*
+ * Kernels for stacks of small matrices, computing
+ * C[b, m, p] = A[b, m, n] @ B[b, n, p] for `nbatch` products with all of
+ * m, n, p in [1, NPY_GEMM_SMALL_MAX].  The products are vectorized across
+ * the stack, the strides `*s_b` of the stack dimension may be 0.  Defined
+ * for the suffixes u32 (serving both 32 bit integer types), f32 and f64.
+ * Returns -1 without touching C if the dimensions or strides are not
+ * supported (or SIMD is not available), 0 otherwise.
+ */
+#define NPY__GEMM_SMALL_DECLARE(SFX) \
+    NPY_CPU_DISPATCH_DECLARE(NPY_NO_EXPORT int npy_gemm_small_##SFX, \
+        (const char *a, npy_intp as_b, npy_intp as_m, npy_intp as_n, \
+         const char *b, npy_intp bs_b, npy_intp bs_n, npy_intp bs_p, \
+         char *c, npy_intp cs_b, npy_intp cs_m, npy_intp cs_p, \
+         npy_intp nbatch, npy_intp m, npy_intp n, npy_intp p))
+
+NPY__GEMM_SMALL_DECLARE(u32)
+NPY__GEMM_SMALL_DECLARE(f32)
+NPY__GEMM_SMALL_DECLARE(f64)
+
+#undef NPY__GEMM_SMALL_DECLARE
+
+/*
+ * Matrix multiplication C[m, p] = A[m, n] @ B[n, p] of arrays of type
+ * `type_num` with the kernels above, split across the parallel thread pool
+ * for large products.  Supports the integer types, float16 (computed in
+ * float32), float32, float64, complex64 and complex128 in native byte order.
+ * Products with fewer than NPY_GEMM_MIN_WORK multiply-adds are not worth
+ * the packing and are rejected as well, like matrix-vector products.
+ *
+ * Returns 0 on success and -1 if the type or size is not supported or
+ * memory could not be allocated, in which case the caller has to fall back
+ * to a simple loop.  Does not need the GIL and never sets an exception.
+ */
+#define NPY_GEMM_MIN_WORK 4096
+
+NPY_NO_EXPORT int
+npy_gemm(int type_num,
+         const char *a, npy_intp as_m, npy_intp as_n,
+         const char *b, npy_intp bs_n, npy_intp bs_p,
+         char *c, npy_intp cs_m, npy_intp cs_p,
+         npy_intp m, npy_intp n, npy_intp p);
+
+/*
+ * Stacked products of small matrices of type `type_num` with the kernels
+ * above, the arguments are as for the kernels.  Types without a kernel are
+ * rejected.  Returns 0 on success and -1 if the caller has to fall back to
+ * computing the products one by one.
+ *
+ * They only pay off for stacks of at least NPY_GEMM_SMALL_MIN_BATCH
+ * products.  Callers check this for the whole stack, so that all parts of
+ * a stack split across threads use the same kernel.
+ */
+#define NPY_GEMM_SMALL_MIN_BATCH 8
+
+NPY_NO_EXPORT int
+npy_gemm_small(int type_num,
+               const char *a, npy_intp as_b, npy_intp as_m, npy_intp as_n,
+               const char *b, npy_intp bs_b, npy_intp bs_n, npy_intp bs_p,
+               char *c, npy_intp cs_b, npy_intp cs_m, npy_intp cs_p,
+               npy_intp nbatch, npy_intp m, npy_intp n, npy_intp p);
+
+#endif  /* _NPY_UMATH_GEMM_H_ */
@@ -48,6 +48,23 @@ legacy_array_method_auxdata_free(NpyAuxData *data)
 #undef NPY_LOOP_DATA_CACHE_SIZE
 
 
+/*
+ * The loop data is never modified by the loop, but threads executing the
+ * same loop in parallel still each require their own copy.
+ */
+static NpyAuxData *
+legacy_array_method_auxdata_clone(NpyAuxData *data)
+{
+    legacy_array_method_auxdata *res = PyMem_Malloc(
+            sizeof(legacy_array_method_auxdata));
+    if (res == NULL) {
+        return NULL;
+    }
+    memcpy(res, data, sizeof(legacy_array_method_auxdata));
+    return (NpyAuxData *)res;
+}
+
+
 NpyAuxData *
 get_new_loop_data(
         PyUFuncGenericFunction loop, void *user_data, int pyerr_check)
@@ -63,7 +80,7 @@ get_new_loop_data(
             return NULL;
         }
         data->base.free = legacy_array_method_auxdata_free;
-        data->base.clone = NULL;  /* no need for cloning (at least for now) */
+        data->base.clone = legacy_array_method_auxdata_clone;
     }
     data->loop = loop;
     data->user_data = user_data;
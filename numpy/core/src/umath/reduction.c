@@ -23,6 +23,7 @@
 #include "lowlevel_strided_loops.h"
 #include "reduction.h"
 #include "extobj.h"  /* for _check_ufunc_fperr */
+#include "npy_parallel.h"
 
 
 /*
@@ -140,6 +141,224 @@ PyArray_CopyInitialReduceValues(
     return size;
 }
 
+/*
+ * Parallel reductions.
+ *
+ * The simple (and most common) reductions over all elements of an array or
+ * over its last (contiguous) axis are split into parts which are reduced
+ * independently by multiple threads.  The parts are the blocks of
+ * `buffersize` elements which the iterator passes to the inner loop when
+ * executing serially.  Each row (a single one when reducing over all
+ * elements) is split into these blocks, and the partial results are combined
+ * into the result in order.  Thus, the parts do not depend on the number
+ * of threads and the result is the same for any number of threads.  For
+ * the usual reductions (additions using pairwise summation within a block,
+ * integer arithmetic, logical operations, minimum and maximum) it is also
+ * bit-identical to the result of a serial reduction.
+ */
+
+typedef struct {
+    PyUFuncGenericFunction innerloop;
+    void *innerloopdata;
+    /* The operand, the first element to reduce of row `i` is at
+     * `operand + i * row_stride` */
+    char *operand;
+    npy_intp row_stride, stride;
+    /* The result, one element per row */
+    char *result;
+    npy_intp result_stride;
+    npy_intp nrows;
+    /* Number of elements to reduce in each row */
+    npy_intp n;
+    /* Each row is split into `nparts` parts of `partsize` elements */
+    npy_intp partsize, nparts;
+    /* `nrows * nparts` partial results, NULL if rows are not split */
+    char *partials;
+    npy_intp itemsize;
+    /* Whether partial results start with the first element of the part */
+    int copy_first;
+    /* Number of rows handled by a task if rows are not split */
+    npy_intp rows_per_task;
+} parallel_reduce_data;
+
+
+/* Reduces `count` elements at `in` (with `stride`) into `out` */
+static NPY_INLINE void
+parallel_reduce_inner(const parallel_reduce_data *d, char *out,
+                      char *in, npy_intp stride, npy_intp count)
+{
+    char *args[3] = {out, in, out};
+    npy_intp strides[3] = {0, stride, 0};
+
+    d->innerloop(args, &count, strides, d->innerloopdata);
+}
+
+
+static int
+parallel_reduce_task(void *data, npy_intp itask, int NPY_UNUSED(ithread))
+{
+    const parallel_reduce_data *d = (const parallel_reduce_data *)data;
+
+    if (d->partials == NULL) {
+        /* Reduce whole rows directly into the result */
+        npy_intp start = itask * d->rows_per_task;
+        npy_intp stop = start + d->rows_per_task;
+        if (stop > d->nrows) {
+            stop = d->nrows;
+        }
+        for (npy_intp i = start; i < stop; i++) {
+            parallel_reduce_inner(d, d->result + i * d->result_stride,
+                                  d->operand + i * d->row_stride,
+                                  d->stride, d->n);
+        }
+        return 0;
+    }
+
+    npy_intp irow = itask / d->nparts;
+    npy_intp start = (itask % d->nparts) * d->partsize;
+    npy_intp count = d->n - start;
+    char *partial = d->partials + itask * d->itemsize;
+    char *in = d->operand + irow * d->row_stride + start * d->stride;
+
+    if (count > d->partsize) {
+        count = d->partsize;
+    }
+    if (d->copy_first) {
+        memcpy(partial, in, d->itemsize);
+        in += d->stride;
+        count--;
+    }
+    if (count > 0) {
+        parallel_reduce_inner(d, partial, in, d->stride, count);
+    }
+    return 0;
+}
+
+
+/*
+ * Tries to execute the reduction using multiple threads.  `result` must
+ * already be initialized and `skip_first_count` is the value returned by
+ * `PyArray_CopyInitialReduceValues` (or 0).
+ *
+ * Returns 1 if the reduction was done, 0 if it has to be done serially
+ * and -1 on error.
+ */
+static int
+try_parallel_reduce(PyArrayObject *result, PyArrayObject *operand,
+                    const npy_bool *axis_flags, npy_intp skip_first_count,
+                    npy_intp buffersize, PyArray_ParallelReduceInfo *info)
+{
+    int ndim = PyArray_NDIM(operand);
+    PyArray_Descr *descr = PyArray_DESCR(operand);
+    npy_intp size = PyArray_SIZE(operand);
+    npy_intp naxes = count_axes(ndim, axis_flags);
+    parallel_reduce_data d;
+    PyArrayObject *partials = NULL;
+    npy_intp ntasks;
+    int nthreads, res;
+
+    nthreads = npy_parallel_threads_for_size(size);
+    if (nthreads <= 1 || ndim == 0 || size == 0) {
+        return 0;
+    }
+    /* The inner loop is used without buffering */
+    if (!PyArray_EquivTypes(descr, PyArray_DESCR(result)) ||
+            !PyArray_ISNBO(descr->byteorder) ||
+            !PyArray_ISALIGNED(operand) || !PyArray_ISALIGNED(result)) {
+        return 0;
+    }
+
+    memset(&d, 0, sizeof(d));
+    d.itemsize = descr->elsize;
+    if (naxes == ndim && (ndim == 1 || PyArray_IS_C_CONTIGUOUS(operand) ||
+                          PyArray_IS_F_CONTIGUOUS(operand))) {
+        /* Reduction over all elements, viewed as a single row */
+        d.nrows = 1;
+        d.n = size;
+        d.stride = ndim == 1 ? PyArray_STRIDE(operand, 0) : d.itemsize;
+    }
+    else if (naxes == 1 && axis_flags[ndim - 1] &&
+             PyArray_IS_C_CONTIGUOUS(operand) &&
+             PyArray_IS_C_CONTIGUOUS(result)) {
+        /* Reduction over the last axis */
+        d.n = PyArray_DIM(operand, ndim - 1);
+        d.nrows = size / d.n;
+        d.stride = d.itemsize;
+        d.row_stride = d.n * d.itemsize;
+        d.result_stride = d.itemsize;
+    }
+    else {
+        return 0;
+    }
+
+    d.innerloop = info->innerloop;
+    d.innerloopdata = info->innerloopdata;
+    d.operand = PyArray_BYTES(operand);
+    d.result = PyArray_BYTES(result);
+    if (skip_first_count > 0) {
+        /* The first element of every row was copied into the result */
+        d.operand += d.stride;
+        d.n--;
+        if (d.n == 0) {
+            return 1;
+        }
+    }
+
+    /* Use the same blocks as the iterator does */
+    d.partsize = buffersize > 0 ? buffersize : NPY_BUFSIZE;
+    d.nparts = (d.n + d.partsize - 1) / d.partsize;
+    if (d.nparts == 1) {
+        /* Short rows are not split, but several are reduced per task */
+        d.rows_per_task = (d.partsize + d.n - 1) / d.n;
+        ntasks = (d.nrows + d.rows_per_task - 1) / d.rows_per_task;
+    }
+    else if (descr->type_num == NPY_HALF) {
+        /*
+         * The half precision loops sum up a whole block in single precision,
+         * so that combining rounded partial results gives different results.
+         */
+        return 0;
+    }
+    else {
+        ntasks = d.nrows * d.nparts;
+        Py_INCREF(descr);
+        partials = (PyArrayObject *)PyArray_NewFromDescr(
+                &PyArray_Type, descr, 1, &ntasks, NULL, NULL, 0, NULL);
+        if (partials == NULL) {
+            return -1;
+        }
+        d.copy_first = (info->identity == Py_None);
+        if (!d.copy_first &&
+                PyArray_FillWithScalar(partials, info->identity) < 0) {
+            Py_DECREF(partials);
+            return -1;
+        }
+        d.partials = PyArray_BYTES(partials);
+    }
+
+    NPY_BEGIN_THREADS_DEF;
+    NPY_BEGIN_THREADS;
+
+    res = npy_parallel_run(ntasks, nthreads, &parallel_reduce_task, &d);
+    if (res == 0 && d.partials != NULL) {
+        /* Combine the partial results of each row in order */
+        for (npy_intp i = 0; i < d.nrows; i++) {
+            char *out = d.result + i * d.result_stride;
+            char *row_partials = d.partials + i * d.nparts * d.itemsize;
+            for (npy_intp j = 0; j < d.nparts; j++) {
+                parallel_reduce_inner(&d, out,
+                                      row_partials + j * d.itemsize, 0, 1);
+            }
+        }
+    }
+
+    NPY_END_THREADS;
+
+    Py_XDECREF(partials);
+    return res == 0 ? 1 : -1;
+}
+
+
 /*
  * This function executes all the standard NumPy reduction function
  * boilerplate code, just calling the appropriate inner loop function where
@@ -168,6 +387,8 @@ PyArray_CopyInitialReduceValues(
  *               the reduction's unit.
  * loop        : `reduce_loop` from `ufunc_object.c`.  TODO: Refactor
  * data        : Data which is passed to the inner loop.
+ * parallel    : NULL, or the information needed to execute the reduction
+ *               using multiple threads (see `try_parallel_reduce`).
  * buffersize  : Buffer size for the iterator. For the default, pass in 0.
  * funcname    : The name of the reduction function, for error messages.
  * errormask   : forwarded from _get_bufsize_errmask
@@ -188,7 +409,8 @@ PyUFunc_ReduceWrapper(
         NPY_CASTING casting,
         npy_bool *axis_flags, int reorderable, int keepdims,
         PyObject *identity, PyArray_ReduceLoopFunc *loop,
-        void *data, npy_intp buffersize, const char *funcname, int errormask)
+        void *data, PyArray_ParallelReduceInfo *parallel,
+        npy_intp buffersize, const char *funcname, int errormask)
 {
     assert(loop != NULL);
     PyArrayObject *result = NULL;
@@ -331,6 +553,19 @@ PyUFunc_ReduceWrapper(
         goto fail;
     }
 
+    if (parallel != NULL && wheremask == NULL && !needs_api &&
+            NpyIter_GetIterSize(iter) != 0) {
+        int res = try_parallel_reduce(
+                result, NpyIter_GetOperandArray(iter)[1], axis_flags,
+                skip_first_count, buffersize, parallel);
+        if (res < 0) {
+            goto fail;
+        }
+        else if (res == 1) {
+            goto finish;
+        }
+    }
+
     if (NpyIter_GetIterSize(iter) != 0) {
         NpyIter_IterNextFunc *iternext;
         char **dataptr;
@@ -351,6 +586,7 @@ PyUFunc_ReduceWrapper(
         }
     }
 
+finish:
     /* Check whether any errors occurred during the loop */
     if (PyErr_Occurred() ||
             _check_ufunc_fperr(errormask, NULL, "reduce") < 0) {
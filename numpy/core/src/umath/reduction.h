@@ -107,6 +107,24 @@ typedef int (PyArray_ReduceLoopFunc)(NpyIter *iter,
                                             npy_intp skip_first_count,
                                             void *data);
 
+/*
+ * Information needed to split a reduction into parts which can be
+ * executed in parallel (see `npy_parallel.h`).  The inner loop is called
+ * directly on the unbuffered operand, so it must not require the Python API.
+ *
+ * innerloop     : The ufunc inner loop for (result, operand) -> result.
+ * innerloopdata : The data passed to the inner loop.
+ * identity      : The identity of the reduction operation which is used to
+ *                 start the partial results (this is not the `initial`
+ *                 value passed by the user).  If Py_None, each partial
+ *                 result starts with the first element of its part.
+ */
+typedef struct {
+    PyUFuncGenericFunction innerloop;
+    void *innerloopdata;
+    PyObject *identity;
+} PyArray_ParallelReduceInfo;
+
 /*
  * This function executes all the standard NumPy reduction function
  * boilerplate code, just calling the appropriate inner loop function where
@@ -133,6 +151,8 @@ typedef int (PyArray_ReduceLoopFunc)(NpyIter *iter,
  *               the reduction's unit.
  * loop        : The loop which does the reduction.
  * data        : Data which is passed to the inner loop.
+ * parallel    : NULL, or the information needed to execute the reduction
+ *               using multiple threads.
  * buffersize  : Buffer size for the iterator. For the default, pass in 0.
  * funcname    : The name of the reduction function, for error messages.
  * errormask   : forwarded from _get_bufsize_errmask
@@ -147,7 +167,8 @@ PyUFunc_ReduceWrapper(PyArrayObject *operand, PyArrayObject *out,
                       int keepdims,
                       PyObject *identity,
                       PyArray_ReduceLoopFunc *loop,
-                      void *data, npy_intp buffersize, const char *funcname,
+                      void *data, PyArray_ParallelReduceInfo *parallel,
+                      npy_intp buffersize, const char *funcname,
                       int errormask);
 
 #endif
@@ -42,6 +42,7 @@
 #include "reduction.h"
 #include "mem_overlap.h"
 #include "npy_hashtable.h"
+#include "npy_parallel.h"
 
 #include "ufunc_object.h"
 #include "override.h"
@@ -1173,6 +1174,238 @@ prepare_ufunc_output(PyUFuncObject *ufunc,
 }
 
 
+/*
+ * Multithreaded execution of elementwise loops.
+ *
+ * The iteration space is split into one chunk per thread and each thread
+ * calls the unmodified strided loop on its chunk.  Since every element is
+ * computed exactly as in the serial loop, the result is bit-identical.
+ * Each thread uses its own copy of the loop's auxiliary data and, when the
+ * iterator is used, its own (ranged) copy of the iterator.
+ */
+
+/* Chunk boundaries are multiples of this many elements */
+#define UFUNC_PARALLEL_ALIGN 64
+
+typedef struct {
+    PyArrayMethod_Context *context;
+    PyArrayMethod_StridedLoop *strided_loop;
+    /* One copy of the auxdata per thread (the first one is the original) */
+    NpyAuxData **auxdata;
+    npy_intp nchunks;
+    /* Used by the trivial loop */
+    int nop;
+    char **data;
+    npy_intp *strides;
+    npy_intp count;
+    /* Used by the iterator loop, one iterator per chunk */
+    NpyIter **iters;
+    NpyIter_IterNextFunc **iternexts;
+} ufunc_parallel_loop_data;
+
+
+static int
+ufunc_parallel_trivial_task(void *data, npy_intp itask, int ithread)
+{
+    ufunc_parallel_loop_data *ldata = (ufunc_parallel_loop_data *)data;
+    char *dataptrs[NPY_MAXARGS];
+    npy_intp start, stop, count;
+
+    npy_parallel_chunk_bounds(ldata->count, ldata->nchunks, itask,
+                              UFUNC_PARALLEL_ALIGN, &start, &stop);
+    if (start >= stop) {
+        return 0;
+    }
+    for (int iop = 0; iop < ldata->nop; iop++) {
+        dataptrs[iop] = ldata->data[iop] + start * ldata->strides[iop];
+    }
+    count = stop - start;
+    return ldata->strided_loop(ldata->context,
+            dataptrs, &count, ldata->strides, ldata->auxdata[ithread]);
+}
+
+
+static int
+ufunc_parallel_iterator_task(void *data, npy_intp itask, int ithread)
+{
+    ufunc_parallel_loop_data *ldata = (ufunc_parallel_loop_data *)data;
+    NpyIter *iter = ldata->iters[itask];
+    NpyIter_IterNextFunc *iternext = ldata->iternexts[itask];
+    int res;
+
+    if (iter == NULL) {
+        return 0;  /* empty chunk */
+    }
+    char **dataptr = NpyIter_GetDataPtrArray(iter);
+    npy_intp *strides = NpyIter_GetInnerStrideArray(iter);
+    npy_intp *countptr = NpyIter_GetInnerLoopSizePtr(iter);
+
+    do {
+        res = ldata->strided_loop(ldata->context,
+                dataptr, countptr, strides, ldata->auxdata[ithread]);
+    } while (res == 0 && iternext(iter));
+    return res;
+}
+
+
+/*
+ * Allocate the per-thread copies of the loop auxdata.  Returns -2 if the
+ * auxdata cannot be copied (the loop has to run serially then).
+ */
+static int
+ufunc_parallel_clone_auxdata(
+        NpyAuxData *auxdata, int nthreads, NpyAuxData ***out)
+{
+    if (auxdata != NULL && auxdata->clone == NULL) {
+        return -2;
+    }
+    NpyAuxData **res = PyMem_Calloc(nthreads, sizeof(NpyAuxData *));
+    if (res == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    res[0] = auxdata;
+    for (int i = 1; i < nthreads && auxdata != NULL; i++) {
+        res[i] = NPY_AUXDATA_CLONE(auxdata);
+        if (res[i] == NULL) {
+            for (int j = 1; j < i; j++) {
+                NPY_AUXDATA_FREE(res[j]);
+            }
+            PyMem_Free(res);
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    *out = res;
+    return 0;
+}
+
+
+static void
+ufunc_parallel_free_auxdata(NpyAuxData **auxdata, int nthreads)
+{
+    for (int i = 1; i < nthreads; i++) {
+        NPY_AUXDATA_FREE(auxdata[i]);
+    }
+    PyMem_Free(auxdata);
+}
+
+
+/*
+ * Runs the strided loop on `count` elements (without iterator) using
+ * `nthreads` threads.  Must be called with the GIL held, the GIL is released
+ * while the loop runs.  Returns -2 if the loop cannot be parallelized.
+ */
+static int
+execute_parallel_trivial_loop(PyArrayMethod_Context *context,
+        PyArrayMethod_StridedLoop *strided_loop, NpyAuxData *auxdata,
+        int nop, char **data, npy_intp count, npy_intp *strides,
+        int nthreads)
+{
+    ufunc_parallel_loop_data ldata = {
+        .context = context,
+        .strided_loop = strided_loop,
+        .nchunks = nthreads,
+        .nop = nop,
+        .data = data,
+        .strides = strides,
+        .count = count,
+    };
+    int res = ufunc_parallel_clone_auxdata(auxdata, nthreads, &ldata.auxdata);
+    if (res < 0) {
+        return res;
+    }
+    NPY_BEGIN_THREADS_DEF;
+    NPY_BEGIN_THREADS;
+    res = npy_parallel_run(nthreads, nthreads,
+                           &ufunc_parallel_trivial_task, &ldata);
+    NPY_END_THREADS;
+
+    ufunc_parallel_free_auxdata(ldata.auxdata, nthreads);
+    return res;
+}
+
+
+/*
+ * Runs the strided loop over a ranged iterator using `nthreads` threads.
+ * The iterator is split into consecutive iteration index ranges; the
+ * first range is iterated by `iter` itself, the others by copies of it.
+ * Must be called with the GIL held, the GIL is released while the loop
+ * runs.  Returns -2 if the loop cannot be parallelized.
+ */
+static int
+execute_parallel_iterator_loop(PyArrayMethod_Context *context,
+        PyArrayMethod_StridedLoop *strided_loop, NpyAuxData *auxdata,
+        NpyIter *iter, int nthreads)
+{
+    npy_intp size = NpyIter_GetIterSize(iter);
+    ufunc_parallel_loop_data ldata = {
+        .context = context,
+        .strided_loop = strided_loop,
+        .nchunks = nthreads,
+    };
+    int res = ufunc_parallel_clone_auxdata(auxdata, nthreads, &ldata.auxdata);
+    if (res < 0) {
+        return res;
+    }
+    ldata.iters = PyMem_Calloc(nthreads, sizeof(NpyIter *));
+    ldata.iternexts = PyMem_Calloc(nthreads, sizeof(NpyIter_IterNextFunc *));
+    if (ldata.iters == NULL || ldata.iternexts == NULL) {
+        PyErr_NoMemory();
+        res = -1;
+        goto finish;
+    }
+
+    for (int i = 0; i < nthreads; i++) {
+        npy_intp start, stop;
+        npy_parallel_chunk_bounds(size, nthreads, i,
+                                  UFUNC_PARALLEL_ALIGN, &start, &stop);
+        if (start >= stop) {
+            break;
+        }
+        NpyIter *chunk_iter = (i == 0) ? iter : NpyIter_Copy(iter);
+        if (chunk_iter == NULL) {
+            res = -1;
+            goto finish;
+        }
+        ldata.iters[i] = chunk_iter;
+        if (NpyIter_ResetToIterIndexRange(
+                chunk_iter, start, stop, NULL) != NPY_SUCCEED) {
+            res = -1;
+            goto finish;
+        }
+        ldata.iternexts[i] = NpyIter_GetIterNext(chunk_iter, NULL);
+        if (ldata.iternexts[i] == NULL) {
+            res = -1;
+            goto finish;
+        }
+    }
+
+    NPY_BEGIN_THREADS_DEF;
+    NPY_BEGIN_THREADS;
+    res = npy_parallel_run(nthreads, nthreads,
+                           &ufunc_parallel_iterator_task, &ldata);
+    NPY_END_THREADS;
+
+  finish:
+    if (ldata.iters != NULL) {
+        /* The copies resolve possible writeback operands when deallocated */
+        for (int i = 1; i < nthreads; i++) {
+            if (ldata.iters[i] != NULL &&
+                    !NpyIter_Deallocate(ldata.iters[i])) {
+                res = -1;
+            }
+        }
+    }
+    PyMem_Free(ldata.iters);
+    PyMem_Free(ldata.iternexts);
+    ufunc_parallel_free_auxdata(ldata.auxdata, nthreads);
+    return res;
+}
+
+#undef UFUNC_PARALLEL_ALIGN
+
+
 /*
  * Check whether a trivial loop is possible and call the innerloop if it is.
  * A trivial loop is defined as one where a single strided inner-loop call
@@ -1315,13 +1548,22 @@ try_trivial_single_output_loop(PyArrayMethod_Context *context,
     if (!(flags & NPY_METH_NO_FLOATINGPOINT_ERRORS)) {
         npy_clear_floatstatus_barrier((char *)context);
     }
+
+    int res = -2;
     if (!(flags & NPY_METH_REQUIRES_PYAPI)) {
-        NPY_BEGIN_THREADS_THRESHOLDED(count);
+        int nthreads = npy_parallel_threads_for_size(count);
+        if (nthreads > 1) {
+            res = execute_parallel_trivial_loop(context, strided_loop,
+                    auxdata, nop, data, count, fixed_strides, nthreads);
+        }
+    }
+    if (res == -2) {
+        if (!(flags & NPY_METH_REQUIRES_PYAPI)) {
+            NPY_BEGIN_THREADS_THRESHOLDED(count);
+        }
+        res = strided_loop(context, data, &count, fixed_strides, auxdata);
+        NPY_END_THREADS;
     }
-
-    int res = strided_loop(context, data, &count, fixed_strides, auxdata);
-
-    NPY_END_THREADS;
     NPY_AUXDATA_FREE(auxdata);
 
     if (res == 0 && !(flags & NPY_METH_NO_FLOATINGPOINT_ERRORS)) {
@@ -1357,6 +1599,52 @@ validate_casting(PyArrayMethodObject *method, PyUFuncObject *ufunc,
 }
 
 
+/*
+ * The size of the broadcast shape of the operands which are given (NULL
+ * outputs are skipped), saturating at NPY_MAX_INTP.  If the shapes do not
+ * broadcast, the result is meaningless but the iterator will fail anyway.
+ */
+static npy_intp
+broadcast_size(int nop, PyArrayObject **op)
+{
+    npy_intp shape[NPY_MAXDIMS];
+    npy_intp size = 1;
+    int ndim = 0;
+
+    for (int i = 0; i < nop; i++) {
+        if (op[i] == NULL) {
+            continue;
+        }
+        int op_ndim = PyArray_NDIM(op[i]);
+        npy_intp *dims = PyArray_DIMS(op[i]);
+        for (int idim = 0; idim < op_ndim; idim++) {
+            int j = NPY_MAXDIMS - op_ndim + idim;
+            if (NPY_MAXDIMS - j > ndim) {
+                shape[j] = dims[idim];
+            }
+            else if (shape[j] == 1 || dims[idim] == 0) {
+                shape[j] = dims[idim];
+            }
+        }
+        if (op_ndim > ndim) {
+            ndim = op_ndim;
+        }
+    }
+    for (int j = NPY_MAXDIMS - ndim; j < NPY_MAXDIMS; j++) {
+        if (shape[j] == 0) {
+            return 0;
+        }
+        if (size > NPY_MAX_INTP / shape[j]) {
+            size = NPY_MAX_INTP;
+        }
+        else {
+            size *= shape[j];
+        }
+    }
+    return size;
+}
+
+
 /*
  * The ufunc loop implementation for both normal ufunc calls and masked calls
  * when the iterator has to be used.
@@ -1419,6 +1707,15 @@ execute_ufunc_loop(PyArrayMethod_Context *context, int masked,
                  NPY_ITER_DELAY_BUFALLOC |
                  NPY_ITER_COPY_IF_OVERLAP;
 
+    /*
+     * Ranged iteration allows splitting the loop across threads, it is only
+     * requested when the loop is large enough to be split.
+     */
+    if (!(iter_flags & NPY_ITER_REDUCE_OK) &&
+            npy_parallel_threads_for_size(broadcast_size(nop, op)) > 1) {
+        iter_flags |= NPY_ITER_RANGED;
+    }
+
     /*
      * Call the __array_prepare__ functions for already existing output arrays.
      * Do this before creating the iterator, as the iterator may UPDATEIFCOPY
@@ -1548,19 +1845,31 @@ execute_ufunc_loop(PyArrayMethod_Context *context, int masked,
     if (!(flags & NPY_METH_NO_FLOATINGPOINT_ERRORS)) {
         npy_clear_floatstatus_barrier((char *)context);
     }
-    if (!needs_api && !(flags & NPY_METH_REQUIRES_PYAPI)) {
-        NPY_BEGIN_THREADS_THRESHOLDED(full_size);
+
+    int res = -2;
+    if (!needs_api && !(flags & NPY_METH_REQUIRES_PYAPI) &&
+            (iter_flags & NPY_ITER_RANGED)) {
+        int nthreads = npy_parallel_threads_for_size(full_size);
+        if (nthreads > 1) {
+            NPY_UF_DBG_PRINT1("Parallel inner loop, %d threads\n", nthreads);
+            res = execute_parallel_iterator_loop(context, strided_loop,
+                    auxdata, iter, nthreads);
+        }
     }
+    if (res == -2) {
+        if (!needs_api && !(flags & NPY_METH_REQUIRES_PYAPI)) {
+            NPY_BEGIN_THREADS_THRESHOLDED(full_size);
+        }
 
-    NPY_UF_DBG_PRINT("Actual inner loop:\n");
-    /* Execute the loop */
-    int res;
-    do {
-        NPY_UF_DBG_PRINT1("iterator loop count %d\n", (int)*countptr);
-        res = strided_loop(context, dataptr, countptr, strides, auxdata);
-    } while (res == 0 && iternext(iter));
+        NPY_UF_DBG_PRINT("Actual inner loop:\n");
+        /* Execute the loop */
+        do {
+            NPY_UF_DBG_PRINT1("iterator loop count %d\n", (int)*countptr);
+            res = strided_loop(context, dataptr, countptr, strides, auxdata);
+        } while (res == 0 && iternext(iter));
 
-    NPY_END_THREADS;
+        NPY_END_THREADS;
+    }
     NPY_AUXDATA_FREE(auxdata);
 
     if (res == 0 && !(flags & NPY_METH_NO_FLOATINGPOINT_ERRORS)) {
@@ -2998,30 +3307,52 @@ PyUFunc_Reduce(PyUFuncObject *ufunc, PyArrayObject *arr, PyArrayObject *out,
         * object arrays can't be used in general
         */
         if (initial != Py_None && PyArray_ISOBJECT(arr) && PyArray_SIZE(arr) != 0) {
-            Py_DECREF(initial);
             initial = Py_None;
-            Py_INCREF(initial);
         }
-    } else {
-        Py_DECREF(identity);
-        Py_INCREF(initial);  /* match the reference count in the if above */
     }
+    Py_INCREF(initial);
 
     /* Get the reduction dtype */
     if (reduce_type_resolver(ufunc, arr, odtype, &dtype) < 0) {
+        Py_DECREF(identity);
         Py_DECREF(initial);
         return NULL;
     }
 
+    /*
+     * Reorderable reductions may be split up for parallel execution, this
+     * requires an inner loop which can run without the Python API.
+     */
+    PyArray_ParallelReduceInfo parallel_info;
+    PyArray_ParallelReduceInfo *parallel = NULL;
+    if (reorderable && npy_parallel_get_num_threads() > 1 &&
+            PyArray_SIZE(arr) >= npy_parallel_get_threshold()) {
+        PyArray_Descr *dtypes[3] = {dtype, dtype, dtype};
+        int needs_api = 0;
+
+        if (ufunc->legacy_inner_loop_selector(ufunc, dtypes,
+                &parallel_info.innerloop, &parallel_info.innerloopdata,
+                &needs_api) < 0) {
+            /* The error is raised again by the serial reduction */
+            PyErr_Clear();
+        }
+        else if (!needs_api) {
+            parallel_info.identity = identity;
+            parallel = &parallel_info;
+        }
+    }
+
     result = PyUFunc_ReduceWrapper(arr, out, wheremask, dtype, dtype,
                                    NPY_UNSAFE_CASTING,
                                    axis_flags, reorderable,
                                    keepdims,
                                    initial,
                                    reduce_loop,
-                                   ufunc, buffersize, ufunc_name, errormask);
+                                   ufunc, parallel,
+                                   buffersize, ufunc_name, errormask);
 
     Py_DECREF(dtype);
+    Py_DECREF(identity);
     Py_DECREF(initial);
     return result;
 }
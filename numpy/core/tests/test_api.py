@@ -295,6 +295,21 @@ def test_array_astype_to_string_discovery_empty(dt):
     # as well as for the object as a descriptor:
     assert np.can_cast("O", dt, casting="unsafe")
 
+@pytest.mark.parametrize("from_dt", ["f4", "f8", ">f4", ">f8"])
+@pytest.mark.parametrize("to_dt", ["S", "U", "S5", "U5", "S40", "U40"])
+def test_array_astype_float_to_string(from_dt, to_dt):
+    # Floats are formatted like `str` of the scalar, truncated to the
+    # itemsize if it is given.
+    arr = np.array([0., -0., 1.5, -1e-300, 1e16, 0.1, 123456.789,
+                    np.inf, -np.inf, np.nan], dtype=from_dt)
+    res = arr.astype(to_dt)
+    res_strided = arr[::-1].astype(to_dt)[::-1]
+    expected = np.array([str(x) for x in arr], dtype=to_dt[0])
+    if len(to_dt) > 1:
+        expected = expected.astype(to_dt)
+    assert_array_equal(res, expected)
+    assert_array_equal(res_strided, expected)
+
 @pytest.mark.parametrize("dt", ["d", "f", "S13", "U32"])
 def test_array_astype_to_void(dt):
     dt = np.dtype(dt)
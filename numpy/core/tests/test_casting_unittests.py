@@ -658,6 +658,36 @@ def test_void_and_structured_with_subarray(self, casting):
         assert np.can_cast("V4", dtype, casting=casting) == expected
         assert np.can_cast(dtype, "V4", casting=casting) == expected
 
+    @pytest.mark.parametrize("from_dt", "?BHILQbhilqefd")
+    @pytest.mark.parametrize("to_dt", "?BHILQbhilqefd")
+    def test_contiguous_cast_kernels(self, from_dt, to_dt):
+        # Many aligned contiguous casts use vectorized kernels, which must
+        # give the same results as the strided loops.
+        rng = np.random.RandomState(0)
+        from_dt, to_dt = np.dtype(from_dt), np.dtype(to_dt)
+        if from_dt.kind == "b":
+            # bools which are neither 0 nor 1
+            arr = rng.randint(0, 3, 1003).astype(np.uint8).view(from_dt)
+        elif from_dt.kind == "f":
+            arr = (rng.standard_normal(1003) * 100).astype(from_dt)
+            if to_dt.kind in "iu":
+                # out of range float to int casts are undefined
+                arr = abs(arr) % np.iinfo(to_dt).max // 2
+            else:
+                arr[::37] = [np.nan, np.inf, -np.inf, -0.0] * 7
+                # NaNs with payloads (also signaling ones) are preserved
+                bits = arr.view("u%d" % arr.itemsize)
+                bits[1::101] = bits[0] | (np.arange(1, 11) << 4)
+        else:
+            info = np.iinfo(from_dt)
+            arr = rng.randint(info.min, info.max, 1003, dtype=from_dt)
+
+        for offset in [0, 1, 8]:
+            contig = arr[offset:].astype(to_dt)
+            strided = np.empty((1003 - offset, 2), dtype=to_dt)[:, 0]
+            strided[...] = arr[offset:]
+            assert contig.tobytes() == strided.tobytes()
+
     @pytest.mark.parametrize("dtype", np.typecodes["All"])
     def test_object_casts_NULL_None_equivalence(self, dtype):
         # None to <other> casts may succeed or fail, but a NULL'ed array must
@@ -351,6 +351,38 @@ def test_trivial_fancy_not_possible(self):
         res[3] = -1
         assert_array_equal(a, res)
 
+    @pytest.mark.parametrize("dtype", ["i4", "f4", "i8", "f8", "c8"])
+    @pytest.mark.parametrize("size", [7, 1000, 10**6])
+    def test_trivial_fancy_gather(self, dtype, size):
+        # 4 and 8 byte items with contiguous indices use gather kernels,
+        # large arrays are prefetched instead of gathered by hardware
+        rng = np.random.RandomState(0)
+        a = (rng.random_sample(size) * 1000).astype(dtype)
+        ind = rng.randint(-size, size, size=1003)
+        expected = np.array([a[i] for i in ind], dtype=dtype)
+        assert_array_equal(a[ind], expected)
+        assert_array_equal(a[::-2][ind // 2], a[::-2][list(ind // 2)])
+        assert_array_equal(a[ind[::2]], expected[::2])
+
+        b = a.copy()
+        b[ind] = expected[::-1]
+        res = a.copy()
+        for i, v in zip(ind, expected[::-1]):
+            res[i] = v
+        assert_array_equal(b, res)
+        b[ind] = 3
+        res[ind] = np.full(ind.shape, 3, dtype=dtype)
+        assert_array_equal(b, res)
+
+    def test_trivial_fancy_gather_out_of_bounds(self):
+        a = np.arange(10**6, dtype=np.float64)
+        ind = np.arange(100) * 10**4
+        for bad in [10**6, -10**6 - 1]:
+            ind[50] = bad
+            assert_raises(IndexError, a.__getitem__, ind)
+            assert_raises(IndexError, a.__setitem__, ind, -1.)
+            assert_array_equal(a, np.arange(10**6))
+
     def test_nonbaseclass_values(self):
         class SubClass(np.ndarray):
             def __array_finalize__(self, old):
@@ -1330,6 +1362,95 @@ def test_boolean_indexing_fast_path(self):
             "dimension is 1 but corresponding boolean dimension is 2",
             lambda: a[idx])
 
+    @pytest.mark.parametrize("dtype", ["u1", "i2", "f4", "f8", "c8"])
+    @pytest.mark.parametrize("size", [0, 7, 64, 65, 1000, 100003])
+    @pytest.mark.parametrize("p", [0, 0.01, 0.5, 1])
+    def test_boolean_mask_kernels(self, dtype, size, p):
+        # Contiguous arrays of 1, 2, 4 or 8 byte items indexed by a mask
+        # of the same shape are compacted/expanded by the mask kernels
+        rng = np.random.RandomState(0)
+        a = (rng.random_sample(size) * 100).astype(dtype)
+        mask = rng.random_sample(size) < p
+        ind = np.array([i for i in range(size) if mask[i]], dtype=np.intp)
+        assert_array_equal(a[mask], a[ind])
+        assert_array_equal(a.reshape(1, -1)[mask.reshape(1, -1)], a[ind])
+
+        b = a.copy()
+        values = (rng.random_sample(len(ind)) * 100).astype(dtype)
+        b[mask] = values
+        res = a.copy()
+        res[ind] = values
+        assert_array_equal(b, res)
+        b[mask] = 3
+        res[ind] = 3
+        assert_array_equal(b, res)
+
+    def test_boolean_mask_kernels_non_canonical(self):
+        # Any non-zero byte of the mask counts as True
+        a = np.arange(1000.)
+        raw = (np.arange(1000) % 3).astype(np.uint8) * 2
+        mask = raw.view(np.bool_)
+        assert_array_equal(a[mask], a[raw != 0])
+        a[mask] = -1
+        assert_array_equal(a[raw != 0], -1)
+        assert_array_equal(a[raw == 0], np.arange(0, 1000, 3))
+
+    def test_boolean_mask_kernels_overlap(self):
+        # Values overlapping the indexed array are assigned element by
+        # element in order, as they always were
+        a = np.arange(100)
+        mask = a % 2 == 1
+        a[mask] = a[:50]
+        res = np.arange(100)
+        for k, i in enumerate(range(1, 100, 2)):
+            res[i] = res[k]
+        assert_array_equal(a, res)
+
+    @pytest.mark.parametrize("threads", [1, 2, 3, 8])
+    def test_boolean_mask_kernels_threads(self, threads):
+        rng = np.random.RandomState(0)
+        a = rng.random_sample(200001)
+        mask = a < 0.3
+        ind = np.flatnonzero(a < 0.3)
+        with np.parallelstate(threads=threads, threshold=1):
+            assert_array_equal(a[mask], a[ind])
+            assert_array_equal(np.nonzero(mask)[0], ind)
+            b = a.copy()
+            b[mask] = np.arange(len(ind))
+        res = a.copy()
+        res[ind] = np.arange(len(ind))
+        assert_array_equal(b, res)
+
+    @pytest.mark.skipif(not sys.platform.startswith("linux"),
+                        reason="uses mprotect")
+    @pytest.mark.parametrize("dtype", ["u1", "i2", "f4", "f8"])
+    @pytest.mark.parametrize("size", [1, 4, 7, 8, 100])
+    def test_boolean_mask_kernels_end_of_page(self, dtype, size):
+        # The kernels must not read past the end of the mask, place it
+        # right before a page which cannot be accessed
+        ctypes = pytest.importorskip("ctypes")
+        mmap = pytest.importorskip("mmap")
+        libc = ctypes.CDLL(None, use_errno=True)
+        libc.mprotect.argtypes = [ctypes.c_void_p, ctypes.c_size_t,
+                                  ctypes.c_int]
+        page = mmap.PAGESIZE
+        buf = mmap.mmap(-1, 2 * page)
+        addr = ctypes.addressof(ctypes.c_char.from_buffer(buf))
+        if libc.mprotect(addr + page, page, 0) != 0:  # PROT_NONE
+            pytest.skip("mprotect failed")
+
+        mask = np.frombuffer(buf, dtype=np.bool_, count=size,
+                             offset=page - size)
+        a = np.arange(size).astype(dtype)
+        for value in [True, False]:
+            mask[...] = value
+            ind = np.arange(size) if value else np.arange(0)
+            assert_array_equal(a[mask], a[ind])
+            assert_array_equal(np.nonzero(mask)[0], ind)
+            b = a.copy()
+            b[mask] = 0
+            assert_array_equal(b[ind], 0)
+
 
 class TestArrayToIndexDeprecation:
     """Creating an an index from array not 0-D is an error.
@@ -1,5 +1,7 @@
 import sys
 
+import pytest
+
 import numpy as np
 from numpy.testing import (
     assert_, assert_raises, assert_array_equal, HAS_REFCOUNT
@@ -62,6 +64,54 @@ def test_refcounting(self):
             if HAS_REFCOUNT:
                 assert_(all(sys.getrefcount(o) == 3 for o in objects))
 
+    @pytest.mark.parametrize("dtype", ["i4", "f4", "i8", "f8"])
+    @pytest.mark.parametrize("index_dtype", ["i4", "i8", "u1"])
+    @pytest.mark.parametrize("size", [5, 1000, 10**6])
+    def test_gather(self, dtype, index_dtype, size):
+        # 4 and 8 byte items use gather kernels for int32 and intp indices
+        rng = np.random.RandomState(0)
+        a = (rng.random_sample(size) * 1000).astype(dtype)
+        low = -size if index_dtype[0] == "i" else 0
+        ind = rng.randint(low, min(size, 256), size=1001).astype(index_dtype)
+        expected = np.array([a[i] for i in ind], dtype=dtype)
+        for mode in ('raise', 'wrap'):
+            assert_array_equal(a.take(ind, mode=mode), expected)
+        assert_array_equal(a.take(ind, mode='clip'),
+                           a[np.clip(ind, 0, size - 1)])
+
+        a2 = np.stack([a, -a, 2 * a])
+        assert_array_equal(a2.take(ind, axis=1),
+                           np.stack([expected, -expected, 2 * expected]))
+        out = np.empty((3, ind.size), dtype=dtype)
+        a2.take(ind, axis=1, out=out)
+        assert_array_equal(out[1], -expected)
+
+    @pytest.mark.parametrize("index_dtype", ["i4", "i8"])
+    def test_gather_out_of_bounds(self, index_dtype):
+        a = np.arange(100, dtype=np.float64)
+        ind = np.array([1, 5, 100, -101, 7], dtype=index_dtype)
+        assert_raises(IndexError, a.take, ind)
+        assert_array_equal(a.take(ind, mode='wrap'), [1, 5, 0, 99, 7])
+        assert_array_equal(a.take(ind, mode='clip'), [1, 5, 99, 0, 7])
+        out = np.zeros(5)
+        assert_raises(IndexError, a.take, ind, out=out)
+        assert_array_equal(out, 0)
+
+    @pytest.mark.parametrize("dtype", ["S8", "V8", "c8", "S4"])
+    @pytest.mark.parametrize("index_dtype", ["i4", "i8"])
+    def test_gather_unaligned(self, dtype, index_dtype):
+        # Items need not be uint aligned, then the generic loop is used
+        buf = np.zeros(8 * 100 + 1, dtype=np.uint8)
+        buf[1:] = np.arange(8 * 100) % 251
+        a = buf[1:].view(dtype)
+        ind = np.array([3, 0, 99, 3, -1], dtype=index_dtype)
+        expected = np.array([a[i] for i in ind], dtype=dtype)
+        assert_array_equal(a.take(ind), expected)
+        size = np.dtype(dtype).itemsize
+        out = np.zeros(size * 5 + 1, dtype=np.uint8)[1:].view(dtype)
+        a.take(ind, out=out)
+        assert_array_equal(out, expected)
+
     def test_unicode_mode(self):
         d = np.arange(10)
         k = b'\xc3\xa4'.decode("UTF8")
@@ -0,0 +1,407 @@
+import os
+import pickle
+import threading
+import time
+
+import pytest
+
+import numpy as np
+from numpy.core.multiarray import get_handler_name, get_handler_version
+from numpy.testing import assert_, assert_equal, assert_raises
+
+
+POLICIES = [
+    "default_allocator",
+    "aligned_allocator",
+    "hugepage_allocator",
+    "numa_local_allocator",
+    "numa_interleave_allocator",
+    "arena_allocator",
+]
+
+# Sizes below and above the thresholds of the hugepage and NUMA allocators
+SIZES = [0, 1, 1000, 3 * 2**20 // 8 + 17]
+
+
+class TestAllocatorState:
+    def test_default(self):
+        assert_equal(np.getallocator(), "default_allocator")
+        assert_equal(get_handler_name(), "default_allocator")
+        assert_equal(get_handler_name(np.ones(3)), "default_allocator")
+        assert_equal(get_handler_version(np.ones(3)), 1)
+
+    def test_setallocator(self):
+        old = np.setallocator("aligned_allocator")
+        try:
+            assert_equal(old, "default_allocator")
+            assert_equal(np.getallocator(), "aligned_allocator")
+            assert_equal(get_handler_name(np.ones(3)), "aligned_allocator")
+        finally:
+            assert_equal(np.setallocator(old), "aligned_allocator")
+        assert_equal(np.getallocator(), "default_allocator")
+
+    def test_allocatorstate(self):
+        with np.allocatorstate("arena_allocator"):
+            assert_equal(np.getallocator(), "arena_allocator")
+            a = np.ones(10)
+            with np.allocatorstate("aligned_allocator"):
+                assert_equal(get_handler_name(np.ones(3)),
+                             "aligned_allocator")
+            assert_equal(np.getallocator(), "arena_allocator")
+        assert_equal(np.getallocator(), "default_allocator")
+        assert_equal(get_handler_name(a), "arena_allocator")
+        assert_equal(a.sum(), 10)
+
+    def test_allocatorstate_decorator(self):
+        @np.allocatorstate("hugepage_allocator")
+        def f():
+            return np.getallocator()
+
+        assert_equal(f(), "hugepage_allocator")
+        assert_equal(np.getallocator(), "default_allocator")
+
+    def test_capsule(self):
+        # A capsule is accepted wherever a name is
+        capsule = np.core.multiarray._get_allocator_handler(
+            "aligned_allocator")
+        with np.allocatorstate(capsule):
+            assert_equal(np.getallocator(), "aligned_allocator")
+        old = np.setallocator(capsule)
+        try:
+            assert_equal(np.setallocator(old), "aligned_allocator")
+        finally:
+            np.setallocator("default_allocator")
+
+    def test_invalid(self):
+        assert_raises(ValueError, np.setallocator, "no_such_allocator")
+        assert_raises(ValueError, np.allocatorstate("no_allocator").__enter__)
+        assert_raises(TypeError, np.setallocator, 3)
+        assert_raises(ValueError, get_handler_name, [1, 2])
+        assert_equal(np.getallocator(), "default_allocator")
+
+    def test_view_has_no_handler(self):
+        a = np.arange(10)
+        assert_(get_handler_name(a[::2]) is None)
+        assert_(get_handler_name(a.reshape(2, 5)) is None)
+        assert_(get_handler_version(a[1:]) is None)
+
+    def test_thread_uses_process_default(self):
+        names = []
+
+        def run():
+            names.append(get_handler_name(np.ones(3)))
+
+        with np.allocatorstate("arena_allocator"):
+            t = threading.Thread(target=run)
+            t.start()
+            t.join()
+        old = np.setallocator("aligned_allocator")
+        try:
+            t = threading.Thread(target=run)
+            t.start()
+            t.join()
+        finally:
+            np.setallocator(old)
+        assert_equal(names, ["default_allocator", "aligned_allocator"])
+
+
+@pytest.mark.parametrize("policy", POLICIES)
+class TestPolicies:
+    def test_alloc(self, policy):
+        with np.allocatorstate(policy):
+            for n in SIZES:
+                a = np.empty(n)
+                b = np.zeros(n)
+                c = np.ones(n, dtype=np.int8)
+                for arr in (a, b, c):
+                    assert_equal(get_handler_name(arr), policy)
+                    if policy != "default_allocator":
+                        assert_equal(arr.ctypes.data % 64, 0)
+                assert_(not b.any())
+                assert_equal(c.sum(), n)
+                a[...] = 3
+                assert_equal(a.sum(), 3 * n)
+
+    def test_freed_outside_context(self, policy):
+        with np.allocatorstate(policy):
+            arrs = [np.full(n, 2.) for n in SIZES]
+        for a, n in zip(arrs, SIZES):
+            assert_equal(get_handler_name(a), policy)
+            assert_equal(a.sum(), 2 * n)
+        del arrs
+
+    def test_resize(self, policy):
+        with np.allocatorstate(policy):
+            a = np.arange(100)
+        a.resize(3 * 2**20 // 8 + 5, refcheck=False)
+        assert_equal(a[:100], np.arange(100))
+        assert_equal(a[100:].any(), False)
+        a.resize(10, refcheck=False)
+        assert_equal(a, np.arange(10))
+        a.resize(0, refcheck=False)
+        assert_equal(a.size, 0)
+        assert_equal(get_handler_name(a), policy)
+
+    def test_growing(self, policy):
+        # fromiter and fromstring grow their result by reallocating it
+        with np.allocatorstate(policy):
+            a = np.fromiter(iter(range(100000)), dtype=np.int64)
+            b = np.fromstring(" ".join(["1"] * 10000), dtype=int, sep=" ")
+        assert_equal(a, np.arange(100000))
+        assert_equal(b.sum(), 10000)
+        assert_equal(get_handler_name(a), policy)
+        assert_equal(get_handler_name(b), policy)
+
+    def test_pickle(self, policy):
+        with np.allocatorstate(policy):
+            a = np.arange(1000.).reshape(10, 100)
+            b = pickle.loads(pickle.dumps(a))
+        assert_equal(a, b)
+        # setstate frees the data with the handler which allocated it and
+        # copies object arrays into new data
+        with np.allocatorstate(policy):
+            c = np.empty(1000, dtype=object)
+        c.__setstate__(np.arange(5, dtype=object).__reduce__()[2])
+        assert_equal(c, np.arange(5))
+        assert_equal(get_handler_name(c), "default_allocator")
+
+    def test_set_data(self, policy):
+        with np.allocatorstate(policy):
+            a = np.zeros(1000)
+        b = np.ones(1000)
+        with pytest.warns(DeprecationWarning):
+            a.data = b.data
+        assert_equal(a.sum(), 1000)
+        assert_(get_handler_name(a) is None)
+
+
+class TestArena:
+    def test_reuse(self):
+        # Freeing the last block allows reusing its memory right away
+        with np.allocatorstate("arena_allocator"):
+            a = np.empty(1000)
+            ptr = a.ctypes.data
+            del a
+            b = np.empty(1000)
+            assert_equal(b.ctypes.data, ptr)
+
+    def test_many_chunks(self):
+        # Blocks are freed in any order and span several chunks
+        with np.allocatorstate("arena_allocator"):
+            arrs = [np.full(2**20, i) for i in range(100)]
+            big = np.ones(3 * 2**21)
+        for i, a in enumerate(arrs):
+            assert_equal(a[-1], i)
+        del arrs[::2]
+        with np.allocatorstate("arena_allocator"):
+            arrs += [np.full(2**20, i) for i in range(50)]
+        assert_equal(big.sum(), 3 * 2**21)
+        del arrs, big
+
+    def test_larger_than_chunk(self):
+        with np.allocatorstate("arena_allocator"):
+            a = np.arange(3 * 2**22)
+        assert_equal(a[-1], 3 * 2**22 - 1)
+        assert_equal(get_handler_name(a), "arena_allocator")
+
+    def test_threads(self):
+        def run():
+            with np.allocatorstate("arena_allocator"):
+                for i in range(200):
+                    a = np.full(1000 + i, i)
+                    b = np.ones(50000)
+                    assert a[-1] == i and b[-1] == 1
+                    del a
+
+        threads = [threading.Thread(target=run) for _ in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+
+class TestMemPool:
+    def setup(self):
+        # Start with an empty pool, which is disabled by default
+        self.old = np.setmempool(max_bytes=0)
+        np.setmempool(max_bytes=2**28)
+
+    def teardown(self):
+        np.setmempool(**self.old)
+
+    def test_settings(self):
+        assert_equal(self.old, {'max_block': 2**26, 'max_bytes': 0,
+                                'idle_time': 1.0})
+        old = np.setmempool(max_block=2**20)
+        assert_equal(old, {'max_block': 2**26, 'max_bytes': 2**28,
+                           'idle_time': 1.0})
+        assert_equal(np.getmempool()['max_block'], 2**20)
+        np.setmempool(idle_time=np.inf, max_bytes=10)
+        assert_equal(np.getmempool(), {'max_block': 2**20, 'max_bytes': 10,
+                                       'idle_time': np.inf})
+        assert_raises(ValueError, np.setmempool, max_block=2**26 + 1)
+        assert_raises(ValueError, np.setmempool, max_block=-1)
+        assert_raises(ValueError, np.setmempool, max_bytes=-1)
+        assert_raises(ValueError, np.setmempool, idle_time=-1)
+        assert_raises(ValueError, np.setmempool, idle_time=np.nan)
+        assert_raises(TypeError, np.setmempool, max_bytes=1.5)
+
+    @pytest.mark.parametrize("n", [200, 2**17, 2**19])
+    def test_reuse(self, n):
+        # Blocks are reused for arrays of the same size class, this holds
+        # for the caches of the threads (up to 4 MiB) and the shared one
+        a = np.empty(n)
+        ptr = a.ctypes.data
+        del a
+        stats = np.mempoolstats()
+        assert_equal(stats['cached_blocks'], {2**(n * 8 - 1).bit_length(): 1})
+        assert_equal(stats['cached_bytes'], 2**(n * 8 - 1).bit_length())
+        b = np.ones(n * 3 // 4)
+        assert_equal(b.ctypes.data, ptr)
+        assert_equal(np.mempoolstats()['hits'], stats['hits'] + 1)
+        assert_equal(np.mempoolstats()['cached_bytes'], 0)
+
+    def test_disabled(self):
+        # Blocks allocated while the pool is disabled are never cached
+        np.setmempool(max_bytes=0)
+        a = np.empty(100000)
+        np.setmempool(max_bytes=2**28)
+        stats = np.mempoolstats()
+        del a
+        assert_equal(np.mempoolstats()['cached_bytes'], 0)
+        assert_equal(np.mempoolstats()['released'], stats['released'])
+
+    def test_legacy_renew(self):
+        # A block shrunk by `PyDataMem_RENEW` has less than the capacity of
+        # its size class and must not be cached
+        from numpy.core._multiarray_tests import legacy_renew_data
+        a = np.arange(100000, dtype=np.float64)
+        legacy_renew_data(a, 70000)
+        assert_equal(a, np.arange(70000))
+        stats = np.mempoolstats()
+        del a
+        assert_equal(np.mempoolstats()['cached_bytes'], stats['cached_bytes'])
+
+    def test_zeroed(self):
+        a = np.ones(2**17)
+        ptr = a.ctypes.data
+        del a
+        b = np.zeros(2**17)
+        assert_equal(b.ctypes.data, ptr)
+        assert_(not b.any())
+
+    def test_limits(self):
+        np.setmempool(max_bytes=2**20)
+        stats = np.mempoolstats()
+        a, b = np.empty(2**17), np.empty(2**17)
+        del a, b
+        assert_equal(np.mempoolstats()['cached_bytes'], 2**20)
+        assert_equal(np.mempoolstats()['released'], stats['released'] + 1)
+        np.setmempool(max_block=2**19)
+        assert_equal(np.mempoolstats()['cached_bytes'], 0)
+        a = np.empty(2**17)
+        del a
+        assert_equal(np.mempoolstats()['cached_bytes'], 0)
+        np.setmempool(max_block=0)
+        a = np.empty(100)
+        del a
+        assert_equal(np.mempoolstats()['cached_bytes'], 0)
+
+    def test_idle(self):
+        # Blocks of more than 4 MiB always go to the shared cache
+        np.setmempool(idle_time=0.01)
+        a = np.empty(2**20)
+        del a
+        assert_equal(np.mempoolstats()['cached_blocks'], {2**23: 1})
+        time.sleep(0.05)
+        # the shared cache is checked for idle blocks when used
+        a = np.empty(2**21)
+        del a
+        assert_equal(np.mempoolstats()['cached_blocks'], {2**24: 1})
+        np.setmempool(idle_time=0)
+        assert_equal(np.mempoolstats()['cached_bytes'], 0)
+
+    def test_resize(self):
+        a = np.arange(1000)
+        a.resize(2**18, refcheck=False)
+        assert_equal(a[:1000], np.arange(1000))
+        a.resize(2**10, refcheck=False)
+        assert_equal(a[:1000], np.arange(1000))
+        del a
+        b = np.fromiter(range(100000), dtype=np.intp)
+        assert_equal(b, np.arange(100000))
+        del b
+        assert_(np.mempoolstats()['cached_bytes'] > 0)
+
+    def test_thread_exit(self):
+        # The blocks cached by a thread are shared when it exits
+        ptrs = []
+
+        def run():
+            a = np.empty(2**17)
+            ptrs.append(a.ctypes.data)
+
+        t = threading.Thread(target=run)
+        t.start()
+        t.join()
+        assert_equal(np.mempoolstats()['cached_blocks'], {2**20: 1})
+        # The system thread may still be exiting after `join`
+        keep = []
+        for i in range(500):
+            keep.append(np.empty(2**17))
+            if keep[-1].ctypes.data == ptrs[0]:
+                break
+            time.sleep(0.01)
+        assert_equal(keep[-1].ctypes.data, ptrs[0])
+
+    def test_threads(self):
+        errors = []
+
+        def run(seed):
+            rng = np.random.default_rng(seed)
+            try:
+                for i in range(300):
+                    n = int(rng.integers(100, 2**20))
+                    a = np.full(n, i)
+                    b = np.zeros(n // 2 + 1)
+                    if a[-1] != i or b.any():
+                        errors.append((seed, i))
+                    del a, b
+            except Exception as e:
+                errors.append(e)
+
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        assert_equal(errors, [])
+
+    @pytest.mark.skipif(not hasattr(os, "fork"), reason="needs os.fork")
+    def test_fork(self):
+        # The child continues with the caches of the forking thread
+        hold = threading.Event()
+
+        def run():
+            a = np.empty(2**17)
+            del a
+            hold.wait()
+
+        t = threading.Thread(target=run)
+        t.start()
+        try:
+            a = np.empty(2**16)
+            del a
+            pid = os.fork()
+            if pid == 0:
+                try:
+                    ok = np.mempoolstats()['cached_blocks'] == {2**19: 1}
+                    for n in (2**16, 2**17, 2**20):
+                        ok &= np.ones(n).sum() == n
+                finally:
+                    os._exit(0 if ok else 1)
+        finally:
+            hold.set()
+            t.join()
+        _, status = os.waitpid(pid, 0)
+        assert_equal(status, 0)
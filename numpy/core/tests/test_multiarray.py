@@ -2074,6 +2074,40 @@ def test_sort_degraded(self):
         assert_equal(np.sort(d), do)
         assert_equal(d[np.argsort(d)], do)
 
+    @pytest.mark.parametrize('dtype', np.typecodes['AllInteger'] + 'fd')
+    @pytest.mark.parametrize('size', [23, 64, 129, 1000, 20001])
+    def test_quicksort_patterns(self, dtype, size):
+        # The integer and float quicksorts partition blocks of 64 elements
+        # with SIMD and special case runs, duplicates and sorted partitions
+        rng = np.random.RandomState(size)
+        patterns = [
+            rng.randint(0, 100, size),
+            rng.randint(0, 3, size),
+            np.zeros(size),
+            np.arange(size),
+            np.arange(size)[::-1],
+            np.arange(size) % 17,
+            np.concatenate([np.arange(size // 2), np.arange(size // 2, 0, -1)]),
+        ]
+        for a in patterns:
+            a = a.astype(dtype)
+            expected = np.sort(a, kind='mergesort')
+            assert_equal(np.sort(a, kind='quicksort'), expected)
+            idx = np.argsort(a, kind='quicksort')
+            assert_equal(np.sort(idx), np.arange(a.size))
+            assert_equal(a[idx], expected)
+
+    @pytest.mark.parametrize('dtype', [np.float32, np.float64])
+    def test_quicksort_nan(self, dtype):
+        rng = np.random.RandomState(0)
+        a = rng.uniform(-10, 10, 10001).astype(dtype)
+        a[::7] = np.nan
+        a[1::13] = np.inf
+        a[2::17] = -np.inf
+        expected = np.sort(a, kind='mergesort')
+        assert_equal(np.sort(a, kind='quicksort'), expected)
+        assert_equal(a[np.argsort(a, kind='quicksort')], expected)
+
     def test_copy(self):
         def assert_fortran(arr):
             assert_(arr.flags.fortran)
@@ -4910,6 +4944,42 @@ def test_fromstring_count0(self):
         d = np.fromstring("1,2", sep=",", dtype=np.int64, count=0)
         assert d.shape == (0,)
 
+    @pytest.mark.parametrize("text", [
+            "9007199254740993", "1e23", "8.589973e9", "7.038531e-26",
+            "2.2250738585072011e-308", "4.9406564584124654e-324",
+            "2.4703282292062327e-324", "2.4703282292062328e-324",
+            "1.7976931348623157e308", "1.7976931348623159e308",
+            "179769313486231580793728971405301e276",
+            "0." + "0" * 330 + "1", "1" * 400, "1e-100000", "1e100000",
+            "5396241648308302265659150142913061157474076615512555031485190"
+            "276081220179897812267261362785379908257574435410010655778326"
+            "708224"])
+    def test_float_fromstring_correctly_rounded(self, text):
+        # halfway cases, subnormals and long mantissas are the hard cases
+        for s in [text, "-" + text]:
+            expected = float(s)
+            assert_equal(np.fromstring(s, sep=" ")[0], expected)
+            assert_equal(np.array([s]).astype(np.float64)[0], expected)
+            assert_equal(np.array([s.encode()]).astype(np.float64)[0],
+                         expected)
+            assert_equal(np.array([s], dtype=np.float64)[0], expected)
+
+    def test_float32_fromstring_rounds_once(self, tmp_filename):
+        # Rounding to float64 first would give the float32 halfway point
+        # 1 + 2**-24, which then rounds down to 1.
+        text = "1.00000005960464477539062500000001"
+        expected = np.nextafter(np.float32(1), np.float32(2))
+        assert_equal(np.fromstring(text, sep=" ", dtype=np.float32)[0],
+                     expected)
+        assert_equal(np.array([text]).astype(np.float32)[0], expected)
+        assert_equal(np.array([text], dtype=np.float32)[0], expected)
+        with open(tmp_filename, 'w') as f:
+            f.write(text)
+        assert_equal(np.fromfile(tmp_filename, sep=" ", dtype=np.float32),
+                     [expected])
+        halfway = "1.000000059604644775390625"
+        assert_equal(np.array([halfway]).astype(np.float32)[0], 1)
+
     def test_empty_files_text(self, tmp_filename):
         with open(tmp_filename, 'w') as f:
             pass
@@ -6763,6 +6833,118 @@ def test_matmul_bool(self):
         c = np.matmul(np.zeros((2, 0), dtype=bool), np.zeros(0, dtype=bool))
         assert not np.any(c)
 
+    # Shapes exercising the partial tiles and panels of the blocked kernels
+    blocked_shapes = [(7, 300, 33), (33, 700, 70), (100, 257, 5),
+                      (5, 600, 1100), (64, 64, 64)]
+
+    @pytest.mark.parametrize('dt', np.typecodes['AllInteger'])
+    @pytest.mark.parametrize('shape', blocked_shapes)
+    def test_matmul_blocked_int(self, dt, shape):
+        m, n, p = shape
+        rg = np.random.default_rng(1234)
+        a = rg.integers(-100, 100, size=(m, n)).astype(dt)
+        b = rg.integers(-100, 100, size=(n, p)).astype(dt)
+        # integer results (including overflow) match a naive sum exactly
+        tgt = np.add.reduce(a[:, :, None] * b[None, :, :], axis=1, dtype=dt)
+        assert_equal(self.matmul(a, b), tgt)
+        assert_equal(np.dot(a, b), tgt)
+        assert_equal(self.matmul(np.asfortranarray(a), b[:, ::-1]),
+                     tgt[:, ::-1])
+        out = np.zeros((2*p, m), dtype=dt).T[:, ::2]
+        self.matmul(a, b, out=out)
+        assert_equal(out, tgt)
+
+    @pytest.mark.parametrize('dt', ['e', 'f', 'd', 'F', 'D'])
+    @pytest.mark.parametrize('shape', blocked_shapes)
+    def test_matmul_blocked_inexact(self, dt, shape):
+        m, n, p = shape
+        rg = np.random.default_rng(1234)
+        a = rg.standard_normal((m, n))
+        b = rg.standard_normal((n, p))
+        if np.dtype(dt).kind == 'c':
+            a = a + 1j * rg.standard_normal((m, n))
+            b = b + 1j * rg.standard_normal((n, p))
+        a = a.astype(dt)
+        b = b.astype(dt)
+        tgt = a.astype(np.cdouble) @ b.astype(np.cdouble)
+        # error bound relative to the magnitude of the summands
+        scale = np.abs(a).astype(float) @ np.abs(b).astype(float)
+        rtol = {'e': 1e-2, 'f': 1e-5, 'F': 1e-5}.get(dt, 1e-12)
+        for a_, b_ in [(a, b), (a[:, ::-1], b[::-1]), (a.T.copy().T, b)]:
+            res = self.matmul(a_, b_)
+            assert_(res.dtype == np.dtype(dt))
+            assert_array_less(np.abs(res - tgt), rtol * scale + 1e-300)
+
+    def test_matmul_blocked_parallel(self):
+        rg = np.random.default_rng(1234)
+        a = rg.integers(-100, 100, size=(150, 400))
+        b = rg.integers(-100, 100, size=(400, 90))
+        af = (a % 5).astype(np.float16)
+        bf = (b % 5).astype(np.float16)
+        tgt = self.matmul(a, b)
+        tgt_s = self.matmul(a[:, ::2], b[::2])
+        tgt_f = self.matmul(af, bf)
+        with np.parallelstate(threads=4, threshold=1):
+            assert_equal(self.matmul(a, b), tgt)
+            assert_equal(self.matmul(a[:, ::2], b[::2]), tgt_s)
+            assert_equal(np.dot(a, b), tgt)
+            assert_equal(self.matmul(af, bf), tgt_f)
+
+    @pytest.mark.parametrize('dt', ['e', 'f', 'd'])
+    def test_matmul_blocked_padding_fpe(self, dt):
+        # The zero padding of partial tiles must not set the invalid flag
+        # for an infinity in A or B, strided operands avoid BLAS
+        a = np.ones((5, 64, 2), dtype=dt)[:, :, 0]
+        b = np.ones((64, 66, 2), dtype=dt)[:, :, 0]
+        a[2, 7] = np.inf
+        b[3, 1] = np.inf
+        with np.errstate(invalid='raise'):
+            res = self.matmul(a, b)
+            assert_equal(np.dot(a, b), res)
+        assert_equal(res[2], np.inf)
+        assert_equal(res[:, 1], np.inf)
+        assert_equal(res[[0, 1, 3, 4]][:, [0] + list(range(2, 66))], 64)
+
+        # An invalid result still sets it
+        b[5, 1] = -np.inf
+        with np.errstate(invalid='raise'):
+            assert_raises(FloatingPointError, self.matmul, a, b)
+
+    @pytest.mark.parametrize('dt', ['i', 'I', 'l', 'f', 'd'])
+    @pytest.mark.parametrize('shape', [(1, 3, 3), (2, 2, 2), (3, 3, 3),
+                                       (4, 4, 4), (4, 4, 1), (3, 5, 7),
+                                       (8, 8, 8)])
+    @pytest.mark.parametrize('nbatch', [8, 37])
+    def test_matmul_small_stacked(self, dt, shape, nbatch):
+        m, n, p = shape
+        rg = np.random.default_rng(1234)
+        a = rg.integers(-50, 50, size=(nbatch, m, n)).astype(dt)
+        b = rg.integers(-50, 50, size=(nbatch, n, p)).astype(dt)
+        # small integers, so that the results are exact for all types
+        tgt = np.stack([np.dot(x, y) for x, y in zip(a, b)])
+        assert_equal(self.matmul(a, b), tgt)
+        assert_equal(self.matmul(a[::-1], b[::-1]), tgt[::-1])
+        assert_equal(self.matmul(a, b[:1]),
+                     np.stack([np.dot(x, b[0]) for x in a]))
+        assert_equal(self.matmul(a.transpose(0, 2, 1).copy().swapaxes(1, 2),
+                                 b), tgt)
+        out = np.zeros((nbatch, p, m), dtype=dt).swapaxes(1, 2)
+        self.matmul(a, b, out=out)
+        assert_equal(out, tgt)
+        with np.parallelstate(threads=4, threshold=1):
+            assert_equal(self.matmul(a, b), tgt)
+
+    @pytest.mark.parametrize('dt', ['f', 'd'])
+    def test_matmul_small_stacked_threads(self, dt):
+        # the result does not depend on how the stack is split
+        rg = np.random.default_rng(1234)
+        a = rg.standard_normal((37, 7, 7)).astype(dt)
+        b = rg.standard_normal((37, 7, 7)).astype(dt)
+        tgt = self.matmul(a, b)
+        for threads in [2, 3, 8]:
+            with np.parallelstate(threads=threads, threshold=1):
+                assert_array_equal(self.matmul(a, b), tgt)
+
 
 class TestMatmulOperator(MatmulCommon):
     import operator
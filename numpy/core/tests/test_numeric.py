@@ -1277,6 +1277,16 @@ def test_nonzero_onedim(self):
         assert_equal(np.nonzero(x['a']), ([0, 2, 3],))
         assert_equal(np.nonzero(x['b']), ([0, 2, 3, 4],))
 
+    @pytest.mark.parametrize("size", [1, 63, 64, 1000, 100003])
+    def test_nonzero_onedim_bool(self, size):
+        # contiguous boolean masks use the mask kernels
+        rng = np.random.RandomState(1)
+        for p in [0, 0.01, 0.5, 1]:
+            x = rng.random_sample(size) < p
+            expected = np.array([i for i in range(size) if x[i]], dtype=np.intp)
+            assert_equal(np.nonzero(x), (expected,))
+            assert_equal(np.flatnonzero(x), expected)
+
     def test_nonzero_twodim(self):
         x = np.array([[0, 1, 0], [2, 0, 3]])
         assert_equal(np.count_nonzero(x.astype('i1')), 3)
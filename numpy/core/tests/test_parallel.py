@@ -0,0 +1,497 @@
+import io
+import os
+import sys
+import threading
+import warnings
+
+import pytest
+
+import numpy as np
+from numpy.testing import (
+    assert_, assert_equal, assert_array_equal, assert_raises, temppath
+    )
+
+
+@pytest.fixture
+def parallel():
+    # Run with a few threads and a threshold small enough to split all
+    # arrays used in the tests
+    with np.parallelstate(threads=4, threshold=100):
+        yield
+
+
+class TestParallelState:
+    def test_defaults(self):
+        state = np.getparallel()
+        assert_equal(state['threads'], 1)
+        assert_(state['threshold'] > 0)
+        assert_equal(state['linalg'], False)
+
+    def test_setparallel(self):
+        old = np.setparallel(threads=3, threshold=1000, linalg=True)
+        try:
+            assert_equal(np.getparallel(),
+                         {'threads': 3, 'threshold': 1000, 'linalg': True})
+            # unspecified values are unchanged
+            np.setparallel(threads=2)
+            assert_equal(np.getparallel(),
+                         {'threads': 2, 'threshold': 1000, 'linalg': True})
+        finally:
+            np.setparallel(**old)
+        assert_equal(np.getparallel(), old)
+
+    @pytest.mark.parametrize("kwargs", [
+        dict(threads=0), dict(threads=-1), dict(threads=100000),
+        dict(threshold=-1)])
+    def test_invalid(self, kwargs):
+        old = np.getparallel()
+        assert_raises(ValueError, np.setparallel, **kwargs)
+        assert_equal(np.getparallel(), old)
+
+    def test_invalid_type(self):
+        assert_raises(TypeError, np.setparallel, threads=2.5)
+
+    def test_parallelstate(self):
+        old = np.getparallel()
+        with np.parallelstate(threads=5, threshold=10):
+            assert_equal(np.getparallel(),
+                         {'threads': 5, 'threshold': 10, 'linalg': False})
+        assert_equal(np.getparallel(), old)
+
+    def test_parallelstate_decorator(self):
+        @np.parallelstate(threads=2)
+        def f():
+            return np.getparallel()['threads']
+
+        assert_equal(f(), 2)
+        assert_equal(np.getparallel()['threads'], 1)
+
+
+@pytest.mark.usefixtures("parallel")
+class TestParallelUfunc:
+    @pytest.mark.parametrize("dtype",
+            [np.int8, np.int32, np.int64, np.float16, np.float32, np.float64,
+             np.complex128])
+    @pytest.mark.parametrize("n", [1, 99, 100, 1001, 12345])
+    def test_binary_contiguous(self, dtype, n):
+        a = (np.arange(n) % 100).astype(dtype)
+        b = (np.arange(n)[::-1] % 7 + 1).astype(dtype)
+        with np.parallelstate(threads=1):
+            expected = [a + b, a * b, np.maximum(a, b), a == b]
+        assert_array_equal(a + b, expected[0])
+        assert_array_equal(a * b, expected[1])
+        assert_array_equal(np.maximum(a, b), expected[2])
+        assert_array_equal(a == b, expected[3])
+
+    @pytest.mark.parametrize("ufunc", [np.exp, np.sin, np.sqrt, np.log1p])
+    @pytest.mark.parametrize("dtype", [np.float32, np.float64])
+    def test_unary_bit_identical(self, ufunc, dtype):
+        a = np.linspace(0, 10, 10007, dtype=dtype)
+        with np.parallelstate(threads=1):
+            expected = ufunc(a)
+        res = ufunc(a)
+        assert_array_equal(res.view(np.uint8), expected.view(np.uint8))
+
+    def test_out_and_scalar(self):
+        a = np.arange(5000, dtype=np.float64)
+        out = np.empty_like(a)
+        res = np.multiply(a, 3., out=out)
+        assert_(res is out)
+        assert_array_equal(out, np.arange(5000) * 3.)
+
+    def test_in_place(self):
+        a = np.arange(5000, dtype=np.int64)
+        a += 1
+        assert_array_equal(a, np.arange(1, 5001))
+
+    def test_strided_and_broadcast(self):
+        a = np.arange(300 * 200, dtype=np.float64).reshape(300, 200)
+        b = np.arange(200, dtype=np.float64)
+        c = a[:200]
+        with np.parallelstate(threads=1):
+            expected = [c.T + c, a[::2, ::3] * b[::3], a + b, a[:, :1] - b]
+        assert_array_equal(c.T + c, expected[0])
+        assert_array_equal(a[::2, ::3] * b[::3], expected[1])
+        assert_array_equal(a + b, expected[2])
+        assert_array_equal(a[:, :1] - b, expected[3])
+
+    def test_broadcast_to_output(self):
+        # The loop size is given by the output, not by the inputs
+        out = np.zeros((100, 100))
+        np.add(np.ones(1), 2., out=out)
+        assert_array_equal(out, 3.)
+        np.multiply(np.arange(100.)[:, None], 2, out=out)
+        assert_array_equal(out, np.repeat(np.arange(0, 200., 2), 100)
+                                  .reshape(100, 100))
+
+    def test_casting(self):
+        # Buffered iteration with casts in every thread
+        a = np.arange(10000, dtype=np.int16)
+        b = np.linspace(0, 1, 10000, dtype=np.float32)
+        res = np.add(a, b, dtype=np.float64)
+        with np.parallelstate(threads=1):
+            expected = np.add(a, b, dtype=np.float64)
+        assert_array_equal(res, expected)
+
+        out = np.zeros(10000, dtype=np.int32)
+        np.add(a, a, out=out, casting="unsafe")
+        assert_array_equal(out, 2 * np.arange(10000))
+
+    def test_where(self):
+        a = np.arange(10000, dtype=np.float64)
+        mask = (np.arange(10000) % 3) == 0
+        out = np.full_like(a, -1)
+        np.negative(a, out=out, where=mask)
+        expected = np.where(mask, -a, -1)
+        assert_array_equal(out, expected)
+
+    def test_overlap(self):
+        # The iterator makes copies of overlapping operands which are
+        # written back after all threads are done
+        a = np.arange(10001, dtype=np.int64)
+        np.add(a[:-1], a[1:], out=a[1:])
+        expected = np.arange(10001, dtype=np.int64)
+        expected[1:] = expected[:-1] + expected[1:]
+        assert_array_equal(a, expected)
+
+    def test_multiple_outputs(self):
+        a = np.linspace(-10, 10, 5001)
+        frac, integral = np.modf(a)
+        with np.parallelstate(threads=1):
+            expected = np.modf(a)
+        assert_array_equal(frac, expected[0])
+        assert_array_equal(integral, expected[1])
+
+    def test_object(self):
+        a = np.arange(1000).astype(object)
+        assert_array_equal(a + a, 2 * np.arange(1000))
+
+    def test_below_threshold(self):
+        with np.parallelstate(threshold=10**6):
+            a = np.arange(1000.)
+            assert_array_equal(a * 2, np.arange(0, 2000., 2))
+
+    @pytest.mark.parametrize("pos", [0, 5000, 9999])
+    def test_floating_point_errors(self, pos):
+        # Errors raised on any thread must be reported
+        a = np.ones(10000)
+        a[pos] = 0
+        with np.errstate(divide="raise"):
+            assert_raises(FloatingPointError, np.divide, 1., a)
+        with np.errstate(invalid="raise"):
+            assert_raises(FloatingPointError, np.divide, a - 1, a - 1)
+        with np.errstate(all="ignore"):
+            np.divide(1., a)
+
+    def test_concurrent_python_threads(self):
+        a = np.arange(100000, dtype=np.float64)
+        expected = np.sqrt(a)
+        results = []
+
+        def worker():
+            for i in range(20):
+                results.append(np.array_equal(np.sqrt(a), expected))
+
+        threads = [threading.Thread(target=worker) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        assert_(all(results) and len(results) == 80)
+
+
+@pytest.mark.usefixtures("parallel")
+class TestParallelReduce:
+    # Results must be bit-identical to serial reductions and must not
+    # depend on the number of threads
+    def check(self, func, *args):
+        with np.parallelstate(threads=1):
+            expected = func(*args)
+        for threads in [2, 3, 8]:
+            with np.parallelstate(threads=threads):
+                res = func(*args)
+            assert_equal(np.asarray(res).tobytes(),
+                         np.asarray(expected).tobytes())
+
+    @pytest.mark.parametrize("dtype",
+            [np.int8, np.int64, np.uint32, np.float32, np.float64,
+             np.complex64, np.complex128, np.float16])
+    @pytest.mark.parametrize("n", [100, 8193, 65536, 100003])
+    def test_all_elements(self, dtype, n):
+        a = (np.sin(np.arange(n) * 1.234) * 1000).astype(dtype)
+        self.check(np.add.reduce, a)
+        self.check(np.maximum.reduce, a)
+        self.check(np.minimum.reduce, a)
+        self.check(np.add.reduce, a[::3])
+        self.check(lambda a: np.add.reduce(a, initial=5), a)
+        self.check(lambda a: a.reshape(-1, 1).sum(axis=None), a)
+        self.check(lambda a: a.reshape(-1, 1).T.sum(keepdims=True), a)
+        if a.dtype.kind in "iu":
+            self.check(np.multiply.reduce, a)
+
+    @pytest.mark.parametrize("dtype", [np.int32, np.float32, np.float64])
+    @pytest.mark.parametrize("shape", [(1000, 100), (4, 30000), (3, 8192)])
+    def test_last_axis(self, dtype, shape):
+        a = np.sin(np.arange(np.prod(shape)) * 1.234).reshape(shape) * 1000
+        a = a.astype(dtype)
+        self.check(lambda a: a.sum(axis=-1), a)
+        self.check(lambda a: a.max(axis=-1, keepdims=True), a)
+        self.check(lambda a: np.add.reduce(a, axis=-1, out=np.empty(
+            shape[0], dtype=dtype)), a)
+
+    def test_bufsize(self):
+        # The parts of a reduction follow the buffer size
+        a = np.sin(np.arange(30001) * 1.234)
+        old = np.setbufsize(1024)
+        try:
+            self.check(np.add.reduce, a)
+        finally:
+            np.setbufsize(old)
+
+    def test_logical(self):
+        a = np.ones(100000, dtype=bool)
+        assert_(np.logical_and.reduce(a))
+        a[77777] = False
+        assert_(not np.logical_and.reduce(a))
+        assert_(np.logical_or.reduce(a))
+        assert_(not np.logical_or.reduce(np.zeros(100000, dtype=bool)))
+        assert_(not np.all(a))
+        assert_(np.any(a))
+
+    def test_nan(self):
+        a = np.arange(100000.)
+        a[[5000, 50000]] = np.nan
+        assert_(np.isnan(np.max(a)))
+        assert_(np.isnan(np.sum(a)))
+        assert_equal(np.nanmax(a), 99999.)
+
+    def test_empty_and_no_identity(self):
+        assert_raises(ValueError, np.maximum.reduce, np.empty((10000, 0)),
+                      axis=-1)
+        assert_equal(np.maximum.reduce(np.ones((100000, 1)), axis=-1),
+                     np.ones(100000))
+        assert_equal(np.add.reduce(np.empty((10000, 0)), axis=-1),
+                     np.zeros(10000))
+
+    def test_overlapping_out(self):
+        a = np.arange(100000, dtype=np.int64).reshape(1000, 100)
+        expected = a.sum(axis=-1)
+        np.add.reduce(a, axis=-1, out=a[:, 0])
+        assert_array_equal(a[:, 0], expected)
+
+    def test_object(self):
+        a = np.arange(10000).astype(object)
+        assert_equal(np.add.reduce(a), 10000 * 9999 // 2)
+
+
+@pytest.mark.usefixtures("parallel")
+class TestParallelSort:
+    def check(self, a, axis=-1):
+        with np.parallelstate(threads=1):
+            expected = np.sort(a, axis=axis, kind='stable')
+            expected_idx = np.argsort(a, axis=axis, kind='stable')
+        for threads in [2, 3, 8]:
+            with np.parallelstate(threads=threads):
+                for kind in ['quicksort', 'stable', 'heapsort']:
+                    assert_array_equal(np.sort(a, axis=axis, kind=kind),
+                                       expected)
+                    idx = np.argsort(a, axis=axis, kind=kind)
+                    assert_array_equal(
+                        np.take_along_axis(a, idx, axis=axis), expected)
+                    if kind == 'stable':
+                        assert_array_equal(idx, expected_idx)
+
+    @pytest.mark.parametrize("dtype",
+            [np.int8, np.uint16, np.int32, np.int64, np.float16, np.float32,
+             np.float64, np.complex128, 'M8[s]', 'U3'])
+    @pytest.mark.parametrize("n", [1000, 30001])
+    def test_single_lane(self, dtype, n):
+        a = np.sin(np.arange(n) * 1.234) * 100
+        if np.dtype(dtype).kind == 'M':
+            a = a.astype(np.int64).view(dtype)
+            a[::11] = np.datetime64('NaT')
+        else:
+            a = a.astype(dtype)
+        if a.dtype.kind in 'fc':
+            a[::13] = np.nan
+        self.check(a)
+
+    @pytest.mark.parametrize("shape", [(100, 100), (3, 5000), (7, 13, 101)])
+    def test_lanes(self, shape):
+        a = np.sin(np.arange(np.prod(shape)) * 1.234).reshape(shape)
+        self.check(a)
+        self.check(a, axis=0)
+        self.check(a.astype('>i4'), axis=1)
+        self.check(a[..., ::2])
+
+    def test_in_place(self):
+        a = np.sin(np.arange(30000) * 1.234)
+        with np.parallelstate(threads=1):
+            expected = np.sort(a)
+        a.sort()
+        assert_array_equal(a, expected)
+        b = np.sin(np.arange(30000) * 1.234).reshape(300, 100)
+        b.sort(axis=0)
+        assert_((np.diff(b, axis=0) >= 0).all())
+
+    def test_partition(self):
+        a = np.sin(np.arange(30000) * 1.234).reshape(100, 300)
+        p = np.partition(a, 10, axis=-1)
+        assert_array_equal(p[:, 10], np.sort(a, axis=-1)[:, 10])
+        idx = np.argpartition(a, 10, axis=0)
+        assert_array_equal(np.take_along_axis(a, idx, axis=0)[10],
+                           np.sort(a, axis=0)[10])
+
+    def test_object(self):
+        a = np.arange(10000)[::-1].astype(object)
+        assert_array_equal(np.sort(a), np.arange(10000))
+        assert_array_equal(np.argsort(a), np.arange(10000)[::-1])
+
+
+@pytest.mark.usefixtures("parallel")
+class TestParallelText:
+    def check(self, func):
+        with np.parallelstate(threads=1):
+            with warnings.catch_warnings(record=True) as expected_w:
+                warnings.simplefilter("always")
+                expected = func()
+        for threads in [2, 3, 8]:
+            with np.parallelstate(threads=threads):
+                with warnings.catch_warnings(record=True) as w:
+                    warnings.simplefilter("always")
+                    res = func()
+            assert_equal(res, expected)
+            assert_equal([str(x.message) for x in w],
+                         [str(x.message) for x in expected_w])
+        return expected
+
+    @pytest.mark.parametrize("dtype",
+            [np.float64, np.float32, np.float16, np.int64, np.uint8, bool])
+    @pytest.mark.parametrize("sep", [",", " ", " ; ", ":\n"])
+    def test_fromstring(self, dtype, sep):
+        if np.dtype(dtype).kind == 'f':
+            values = [str(i) if i % 3 else repr(i / 7) for i in range(3000)]
+        else:
+            values = [str(i % 200) for i in range(3000)]
+        text = sep.join(values)
+        res = self.check(lambda: np.fromstring(text, dtype=dtype, sep=sep))
+        assert_equal(len(res), 3000)
+        # Unmatched data in the middle, empty fields and trailing garbage
+        for bad in [text[:5000] + "x" + text[5000:],
+                    text[:7001] + sep + sep + text[7001:],
+                    text + sep + "  ", text + "abc"]:
+            self.check(lambda: np.fromstring(bad, dtype=dtype, sep=sep))
+
+    @pytest.mark.parametrize("dtype", [np.float64, np.int32])
+    def test_fromfile(self, dtype):
+        values = [str(i) if i % 2 else "%.3e" % (i * 1.5) for i in range(5000)]
+        if dtype == np.int32:
+            values = [str(i) for i in range(5000)]
+        for text in [", ".join(values), ", ".join(values) + ", x1, 2"]:
+            with temppath() as path:
+                with open(path, "w") as f:
+                    f.write(text)
+
+                def read():
+                    with open(path, "rb") as f:
+                        res = np.fromfile(f, dtype=dtype, sep=",")
+                        return res, f.tell()
+
+                res, pos = self.check(read)
+            assert_equal(len(res), 5000)
+            if text.endswith("2"):
+                # The file position is at the unmatched data
+                assert_equal(pos, len(text) - 5)
+
+    def test_float_spellings(self):
+        values = ["0", "-0", "1.5", ".5", "5.", "1e5", "1E-5", "-2.5e+3",
+                  "123456789012345678", "1234567890123456789012",
+                  "0.000000000000000000000000001", "9007199254740993",
+                  "1.7976931348623157e308", "2e308", "4.9e-324", "1e-400",
+                  "inf", "-Infinity", "1e22", "1e23", "123e30", "0.1"]
+        res = np.fromstring(" ".join(values * 100), sep=" ")
+        assert_equal(res, [float(v) for v in values * 100])
+        assert_equal(np.signbit(res[1]), True)
+
+    def test_loadtxt(self):
+        lines = ["%d,%r,%d" % (i, i / 7, -i) for i in range(20000)]
+        lines[100] = "# a comment"
+        lines[200] = ""
+        lines[10000] = "1_000,12345678901234567890123456,0"
+        text = "\n".join(lines)
+        res = self.check(lambda: np.loadtxt(io.StringIO(text), delimiter=","))
+        assert_equal(res.shape, (19998, 3))
+        self.check(lambda: np.loadtxt(io.StringIO(text), delimiter=",",
+                                      dtype="i8,f4,i2", usecols=(2, 1, 0)))
+
+        # The first error is reported, with the correct line number
+        lines[15000] = "1,2"
+        lines[17000] = "1,2,x"
+        text = "\n".join(lines)
+
+        def read():
+            with assert_raises(ValueError) as cm:
+                np.loadtxt(io.StringIO(text), delimiter=",")
+            return str(cm.exception)
+
+        assert_("line 15001" in self.check(read))
+
+
+@pytest.mark.usefixtures("parallel")
+class TestParallelCast:
+    def check(self, func):
+        with np.parallelstate(threads=1):
+            expected = func()
+        for threads in [2, 3, 8]:
+            with np.parallelstate(threads=threads):
+                res = func()
+                assert_equal(res.dtype, expected.dtype)
+                assert_array_equal(res, expected)
+
+    @pytest.mark.parametrize("dtype",
+            [np.bool_, np.uint8, np.int32, np.int64, np.float16, np.float32,
+             np.complex64, '>f8', 'S10'])
+    def test_astype(self, dtype):
+        a = np.sin(np.arange(30001) * 1.234) * 100
+        self.check(lambda: a.astype(dtype))
+        self.check(lambda: a[::3].astype(dtype))
+        self.check(lambda: a[:30000].reshape(300, 100).T.astype(dtype))
+
+    def test_assign(self):
+        a = np.arange(30000, dtype=np.int64).reshape(100, 300)
+        def func():
+            res = np.zeros((300, 100), dtype=np.float32)
+            res[...] = a.T
+            res[::2] = a[:, ::2].T
+            return res
+        self.check(func)
+
+    def test_overlap(self):
+        # Overlapping assignments are not split
+        def func():
+            a = np.arange(20000, dtype=np.int64)
+            a[3:] = a[:-3].astype(np.int32)
+            a[:-5] = a[5:]
+            a.view(np.int32)[:10000] = a[:10000]
+            return a
+        self.check(func)
+
+    def test_structured_and_object(self):
+        a = np.arange(10000, dtype=np.float64)
+        dt = np.dtype([("a", np.int32), ("b", np.float16)])
+        self.check(lambda: a.astype(dt))
+        self.check(lambda: a.astype(object).astype(np.int16))
+
+
+@pytest.mark.skipif(not hasattr(os, "fork"), reason="requires fork")
+@pytest.mark.skipif(sys.platform == "darwin", reason="fork is unsafe on macOS")
+def test_fork(parallel):
+    a = np.arange(100000, dtype=np.float64)
+    pid = os.fork()
+    if pid == 0:
+        # The child sets up its own pool
+        ok = (np.getparallel()['threads'] == 4 and
+              np.array_equal(a * 2, np.arange(0, 200000., 2)))
+        os._exit(0 if ok else 1)
+    _, status = os.waitpid(pid, 0)
+    assert_equal(os.WEXITSTATUS(status), 0)
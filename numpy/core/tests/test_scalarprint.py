@@ -7,6 +7,7 @@
 import pytest
 import sys
 
+from decimal import Decimal
 from tempfile import TemporaryFile
 import numpy as np
 from numpy.testing import assert_, assert_equal, assert_raises
@@ -262,6 +263,41 @@ def test_dragon4(self):
                                    fractional=False), "324.00")
 
 
+    def test_dragon4_shortest_roundtrip(self):
+        # The shortest repr is found with Ryu, check it against python's
+        # repr for float64 and that it round-trips and is shortest for the
+        # smaller types.
+        rng = np.random.RandomState(1234)
+        bits = rng.randint(0, 2**63 - 1, size=2000, dtype=np.int64)
+        for x in bits.view(np.float64):
+            if not np.isfinite(x) or x == 0:
+                continue
+            assert_equal(Decimal(np.format_float_scientific(x)),
+                         Decimal(repr(float(x))))
+
+        for tp, nbits in [(np.float16, 16), (np.float32, 32)]:
+            bits = rng.randint(0, 2**nbits, size=2000, dtype=np.uint64)
+            for x in bits.astype(f'u{nbits // 8}').view(tp):
+                if not np.isfinite(x) or x == 0:
+                    continue
+                s = np.format_float_scientific(x)
+                assert_equal(tp(s), x)
+                ndigits = len(s.split('e')[0].replace('-', '').replace('.', ''))
+                if ndigits > 1:
+                    shorter = np.format_float_scientific(
+                        x, unique=False, precision=ndigits - 2)
+                    assert_(tp(shorter) != x)
+
+        # a precision cutoff below the shortest digits needs correct rounding
+        assert_equal(np.format_float_positional(np.float64(0.125),
+                                                precision=2), '0.12')
+        assert_equal(np.format_float_positional(np.float64(9.995),
+                                                precision=2), '9.99')
+        assert_equal(np.format_float_positional(np.float64(9.9999),
+                                                precision=3), '10.')
+        assert_equal(np.format_float_scientific(np.float32(9.5e-7),
+                                                precision=0), '1.e-06')
+
     def test_dragon4_interface(self):
         tps = [np.float16, np.float32, np.float64]
         if hasattr(np, 'float128'):
@@ -53,6 +53,16 @@
    fftshift  Shift zero-frequency component to center of spectrum.
    ifftshift Inverse of fftshift.
 
+Plan cache
+----------
+
+.. autosummary::
+   :toctree: generated/
+
+   plan_cache_info        Information about the cache of FFT plans.
+   set_plan_cache_limits  Set the size limits of the plan cache.
+   clear_plan_cache       Remove all plans from the cache.
+
 
 Background information
 ----------------------
@@ -20,6 +20,9 @@ def fft2(a, s=..., axes=..., norm=...): ...
 def ifft2(a, s=..., axes=..., norm=...): ...
 def rfft2(a, s=..., axes=..., norm=...): ...
 def irfft2(a, s=..., axes=..., norm=...): ...
+def plan_cache_info(): ...
+def set_plan_cache_limits(max_size=..., max_nbytes=...): ...
+def clear_plan_cache(): ...
 def fftshift(x, axes=...): ...
 def ifftshift(x, axes=...): ...
 def fftfreq(n, d=...): ...
@@ -20,6 +20,7 @@
 #include <stdlib.h>
 
 #include "npy_config.h"
+#include "npy_parallel.h"
 #define restrict NPY_RESTRICT
 
 #define RALLOC(type,num) \
@@ -275,6 +276,20 @@ typedef struct cmplx {
   double r,i;
 } cmplx;
 
+#ifdef __GNUC__
+/*
+ * The lanes of a batched transform can be computed VLEN at a time by
+ * running the radix 2, 3, 4 and 5 kernels on vectors holding one value
+ * per lane.  Two doubles fill the SSE2 and NEON registers, wider vectors
+ * are split up again by the compiler on these targets and run slower.
+ */
+#define VLEN 2
+typedef double vdbl __attribute__((vector_size(VLEN*sizeof(double))));
+typedef struct vcmplx {
+  vdbl r,i;
+} vcmplx;
+#endif
+
 #define NFCT 25
 typedef struct cfftp_fctdata
   {
@@ -630,6 +645,343 @@ NOINLINE static void pass5f (size_t ido, size_t l1, const cmplx * restrict cc,
       }
   }
 
+#ifdef VLEN
+#define ROT90V(a) { vdbl tmp_=a.r; a.r=-a.i; a.i=tmp_; }
+#define ROTM90V(a) { vdbl tmp_=-a.r; a.r=a.i; a.i=tmp_; }
+
+NOINLINE static void pass2b_v (size_t ido, size_t l1, const vcmplx * restrict cc,
+  vcmplx * restrict ch, const cmplx * restrict wa)
+  {
+  const size_t cdim=2;
+
+  if (ido==1)
+    for (size_t k=0; k<l1; ++k)
+      PMC (CH(0,k,0),CH(0,k,1),CC(0,0,k),CC(0,1,k))
+  else
+    for (size_t k=0; k<l1; ++k)
+      {
+      PMC (CH(0,k,0),CH(0,k,1),CC(0,0,k),CC(0,1,k))
+      for (size_t i=1; i<ido; ++i)
+        {
+        vcmplx t;
+        PMC (CH(i,k,0),t,CC(i,0,k),CC(i,1,k))
+        A_EQ_B_MUL_C (CH(i,k,1),WA(0,i),t)
+        }
+      }
+  }
+
+NOINLINE static void pass2f_v (size_t ido, size_t l1, const vcmplx * restrict cc,
+  vcmplx * restrict ch, const cmplx * restrict wa)
+  {
+  const size_t cdim=2;
+
+  if (ido==1)
+    for (size_t k=0; k<l1; ++k)
+      PMC (CH(0,k,0),CH(0,k,1),CC(0,0,k),CC(0,1,k))
+  else
+    for (size_t k=0; k<l1; ++k)
+      {
+      PMC (CH(0,k,0),CH(0,k,1),CC(0,0,k),CC(0,1,k))
+      for (size_t i=1; i<ido; ++i)
+        {
+        vcmplx t;
+        PMC (CH(i,k,0),t,CC(i,0,k),CC(i,1,k))
+        A_EQ_CB_MUL_C (CH(i,k,1),WA(0,i),t)
+        }
+      }
+  }
+
+#define PREP3V(idx) \
+        vcmplx t0 = CC(idx,0,k), t1, t2; \
+        PMC (t1,t2,CC(idx,1,k),CC(idx,2,k)) \
+        CH(idx,k,0).r=t0.r+t1.r; \
+        CH(idx,k,0).i=t0.i+t1.i;
+#define PARTSTEP3aV(u1,u2,twr,twi) \
+        { \
+        vcmplx ca,cb; \
+        ca.r=t0.r+twr*t1.r; \
+        ca.i=t0.i+twr*t1.i; \
+        cb.i=twi*t2.r; \
+        cb.r=-(twi*t2.i); \
+        PMC(CH(0,k,u1),CH(0,k,u2),ca,cb) \
+        }
+
+#define PARTSTEP3bV(u1,u2,twr,twi) \
+        { \
+        vcmplx ca,cb,da,db; \
+        ca.r=t0.r+twr*t1.r; \
+        ca.i=t0.i+twr*t1.i; \
+        cb.i=twi*t2.r; \
+        cb.r=-(twi*t2.i); \
+        PMC(da,db,ca,cb) \
+        A_EQ_B_MUL_C (CH(i,k,u1),WA(u1-1,i),da) \
+        A_EQ_B_MUL_C (CH(i,k,u2),WA(u2-1,i),db) \
+        }
+NOINLINE static void pass3b_v (size_t ido, size_t l1, const vcmplx * restrict cc,
+  vcmplx * restrict ch, const cmplx * restrict wa)
+  {
+  const size_t cdim=3;
+  const double tw1r=-0.5, tw1i= 0.86602540378443864676;
+
+  if (ido==1)
+    for (size_t k=0; k<l1; ++k)
+      {
+      PREP3V(0)
+      PARTSTEP3aV(1,2,tw1r,tw1i)
+      }
+  else
+    for (size_t k=0; k<l1; ++k)
+      {
+      {
+      PREP3V(0)
+      PARTSTEP3aV(1,2,tw1r,tw1i)
+      }
+      for (size_t i=1; i<ido; ++i)
+        {
+        PREP3V(i)
+        PARTSTEP3bV(1,2,tw1r,tw1i)
+        }
+      }
+  }
+#define PARTSTEP3fV(u1,u2,twr,twi) \
+        { \
+        vcmplx ca,cb,da,db; \
+        ca.r=t0.r+twr*t1.r; \
+        ca.i=t0.i+twr*t1.i; \
+        cb.i=twi*t2.r; \
+        cb.r=-(twi*t2.i); \
+        PMC(da,db,ca,cb) \
+        A_EQ_CB_MUL_C (CH(i,k,u1),WA(u1-1,i),da) \
+        A_EQ_CB_MUL_C (CH(i,k,u2),WA(u2-1,i),db) \
+        }
+NOINLINE static void pass3f_v (size_t ido, size_t l1, const vcmplx * restrict cc,
+  vcmplx * restrict ch, const cmplx * restrict wa)
+  {
+  const size_t cdim=3;
+  const double tw1r=-0.5, tw1i= -0.86602540378443864676;
+
+  if (ido==1)
+    for (size_t k=0; k<l1; ++k)
+      {
+      PREP3V(0)
+      PARTSTEP3aV(1,2,tw1r,tw1i)
+      }
+  else
+    for (size_t k=0; k<l1; ++k)
+      {
+      {
+      PREP3V(0)
+      PARTSTEP3aV(1,2,tw1r,tw1i)
+      }
+      for (size_t i=1; i<ido; ++i)
+        {
+        PREP3V(i)
+        PARTSTEP3fV(1,2,tw1r,tw1i)
+        }
+      }
+  }
+
+NOINLINE static void pass4b_v (size_t ido, size_t l1, const vcmplx * restrict cc,
+  vcmplx * restrict ch, const cmplx * restrict wa)
+  {
+  const size_t cdim=4;
+
+  if (ido==1)
+    for (size_t k=0; k<l1; ++k)
+      {
+      vcmplx t1, t2, t3, t4;
+      PMC(t2,t1,CC(0,0,k),CC(0,2,k))
+      PMC(t3,t4,CC(0,1,k),CC(0,3,k))
+      ROT90V(t4)
+      PMC(CH(0,k,0),CH(0,k,2),t2,t3)
+      PMC(CH(0,k,1),CH(0,k,3),t1,t4)
+      }
+  else
+    for (size_t k=0; k<l1; ++k)
+      {
+      {
+      vcmplx t1, t2, t3, t4;
+      PMC(t2,t1,CC(0,0,k),CC(0,2,k))
+      PMC(t3,t4,CC(0,1,k),CC(0,3,k))
+      ROT90V(t4)
+      PMC(CH(0,k,0),CH(0,k,2),t2,t3)
+      PMC(CH(0,k,1),CH(0,k,3),t1,t4)
+      }
+      for (size_t i=1; i<ido; ++i)
+        {
+        vcmplx c2, c3, c4, t1, t2, t3, t4;
+        vcmplx cc0=CC(i,0,k), cc1=CC(i,1,k),cc2=CC(i,2,k),cc3=CC(i,3,k);
+        PMC(t2,t1,cc0,cc2)
+        PMC(t3,t4,cc1,cc3)
+        ROT90V(t4)
+        cmplx wa0=WA(0,i), wa1=WA(1,i),wa2=WA(2,i);
+        PMC(CH(i,k,0),c3,t2,t3)
+        PMC(c2,c4,t1,t4)
+        A_EQ_B_MUL_C (CH(i,k,1),wa0,c2)
+        A_EQ_B_MUL_C (CH(i,k,2),wa1,c3)
+        A_EQ_B_MUL_C (CH(i,k,3),wa2,c4)
+        }
+      }
+  }
+NOINLINE static void pass4f_v (size_t ido, size_t l1, const vcmplx * restrict cc,
+  vcmplx * restrict ch, const cmplx * restrict wa)
+  {
+  const size_t cdim=4;
+
+  if (ido==1)
+    for (size_t k=0; k<l1; ++k)
+      {
+      vcmplx t1, t2, t3, t4;
+      PMC(t2,t1,CC(0,0,k),CC(0,2,k))
+      PMC(t3,t4,CC(0,1,k),CC(0,3,k))
+      ROTM90V(t4)
+      PMC(CH(0,k,0),CH(0,k,2),t2,t3)
+      PMC(CH(0,k,1),CH(0,k,3),t1,t4)
+      }
+  else
+    for (size_t k=0; k<l1; ++k)
+      {
+      {
+      vcmplx t1, t2, t3, t4;
+      PMC(t2,t1,CC(0,0,k),CC(0,2,k))
+      PMC(t3,t4,CC(0,1,k),CC(0,3,k))
+      ROTM90V(t4)
+      PMC(CH(0,k,0),CH(0,k,2),t2,t3)
+      PMC (CH(0,k,1),CH(0,k,3),t1,t4)
+      }
+      for (size_t i=1; i<ido; ++i)
+        {
+        vcmplx c2, c3, c4, t1, t2, t3, t4;
+        vcmplx cc0=CC(i,0,k), cc1=CC(i,1,k),cc2=CC(i,2,k),cc3=CC(i,3,k);
+        PMC(t2,t1,cc0,cc2)
+        PMC(t3,t4,cc1,cc3)
+        ROTM90V(t4)
+        cmplx wa0=WA(0,i), wa1=WA(1,i),wa2=WA(2,i);
+        PMC(CH(i,k,0),c3,t2,t3)
+        PMC(c2,c4,t1,t4)
+        A_EQ_CB_MUL_C (CH(i,k,1),wa0,c2)
+        A_EQ_CB_MUL_C (CH(i,k,2),wa1,c3)
+        A_EQ_CB_MUL_C (CH(i,k,3),wa2,c4)
+        }
+      }
+  }
+
+#define PREP5V(idx) \
+        vcmplx t0 = CC(idx,0,k), t1, t2, t3, t4; \
+        PMC (t1,t4,CC(idx,1,k),CC(idx,4,k)) \
+        PMC (t2,t3,CC(idx,2,k),CC(idx,3,k)) \
+        CH(idx,k,0).r=t0.r+t1.r+t2.r; \
+        CH(idx,k,0).i=t0.i+t1.i+t2.i;
+
+#define PARTSTEP5aV(u1,u2,twar,twbr,twai,twbi) \
+        { \
+        vcmplx ca,cb; \
+        ca.r=t0.r+twar*t1.r+twbr*t2.r; \
+        ca.i=t0.i+twar*t1.i+twbr*t2.i; \
+        cb.i=twai*t4.r twbi*t3.r; \
+        cb.r=-(twai*t4.i twbi*t3.i); \
+        PMC(CH(0,k,u1),CH(0,k,u2),ca,cb) \
+        }
+
+#define PARTSTEP5bV(u1,u2,twar,twbr,twai,twbi) \
+        { \
+        vcmplx ca,cb,da,db; \
+        ca.r=t0.r+twar*t1.r+twbr*t2.r; \
+        ca.i=t0.i+twar*t1.i+twbr*t2.i; \
+        cb.i=twai*t4.r twbi*t3.r; \
+        cb.r=-(twai*t4.i twbi*t3.i); \
+        PMC(da,db,ca,cb) \
+        A_EQ_B_MUL_C (CH(i,k,u1),WA(u1-1,i),da) \
+        A_EQ_B_MUL_C (CH(i,k,u2),WA(u2-1,i),db) \
+        }
+NOINLINE static void pass5b_v (size_t ido, size_t l1, const vcmplx * restrict cc,
+  vcmplx * restrict ch, const cmplx * restrict wa)
+  {
+  const size_t cdim=5;
+  const double tw1r= 0.3090169943749474241,
+               tw1i= 0.95105651629515357212,
+               tw2r= -0.8090169943749474241,
+               tw2i= 0.58778525229247312917;
+
+  if (ido==1)
+    for (size_t k=0; k<l1; ++k)
+      {
+      PREP5V(0)
+      PARTSTEP5aV(1,4,tw1r,tw2r,+tw1i,+tw2i)
+      PARTSTEP5aV(2,3,tw2r,tw1r,+tw2i,-tw1i)
+      }
+  else
+    for (size_t k=0; k<l1; ++k)
+      {
+      {
+      PREP5V(0)
+      PARTSTEP5aV(1,4,tw1r,tw2r,+tw1i,+tw2i)
+      PARTSTEP5aV(2,3,tw2r,tw1r,+tw2i,-tw1i)
+      }
+      for (size_t i=1; i<ido; ++i)
+        {
+        PREP5V(i)
+        PARTSTEP5bV(1,4,tw1r,tw2r,+tw1i,+tw2i)
+        PARTSTEP5bV(2,3,tw2r,tw1r,+tw2i,-tw1i)
+        }
+      }
+  }
+#define PARTSTEP5fV(u1,u2,twar,twbr,twai,twbi) \
+        { \
+        vcmplx ca,cb,da,db; \
+        ca.r=t0.r+twar*t1.r+twbr*t2.r; \
+        ca.i=t0.i+twar*t1.i+twbr*t2.i; \
+        cb.i=twai*t4.r twbi*t3.r; \
+        cb.r=-(twai*t4.i twbi*t3.i); \
+        PMC(da,db,ca,cb) \
+        A_EQ_CB_MUL_C (CH(i,k,u1),WA(u1-1,i),da) \
+        A_EQ_CB_MUL_C (CH(i,k,u2),WA(u2-1,i),db) \
+        }
+NOINLINE static void pass5f_v (size_t ido, size_t l1, const vcmplx * restrict cc,
+  vcmplx * restrict ch, const cmplx * restrict wa)
+  {
+  const size_t cdim=5;
+  const double tw1r= 0.3090169943749474241,
+               tw1i= -0.95105651629515357212,
+               tw2r= -0.8090169943749474241,
+               tw2i= -0.58778525229247312917;
+
+  if (ido==1)
+    for (size_t k=0; k<l1; ++k)
+      {
+      PREP5V(0)
+      PARTSTEP5aV(1,4,tw1r,tw2r,+tw1i,+tw2i)
+      PARTSTEP5aV(2,3,tw2r,tw1r,+tw2i,-tw1i)
+      }
+  else
+    for (size_t k=0; k<l1; ++k)
+      {
+      {
+      PREP5V(0)
+      PARTSTEP5aV(1,4,tw1r,tw2r,+tw1i,+tw2i)
+      PARTSTEP5aV(2,3,tw2r,tw1r,+tw2i,-tw1i)
+      }
+      for (size_t i=1; i<ido; ++i)
+        {
+        PREP5V(i)
+        PARTSTEP5fV(1,4,tw1r,tw2r,+tw1i,+tw2i)
+        PARTSTEP5fV(2,3,tw2r,tw1r,+tw2i,-tw1i)
+        }
+      }
+  }
+
+#undef PARTSTEP5fV
+#undef PARTSTEP5bV
+#undef PARTSTEP5aV
+#undef PREP5V
+#undef PARTSTEP3fV
+#undef PARTSTEP3bV
+#undef PARTSTEP3aV
+#undef PREP3V
+#undef ROTM90V
+#undef ROT90V
+#endif
+
 #define PREP7(idx) \
         cmplx t1 = CC(idx,0,k), t2, t3, t4, t5, t6, t7; \
         PMC (t2,t7,CC(idx,1,k),CC(idx,6,k)) \
@@ -940,11 +1292,55 @@ NOINLINE WARN_UNUSED_RESULT static int pass_all(cfftp_plan plan, cmplx c[], doub
   return 0;
   }
 
-#undef PMSIGNC
-#undef A_EQ_B_MUL_C
-#undef A_EQ_CB_MUL_C
-#undef MULPMSIGNC
-#undef MULPMSIGNCEQ
+#ifdef VLEN
+static int cfftp_has_lane_kernels(cfftp_plan plan)
+  {
+  if (plan->length<2) return 0;
+  for(size_t k=0; k<plan->nfct; k++)
+    if (plan->fct[k].fct>5) return 0;
+  return 1;
+  }
+
+/*
+ * pass_all for VLEN lanes at once, the plan must only contain the factors
+ * 2, 3, 4 and 5.  Returns the array (c or ch) holding the unscaled result.
+ */
+static vcmplx *pass_all_v(cfftp_plan plan, vcmplx c[], vcmplx ch[],
+  const int sign)
+  {
+  size_t len=plan->length;
+  size_t l1=1, nf=plan->nfct;
+  vcmplx *p1=c, *p2=ch;
+
+  for(size_t k1=0; k1<nf; k1++)
+    {
+    size_t ip=plan->fct[k1].fct;
+    size_t l2=ip*l1;
+    size_t ido = len/l2;
+    if     (ip==4)
+      sign>0 ? pass4b_v (ido, l1, p1, p2, plan->fct[k1].tw)
+             : pass4f_v (ido, l1, p1, p2, plan->fct[k1].tw);
+    else if(ip==2)
+      sign>0 ? pass2b_v (ido, l1, p1, p2, plan->fct[k1].tw)
+             : pass2f_v (ido, l1, p1, p2, plan->fct[k1].tw);
+    else if(ip==3)
+      sign>0 ? pass3b_v (ido, l1, p1, p2, plan->fct[k1].tw)
+             : pass3f_v (ido, l1, p1, p2, plan->fct[k1].tw);
+    else
+      sign>0 ? pass5b_v (ido, l1, p1, p2, plan->fct[k1].tw)
+             : pass5f_v (ido, l1, p1, p2, plan->fct[k1].tw);
+    SWAP(p1,p2,vcmplx *);
+    l1=l2;
+    }
+  return p1;
+  }
+#endif
+
+#undef PMSIGNC
+#undef A_EQ_B_MUL_C
+#undef A_EQ_CB_MUL_C
+#undef MULPMSIGNC
+#undef MULPMSIGNCEQ
 
 #undef WA
 #undef CC
@@ -1239,6 +1635,156 @@ NOINLINE static void radf5(size_t ido, size_t l1, const double * restrict cc,
       }
   }
 
+#ifdef VLEN
+NOINLINE static void radf2_v (size_t ido, size_t l1, const vdbl * restrict cc,
+  vdbl * restrict ch, const double * restrict wa)
+  {
+  const size_t cdim=2;
+
+  for (size_t k=0; k<l1; k++)
+    PM (CH(0,0,k),CH(ido-1,1,k),CC(0,k,0),CC(0,k,1))
+  if ((ido&1)==0)
+    for (size_t k=0; k<l1; k++)
+      {
+      CH(    0,1,k) = -CC(ido-1,k,1);
+      CH(ido-1,0,k) =  CC(ido-1,k,0);
+      }
+  if (ido<=2) return;
+  for (size_t k=0; k<l1; k++)
+    for (size_t i=2; i<ido; i+=2)
+      {
+      size_t ic=ido-i;
+      vdbl tr2, ti2;
+      MULPM (tr2,ti2,WA(0,i-2),WA(0,i-1),CC(i-1,k,1),CC(i,k,1))
+      PM (CH(i-1,0,k),CH(ic-1,1,k),CC(i-1,k,0),tr2)
+      PM (CH(i  ,0,k),CH(ic  ,1,k),ti2,CC(i  ,k,0))
+      }
+  }
+
+NOINLINE static void radf3_v(size_t ido, size_t l1, const vdbl * restrict cc,
+  vdbl * restrict ch, const double * restrict wa)
+  {
+  const size_t cdim=3;
+  static const double taur=-0.5, taui=0.86602540378443864676;
+
+  for (size_t k=0; k<l1; k++)
+    {
+    vdbl cr2=CC(0,k,1)+CC(0,k,2);
+    CH(0,0,k) = CC(0,k,0)+cr2;
+    CH(0,2,k) = taui*(CC(0,k,2)-CC(0,k,1));
+    CH(ido-1,1,k) = CC(0,k,0)+taur*cr2;
+    }
+  if (ido==1) return;
+  for (size_t k=0; k<l1; k++)
+    for (size_t i=2; i<ido; i+=2)
+      {
+      size_t ic=ido-i;
+      vdbl di2, di3, dr2, dr3;
+      MULPM (dr2,di2,WA(0,i-2),WA(0,i-1),CC(i-1,k,1),CC(i,k,1)) // d2=conj(WA0)*CC1
+      MULPM (dr3,di3,WA(1,i-2),WA(1,i-1),CC(i-1,k,2),CC(i,k,2)) // d3=conj(WA1)*CC2
+      vdbl cr2=dr2+dr3; // c add
+      vdbl ci2=di2+di3;
+      CH(i-1,0,k) = CC(i-1,k,0)+cr2; // c add
+      CH(i  ,0,k) = CC(i  ,k,0)+ci2;
+      vdbl tr2 = CC(i-1,k,0)+taur*cr2; // c add
+      vdbl ti2 = CC(i  ,k,0)+taur*ci2;
+      vdbl tr3 = taui*(di2-di3);  // t3 = taui*i*(d3-d2)?
+      vdbl ti3 = taui*(dr3-dr2);
+      PM(CH(i-1,2,k),CH(ic-1,1,k),tr2,tr3) // PM(i) = t2+t3
+      PM(CH(i  ,2,k),CH(ic  ,1,k),ti3,ti2) // PM(ic) = conj(t2-t3)
+      }
+  }
+
+NOINLINE static void radf4_v(size_t ido, size_t l1, const vdbl * restrict cc,
+  vdbl * restrict ch, const double * restrict wa)
+  {
+  const size_t cdim=4;
+  static const double hsqt2=0.70710678118654752440;
+
+  for (size_t k=0; k<l1; k++)
+    {
+    vdbl tr1,tr2;
+    PM (tr1,CH(0,2,k),CC(0,k,3),CC(0,k,1))
+    PM (tr2,CH(ido-1,1,k),CC(0,k,0),CC(0,k,2))
+    PM (CH(0,0,k),CH(ido-1,3,k),tr2,tr1)
+    }
+  if ((ido&1)==0)
+    for (size_t k=0; k<l1; k++)
+      {
+      vdbl ti1=-hsqt2*(CC(ido-1,k,1)+CC(ido-1,k,3));
+      vdbl tr1= hsqt2*(CC(ido-1,k,1)-CC(ido-1,k,3));
+      PM (CH(ido-1,0,k),CH(ido-1,2,k),CC(ido-1,k,0),tr1)
+      PM (CH(    0,3,k),CH(    0,1,k),ti1,CC(ido-1,k,2))
+      }
+  if (ido<=2) return;
+  for (size_t k=0; k<l1; k++)
+    for (size_t i=2; i<ido; i+=2)
+      {
+      size_t ic=ido-i;
+      vdbl ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
+      MULPM(cr2,ci2,WA(0,i-2),WA(0,i-1),CC(i-1,k,1),CC(i,k,1))
+      MULPM(cr3,ci3,WA(1,i-2),WA(1,i-1),CC(i-1,k,2),CC(i,k,2))
+      MULPM(cr4,ci4,WA(2,i-2),WA(2,i-1),CC(i-1,k,3),CC(i,k,3))
+      PM(tr1,tr4,cr4,cr2)
+      PM(ti1,ti4,ci2,ci4)
+      PM(tr2,tr3,CC(i-1,k,0),cr3)
+      PM(ti2,ti3,CC(i  ,k,0),ci3)
+      PM(CH(i-1,0,k),CH(ic-1,3,k),tr2,tr1)
+      PM(CH(i  ,0,k),CH(ic  ,3,k),ti1,ti2)
+      PM(CH(i-1,2,k),CH(ic-1,1,k),tr3,ti4)
+      PM(CH(i  ,2,k),CH(ic  ,1,k),tr4,ti3)
+      }
+  }
+
+NOINLINE static void radf5_v(size_t ido, size_t l1, const vdbl * restrict cc,
+  vdbl * restrict ch, const double * restrict wa)
+  {
+  const size_t cdim=5;
+  static const double tr11= 0.3090169943749474241, ti11=0.95105651629515357212,
+                      tr12=-0.8090169943749474241, ti12=0.58778525229247312917;
+
+  for (size_t k=0; k<l1; k++)
+    {
+    vdbl cr2, cr3, ci4, ci5;
+    PM (cr2,ci5,CC(0,k,4),CC(0,k,1))
+    PM (cr3,ci4,CC(0,k,3),CC(0,k,2))
+    CH(0,0,k)=CC(0,k,0)+cr2+cr3;
+    CH(ido-1,1,k)=CC(0,k,0)+tr11*cr2+tr12*cr3;
+    CH(0,2,k)=ti11*ci5+ti12*ci4;
+    CH(ido-1,3,k)=CC(0,k,0)+tr12*cr2+tr11*cr3;
+    CH(0,4,k)=ti12*ci5-ti11*ci4;
+    }
+  if (ido==1) return;
+  for (size_t k=0; k<l1;++k)
+    for (size_t i=2; i<ido; i+=2)
+      {
+      vdbl ci2, di2, ci4, ci5, di3, di4, di5, ci3, cr2, cr3, dr2, dr3,
+         dr4, dr5, cr5, cr4, ti2, ti3, ti5, ti4, tr2, tr3, tr4, tr5;
+      size_t ic=ido-i;
+      MULPM (dr2,di2,WA(0,i-2),WA(0,i-1),CC(i-1,k,1),CC(i,k,1))
+      MULPM (dr3,di3,WA(1,i-2),WA(1,i-1),CC(i-1,k,2),CC(i,k,2))
+      MULPM (dr4,di4,WA(2,i-2),WA(2,i-1),CC(i-1,k,3),CC(i,k,3))
+      MULPM (dr5,di5,WA(3,i-2),WA(3,i-1),CC(i-1,k,4),CC(i,k,4))
+      PM(cr2,ci5,dr5,dr2)
+      PM(ci2,cr5,di2,di5)
+      PM(cr3,ci4,dr4,dr3)
+      PM(ci3,cr4,di3,di4)
+      CH(i-1,0,k)=CC(i-1,k,0)+cr2+cr3;
+      CH(i  ,0,k)=CC(i  ,k,0)+ci2+ci3;
+      tr2=CC(i-1,k,0)+tr11*cr2+tr12*cr3;
+      ti2=CC(i  ,k,0)+tr11*ci2+tr12*ci3;
+      tr3=CC(i-1,k,0)+tr12*cr2+tr11*cr3;
+      ti3=CC(i  ,k,0)+tr12*ci2+tr11*ci3;
+      MULPM(tr5,tr4,cr5,cr4,ti11,ti12)
+      MULPM(ti5,ti4,ci5,ci4,ti11,ti12)
+      PM(CH(i-1,2,k),CH(ic-1,1,k),tr2,tr5)
+      PM(CH(i  ,2,k),CH(ic  ,1,k),ti5,ti2)
+      PM(CH(i-1,4,k),CH(ic-1,3,k),tr3,tr4)
+      PM(CH(i  ,4,k),CH(ic  ,3,k),ti4,ti3)
+      }
+  }
+#endif
+
 #undef CC
 #undef CH
 #define C1(a,b,c) cc[(a)+ido*((b)+l1*(c))]
@@ -1382,17 +1928,176 @@ NOINLINE static void radfg(size_t ido, size_t ip, size_t l1,
         }
     }
   }
-#undef C1
-#undef C2
-#undef CH2
-
-#undef CH
-#undef CC
-#define CH(a,b,c) ch[(a)+ido*((b)+l1*(c))]
-#define CC(a,b,c) cc[(a)+ido*((b)+cdim*(c))]
+#undef C1
+#undef C2
+#undef CH2
+
+#undef CH
+#undef CC
+#define CH(a,b,c) ch[(a)+ido*((b)+l1*(c))]
+#define CC(a,b,c) cc[(a)+ido*((b)+cdim*(c))]
+
+NOINLINE static void radb2(size_t ido, size_t l1, const double * restrict cc,
+  double * restrict ch, const double * restrict wa)
+  {
+  const size_t cdim=2;
+
+  for (size_t k=0; k<l1; k++)
+    PM (CH(0,k,0),CH(0,k,1),CC(0,0,k),CC(ido-1,1,k))
+  if ((ido&1)==0)
+    for (size_t k=0; k<l1; k++)
+      {
+      CH(ido-1,k,0) = 2.*CC(ido-1,0,k);
+      CH(ido-1,k,1) =-2.*CC(0    ,1,k);
+      }
+  if (ido<=2) return;
+  for (size_t k=0; k<l1;++k)
+    for (size_t i=2; i<ido; i+=2)
+      {
+      size_t ic=ido-i;
+      double ti2, tr2;
+      PM (CH(i-1,k,0),tr2,CC(i-1,0,k),CC(ic-1,1,k))
+      PM (ti2,CH(i  ,k,0),CC(i  ,0,k),CC(ic  ,1,k))
+      MULPM (CH(i,k,1),CH(i-1,k,1),WA(0,i-2),WA(0,i-1),ti2,tr2)
+      }
+  }
+
+NOINLINE static void radb3(size_t ido, size_t l1, const double * restrict cc,
+  double * restrict ch, const double * restrict wa)
+  {
+  const size_t cdim=3;
+  static const double taur=-0.5, taui=0.86602540378443864676;
+
+  for (size_t k=0; k<l1; k++)
+    {
+    double tr2=2.*CC(ido-1,1,k);
+    double cr2=CC(0,0,k)+taur*tr2;
+    CH(0,k,0)=CC(0,0,k)+tr2;
+    double ci3=2.*taui*CC(0,2,k);
+    PM (CH(0,k,2),CH(0,k,1),cr2,ci3);
+    }
+  if (ido==1) return;
+  for (size_t k=0; k<l1; k++)
+    for (size_t i=2; i<ido; i+=2)
+      {
+      size_t ic=ido-i;
+      double tr2=CC(i-1,2,k)+CC(ic-1,1,k); // t2=CC(I) + conj(CC(ic))
+      double ti2=CC(i  ,2,k)-CC(ic  ,1,k);
+      double cr2=CC(i-1,0,k)+taur*tr2;     // c2=CC +taur*t2
+      double ci2=CC(i  ,0,k)+taur*ti2;
+      CH(i-1,k,0)=CC(i-1,0,k)+tr2;         // CH=CC+t2
+      CH(i  ,k,0)=CC(i  ,0,k)+ti2;
+      double cr3=taui*(CC(i-1,2,k)-CC(ic-1,1,k));// c3=taui*(CC(i)-conj(CC(ic)))
+      double ci3=taui*(CC(i  ,2,k)+CC(ic  ,1,k));
+      double di2, di3, dr2, dr3;
+      PM(dr3,dr2,cr2,ci3) // d2= (cr2-ci3, ci2+cr3) = c2+i*c3
+      PM(di2,di3,ci2,cr3) // d3= (cr2+ci3, ci2-cr3) = c2-i*c3
+      MULPM(CH(i,k,1),CH(i-1,k,1),WA(0,i-2),WA(0,i-1),di2,dr2) // ch = WA*d2
+      MULPM(CH(i,k,2),CH(i-1,k,2),WA(1,i-2),WA(1,i-1),di3,dr3)
+      }
+  }
+
+NOINLINE static void radb4(size_t ido, size_t l1, const double * restrict cc,
+  double * restrict ch, const double * restrict wa)
+  {
+  const size_t cdim=4;
+  static const double sqrt2=1.41421356237309504880;
+
+  for (size_t k=0; k<l1; k++)
+    {
+    double tr1, tr2;
+    PM (tr2,tr1,CC(0,0,k),CC(ido-1,3,k))
+    double tr3=2.*CC(ido-1,1,k);
+    double tr4=2.*CC(0,2,k);
+    PM (CH(0,k,0),CH(0,k,2),tr2,tr3)
+    PM (CH(0,k,3),CH(0,k,1),tr1,tr4)
+    }
+  if ((ido&1)==0)
+    for (size_t k=0; k<l1; k++)
+      {
+      double tr1,tr2,ti1,ti2;
+      PM (ti1,ti2,CC(0    ,3,k),CC(0    ,1,k))
+      PM (tr2,tr1,CC(ido-1,0,k),CC(ido-1,2,k))
+      CH(ido-1,k,0)=tr2+tr2;
+      CH(ido-1,k,1)=sqrt2*(tr1-ti1);
+      CH(ido-1,k,2)=ti2+ti2;
+      CH(ido-1,k,3)=-sqrt2*(tr1+ti1);
+      }
+  if (ido<=2) return;
+  for (size_t k=0; k<l1;++k)
+    for (size_t i=2; i<ido; i+=2)
+      {
+      double ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
+      size_t ic=ido-i;
+      PM (tr2,tr1,CC(i-1,0,k),CC(ic-1,3,k))
+      PM (ti1,ti2,CC(i  ,0,k),CC(ic  ,3,k))
+      PM (tr4,ti3,CC(i  ,2,k),CC(ic  ,1,k))
+      PM (tr3,ti4,CC(i-1,2,k),CC(ic-1,1,k))
+      PM (CH(i-1,k,0),cr3,tr2,tr3)
+      PM (CH(i  ,k,0),ci3,ti2,ti3)
+      PM (cr4,cr2,tr1,tr4)
+      PM (ci2,ci4,ti1,ti4)
+      MULPM (CH(i,k,1),CH(i-1,k,1),WA(0,i-2),WA(0,i-1),ci2,cr2)
+      MULPM (CH(i,k,2),CH(i-1,k,2),WA(1,i-2),WA(1,i-1),ci3,cr3)
+      MULPM (CH(i,k,3),CH(i-1,k,3),WA(2,i-2),WA(2,i-1),ci4,cr4)
+      }
+  }
+
+NOINLINE static void radb5(size_t ido, size_t l1, const double * restrict cc,
+  double * restrict ch, const double * restrict wa)
+  {
+  const size_t cdim=5;
+  static const double tr11= 0.3090169943749474241, ti11=0.95105651629515357212,
+                      tr12=-0.8090169943749474241, ti12=0.58778525229247312917;
+
+  for (size_t k=0; k<l1; k++)
+    {
+    double ti5=CC(0,2,k)+CC(0,2,k);
+    double ti4=CC(0,4,k)+CC(0,4,k);
+    double tr2=CC(ido-1,1,k)+CC(ido-1,1,k);
+    double tr3=CC(ido-1,3,k)+CC(ido-1,3,k);
+    CH(0,k,0)=CC(0,0,k)+tr2+tr3;
+    double cr2=CC(0,0,k)+tr11*tr2+tr12*tr3;
+    double cr3=CC(0,0,k)+tr12*tr2+tr11*tr3;
+    double ci4, ci5;
+    MULPM(ci5,ci4,ti5,ti4,ti11,ti12)
+    PM(CH(0,k,4),CH(0,k,1),cr2,ci5)
+    PM(CH(0,k,3),CH(0,k,2),cr3,ci4)
+    }
+  if (ido==1) return;
+  for (size_t k=0; k<l1;++k)
+    for (size_t i=2; i<ido; i+=2)
+      {
+      size_t ic=ido-i;
+      double tr2, tr3, tr4, tr5, ti2, ti3, ti4, ti5;
+      PM(tr2,tr5,CC(i-1,2,k),CC(ic-1,1,k))
+      PM(ti5,ti2,CC(i  ,2,k),CC(ic  ,1,k))
+      PM(tr3,tr4,CC(i-1,4,k),CC(ic-1,3,k))
+      PM(ti4,ti3,CC(i  ,4,k),CC(ic  ,3,k))
+      CH(i-1,k,0)=CC(i-1,0,k)+tr2+tr3;
+      CH(i  ,k,0)=CC(i  ,0,k)+ti2+ti3;
+      double cr2=CC(i-1,0,k)+tr11*tr2+tr12*tr3;
+      double ci2=CC(i  ,0,k)+tr11*ti2+tr12*ti3;
+      double cr3=CC(i-1,0,k)+tr12*tr2+tr11*tr3;
+      double ci3=CC(i  ,0,k)+tr12*ti2+tr11*ti3;
+      double ci4, ci5, cr5, cr4;
+      MULPM(cr5,cr4,tr5,tr4,ti11,ti12)
+      MULPM(ci5,ci4,ti5,ti4,ti11,ti12)
+      double dr2, dr3, dr4, dr5, di2, di3, di4, di5;
+      PM(dr4,dr3,cr3,ci4)
+      PM(di3,di4,ci3,cr4)
+      PM(dr5,dr2,cr2,ci5)
+      PM(di2,di5,ci2,cr5)
+      MULPM(CH(i,k,1),CH(i-1,k,1),WA(0,i-2),WA(0,i-1),di2,dr2)
+      MULPM(CH(i,k,2),CH(i-1,k,2),WA(1,i-2),WA(1,i-1),di3,dr3)
+      MULPM(CH(i,k,3),CH(i-1,k,3),WA(2,i-2),WA(2,i-1),di4,dr4)
+      MULPM(CH(i,k,4),CH(i-1,k,4),WA(3,i-2),WA(3,i-1),di5,dr5)
+      }
+  }
 
-NOINLINE static void radb2(size_t ido, size_t l1, const double * restrict cc,
-  double * restrict ch, const double * restrict wa)
+#ifdef VLEN
+NOINLINE static void radb2_v(size_t ido, size_t l1, const vdbl * restrict cc,
+  vdbl * restrict ch, const double * restrict wa)
   {
   const size_t cdim=2;
 
@@ -1409,25 +2114,25 @@ NOINLINE static void radb2(size_t ido, size_t l1, const double * restrict cc,
     for (size_t i=2; i<ido; i+=2)
       {
       size_t ic=ido-i;
-      double ti2, tr2;
+      vdbl ti2, tr2;
       PM (CH(i-1,k,0),tr2,CC(i-1,0,k),CC(ic-1,1,k))
       PM (ti2,CH(i  ,k,0),CC(i  ,0,k),CC(ic  ,1,k))
       MULPM (CH(i,k,1),CH(i-1,k,1),WA(0,i-2),WA(0,i-1),ti2,tr2)
       }
   }
 
-NOINLINE static void radb3(size_t ido, size_t l1, const double * restrict cc,
-  double * restrict ch, const double * restrict wa)
+NOINLINE static void radb3_v(size_t ido, size_t l1, const vdbl * restrict cc,
+  vdbl * restrict ch, const double * restrict wa)
   {
   const size_t cdim=3;
   static const double taur=-0.5, taui=0.86602540378443864676;
 
   for (size_t k=0; k<l1; k++)
     {
-    double tr2=2.*CC(ido-1,1,k);
-    double cr2=CC(0,0,k)+taur*tr2;
+    vdbl tr2=2.*CC(ido-1,1,k);
+    vdbl cr2=CC(0,0,k)+taur*tr2;
     CH(0,k,0)=CC(0,0,k)+tr2;
-    double ci3=2.*taui*CC(0,2,k);
+    vdbl ci3=2.*taui*CC(0,2,k);
     PM (CH(0,k,2),CH(0,k,1),cr2,ci3);
     }
   if (ido==1) return;
@@ -1435,15 +2140,15 @@ NOINLINE static void radb3(size_t ido, size_t l1, const double * restrict cc,
     for (size_t i=2; i<ido; i+=2)
       {
       size_t ic=ido-i;
-      double tr2=CC(i-1,2,k)+CC(ic-1,1,k); // t2=CC(I) + conj(CC(ic))
-      double ti2=CC(i  ,2,k)-CC(ic  ,1,k);
-      double cr2=CC(i-1,0,k)+taur*tr2;     // c2=CC +taur*t2
-      double ci2=CC(i  ,0,k)+taur*ti2;
+      vdbl tr2=CC(i-1,2,k)+CC(ic-1,1,k); // t2=CC(I) + conj(CC(ic))
+      vdbl ti2=CC(i  ,2,k)-CC(ic  ,1,k);
+      vdbl cr2=CC(i-1,0,k)+taur*tr2;     // c2=CC +taur*t2
+      vdbl ci2=CC(i  ,0,k)+taur*ti2;
       CH(i-1,k,0)=CC(i-1,0,k)+tr2;         // CH=CC+t2
       CH(i  ,k,0)=CC(i  ,0,k)+ti2;
-      double cr3=taui*(CC(i-1,2,k)-CC(ic-1,1,k));// c3=taui*(CC(i)-conj(CC(ic)))
-      double ci3=taui*(CC(i  ,2,k)+CC(ic  ,1,k));
-      double di2, di3, dr2, dr3;
+      vdbl cr3=taui*(CC(i-1,2,k)-CC(ic-1,1,k));// c3=taui*(CC(i)-conj(CC(ic)))
+      vdbl ci3=taui*(CC(i  ,2,k)+CC(ic  ,1,k));
+      vdbl di2, di3, dr2, dr3;
       PM(dr3,dr2,cr2,ci3) // d2= (cr2-ci3, ci2+cr3) = c2+i*c3
       PM(di2,di3,ci2,cr3) // d3= (cr2+ci3, ci2-cr3) = c2-i*c3
       MULPM(CH(i,k,1),CH(i-1,k,1),WA(0,i-2),WA(0,i-1),di2,dr2) // ch = WA*d2
@@ -1451,25 +2156,25 @@ NOINLINE static void radb3(size_t ido, size_t l1, const double * restrict cc,
       }
   }
 
-NOINLINE static void radb4(size_t ido, size_t l1, const double * restrict cc,
-  double * restrict ch, const double * restrict wa)
+NOINLINE static void radb4_v(size_t ido, size_t l1, const vdbl * restrict cc,
+  vdbl * restrict ch, const double * restrict wa)
   {
   const size_t cdim=4;
   static const double sqrt2=1.41421356237309504880;
 
   for (size_t k=0; k<l1; k++)
     {
-    double tr1, tr2;
+    vdbl tr1, tr2;
     PM (tr2,tr1,CC(0,0,k),CC(ido-1,3,k))
-    double tr3=2.*CC(ido-1,1,k);
-    double tr4=2.*CC(0,2,k);
+    vdbl tr3=2.*CC(ido-1,1,k);
+    vdbl tr4=2.*CC(0,2,k);
     PM (CH(0,k,0),CH(0,k,2),tr2,tr3)
     PM (CH(0,k,3),CH(0,k,1),tr1,tr4)
     }
   if ((ido&1)==0)
     for (size_t k=0; k<l1; k++)
       {
-      double tr1,tr2,ti1,ti2;
+      vdbl tr1,tr2,ti1,ti2;
       PM (ti1,ti2,CC(0    ,3,k),CC(0    ,1,k))
       PM (tr2,tr1,CC(ido-1,0,k),CC(ido-1,2,k))
       CH(ido-1,k,0)=tr2+tr2;
@@ -1481,7 +2186,7 @@ NOINLINE static void radb4(size_t ido, size_t l1, const double * restrict cc,
   for (size_t k=0; k<l1;++k)
     for (size_t i=2; i<ido; i+=2)
       {
-      double ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
+      vdbl ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
       size_t ic=ido-i;
       PM (tr2,tr1,CC(i-1,0,k),CC(ic-1,3,k))
       PM (ti1,ti2,CC(i  ,0,k),CC(ic  ,3,k))
@@ -1497,8 +2202,8 @@ NOINLINE static void radb4(size_t ido, size_t l1, const double * restrict cc,
       }
   }
 
-NOINLINE static void radb5(size_t ido, size_t l1, const double * restrict cc,
-  double * restrict ch, const double * restrict wa)
+NOINLINE static void radb5_v(size_t ido, size_t l1, const vdbl * restrict cc,
+  vdbl * restrict ch, const double * restrict wa)
   {
   const size_t cdim=5;
   static const double tr11= 0.3090169943749474241, ti11=0.95105651629515357212,
@@ -1506,14 +2211,14 @@ NOINLINE static void radb5(size_t ido, size_t l1, const double * restrict cc,
 
   for (size_t k=0; k<l1; k++)
     {
-    double ti5=CC(0,2,k)+CC(0,2,k);
-    double ti4=CC(0,4,k)+CC(0,4,k);
-    double tr2=CC(ido-1,1,k)+CC(ido-1,1,k);
-    double tr3=CC(ido-1,3,k)+CC(ido-1,3,k);
+    vdbl ti5=CC(0,2,k)+CC(0,2,k);
+    vdbl ti4=CC(0,4,k)+CC(0,4,k);
+    vdbl tr2=CC(ido-1,1,k)+CC(ido-1,1,k);
+    vdbl tr3=CC(ido-1,3,k)+CC(ido-1,3,k);
     CH(0,k,0)=CC(0,0,k)+tr2+tr3;
-    double cr2=CC(0,0,k)+tr11*tr2+tr12*tr3;
-    double cr3=CC(0,0,k)+tr12*tr2+tr11*tr3;
-    double ci4, ci5;
+    vdbl cr2=CC(0,0,k)+tr11*tr2+tr12*tr3;
+    vdbl cr3=CC(0,0,k)+tr12*tr2+tr11*tr3;
+    vdbl ci4, ci5;
     MULPM(ci5,ci4,ti5,ti4,ti11,ti12)
     PM(CH(0,k,4),CH(0,k,1),cr2,ci5)
     PM(CH(0,k,3),CH(0,k,2),cr3,ci4)
@@ -1523,21 +2228,21 @@ NOINLINE static void radb5(size_t ido, size_t l1, const double * restrict cc,
     for (size_t i=2; i<ido; i+=2)
       {
       size_t ic=ido-i;
-      double tr2, tr3, tr4, tr5, ti2, ti3, ti4, ti5;
+      vdbl tr2, tr3, tr4, tr5, ti2, ti3, ti4, ti5;
       PM(tr2,tr5,CC(i-1,2,k),CC(ic-1,1,k))
       PM(ti5,ti2,CC(i  ,2,k),CC(ic  ,1,k))
       PM(tr3,tr4,CC(i-1,4,k),CC(ic-1,3,k))
       PM(ti4,ti3,CC(i  ,4,k),CC(ic  ,3,k))
       CH(i-1,k,0)=CC(i-1,0,k)+tr2+tr3;
       CH(i  ,k,0)=CC(i  ,0,k)+ti2+ti3;
-      double cr2=CC(i-1,0,k)+tr11*tr2+tr12*tr3;
-      double ci2=CC(i  ,0,k)+tr11*ti2+tr12*ti3;
-      double cr3=CC(i-1,0,k)+tr12*tr2+tr11*tr3;
-      double ci3=CC(i  ,0,k)+tr12*ti2+tr11*ti3;
-      double ci4, ci5, cr5, cr4;
+      vdbl cr2=CC(i-1,0,k)+tr11*tr2+tr12*tr3;
+      vdbl ci2=CC(i  ,0,k)+tr11*ti2+tr12*ti3;
+      vdbl cr3=CC(i-1,0,k)+tr12*tr2+tr11*tr3;
+      vdbl ci3=CC(i  ,0,k)+tr12*ti2+tr11*ti3;
+      vdbl ci4, ci5, cr5, cr4;
       MULPM(cr5,cr4,tr5,tr4,ti11,ti12)
       MULPM(ci5,ci4,ti5,ti4,ti11,ti12)
-      double dr2, dr3, dr4, dr5, di2, di3, di4, di5;
+      vdbl dr2, dr3, dr4, dr5, di2, di3, di4, di5;
       PM(dr4,dr3,cr3,ci4)
       PM(di3,di4,ci3,cr4)
       PM(dr5,dr2,cr2,ci5)
@@ -1548,6 +2253,7 @@ NOINLINE static void radb5(size_t ido, size_t l1, const double * restrict cc,
       MULPM(CH(i,k,4),CH(i-1,k,4),WA(3,i-2),WA(3,i-1),di5,dr5)
       }
   }
+#endif
 
 #undef CC
 #undef CH
@@ -1777,6 +2483,70 @@ static int rfftp_backward(rfftp_plan plan, double c[], double fct)
   return 0;
   }
 
+#ifdef VLEN
+static int rfftp_has_lane_kernels(rfftp_plan plan)
+  {
+  if (plan->length<2) return 0;
+  for(size_t k=0; k<plan->nfct; k++)
+    if (plan->fct[k].fct>5) return 0;
+  return 1;
+  }
+
+/*
+ * rfftp_forward and rfftp_backward for VLEN lanes at once, the plan must
+ * only contain the factors 2, 3, 4 and 5.  They return the array (c or ch)
+ * holding the unscaled result.
+ */
+static vdbl *rfftp_forward_v(rfftp_plan plan, vdbl c[], vdbl ch[])
+  {
+  size_t n=plan->length;
+  size_t l1=n, nf=plan->nfct;
+  vdbl *p1=c, *p2=ch;
+
+  for(size_t k1=0; k1<nf;++k1)
+    {
+    size_t k=nf-k1-1;
+    size_t ip=plan->fct[k].fct;
+    size_t ido=n / l1;
+    l1 /= ip;
+    if(ip==4)
+      radf4_v(ido, l1, p1, p2, plan->fct[k].tw);
+    else if(ip==2)
+      radf2_v(ido, l1, p1, p2, plan->fct[k].tw);
+    else if(ip==3)
+      radf3_v(ido, l1, p1, p2, plan->fct[k].tw);
+    else
+      radf5_v(ido, l1, p1, p2, plan->fct[k].tw);
+    SWAP (p1,p2,vdbl *);
+    }
+  return p1;
+  }
+
+static vdbl *rfftp_backward_v(rfftp_plan plan, vdbl c[], vdbl ch[])
+  {
+  size_t n=plan->length;
+  size_t l1=1, nf=plan->nfct;
+  vdbl *p1=c, *p2=ch;
+
+  for(size_t k=0; k<nf; k++)
+    {
+    size_t ip = plan->fct[k].fct,
+           ido= n/(ip*l1);
+    if(ip==4)
+      radb4_v(ido, l1, p1, p2, plan->fct[k].tw);
+    else if(ip==2)
+      radb2_v(ido, l1, p1, p2, plan->fct[k].tw);
+    else if(ip==3)
+      radb3_v(ido, l1, p1, p2, plan->fct[k].tw);
+    else
+      radb5_v(ido, l1, p1, p2, plan->fct[k].tw);
+    SWAP (p1,p2,vdbl *);
+    l1*=ip;
+    }
+  return p1;
+  }
+#endif
+
 WARN_UNUSED_RESULT
 static int rfftp_factorize (rfftp_plan plan)
   {
@@ -2189,6 +2959,424 @@ WARN_UNUSED_RESULT static int rfft_forward(rfft_plan plan, double c[], double fc
     return rfftblue_forward(plan->blueplan,c,fct);
   }
 
+static size_t cfftp_plan_size (cfftp_plan plan)
+  { return sizeof(cfftp_plan_i)+cfftp_twsize(plan)*sizeof(cmplx); }
+
+static size_t rfftp_plan_size (rfftp_plan plan)
+  { return sizeof(rfftp_plan_i)+rfftp_twsize(plan)*sizeof(double); }
+
+static size_t fftblue_plan_size (fftblue_plan plan)
+  {
+  return sizeof(fftblue_plan_i)+(2*plan->n+2*plan->n2)*sizeof(double)
+    +cfftp_plan_size(plan->plan);
+  }
+
+static size_t cfft_plan_size (cfft_plan plan)
+  {
+  return sizeof(cfft_plan_i)
+    +(plan->packplan ? cfftp_plan_size(plan->packplan) : 0)
+    +(plan->blueplan ? fftblue_plan_size(plan->blueplan) : 0);
+  }
+
+static size_t rfft_plan_size (rfft_plan plan)
+  {
+  return sizeof(rfft_plan_i)
+    +(plan->packplan ? rfftp_plan_size(plan->packplan) : 0)
+    +(plan->blueplan ? fftblue_plan_size(plan->blueplan) : 0);
+  }
+
+/*
+ * Plan cache
+ *
+ * Building a plan (factorization, twiddle factors and the Bluestein kernel
+ * for lengths with large prime factors) often costs as much as the
+ * transform itself, so plans are kept in a least recently used cache keyed
+ * by length and kind.  Plans are not modified by the transforms, so one
+ * plan can be used by several threads at once.
+ *
+ * The cache is only accessed with the GIL held.  Entries are reference
+ * counted (the cache holds one reference), so an entry which is evicted
+ * while a transform is running without the GIL is freed when the
+ * transform finishes.
+ */
+typedef struct plan_cache_entry {
+    /* doubly linked list, most recently used first */
+    struct plan_cache_entry *prev, *next;
+    size_t length;
+    int is_real;
+    /* a cfft_plan or an rfft_plan, depending on is_real */
+    void *plan;
+    size_t nbytes;
+    npy_intp refcount;
+} plan_cache_entry;
+
+static struct {
+    plan_cache_entry *head, *tail;
+    npy_intp size;
+    size_t nbytes;
+    npy_intp max_size;
+    size_t max_nbytes;
+    npy_intp hits, misses;
+} plan_cache = {NULL, NULL, 0, 0, 32, 100 << 20, 0, 0};
+
+static void
+plan_cache_release(plan_cache_entry *entry)
+{
+    if (--entry->refcount > 0) {
+        return;
+    }
+    if (entry->is_real) {
+        destroy_rfft_plan((rfft_plan)entry->plan);
+    }
+    else {
+        destroy_cfft_plan((cfft_plan)entry->plan);
+    }
+    free(entry);
+}
+
+static void
+plan_cache_unlink(plan_cache_entry *entry)
+{
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    }
+    else {
+        plan_cache.head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    }
+    else {
+        plan_cache.tail = entry->prev;
+    }
+}
+
+static void
+plan_cache_push_front(plan_cache_entry *entry)
+{
+    entry->prev = NULL;
+    entry->next = plan_cache.head;
+    if (plan_cache.head) {
+        plan_cache.head->prev = entry;
+    }
+    else {
+        plan_cache.tail = entry;
+    }
+    plan_cache.head = entry;
+}
+
+/*
+ * Evicts the least recently used plans until the cache is within its
+ * limits.  A single plan larger than `max_nbytes` is kept anyway, like
+ * the plan which was just used.
+ */
+static void
+plan_cache_prune(void)
+{
+    while (plan_cache.size > plan_cache.max_size ||
+           (plan_cache.size > 1 && plan_cache.nbytes > plan_cache.max_nbytes)) {
+        plan_cache_entry *entry = plan_cache.tail;
+
+        plan_cache_unlink(entry);
+        plan_cache.size--;
+        plan_cache.nbytes -= entry->nbytes;
+        plan_cache_release(entry);
+    }
+}
+
+/* Returns a new reference to the cached entry, or NULL if there is none */
+static plan_cache_entry *
+plan_cache_lookup(size_t length, int is_real)
+{
+    plan_cache_entry *entry;
+
+    for (entry = plan_cache.head; entry != NULL; entry = entry->next) {
+        if (entry->length == length && entry->is_real == is_real) {
+            if (entry != plan_cache.head) {
+                plan_cache_unlink(entry);
+                plan_cache_push_front(entry);
+            }
+            entry->refcount++;
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Returns a new reference to an entry holding the plan for transforms of
+ * the given length.  The plan is built without the GIL if it is not in the
+ * cache.  Must be called with the GIL held; the entry has to be given back
+ * with `plan_cache_release`.
+ */
+static plan_cache_entry *
+plan_cache_acquire(size_t length, int is_real)
+{
+    plan_cache_entry *entry = plan_cache_lookup(length, is_real);
+    plan_cache_entry *other;
+    void *plan;
+    size_t nbytes;
+
+    if (entry != NULL) {
+        plan_cache.hits++;
+        return entry;
+    }
+    plan_cache.misses++;
+
+    Py_BEGIN_ALLOW_THREADS;
+    if (is_real) {
+        plan = make_rfft_plan(length);
+        nbytes = plan ? rfft_plan_size((rfft_plan)plan) : 0;
+    }
+    else {
+        plan = make_cfft_plan(length);
+        nbytes = plan ? cfft_plan_size((cfft_plan)plan) : 0;
+    }
+    Py_END_ALLOW_THREADS;
+    if (plan == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    entry = malloc(sizeof(plan_cache_entry));
+    if (entry == NULL) {
+        if (is_real) {
+            destroy_rfft_plan((rfft_plan)plan);
+        }
+        else {
+            destroy_cfft_plan((cfft_plan)plan);
+        }
+        PyErr_NoMemory();
+        return NULL;
+    }
+    entry->length = length;
+    entry->is_real = is_real;
+    entry->plan = plan;
+    entry->nbytes = nbytes;
+    entry->refcount = 1;
+
+    /* Another thread may have cached the same plan while we built ours */
+    other = plan_cache_lookup(length, is_real);
+    if (other != NULL) {
+        plan_cache_release(entry);
+        return other;
+    }
+    if (plan_cache.max_size > 0) {
+        plan_cache_push_front(entry);
+        entry->refcount++;
+        plan_cache.size++;
+        plan_cache.nbytes += nbytes;
+        plan_cache_prune();
+    }
+    return entry;
+}
+
+static void
+plan_cache_clear(void)
+{
+    while (plan_cache.head != NULL) {
+        plan_cache_entry *entry = plan_cache.head;
+
+        plan_cache_unlink(entry);
+        plan_cache_release(entry);
+    }
+    plan_cache.size = 0;
+    plan_cache.nbytes = 0;
+    plan_cache.hits = 0;
+    plan_cache.misses = 0;
+}
+
+/*
+ * Batched transforms
+ *
+ * The lanes of a transform over a multi-dimensional array are independent.
+ * When parallel execution is enabled (see `np.setparallel`) and the array
+ * is large enough, they are split into consecutive chunks which run on the
+ * thread pool of numpy.core, all sharing the same plan.  When the plan only
+ * uses the radices 2, 3, 4 and 5, groups of VLEN lanes are transformed at
+ * once by the vector kernels.  Either way each lane goes through the same
+ * operations and gives exactly the same result as in a serial run.
+ */
+static npy_parallel_api *parallel_api = NULL;
+
+typedef enum {
+    FFT_COMPLEX,
+    FFT_REAL_FORWARD,
+    FFT_REAL_BACKWARD,
+} fft_kind;
+
+typedef struct {
+    fft_kind kind;
+    void *plan;
+    int is_forward;
+    double fct;
+    npy_intp npts, nlanes;
+    /* input and output lanes and their distance (in doubles) */
+    double *dptr, *rptr;
+    npy_intp dstep, rstep;
+    npy_intp ntasks;
+    /* packed plan to be used by the vector kernels, or NULL */
+    void *vplan;
+} fft_batch;
+
+#ifdef VLEN
+/*
+ * Transforms the lanes [start, stop) VLEN at a time.  Returns the first
+ * lane left over for the scalar loop, or -1 when out of memory.
+ */
+static npy_intp
+fft_batch_lanes(fft_batch *b, npy_intp start, npy_intp stop)
+{
+    npy_intp npts = b->npts, dstep = b->dstep, rstep = b->rstep;
+    npy_intp nvec = b->kind == FFT_COMPLEX ? 2*npts : npts;
+    double fct = b->fct;
+    npy_intp i, j;
+    int l;
+
+    /* malloc does not guarantee the alignment of vdbl */
+    char *mem = malloc((2*nvec + 1)*sizeof(vdbl));
+    if (!mem) return -1;
+    vdbl *buf = (vdbl *)(((npy_uintp)mem + sizeof(vdbl) - 1) &
+                         ~(npy_uintp)(sizeof(vdbl) - 1));
+    vdbl *p;
+
+    for (i = start; i + VLEN <= stop; i += VLEN) {
+      double *dptr = b->dptr + i*dstep;
+      double *rptr = b->rptr + i*rstep;
+      switch (b->kind) {
+        case FFT_COMPLEX: {
+          vcmplx *c = (vcmplx *)buf;
+          for (j = 0; j < npts; j++)
+            for (l = 0; l < VLEN; l++) {
+              c[j].r[l] = dptr[l*dstep + 2*j];
+              c[j].i[l] = dptr[l*dstep + 2*j + 1];
+            }
+          c = pass_all_v((cfftp_plan)b->vplan, c, c + npts,
+                         b->is_forward ? -1 : 1);
+          p = (vdbl *)c;
+          break;
+        }
+        case FFT_REAL_FORWARD:
+          for (j = 0; j < npts; j++)
+            for (l = 0; l < VLEN; l++)
+              buf[j][l] = dptr[l*dstep + j];
+          p = rfftp_forward_v((rfftp_plan)b->vplan, buf, buf + npts);
+          break;
+        default:
+          for (l = 0; l < VLEN; l++)
+            buf[0][l] = dptr[l*dstep];
+          for (j = 1; j < npts; j++)
+            for (l = 0; l < VLEN; l++)
+              buf[j][l] = dptr[l*dstep + j + 1];
+          p = rfftp_backward_v((rfftp_plan)b->vplan, buf, buf + npts);
+          break;
+      }
+      if (fct != 1.)
+        for (j = 0; j < nvec; j++)
+          p[j] *= fct;
+      /* the output layout is the same as in fft_batch_task */
+      for (l = 0; l < VLEN; l++) {
+        double *r = rptr + l*rstep;
+        switch (b->kind) {
+          case FFT_COMPLEX:
+          case FFT_REAL_BACKWARD:
+            for (j = 0; j < nvec; j++)
+              r[j] = p[j][l];
+            break;
+          case FFT_REAL_FORWARD:
+            r[rstep-1] = 0.0;
+            for (j = 1; j < npts; j++)
+              r[j+1] = p[j][l];
+            r[0] = p[0][l];
+            r[1] = 0.0;
+            break;
+        }
+      }
+    }
+    free(mem);
+    return i;
+}
+#endif
+
+static int
+fft_batch_task(void *data, npy_intp itask, int NPY_UNUSED(ithread))
+{
+    fft_batch *b = (fft_batch *)data;
+    npy_intp npts = b->npts, rstep = b->rstep;
+    npy_intp start, stop, i;
+
+#ifdef VLEN
+    if (b->vplan != NULL) {
+      /* keep the groups of lanes whole */
+      npy_parallel_chunk_bounds(b->nlanes, b->ntasks, itask, VLEN,
+                                &start, &stop);
+      i = fft_batch_lanes(b, start, stop);
+      if (i < 0) return -1;
+    }
+    else
+#endif
+    {
+      npy_parallel_chunk_bounds(b->nlanes, b->ntasks, itask, 1, &start, &stop);
+      i = start;
+    }
+    double *dptr = b->dptr + i*b->dstep;
+    double *rptr = b->rptr + i*rstep;
+    for (; i < stop; i++) {
+      int res;
+      switch (b->kind) {
+        case FFT_COMPLEX:
+          res = b->is_forward ?
+            cfft_forward((cfft_plan)b->plan, dptr, b->fct) :
+            cfft_backward((cfft_plan)b->plan, dptr, b->fct);
+          break;
+        case FFT_REAL_FORWARD:
+          rptr[rstep-1] = 0.0;
+          memcpy((char *)(rptr+1), dptr, npts*sizeof(double));
+          res = rfft_forward((rfft_plan)b->plan, rptr+1, b->fct);
+          rptr[0] = rptr[1];
+          rptr[1] = 0.0;
+          break;
+        default:
+          memcpy((char *)(rptr + 1), (dptr + 2), (npts - 1)*sizeof(double));
+          rptr[0] = dptr[0];
+          res = rfft_backward((rfft_plan)b->plan, rptr, b->fct);
+          break;
+      }
+      if (res!=0) return -1;
+      dptr += b->dstep;
+      rptr += rstep;
+    }
+    return 0;
+}
+
+/* Transforms all lanes of the batch, called without the GIL */
+static int
+fft_batch_run(fft_batch *b)
+{
+    int nthreads = 1;
+
+    if (parallel_api != NULL && b->nlanes > 1) {
+      nthreads = parallel_api->threads_for_size(b->nlanes*b->npts);
+      if (nthreads > b->nlanes) nthreads = (int)b->nlanes;
+    }
+    b->ntasks = nthreads;
+    b->vplan = NULL;
+#ifdef VLEN
+    if (b->nlanes >= VLEN) {
+      if (b->kind == FFT_COMPLEX) {
+        cfftp_plan plan = ((cfft_plan)b->plan)->packplan;
+        if (plan && cfftp_has_lane_kernels(plan)) b->vplan = plan;
+      }
+      else {
+        rfftp_plan plan = ((rfft_plan)b->plan)->packplan;
+        if (plan && rfftp_has_lane_kernels(plan)) b->vplan = plan;
+      }
+    }
+#endif
+    if (nthreads <= 1)
+      return fft_batch_task(b, 0, 0);
+    return parallel_api->run(b->ntasks, nthreads, &fft_batch_task, b);
+}
+
 static PyObject *
 execute_complex(PyObject *a1, int is_forward, double fct)
 {
@@ -2200,23 +3388,20 @@ execute_complex(PyObject *a1, int is_forward, double fct)
     if (!data) return NULL;
 
     int npts = PyArray_DIM(data, PyArray_NDIM(data) - 1);
-    cfft_plan plan=NULL;
-
-    int nrepeats = PyArray_SIZE(data)/npts;
-    double *dptr = (double *)PyArray_DATA(data);
+    plan_cache_entry *entry = plan_cache_acquire(npts, 0);
+    if (!entry) {
+      Py_DECREF(data);
+      return NULL;
+    }
+    fft_batch batch = {FFT_COMPLEX, entry->plan, is_forward, fct,
+                       npts, PyArray_SIZE(data)/npts};
+    batch.dptr = batch.rptr = (double *)PyArray_DATA(data);
+    batch.dstep = batch.rstep = npts*2;
     int fail=0;
     Py_BEGIN_ALLOW_THREADS;
-    plan = make_cfft_plan(npts);
-    if (!plan) fail=1;
-    if (!fail)
-      for (int i = 0; i < nrepeats; i++) {
-          int res = is_forward ?
-            cfft_forward(plan, dptr, fct) : cfft_backward(plan, dptr, fct);
-          if (res!=0) { fail=1; break; }
-          dptr += npts*2;
-      }
-    if (plan) destroy_cfft_plan(plan);
+    fail = fft_batch_run(&batch);
     Py_END_ALLOW_THREADS;
+    plan_cache_release(entry);
     if (fail) {
       Py_XDECREF(data);
       return PyErr_NoMemory();
@@ -2227,7 +3412,7 @@ execute_complex(PyObject *a1, int is_forward, double fct)
 static PyObject *
 execute_real_forward(PyObject *a1, double fct)
 {
-    rfft_plan plan=NULL;
+    plan_cache_entry *entry;
     int fail = 0;
     PyArrayObject *data = (PyArrayObject *)PyArray_FromAny(a1,
             PyArray_DescrFromType(NPY_DOUBLE), 1, 0,
@@ -2249,27 +3434,24 @@ execute_real_forward(PyObject *a1, double fct)
     free(tdim);
     if (!ret) fail=1;
     if (!fail) {
-      int rstep = PyArray_DIM(ret, PyArray_NDIM(ret) - 1)*2;
-
-      int nrepeats = PyArray_SIZE(data)/npts;
-      double *rptr = (double *)PyArray_DATA(ret),
-             *dptr = (double *)PyArray_DATA(data);
-
+      fft_batch batch = {FFT_REAL_FORWARD, NULL, 1, fct,
+                         npts, PyArray_SIZE(data)/npts};
+      batch.rptr = (double *)PyArray_DATA(ret);
+      batch.dptr = (double *)PyArray_DATA(data);
+      batch.rstep = PyArray_DIM(ret, PyArray_NDIM(ret) - 1)*2;
+      batch.dstep = npts;
+
+      entry = plan_cache_acquire(npts, 1);
+      if (!entry) {
+        Py_DECREF(data);
+        Py_DECREF(ret);
+        return NULL;
+      }
+      batch.plan = entry->plan;
       Py_BEGIN_ALLOW_THREADS;
-      plan = make_rfft_plan(npts);
-      if (!plan) fail=1;
-      if (!fail)
-        for (int i = 0; i < nrepeats; i++) {
-            rptr[rstep-1] = 0.0;
-            memcpy((char *)(rptr+1), dptr, npts*sizeof(double));
-            if (rfft_forward(plan, rptr+1, fct)!=0) {fail=1; break;}
-            rptr[0] = rptr[1];
-            rptr[1] = 0.0;
-            rptr += rstep;
-            dptr += npts;
-      }
-      if (plan) destroy_rfft_plan(plan);
+      fail = fft_batch_run(&batch);
       Py_END_ALLOW_THREADS;
+      plan_cache_release(entry);
     }
     if (fail) {
       Py_XDECREF(data);
@@ -2282,7 +3464,7 @@ execute_real_forward(PyObject *a1, double fct)
 static PyObject *
 execute_real_backward(PyObject *a1, double fct)
 {
-    rfft_plan plan=NULL;
+    plan_cache_entry *entry;
     PyArrayObject *data = (PyArrayObject *)PyArray_FromAny(a1,
             PyArray_DescrFromType(NPY_CDOUBLE), 1, 0,
             NPY_ARRAY_DEFAULT | NPY_ARRAY_ENSUREARRAY | NPY_ARRAY_FORCECAST,
@@ -2294,24 +3476,24 @@ execute_real_backward(PyObject *a1, double fct)
     int fail = 0;
     if (!ret) fail=1;
     if (!fail) {
-      int nrepeats = PyArray_SIZE(ret)/npts;
-      double *rptr = (double *)PyArray_DATA(ret),
-             *dptr = (double *)PyArray_DATA(data);
-
-      Py_BEGIN_ALLOW_THREADS;
-      plan = make_rfft_plan(npts);
-      if (!plan) fail=1;
-      if (!fail) {
-        for (int i = 0; i < nrepeats; i++) {
-          memcpy((char *)(rptr + 1), (dptr + 2), (npts - 1)*sizeof(double));
-          rptr[0] = dptr[0];
-          if (rfft_backward(plan, rptr, fct)!=0) {fail=1; break;}
-          rptr += npts;
-          dptr += npts*2;
-        }
+      fft_batch batch = {FFT_REAL_BACKWARD, NULL, 0, fct,
+                         npts, PyArray_SIZE(ret)/npts};
+      batch.rptr = (double *)PyArray_DATA(ret);
+      batch.dptr = (double *)PyArray_DATA(data);
+      batch.rstep = npts;
+      batch.dstep = npts*2;
+
+      entry = plan_cache_acquire(npts, 1);
+      if (!entry) {
+        Py_DECREF(data);
+        Py_DECREF(ret);
+        return NULL;
       }
-      if (plan) destroy_rfft_plan(plan);
+      batch.plan = entry->plan;
+      Py_BEGIN_ALLOW_THREADS;
+      fail = fft_batch_run(&batch);
       Py_END_ALLOW_THREADS;
+      plan_cache_release(entry);
     }
     if (fail) {
       Py_XDECREF(data);
@@ -2346,13 +3528,61 @@ execute(PyObject *NPY_UNUSED(self), PyObject *args)
                    : execute_complex(a1, is_forward, fct);
 }
 
+static PyObject *
+plan_cache_info(PyObject *NPY_UNUSED(self), PyObject *NPY_UNUSED(args))
+{
+    return Py_BuildValue("{s:n,s:n,s:n,s:n,s:n,s:n}",
+            "size", plan_cache.size,
+            "nbytes", (Py_ssize_t)plan_cache.nbytes,
+            "max_size", plan_cache.max_size,
+            "max_nbytes", (Py_ssize_t)plan_cache.max_nbytes,
+            "hits", plan_cache.hits,
+            "misses", plan_cache.misses);
+}
+
+static PyObject *
+set_plan_cache_limits(PyObject *NPY_UNUSED(self), PyObject *args)
+{
+    Py_ssize_t max_size, max_nbytes;
+
+    if (!PyArg_ParseTuple(args, "nn:set_plan_cache_limits",
+                          &max_size, &max_nbytes)) {
+        return NULL;
+    }
+    if (max_size < 0 || max_nbytes < 0) {
+        PyErr_SetString(PyExc_ValueError,
+                "plan cache limits must not be negative");
+        return NULL;
+    }
+    plan_cache.max_size = max_size;
+    plan_cache.max_nbytes = (size_t)max_nbytes;
+    plan_cache_prune();
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+clear_plan_cache(PyObject *NPY_UNUSED(self), PyObject *NPY_UNUSED(args))
+{
+    plan_cache_clear();
+    Py_RETURN_NONE;
+}
+
 /* List of methods defined in the module */
 
 static struct PyMethodDef methods[] = {
     {"execute",   execute,   1, execute__doc__},
+    {"plan_cache_info", plan_cache_info, METH_NOARGS, NULL},
+    {"set_plan_cache_limits", set_plan_cache_limits, METH_VARARGS, NULL},
+    {"clear_plan_cache", clear_plan_cache, METH_NOARGS, NULL},
     {NULL, NULL, 0, NULL}          /* sentinel */
 };
 
+static void
+module_free(void *NPY_UNUSED(m))
+{
+    plan_cache_clear();
+}
+
 static struct PyModuleDef moduledef = {
         PyModuleDef_HEAD_INIT,
         "_pocketfft_internal",
@@ -2362,7 +3592,7 @@ static struct PyModuleDef moduledef = {
         NULL,
         NULL,
         NULL,
-        NULL
+        module_free
 };
 
 /* Initialization function for the module */
@@ -2377,6 +3607,12 @@ PyMODINIT_FUNC PyInit__pocketfft_internal(void)
     /* Import the array object */
     import_array();
 
+    parallel_api = npy_parallel_import_api();
+    if (parallel_api == NULL) {
+        Py_DECREF(m);
+        return NULL;
+    }
+
     /* XXXX Add constants here */
 
     return m;
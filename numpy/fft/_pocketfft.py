@@ -17,6 +17,9 @@
 ifft2(a, s=None, axes=(-2, -1), norm="backward")
 rfft2(a, s=None, axes=(-2,-1), norm="backward")
 irfft2(a, s=None, axes=(-2, -1), norm="backward")
+plan_cache_info()
+set_plan_cache_limits(max_size=None, max_nbytes=None)
+clear_plan_cache()
 
 i = inverse transform
 r = transform of purely real data
@@ -28,7 +31,8 @@
 
 """
 __all__ = ['fft', 'ifft', 'rfft', 'irfft', 'hfft', 'ihfft', 'rfftn',
-           'irfftn', 'rfft2', 'irfft2', 'fft2', 'ifft2', 'fftn', 'ifftn']
+           'irfftn', 'rfft2', 'irfft2', 'fft2', 'ifft2', 'fftn', 'ifftn',
+           'plan_cache_info', 'set_plan_cache_limits', 'clear_plan_cache']
 
 import functools
 
@@ -36,6 +40,7 @@
 from . import _pocketfft_internal as pfi
 from numpy.core.multiarray import normalize_axis_index
 from numpy.core import overrides
+from numpy.core.overrides import set_module
 
 
 array_function_dispatch = functools.partial(
@@ -1422,3 +1427,109 @@ def irfft2(a, s=None, axes=(-2, -1), norm=None):
            [4., 4., 4., 4., 4.]])
     """
     return irfftn(a, s, axes, norm)
+
+
+@set_module('numpy.fft')
+def plan_cache_info():
+    """
+    Return information about the cache of FFT plans.
+
+    The transforms need a plan for each length, which holds the
+    factorization of the length and the precomputed twiddle factors.
+    Plans are cached, so that repeated transforms of the same length
+    do not recompute them.  The least recently used plans are dropped
+    once the cache exceeds its limits (see `set_plan_cache_limits`).
+
+    .. versionadded:: 1.22.0
+
+    Returns
+    -------
+    info : dict
+        A dictionary with the following keys:
+
+        size
+            Number of cached plans.
+        nbytes
+            Memory used by the cached plans in bytes.
+        max_size
+            Maximum number of cached plans.
+        max_nbytes
+            Maximum memory used by cached plans in bytes.
+        hits, misses
+            Number of transforms which found their plan in the cache and
+            which had to compute it, since the cache was last cleared.
+
+    See Also
+    --------
+    set_plan_cache_limits, clear_plan_cache
+
+    Examples
+    --------
+    >>> np.fft.clear_plan_cache()
+    >>> x = np.fft.rfft(np.ones(128))
+    >>> x = np.fft.rfft(np.ones(128))
+    >>> info = np.fft.plan_cache_info()
+    >>> info['size'], info['hits'], info['misses']
+    (1, 1, 1)
+
+    """
+    return pfi.plan_cache_info()
+
+
+@set_module('numpy.fft')
+def set_plan_cache_limits(max_size=None, max_nbytes=None):
+    """
+    Set the limits of the cache of FFT plans.
+
+    Plans are dropped, least recently used first, while the cache holds
+    more than `max_size` plans or the plans use more than `max_nbytes`
+    bytes.  The most recently used plan is always kept unless `max_size`
+    is 0, which disables the cache.
+
+    .. versionadded:: 1.22.0
+
+    Parameters
+    ----------
+    max_size : int, optional
+        Maximum number of cached plans, 32 by default.  Unchanged if None.
+    max_nbytes : int, optional
+        Maximum memory used by the cached plans in bytes, 100 MiB by
+        default.  Unchanged if None.
+
+    Returns
+    -------
+    old_limits : tuple of int
+        The previous ``(max_size, max_nbytes)``, so that
+        ``set_plan_cache_limits(*old_limits)`` restores them.
+
+    See Also
+    --------
+    plan_cache_info, clear_plan_cache
+
+    """
+    info = pfi.plan_cache_info()
+    old_limits = (info['max_size'], info['max_nbytes'])
+    if max_size is None:
+        max_size = old_limits[0]
+    if max_nbytes is None:
+        max_nbytes = old_limits[1]
+    pfi.set_plan_cache_limits(max_size, max_nbytes)
+    return old_limits
+
+
+@set_module('numpy.fft')
+def clear_plan_cache():
+    """
+    Remove all plans from the cache of FFT plans.
+
+    The hit and miss counters reported by `plan_cache_info` are reset
+    as well.
+
+    .. versionadded:: 1.22.0
+
+    See Also
+    --------
+    plan_cache_info, set_plan_cache_limits
+
+    """
+    pfi.clear_plan_cache()
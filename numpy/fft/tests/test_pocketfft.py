@@ -2,7 +2,7 @@
 import pytest
 from numpy.random import random
 from numpy.testing import (
-        assert_array_equal, assert_raises, assert_allclose
+        assert_array_equal, assert_equal, assert_raises, assert_allclose
         )
 import threading
 import queue
@@ -268,6 +268,121 @@ def test_fft_with_order(dtype, order, fft):
         raise ValueError()
 
 
+class TestPlanCache:
+    def setup(self):
+        self.old_limits = np.fft.set_plan_cache_limits()
+        np.fft.clear_plan_cache()
+
+    def teardown(self):
+        np.fft.set_plan_cache_limits(*self.old_limits)
+        np.fft.clear_plan_cache()
+
+    def test_hits_and_misses(self):
+        x = random(30)
+        expected = np.fft.rfft(x)
+        assert_array_equal(np.fft.rfft(x), expected)
+        # complex transforms of the same length use their own plan
+        np.fft.fft(x)
+        info = np.fft.plan_cache_info()
+        assert_equal((info['size'], info['hits'], info['misses']), (2, 1, 2))
+        assert info['nbytes'] > 0
+
+        np.fft.clear_plan_cache()
+        info = np.fft.plan_cache_info()
+        assert_equal((info['size'], info['nbytes'], info['hits'],
+                      info['misses']), (0, 0, 0, 0))
+
+    def test_lru_eviction(self):
+        np.fft.set_plan_cache_limits(max_size=2)
+        for n in [16, 17, 16, 18]:
+            np.fft.fft(random(n))
+        info = np.fft.plan_cache_info()
+        assert_equal((info['size'], info['hits'], info['misses']), (2, 1, 3))
+        # 17 was the least recently used plan
+        np.fft.fft(random(16))
+        np.fft.fft(random(18))
+        assert_equal(np.fft.plan_cache_info()['hits'], 3)
+        np.fft.fft(random(17))
+        assert_equal(np.fft.plan_cache_info()['misses'], 4)
+
+    def test_nbytes_limit(self):
+        np.fft.set_plan_cache_limits(max_nbytes=0)
+        np.fft.rfft(random(1000))
+        np.fft.rfft(random(1001))
+        # the most recently used plan is always kept
+        info = np.fft.plan_cache_info()
+        assert_equal(info['size'], 1)
+        assert_equal(info['max_nbytes'], 0)
+
+    def test_disabled(self):
+        x = random(97) + 1j*random(97)
+        expected = np.fft.ifft(x)
+        np.fft.clear_plan_cache()
+        assert_equal(np.fft.set_plan_cache_limits(max_size=0)[0], 32)
+        assert_array_equal(np.fft.ifft(x), expected)
+        assert_array_equal(np.fft.ifft(x), expected)
+        info = np.fft.plan_cache_info()
+        assert_equal((info['size'], info['nbytes'], info['misses']), (0, 0, 2))
+
+    def test_invalid_limits(self):
+        assert_raises(ValueError, np.fft.set_plan_cache_limits, -1)
+        assert_raises(ValueError, np.fft.set_plan_cache_limits, None, -1)
+
+    def test_threads_with_eviction(self):
+        # plans evicted by one thread may still be in use by another one
+        np.fft.set_plan_cache_limits(max_size=1)
+        lengths = [64, 65, 127, 128, 1000, 1031]
+        inputs = [random((20, n)) for n in lengths]
+        expected = [np.fft.rfft(x) for x in inputs]
+
+        def worker(q):
+            for _ in range(10):
+                for x, e in zip(inputs, expected):
+                    if not np.array_equal(np.fft.rfft(x), e):
+                        q.put(False)
+                        return
+            q.put(True)
+
+        q = queue.Queue()
+        t = [threading.Thread(target=worker, args=(q,)) for i in range(8)]
+        [x.start() for x in t]
+        [x.join() for x in t]
+        assert all(q.get(timeout=5) for i in range(len(t)))
+
+
+@pytest.mark.parametrize("func, shape", [
+    (np.fft.fft, (100, 64)),
+    (np.fft.ifft, (7, 3, 97)),
+    (np.fft.rfft, (100, 64)),
+    (np.fft.irfft, (33, 65)),
+    (np.fft.fft2, (40, 48)),
+    (np.fft.rfftn, (6, 20, 30)),
+    (np.fft.irfftn, (6, 20, 30)),
+])
+def test_parallel_lanes(func, shape):
+    # lanes split across threads give bit-identical results
+    x = random(shape) + 1j*random(shape)
+    if func is np.fft.rfft or func is np.fft.rfftn:
+        x = x.real
+    expected = func(x)
+    for threads in [2, 3, 8]:
+        with np.parallelstate(threads=threads, threshold=1):
+            assert_array_equal(func(x), expected)
+
+
+@pytest.mark.parametrize("func", [np.fft.fft, np.fft.ifft,
+                                  np.fft.rfft, np.fft.irfft])
+@pytest.mark.parametrize("n", [2, 3, 5, 12, 60, 97, 1024])
+@pytest.mark.parametrize("norm", [None, "ortho", "forward"])
+def test_batched_lanes(func, n, norm):
+    # lanes transformed together give the same bits as one at a time
+    x = random((7, n)) + 1j*random((7, n))
+    if func is np.fft.rfft:
+        x = x.real
+    expected = np.array([func(row, norm=norm) for row in x])
+    assert_array_equal(func(x, norm=norm), expected)
+
+
 class TestFFTThreadSafe:
     threads = 16
     input_shape = (800, 200)
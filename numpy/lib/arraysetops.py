@@ -18,6 +18,7 @@
 
 import numpy as np
 from numpy.core import overrides
+from numpy.core.multiarray import _unique_hash, _isin_hash
 
 
 array_function_dispatch = functools.partial(
@@ -131,13 +132,13 @@ def _unpack_tuple(x):
 
 
 def _unique_dispatcher(ar, return_index=None, return_inverse=None,
-                       return_counts=None, axis=None):
+                       return_counts=None, axis=None, *, sorted=None):
     return (ar,)
 
 
 @array_function_dispatch(_unique_dispatcher)
 def unique(ar, return_index=False, return_inverse=False,
-           return_counts=False, axis=None):
+           return_counts=False, axis=None, *, sorted=True):
     """
     Find the unique elements of an array.
 
@@ -175,6 +176,13 @@ def unique(ar, return_index=False, return_inverse=False,
 
         .. versionadded:: 1.13.0
 
+    sorted : bool, optional
+        If True (default), the unique values are sorted.  If False, their
+        order is unspecified, which allows finding them with a hash table
+        rather than by sorting `ar`.
+
+        .. versionadded:: 1.22.0
+
     Returns
     -------
     unique : ndarray
@@ -255,6 +263,13 @@ def unique(ar, return_index=False, return_inverse=False,
     >>> u[indices]
     array([1, 2, 6, 4, 2, 3, 2])
 
+    Count values without sorting the unique values:
+
+    >>> a = np.array([3, 1, 3, 2, 1, 3])
+    >>> values, counts = np.unique(a, return_counts=True, sorted=False)
+    >>> dict(zip(values, counts))  # doctest: +SKIP
+    {3: 3, 1: 2, 2: 1}
+
     Reconstruct the input values from the unique values and counts:
 
     >>> a = np.array([1, 2, 6, 4, 2, 3, 2])
@@ -269,7 +284,8 @@ def unique(ar, return_index=False, return_inverse=False,
     """
     ar = np.asanyarray(ar)
     if axis is None:
-        ret = _unique1d(ar, return_index, return_inverse, return_counts)
+        ret = _unique1d(ar, return_index, return_inverse, return_counts,
+                        sorted=sorted)
         return _unpack_tuple(ret)
 
     # axis was specified and not None
@@ -312,18 +328,30 @@ def reshape_uniq(uniq):
         return uniq
 
     output = _unique1d(consolidated, return_index,
-                       return_inverse, return_counts)
+                       return_inverse, return_counts, sorted=sorted)
     output = (reshape_uniq(output[0]),) + output[1:]
     return _unpack_tuple(output)
 
 
+# With sorted uniques the hash table is only used if there are at most
+# ``1 / _UNIQUE_HASH_MAX_FRACTION`` as many unique values as elements, as
+# sorting the uniques takes about as long as sorting `ar` otherwise.
+_UNIQUE_HASH_MAX_FRACTION = 8
+
+
 def _unique1d(ar, return_index=False, return_inverse=False,
-              return_counts=False):
+              return_counts=False, *, sorted=True):
     """
     Find the unique elements of an array, ignoring shape.
     """
     ar = np.asanyarray(ar).flatten()
 
+    if type(ar) is np.ndarray:
+        ret = _unique1d_hash(ar, return_index, return_inverse,
+                             return_counts, sorted)
+        if ret is not None:
+            return ret
+
     optional_indices = return_index or return_inverse
 
     if optional_indices:
@@ -361,6 +389,37 @@ def _unique1d(ar, return_index=False, return_inverse=False,
     return ret
 
 
+def _unique1d_hash(ar, return_index, return_inverse, return_counts, sorted):
+    """
+    `_unique1d` for a contiguous 1-D ndarray using a hash table, returns
+    None if the dtype is not supported or (for sorted unique values) there
+    are too many unique values for the hash table to pay off.
+    """
+    max_unique = ar.size // _UNIQUE_HASH_MAX_FRACTION if sorted else -1
+    res = _unique_hash(ar, return_inverse, max_unique)
+    if res is None:
+        return None
+    index, inverse, counts = res
+
+    if sorted:
+        perm = ar[index].argsort(kind='stable')
+        index = index[perm]
+        counts = counts[perm]
+        if return_inverse:
+            rank = np.empty_like(perm)
+            rank[perm] = np.arange(perm.size)
+            inverse = rank[inverse]
+
+    ret = (ar[index],)
+    if return_index:
+        ret += (index,)
+    if return_inverse:
+        ret += (inverse,)
+    if return_counts:
+        ret += (counts,)
+    return ret
+
+
 def _intersect1d_dispatcher(
         ar1, ar2, assume_unique=None, return_indices=None):
     return (ar1, ar2)
@@ -438,31 +497,31 @@ def intersect1d(ar1, ar2, assume_unique=False, return_indices=False):
             ar2, ind2 = unique(ar2, return_index=True)
         else:
             ar1 = unique(ar1)
-            ar2 = unique(ar2)
     else:
         ar1 = ar1.ravel()
         ar2 = ar2.ravel()
 
+    if not return_indices:
+        # only the unique values of `ar1` need to be sorted
+        if assume_unique:
+            ar1 = np.sort(ar1)
+        int1d = ar1[in1d(ar1, ar2, assume_unique=assume_unique)]
+        return int1d.astype(np.result_type(ar1, ar2), copy=False)
+
     aux = np.concatenate((ar1, ar2))
-    if return_indices:
-        aux_sort_indices = np.argsort(aux, kind='mergesort')
-        aux = aux[aux_sort_indices]
-    else:
-        aux.sort()
+    aux_sort_indices = np.argsort(aux, kind='mergesort')
+    aux = aux[aux_sort_indices]
 
     mask = aux[1:] == aux[:-1]
     int1d = aux[:-1][mask]
 
-    if return_indices:
-        ar1_indices = aux_sort_indices[:-1][mask]
-        ar2_indices = aux_sort_indices[1:][mask] - ar1.size
-        if not assume_unique:
-            ar1_indices = ind1[ar1_indices]
-            ar2_indices = ind2[ar2_indices]
+    ar1_indices = aux_sort_indices[:-1][mask]
+    ar2_indices = aux_sort_indices[1:][mask] - ar1.size
+    if not assume_unique:
+        ar1_indices = ind1[ar1_indices]
+        ar2_indices = ind2[ar2_indices]
 
-        return int1d, ar1_indices, ar2_indices
-    else:
-        return int1d
+    return int1d, ar1_indices, ar2_indices
 
 
 def _setxor1d_dispatcher(ar1, ar2, assume_unique=None):
@@ -586,6 +645,10 @@ def in1d(ar1, ar2, assume_unique=False, invert=False):
     ar1 = np.asarray(ar1).ravel()
     ar2 = np.asarray(ar2).ravel()
 
+    mask = _in1d_hash(ar1, ar2, invert)
+    if mask is not None:
+        return mask
+
     # Ensure that iteration through object arrays yields size-1 arrays
     if ar2.dtype == object:
         ar2 = ar2.reshape(-1, 1)
@@ -633,6 +696,24 @@ def in1d(ar1, ar2, assume_unique=False, invert=False):
         return ret[rev_idx]
 
 
+def _in1d_hash(ar1, ar2, invert):
+    """
+    `in1d` for 1-D ndarrays using a bitmap, a merge or a hash table, returns
+    None if the dtypes are not supported.
+    """
+    kinds = ar1.dtype.kind + ar2.dtype.kind
+    if kinds[0] != kinds[1] and kinds.strip("biufc"):
+        return None
+    try:
+        dtype = np.result_type(ar1, ar2)
+    except TypeError:
+        return None
+    dtype = dtype.newbyteorder("=")
+    ar1 = np.ascontiguousarray(ar1, dtype=dtype)
+    ar2 = np.ascontiguousarray(ar2, dtype=dtype)
+    return _isin_hash(ar1, ar2, invert)
+
+
 def _isin_dispatcher(element, test_elements, assume_unique=None, invert=None):
     return (element, test_elements)
 
@@ -822,5 +903,4 @@ def setdiff1d(ar1, ar2, assume_unique=False):
         ar1 = np.asarray(ar1).ravel()
     else:
         ar1 = unique(ar1)
-        ar2 = unique(ar2)
-    return ar1[in1d(ar1, ar2, assume_unique=True, invert=True)]
+    return ar1[in1d(ar1, ar2, assume_unique=assume_unique, invert=True)]
@@ -3,7 +3,7 @@
 __all__: List[str]
 
 def ediff1d(ary, to_end=..., to_begin=...): ...
-def unique(ar, return_index=..., return_inverse=..., return_counts=..., axis=...): ...
+def unique(ar, return_index=..., return_inverse=..., return_counts=..., axis=..., *, sorted=...): ...
 def intersect1d(ar1, ar2, assume_unique=..., return_indices=...): ...
 def setxor1d(ar1, ar2, assume_unique=...): ...
 def in1d(ar1, ar2, assume_unique=..., invert=...): ...
@@ -8,6 +8,7 @@
 
 import numpy as np
 from numpy.core import overrides
+from numpy.core.multiarray import _histogram
 
 __all__ = ['histogram', 'histogramdd', 'histogram_bin_edges']
 
@@ -463,6 +464,25 @@ def _search_sorted_inclusive(a, v):
     ))
 
 
+def _histogram_c(sample, edges, uniform, weights):
+    """
+    Flattened histogram of the 1D arrays `sample` (one per dimension) with
+    the given bin edges, computed in C.  Returns None if the samples cannot
+    be compared to the edges as doubles or the weights are not real.
+    """
+    for x, e in zip(sample, edges):
+        dt = np.result_type(x.dtype, e.dtype)
+        if not ((dt.kind == 'f' and dt.itemsize <= 8) or
+                (dt.kind in 'iu' and dt.itemsize <= 4)):
+            return None
+    if weights is not None:
+        if not np.can_cast(weights.dtype, np.double):
+            return None
+        weights = np.ascontiguousarray(weights, dtype=np.double)
+    edges = [np.ascontiguousarray(e, dtype=np.double) for e in edges]
+    return _histogram(sample, edges, uniform, weights)
+
+
 def _histogram_bin_edges_dispatcher(a, bins=None, range=None, weights=None):
     return (a, bins, weights)
 
@@ -810,7 +830,10 @@ def histogram(a, bins=10, range=None, normed=None, weights=None,
         np.can_cast(weights.dtype, complex)
     )
 
-    if uniform_bins is not None and simple_weights:
+    n = _histogram_c((a,), (bin_edges,), (uniform_bins is not None,), weights)
+    if n is not None:
+        n = n.astype(ntype, copy=False)
+    elif uniform_bins is not None and simple_weights:
         # Fast algorithm for equal bins
         # We now convert values of a to bin indices, under the assumption of
         # equal bin widths (which is valid here).
@@ -929,6 +952,45 @@ def histogram(a, bins=10, range=None, normed=None, weights=None,
         return n, bin_edges
 
 
+def _histogramdd_bincount(sample, edges, nbin, weights):
+    """
+    Histogram of the (N, D) array `sample` using `bincount`, the fallback
+    of `histogramdd` if `_histogram_c` does not support the dtypes.
+    """
+    D = len(edges)
+
+    # Compute the bin number each sample falls into.
+    Ncount = tuple(
+        # avoid np.digitize to work around gh-11022
+        np.searchsorted(edges[i], sample[:, i], side='right')
+        for i in _range(D)
+    )
+
+    # Using digitize, values that fall on an edge are put in the right bin.
+    # For the rightmost bin, we want values equal to the right edge to be
+    # counted in the last bin, and not as an outlier.
+    for i in _range(D):
+        # Find which points are on the rightmost edge.
+        on_edge = (sample[:, i] == edges[i][-1])
+        # Shift these points one bin to the left.
+        Ncount[i][on_edge] -= 1
+
+    # Compute the sample indices in the flattened histogram matrix.
+    # This raises an error if the array is too large.
+    xy = np.ravel_multi_index(Ncount, nbin)
+
+    # Compute the number of repetitions in xy and assign it to the
+    # flattened histmat.
+    hist = np.bincount(xy, weights, minlength=nbin.prod())
+
+    # Shape into a proper matrix
+    hist = hist.reshape(nbin)
+
+    # Remove outliers (indices 0 and -1 for each dimension).
+    core = D*(slice(1, -1),)
+    return hist[core]
+
+
 def _histogramdd_dispatcher(sample, bins=None, range=None, normed=None,
                             weights=None, density=None):
     if hasattr(sample, 'shape'):  # same condition as used in histogramdd
@@ -1022,6 +1084,7 @@ def histogramdd(sample, bins=10, range=None, normed=None, weights=None,
     nbin = np.empty(D, int)
     edges = D*[None]
     dedges = D*[None]
+    uniform = D*[False]
     if weights is not None:
         weights = np.asarray(weights)
 
@@ -1057,6 +1120,7 @@ def histogramdd(sample, bins=10, range=None, normed=None, weights=None,
                 ) from e
                 
             edges[i] = np.linspace(smin, smax, n + 1)    
+            uniform[i] = True
         elif np.ndim(bins[i]) == 1:
             edges[i] = np.asarray(bins[i])
             if np.any(edges[i][:-1] > edges[i][1:]):
@@ -1070,40 +1134,16 @@ def histogramdd(sample, bins=10, range=None, normed=None, weights=None,
         nbin[i] = len(edges[i]) + 1  # includes an outlier on each end
         dedges[i] = np.diff(edges[i])
 
-    # Compute the bin number each sample falls into.
-    Ncount = tuple(
-        # avoid np.digitize to work around gh-11022
-        np.searchsorted(edges[i], sample[:, i], side='right')
-        for i in _range(D)
-    )
-
-    # Using digitize, values that fall on an edge are put in the right bin.
-    # For the rightmost bin, we want values equal to the right edge to be
-    # counted in the last bin, and not as an outlier.
-    for i in _range(D):
-        # Find which points are on the rightmost edge.
-        on_edge = (sample[:, i] == edges[i][-1])
-        # Shift these points one bin to the left.
-        Ncount[i][on_edge] -= 1
-
-    # Compute the sample indices in the flattened histogram matrix.
-    # This raises an error if the array is too large.
-    xy = np.ravel_multi_index(Ncount, nbin)
-
-    # Compute the number of repetitions in xy and assign it to the
-    # flattened histmat.
-    hist = np.bincount(xy, weights, minlength=nbin.prod())
-
-    # Shape into a proper matrix
-    hist = hist.reshape(nbin)
+    hist = _histogram_c([sample[:, i] for i in _range(D)], edges, uniform,
+                        weights)
+    if hist is None:
+        hist = _histogramdd_bincount(sample, edges, nbin, weights)
+    else:
+        hist = hist.reshape(nbin - 2)
 
     # This preserves the (bad) behavior observed in gh-7845, for now.
     hist = hist.astype(float, casting='safe')
 
-    # Remove outliers (indices 0 and -1 for each dimension).
-    core = D*(slice(1, -1),)
-    hist = hist[core]
-
     # handle the aliasing normed argument
     if normed is None:
         if density is None:
@@ -13,8 +13,9 @@
 from ._datasource import DataSource
 from numpy.core import overrides
 from numpy.core.multiarray import packbits, unpackbits
+from numpy.core._multiarray_umath import (
+    _load_from_filelike, _format_float_rows)
 from numpy.core.overrides import set_array_function_like_doc, set_module
-from numpy.core._internal import recursive
 from ._iotools import (
     LineSplitter, NameValidator, StringConverter, ConverterError,
     ConverterLockError, ConversionWarning, _is_string_like,
@@ -761,13 +762,33 @@ def floatconv(x):
         return asstr
 
 
-# amount of lines loadtxt reads in one chunk, can be overridden for testing
+def _loadtxt_flatten_dtype(dt, offset=0):
+    """Return the (dtype, byte offset) of each column stored in `dt`."""
+    if dt.names is None:
+        if dt.shape == ():
+            return [(dt, offset)]
+        base = dt.base
+        columns = []
+        for i in range(int(np.prod(dt.shape))):
+            columns.extend(
+                _loadtxt_flatten_dtype(base, offset + i * base.itemsize))
+        return columns
+    columns = []
+    for name in dt.names:
+        tp, field_offset = dt.fields[name][:2]
+        columns.extend(_loadtxt_flatten_dtype(tp, offset + field_offset))
+    return columns
+
+
+# amount of rows loadtxt allocates at first (they grow as needed), can be
+# overridden for testing
 _loadtxt_chunksize = 50000
 
 
 def _loadtxt_dispatcher(fname, dtype=None, comments=None, delimiter=None,
                         converters=None, skiprows=None, usecols=None, unpack=None,
-                        ndmin=None, encoding=None, max_rows=None, *, like=None):
+                        ndmin=None, encoding=None, max_rows=None, *,
+                        quotechar=None, like=None):
     return (like,)
 
 
@@ -775,7 +796,8 @@ def _loadtxt_dispatcher(fname, dtype=None, comments=None, delimiter=None,
 @set_module('numpy')
 def loadtxt(fname, dtype=float, comments='#', delimiter=None,
             converters=None, skiprows=0, usecols=None, unpack=False,
-            ndmin=0, encoding='bytes', max_rows=None, *, like=None):
+            ndmin=0, encoding='bytes', max_rows=None, *, quotechar=None,
+            like=None):
     r"""
     Load data from a text file.
 
@@ -843,6 +865,14 @@ def loadtxt(fname, dtype=float, comments='#', delimiter=None,
         is to read all the lines.
 
         .. versionadded:: 1.16.0
+    quotechar : str, optional
+        The character used to quote fields.  Inside quotes, delimiters,
+        comment characters and newlines are part of the field, and two
+        consecutive quote characters are read as a single quote character.
+        The quote characters themselves are removed.  The default, None,
+        disables quoting.
+
+        .. versionadded:: 1.22.0
     ${ARRAY_FUNCTION_LIKE}
 
         .. versionadded:: 1.20.0
@@ -864,6 +894,11 @@ def loadtxt(fname, dtype=float, comments='#', delimiter=None,
     `genfromtxt` function provides more sophisticated handling of, e.g.,
     lines with missing values.
 
+    The text is split and parsed in C, directly into the result array.
+    Fields that cannot be parsed there, and columns with a user converter
+    or a dtype without a C parser (e.g. ``longdouble`` or ``object``), are
+    converted by calling a Python function for each value, which is slower.
+
     .. versionadded:: 1.10.0
 
     The strings produced by the Python float.hex method can be used as
@@ -908,112 +943,9 @@ def loadtxt(fname, dtype=float, comments='#', delimiter=None,
             fname, dtype=dtype, comments=comments, delimiter=delimiter,
             converters=converters, skiprows=skiprows, usecols=usecols,
             unpack=unpack, ndmin=ndmin, encoding=encoding,
-            max_rows=max_rows, like=like
+            max_rows=max_rows, quotechar=quotechar, like=like
         )
 
-    # - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    # Nested functions used by loadtxt.
-    # - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-    # not to be confused with the flatten_dtype we import...
-    @recursive
-    def flatten_dtype_internal(self, dt):
-        """Unpack a structured data-type, and produce re-packing info."""
-        if dt.names is None:
-            # If the dtype is flattened, return.
-            # If the dtype has a shape, the dtype occurs
-            # in the list more than once.
-            shape = dt.shape
-            if len(shape) == 0:
-                return ([dt.base], None)
-            else:
-                packing = [(shape[-1], list)]
-                if len(shape) > 1:
-                    for dim in dt.shape[-2::-1]:
-                        packing = [(dim*packing[0][0], packing*dim)]
-                return ([dt.base] * int(np.prod(dt.shape)), packing)
-        else:
-            types = []
-            packing = []
-            for field in dt.names:
-                tp, bytes = dt.fields[field]
-                flat_dt, flat_packing = self(tp)
-                types.extend(flat_dt)
-                # Avoid extra nesting for subarrays
-                if tp.ndim > 0:
-                    packing.extend(flat_packing)
-                else:
-                    packing.append((len(flat_dt), flat_packing))
-            return (types, packing)
-
-    @recursive
-    def pack_items(self, items, packing):
-        """Pack items into nested lists based on re-packing info."""
-        if packing is None:
-            return items[0]
-        elif packing is tuple:
-            return tuple(items)
-        elif packing is list:
-            return list(items)
-        else:
-            start = 0
-            ret = []
-            for length, subpacking in packing:
-                ret.append(self(items[start:start+length], subpacking))
-                start += length
-            return tuple(ret)
-
-    def split_line(line):
-        """Chop off comments, strip, and split at delimiter. """
-        line = _decode_line(line, encoding=encoding)
-
-        if comments is not None:
-            line = regex_comments.split(line, maxsplit=1)[0]
-        line = line.strip('\r\n')
-        return line.split(delimiter) if line else []
-
-    def read_data(chunk_size):
-        """Parse each line, including the first.
-
-        The file read, `fh`, is a global defined above.
-
-        Parameters
-        ----------
-        chunk_size : int
-            At most `chunk_size` lines are read at a time, with iteration
-            until all lines are read.
-
-        """
-        X = []
-        line_iter = itertools.chain([first_line], fh)
-        line_iter = itertools.islice(line_iter, max_rows)
-        for i, line in enumerate(line_iter):
-            vals = split_line(line)
-            if len(vals) == 0:
-                continue
-            if usecols:
-                vals = [vals[j] for j in usecols]
-            if len(vals) != N:
-                line_num = i + skiprows + 1
-                raise ValueError("Wrong number of columns at line %d"
-                                 % line_num)
-
-            # Convert each value according to its column and store
-            items = [conv(val) for (conv, val) in zip(converters, vals)]
-
-            # Then pack it according to the dtype's nesting
-            items = pack_items(items, packing)
-            X.append(items)
-            if len(X) > chunk_size:
-                yield X
-                X = []
-        if X:
-            yield X
-
-    # - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-    # Main body of loadtxt.
-    # - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
     # Check correctness of the values of `ndmin`
     if ndmin not in [0, 1, 2]:
         raise ValueError('Illegal value of ndmin keyword: %s' % ndmin)
@@ -1023,13 +955,16 @@ def read_data(chunk_size):
         if isinstance(comments, (str, bytes)):
             comments = [comments]
         comments = [_decode_line(x) for x in comments]
-        # Compile regex for comments beforehand
-        comments = (re.escape(comment) for comment in comments)
-        regex_comments = re.compile('|'.join(comments))
 
     if delimiter is not None:
         delimiter = _decode_line(delimiter)
 
+    if quotechar is not None:
+        quotechar = _decode_line(quotechar)
+
+    if max_rows is not None and max_rows < 0:
+        raise ValueError("max_rows must be a non-negative integer or None")
+
     user_converters = converters
 
     byte_converters = False
@@ -1053,14 +988,24 @@ def read_data(chunk_size):
                     type(col_idx),
                     )
                 raise
-        # Fall back to existing code
-        usecols = usecols_as_list
+        # An empty list means all columns
+        usecols = usecols_as_list or None
 
     # Make sure we're dealing with a proper dtype
     dtype = np.dtype(dtype)
-    defconv = _getconv(dtype)
-
-    dtype_types, packing = flatten_dtype_internal(dtype)
+    read_dtype = dtype
+    if dtype.kind in 'SU' and dtype.itemsize == 0:
+        # The string length is only known once all values are read
+        read_dtype = np.dtype(object)
+
+    # Each column is parsed into a (dtype, offset) of a row.  Plain dtypes
+    # are homogeneous and the number of columns is found from the data.
+    homogeneous = read_dtype.names is None and read_dtype.shape == ()
+    if homogeneous:
+        fields = [(read_dtype, 0, _getconv(dtype))]
+    else:
+        fields = [(dt, offset, _getconv(dt))
+                  for dt, offset in _loadtxt_flatten_dtype(dtype)]
 
     fown = False
     try:
@@ -1069,11 +1014,11 @@ def read_data(chunk_size):
         if _is_string_like(fname):
             fh = np.lib._datasource.open(fname, 'rt', encoding=encoding)
             fencoding = getattr(fh, 'encoding', 'latin1')
-            fh = iter(fh)
             fown = True
         else:
-            fh = iter(fname)
+            fh = fname
             fencoding = getattr(fname, 'encoding', 'latin1')
+        fh_iter = iter(fh)
     except TypeError as e:
         raise ValueError(
             'fname must be a string, file handle, or generator'
@@ -1088,81 +1033,56 @@ def read_data(chunk_size):
         import locale
         fencoding = locale.getpreferredencoding()
 
+    # By preference, use the converters specified by the user
+    col_converters = {}
+    for i, conv in (user_converters or {}).items():
+        if usecols:
+            try:
+                i = usecols.index(i)
+            except ValueError:
+                # Unused converter specified
+                continue
+        if byte_converters:
+            # converters may use decode to workaround numpy's old
+            # behaviour, so encode the string again before passing to
+            # the user converter
+            def tobytes_first(x, conv):
+                if type(x) is bytes:
+                    return conv(x)
+                return conv(x.encode("latin1"))
+            conv = functools.partial(tobytes_first, conv=conv)
+        elif conv is bytes:
+            conv = lambda x: x.encode(fencoding)
+        col_converters[i] = conv
+
+    # Files are read in large chunks, unless only part of the file should
+    # be consumed; then read line by line to leave the rest of it unread.
+    filelike = hasattr(fh, 'read') and max_rows is None
     try:
-        # Skip the first `skiprows` lines
-        for i in range(skiprows):
-            next(fh)
-
-        # Read until we find a line with some values, and use
-        # it to estimate the number of columns, N.
-        first_vals = None
-        try:
-            while not first_vals:
-                first_line = next(fh)
-                first_vals = split_line(first_line)
-        except StopIteration:
-            # End of lines reached
-            first_line = ''
-            first_vals = []
-            warnings.warn('loadtxt: Empty input file: "%s"' % fname,
-                          stacklevel=2)
-        N = len(usecols or first_vals)
-
-        # Now that we know N, create the default converters list, and
-        # set packing, if necessary.
-        if len(dtype_types) > 1:
-            # We're dealing with a structured array, each field of
-            # the dtype matches a column
-            converters = [_getconv(dt) for dt in dtype_types]
-        else:
-            # All fields have the same dtype
-            converters = [defconv for i in range(N)]
-            if N > 1:
-                packing = [(N, tuple)]
-
-        # By preference, use the converters specified by the user
-        for i, conv in (user_converters or {}).items():
-            if usecols:
-                try:
-                    i = usecols.index(i)
-                except ValueError:
-                    # Unused converter specified
-                    continue
-            if byte_converters:
-                # converters may use decode to workaround numpy's old
-                # behaviour, so encode the string again before passing to
-                # the user converter
-                def tobytes_first(x, conv):
-                    if type(x) is bytes:
-                        return conv(x)
-                    return conv(x.encode("latin1"))
-                converters[i] = functools.partial(tobytes_first, conv=conv)
-            else:
-                converters[i] = conv
-
-        converters = [conv if conv is not bytes else
-                      lambda x: x.encode(fencoding) for conv in converters]
-
-        # read data in chunks and fill it into an array via resize
-        # over-allocating and shrinking the array later may be faster but is
-        # probably not relevant compared to the cost of actually reading and
-        # converting the data
-        X = None
-        for x in read_data(_loadtxt_chunksize):
-            if X is None:
-                X = np.array(x, dtype)
-            else:
-                nshape = list(X.shape)
-                pos = nshape[0]
-                nshape[0] += len(x)
-                X.resize(nshape, refcheck=False)
-                X[pos:, ...] = x
+        X = _load_from_filelike(
+            fh if filelike else fh_iter, delimiter=delimiter,
+            comments=comments, quote=quotechar, usecols=usecols,
+            skiplines=skiprows,
+            max_rows=-1 if max_rows is None else max_rows,
+            dtype=read_dtype, fields=fields, homogeneous=homogeneous,
+            converters=col_converters or None, encoding=encoding,
+            filelike=filelike, chunksize=_loadtxt_chunksize)
     finally:
         if fown:
             fh.close()
 
     if X is None:
+        warnings.warn('loadtxt: Empty input file: "%s"' % fname,
+                      stacklevel=2)
+        X = np.array([], dtype)
+    elif len(X) == 0:
         X = np.array([], dtype)
+    else:
+        if homogeneous and X.shape[1] == 1:
+            # A single column is read as a 1-d array
+            X = X[:, 0]
+        if read_dtype is not dtype:
+            X = X.astype(dtype)
 
     # Multicolumn data are returned with shape (1, N, M), i.e.
     # (1, 1, M) for a single row - remove the singleton dimension there
@@ -1182,7 +1102,7 @@ def tobytes_first(x, conv):
             X = np.atleast_2d(X).T
 
     if unpack:
-        if len(dtype_types) > 1:
+        if dtype.names is not None and len(fields) > 1:
             # For structured arrays, return an array for each field.
             return [X[field] for field in dtype.names]
         else:
@@ -1190,12 +1110,18 @@ def tobytes_first(x, conv):
     else:
         return X
 
-
 _loadtxt_with_like = array_function_dispatch(
     _loadtxt_dispatcher
 )(loadtxt)
 
 
+# Column formats which `_format_float_rows` writes for float32/float64 data
+_c_float_fmt_re = re.compile(r'%[-+ #0]*[0-9]*(\.[0-9]+)?[eEfFgG]|%s')
+
+# Number of values formatted in C per call (and written per `write` call)
+_SAVETXT_CHUNKSIZE = 1 << 16
+
+
 def _savetxt_dispatcher(fname, X, fmt=None, delimiter=None, newline=None,
                         header=None, footer=None, comments=None,
                         encoding=None):
@@ -1310,6 +1236,12 @@ def savetxt(fname, X, fmt='%.18e', delimiter=' ', newline='\n', header='',
     This explanation of ``fmt`` is not complete, for an exhaustive
     specification see [1]_.
 
+    For float32 and float64 data written with a single format for all
+    columns, such as the default ``'%.18e'``, ``'%10.5f'`` or ``'%s'``, the
+    text is generated by a fast path in C with identical output.  ``'%s'``
+    writes the shortest representation which reads back to the same value,
+    which is usually both the fastest and the most compact choice.
+
     References
     ----------
     .. [1] `Format Specification Mini-Language
@@ -1397,12 +1329,16 @@ def first_write(self, v):
             ncol = X.shape[1]
 
         iscomplex_X = np.iscomplexobj(X)
+        # The format of every column, if they are all the same
+        column_fmt = None
         # `fmt` can be a string with multiple insertion points or a
         # list of formats.  E.g. '%10.5f\t%10d' or ('%10.5f', '$10d')
         if type(fmt) in (list, tuple):
             if len(fmt) != ncol:
                 raise AttributeError('fmt has wrong shape.  %s' % str(fmt))
             format = asstr(delimiter).join(map(asstr, fmt))
+            if len(set(map(asstr, fmt))) == 1:
+                column_fmt = asstr(fmt[0])
         elif isinstance(fmt, str):
             n_fmt_chars = fmt.count('%')
             error = ValueError('fmt has wrong number of %% formats:  %s' % fmt)
@@ -1410,6 +1346,7 @@ def first_write(self, v):
                 if iscomplex_X:
                     fmt = [' (%s+%sj)' % (fmt, fmt), ] * ncol
                 else:
+                    column_fmt = fmt
                     fmt = [fmt, ] * ncol
                 format = delimiter.join(fmt)
             elif iscomplex_X and n_fmt_chars != (2 * ncol):
@@ -1432,6 +1369,16 @@ def first_write(self, v):
                     row2.append(number.imag)
                 s = format % tuple(row2) + newline
                 fh.write(s.replace('+-', '-'))
+        elif (X.dtype.type in (np.float32, np.float64)
+                and column_fmt is not None
+                and _c_float_fmt_re.fullmatch(column_fmt)
+                and isinstance(newline, str)):
+            X = X.astype(X.dtype.newbyteorder('='), copy=False)
+            chunk_rows = max(1, _SAVETXT_CHUNKSIZE // max(ncol, 1))
+            for start in range(0, len(X), chunk_rows):
+                fh.write(_format_float_rows(
+                    X[start:start + chunk_rows], column_fmt,
+                    delimiter, newline))
         else:
             for row in X:
                 try:
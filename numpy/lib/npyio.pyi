@@ -55,6 +55,7 @@ def loadtxt(
     encoding=...,
     max_rows=...,
     *,
+    quotechar=...,
     like=...,
 ): ...
 def savetxt(
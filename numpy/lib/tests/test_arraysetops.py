@@ -31,6 +31,14 @@ def test_intersect1d(self):
         assert_array_equal(c, ed)
         assert_array_equal([], intersect1d([], []))
 
+        # the result has the common dtype
+        c = intersect1d(np.array([3, 1, 2, 2]), np.array([2., 3.5, 1.]))
+        assert_array_equal(c, [1., 2.])
+        assert_equal(c.dtype, np.float64)
+        c = intersect1d(np.array([3, 1, 2]), np.array([2., 1.]),
+                        assume_unique=True)
+        assert_array_equal(c, [1., 2.])
+
     def test_intersect1d_array_like(self):
         # See gh-11772
         class Test:
@@ -391,6 +399,55 @@ def test_in1d_with_arrays_containing_tuples(self):
         result = np.in1d(ar1, ar2, invert=True)
         assert_array_equal(result, np.invert(expected))
 
+    def _check_in1d(self, ar1, ar2):
+        expected = (ar1[:, np.newaxis] == ar2).any(axis=1)
+        assert_array_equal(in1d(ar1, ar2), expected)
+        assert_array_equal(in1d(ar1, ar2, invert=True), ~expected)
+
+    @pytest.mark.parametrize("dtype",
+        ["?", "b", "B", "h", "H", "i", "I", "q", "Q", "e", "f", "d", "F", "D",
+         "M8[s]", "m8[D]", "S1", "S3", "U1", "U3", ">i4", ">f8", ">U3"])
+    def test_in1d_hash(self, dtype):
+        rng = np.random.RandomState(0)
+        ar1 = rng.randint(-50, 50, size=500).astype(dtype)
+        ar2 = rng.randint(-20, 20, size=100).astype(dtype)
+        if ar1.dtype.kind in "fc":
+            ar1[::11] = -0.0
+            ar2[::13] = 0.0
+            ar1[::7] = np.nan
+            ar2[::5] = np.nan
+        if ar1.dtype.kind == "c":
+            ar1[::9] = complex(0, np.nan)
+            ar2[::3] = complex(0, np.nan)
+        if ar1.dtype.kind in "mM":
+            ar1[::7] = "NaT"
+            ar2[::5] = "NaT"
+        self._check_in1d(ar1, ar2)
+        self._check_in1d(ar1, ar2[:0])
+        self._check_in1d(ar1[:0], ar2)
+
+    @pytest.mark.parametrize("dtype", ["b", "h", "i", "q", "B", "H", "I", "Q"])
+    def test_in1d_integer_strategies(self, dtype):
+        info = np.iinfo(dtype)
+        rng = np.random.RandomState(0)
+        ar1 = rng.randint(info.min, info.max, size=2000, dtype=dtype)
+        ar2 = np.concatenate([ar1[::3], [info.min, info.max]]).astype(dtype)
+        # large range, hash table or merge of the sorted arrays
+        self._check_in1d(ar1, ar2)
+        self._check_in1d(np.sort(ar1), np.sort(ar2))
+        # small range, bitmap
+        ar1 = ar1 // 2**(8 * ar1.itemsize - 12)
+        ar2 = ar2[:-2] // 2**(8 * ar1.itemsize - 11)
+        self._check_in1d(ar1, ar2)
+
+    def test_in1d_mixed_dtypes(self):
+        ar1 = np.array([1, 2, 3, 2**53 + 1, -1], dtype=np.int64)
+        self._check_in1d(ar1, np.array([1.5, 2., 2.**53], dtype=np.float64))
+        self._check_in1d(ar1, np.array([3, 255], dtype=np.uint8))
+        self._check_in1d(ar1, np.array([True]))
+        self._check_in1d(np.array(["a", "bc", "b"]),
+                         np.array([b"b", b"bc"], dtype="S2").astype("U"))
+
     def test_union1d(self):
         a = np.array([5, 4, 7, 1, 2])
         b = np.array([2, 4, 3, 3, 2, 1, 5])
@@ -722,6 +779,54 @@ def test_unique_sort_order_with_axis(self):
             b = np.unique(a, axis=0)
             assert_array_equal(a, b, fmt % dt)
 
+    class _NoHash(np.ndarray):
+        # subclasses use the sort based implementation
+        pass
+
+    def _check_unique_hash(self, a, sorted):
+        u, idx, inv, cnt = unique(a, True, True, True, sorted=sorted)
+        ref = unique(a.view(self._NoHash), True, True, True)
+        assert_array_equal(u[inv], a)
+        assert_array_equal(a[idx], u)
+        assert_array_equal(np.sort(unique(a, sorted=sorted)), ref[0])
+        if not sorted:
+            perm = np.argsort(u, kind='stable')
+            u, idx, cnt = u[perm], idx[perm], cnt[perm]
+            inv = np.argsort(perm)[inv]
+        assert_array_equal(u, ref[0])
+        assert_array_equal(idx, ref[1])
+        assert_array_equal(inv, ref[2])
+        assert_array_equal(cnt, ref[3])
+
+    @pytest.mark.parametrize("sorted", [True, False])
+    @pytest.mark.parametrize("dtype",
+        ["?", "b", "B", "h", "H", "i", "I", "q", "Q", "e", "f", "d", "F", "D",
+         "M8[s]", "m8[D]", "S1", "S3", "U1", "U3"])
+    def test_unique_hash(self, dtype, sorted):
+        a = np.random.RandomState(0).randint(-20, 20, size=1000).astype(dtype)
+        if a.dtype.kind in "fc":
+            a[::11] = -0.0
+        if a.dtype.kind == "f":
+            a[::7] = np.nan
+            a[::13] = -np.nan
+        if a.dtype.kind in "mM":
+            a[::7] = "NaT"
+        self._check_unique_hash(a, sorted)
+
+    @pytest.mark.parametrize("sorted", [True, False])
+    @pytest.mark.parametrize("dtype", ["F", "D"])
+    def test_unique_hash_complex_nan(self, dtype, sorted):
+        a = (np.arange(1000) % 10).astype(dtype)
+        a[::7] = complex(np.nan, 1)
+        a[::13] = complex(1, np.nan)
+        self._check_unique_hash(a, sorted)
+
+    @pytest.mark.parametrize("dtype", ["i", "q", "f", "d", "S3", "U5"])
+    def test_unique_hash_many(self, dtype):
+        # many unique values, exercises growing the hash table
+        a = np.random.RandomState(0).randint(30000, size=50000).astype(dtype)
+        self._check_unique_hash(a, sorted=False)
+
     def _run_axis_tests(self, dtype):
         data = np.array([[0, 1, 0, 0],
                          [1, 0, 0, 0],
@@ -2562,6 +2562,46 @@ def test_error_not_1d(self, vals):
         with assert_raises(ValueError):
             np.bincount(vals)
 
+    @pytest.mark.parametrize("dtype", np.typecodes["AllInteger"] + "?")
+    @pytest.mark.parametrize("weighted", [False, True])
+    def test_native_dtypes(self, dtype, weighted):
+        # integer inputs are counted without a cast to intp
+        rng = np.random.RandomState(0)
+        x = rng.randint(0, 100, size=10000).astype(dtype)
+        w = rng.random_sample(x.size) if weighted else None
+        expected = np.bincount(x.astype(np.intp), w)
+        assert_array_equal(np.bincount(x, w), expected)
+        assert_array_equal(np.bincount(x[::-3], None if w is None else w[::-3]),
+                           np.bincount(x[::-3].astype(np.intp),
+                                       None if w is None else w[::-3]))
+        x_swapped = x.byteswap().newbyteorder()
+        assert_array_equal(np.bincount(x_swapped, w), expected)
+
+    @pytest.mark.parametrize("dtype", np.typecodes["Integer"])
+    def test_native_dtypes_negative(self, dtype):
+        x = np.array([3, 1, -1, 2], dtype=dtype)
+        assert_raises_regex(ValueError, "no negative elements",
+                            np.bincount, x)
+
+    def test_uint64_too_large(self):
+        x = np.array([1, 2**63 + 1], dtype=np.uint64)
+        assert_raises_regex(ValueError, "too large", np.bincount, x)
+
+    @pytest.mark.parametrize("nbins", [10, 5000])
+    def test_threads(self, nbins):
+        # the result does not depend on the number of threads
+        rng = np.random.RandomState(1)
+        x = rng.randint(0, nbins, size=300000)
+        w = rng.random_sample(x.size)
+        with np.parallelstate(threads=1):
+            expected = np.bincount(x)
+            expected_w = np.bincount(x, w)
+        assert_equal(expected.sum(), x.size)
+        for threads in [2, 3, 7]:
+            with np.parallelstate(threads=threads, threshold=1):
+                assert_array_equal(np.bincount(x), expected)
+                assert_array_equal(np.bincount(x, w), expected_w)
+
 
 class TestInterp:
 
@@ -407,6 +407,36 @@ def test_precision(self):
         self.do_precision(np.single, np.longdouble)
         self.do_precision(np.double, np.longdouble)
 
+    @pytest.mark.parametrize("dtype",
+        ["b", "B", "h", "H", "i", "I", "q", "Q", "e", "f", "d"])
+    @pytest.mark.parametrize("bins", [
+        7, [0, 3, 3, 10, 50.5, 99], [-10, 99, 99], np.linspace(10, 90, 17)])
+    def test_compiled_vs_longdouble(self, dtype, bins):
+        # longdouble samples use the implementation in Python
+        rng = np.random.RandomState(0)
+        a = rng.randint(0, 100, size=200000).astype(dtype)
+        if a.dtype.kind == 'f':
+            a[::1001] = np.nan
+            a[::1003] = -np.inf
+        w = rng.rand(a.size)
+        ld = a.astype(np.longdouble)
+        if np.ndim(bins) == 0:
+            bins = np.linspace(0, 99, bins + 1)
+        assert_equal(histogram(a, bins)[0], histogram(ld, bins)[0])
+        assert_allclose(histogram(a, bins, weights=w)[0],
+                        histogram(ld, bins, weights=w)[0])
+        assert_equal(histogram(a, bins, range=(0, 99))[0],
+                     histogram(ld, bins, range=(0, 99))[0])
+
+    def test_compiled_threads(self):
+        rng = np.random.RandomState(0)
+        a = rng.normal(size=300000)
+        w = rng.normal(size=a.size)
+        res = histogram(a, bins=50, weights=w)[0]
+        for threads in [2, 3, 8]:
+            with np.parallelstate(threads=threads, threshold=1):
+                assert_array_equal(histogram(a, bins=50, weights=w)[0], res)
+
     def test_histogram_bin_edges(self):
         hist, e = histogram([1, 2, 3, 4], [1, 2])
         edges = histogram_bin_edges([1, 2, 3, 4], [1, 2])
@@ -784,6 +814,20 @@ def test_large_integers(self):
 
         assert_equal(hist[0, 0], 1)
 
+    @pytest.mark.parametrize("dtype", ["i", "f", "d"])
+    def test_compiled_vs_longdouble(self, dtype):
+        # longdouble samples use the implementation in Python
+        rng = np.random.RandomState(0)
+        x = rng.randint(0, 20, size=(100000, 3)).astype(dtype)
+        w = rng.rand(len(x))
+        bins = (4, [0, 1, 5, 5, 19], np.arange(-1, 22, 2))
+        ld = x.astype(np.longdouble)
+        hist, edges = histogramdd(x, bins=bins, range=[(0, 19)] * 3)
+        hist_ld, edges_ld = histogramdd(ld, bins=bins, range=[(0, 19)] * 3)
+        assert_equal(hist, hist_ld)
+        assert_allclose(histogramdd(x, bins=edges_ld, weights=w)[0],
+                        histogramdd(ld, bins=edges_ld, weights=w)[0])
+
     def test_density_non_uniform_2d(self):
         # Defines the following grid:
         #
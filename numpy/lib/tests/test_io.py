@@ -505,6 +505,26 @@ def test_complex_negative_exponent(self):
             [b' (3.142e+00-2.718e+00j)  (3.142e+00-2.718e+00j)\n',
              b' (3.142e+00-2.718e+00j)  (3.142e+00-2.718e+00j)\n'])
 
+    @pytest.mark.parametrize("dtype", [np.float32, np.float64, ">f8"])
+    @pytest.mark.parametrize("fmt", ["%s", "%.18e", "%10.5f", "%-12.3g",
+                                     "%+010.3e", "% .2F", "%#.0f", "%G",
+                                     ["%.4e", "%.4e", "%.4e"]])
+    def test_float_format_fast_path(self, dtype, fmt):
+        # Uniform float formats are written by a C formatter, which has to
+        # give the same result as the `%` operator.
+        a = np.array([[0., -0., 1.5, np.inf, -np.inf, np.nan],
+                      [1e-300, 123456789.123, -2.5e-7, 1e16, 0.1, 3.]])
+        a = a.astype(dtype).reshape(-1, 3)
+        c = BytesIO()
+        np.savetxt(c, a, fmt=fmt, delimiter=', ', newline=';\n')
+        c.seek(0)
+
+        row_fmt = ', '.join(fmt if isinstance(fmt, list) else [fmt] * 3)
+        if fmt == "%s":
+            expected = [', '.join(str(v) for v in row) + ';\n' for row in a]
+        else:
+            expected = [row_fmt % tuple(row) + ';\n' for row in a]
+        assert_equal(c.read().decode(), ''.join(expected))
 
     def test_custom_writer(self):
 
@@ -1174,6 +1194,87 @@ def test_max_rows_larger(self):
         a = np.array([[1, 2, 3, 5], [4, 5, 7, 8], [2, 1, 4, 5]], int)
         assert_array_equal(x, a)
 
+    def test_quotechar(self):
+        c = TextIO('"1,5",2\n"a ""b"" # c",3\n"two\nlines",# x\n')
+        x = np.loadtxt(c, dtype='U10', delimiter=',', quotechar='"')
+        assert_equal(x, [['1,5', '2'], ['a "b" # c', '3'], ['two\nlines', '']])
+
+    def test_multichar_delimiter(self):
+        c = TextIO('1::2::3\n4::5::6 # 7::8\n')
+        x = np.loadtxt(c, delimiter='::')
+        assert_array_equal(x, [[1, 2, 3], [4, 5, 6]])
+
+    @pytest.mark.parametrize("dtype", [np.int8, np.uint16, np.int32])
+    def test_small_int_from_float(self, dtype):
+        # Smaller integers are parsed like `int(float(x))`
+        c = TextIO('1.9 -1.9 1e2 70000\n')
+        x = np.loadtxt(c, dtype=dtype)
+        expected = np.array([1, -1, 100, 70000]).astype(dtype)
+        assert_array_equal(x, expected)
+
+    @pytest.mark.parametrize("dtype", [np.int64, np.uint64])
+    def test_int64_overflow(self, dtype):
+        c = TextIO('1 99999999999999999999\n')
+        assert_raises(OverflowError, np.loadtxt, c, dtype=dtype)
+        c = TextIO('1 1.5\n')
+        assert_raises(ValueError, np.loadtxt, c, dtype=dtype)
+
+    @pytest.mark.parametrize("dtype", ['>f8', '<f4', '>c16', '>i2', '>U3'])
+    def test_byteorder(self, dtype):
+        c = TextIO('1 2 3\n4 5 6\n')
+        x = np.loadtxt(c, dtype=dtype)
+        assert_equal(x.dtype, np.dtype(dtype))
+        assert_array_equal(x, np.array([[1, 2, 3], [4, 5, 6]]).astype(dtype))
+
+    def test_float_correctly_rounded(self):
+        # float32 is rounded once, not through float64
+        values = ['1.00000005960464477539062500000001', '9007199254740993',
+                  '2.4703282292062328e-324', '1' * 100]
+        c = TextIO(' '.join(values) + '\n')
+        assert_array_equal(np.loadtxt(c), [float(v) for v in values])
+        c = TextIO(values[0] + ' 1.000000059604644775390625\n')
+        x = np.loadtxt(c, dtype=np.float32)
+        expected = np.nextafter(np.float32(1), np.float32(2))
+        assert_array_equal(x, [expected, 1])
+
+    def test_python_fallback(self):
+        # Values the C parser does not handle are passed to Python
+        c = TextIO('1_000 0x1p3 1e2\n')
+        assert_array_equal(np.loadtxt(c), [1000., 8., 100.])
+        c = TextIO('1+-2j,(3+4j),-j\n')
+        x = np.loadtxt(c, dtype=complex, delimiter=',')
+        assert_array_equal(x, [1-2j, 3+4j, -1j])
+        c = TextIO('1 2\n3 4\n')
+        x = np.loadtxt(c, dtype=object)
+        assert_equal(x, np.array([['1', '2'], ['3', '4']], dtype=object))
+
+    def test_negative_usecols(self):
+        c = TextIO('1 2 3\n4 5 6 7\n')
+        x = np.loadtxt(c, usecols=(-1, 0))
+        assert_array_equal(x, [[3, 1], [7, 4]])
+        c = TextIO('1 2 3\n4 5\n')
+        assert_raises(IndexError, np.loadtxt, c, usecols=(2,))
+
+    def test_unsized_string(self):
+        c = TextIO('a bcd\nefgh i\n')
+        x = np.loadtxt(c, dtype=str)
+        assert_equal(x.dtype, np.dtype('U4'))
+        assert_equal(x, [['a', 'bcd'], ['efgh', 'i']])
+
+    def test_utf8_chunk_boundary(self):
+        # Multi-byte characters are split between the chunks read
+        rows = ['\u00e9%d,%d' % (i, i) for i in range(20000)]
+        data = BytesIO('\n'.join(rows).encode('utf8'))
+        x = np.loadtxt(data, dtype='U8', delimiter=',', encoding='utf8')
+        assert_equal(x.shape, (20000, 2))
+        assert_equal(x[-1], ['\u00e919999', '19999'])
+
+    def test_bad_line_number(self):
+        c = TextIO('# header\n\n1 2 3\n\n4 5\n')
+        with pytest.raises(ValueError, match="at line 5"):
+            np.loadtxt(c)
+
+
 class Testfromregex:
     def test_record(self):
         c = TextIO()
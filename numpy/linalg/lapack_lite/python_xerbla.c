@@ -1,4 +1,5 @@
 #include "Python.h"
+#include "npy_config.h"
 #include "numpy/npy_common.h"
 #include "npy_cblas.h"
 
@@ -19,29 +20,72 @@
   info: Number of the invalid parameter.
 */
 
-CBLAS_INT BLAS_FUNC(xerbla)(char *srname, CBLAS_INT *info)
+/*
+  umath_linalg calls LAPACK from the worker threads of NumPy's thread pool,
+  which must not acquire the GIL.  A thread passes a status slot to
+  npy_xerbla_redirect before calling LAPACK, xerbla then stores the name
+  of the routine (at least 7 chars) and the parameter number in it instead
+  of raising.  The calling thread raises the error with npy_xerbla_raise
+  once all threads are done.  Redirecting needs thread local storage,
+  npy_xerbla_redirect returns -1 without it.
+*/
+#if defined(HAVE___THREAD) || defined(HAVE___DECLSPEC_THREAD_)
+#define XERBLA_REDIRECT 1
+static NPY_TLS char *redirect_name = NULL;
+static NPY_TLS int *redirect_info = NULL;
+#else
+#define XERBLA_REDIRECT 0
+#endif
+
+NPY_VISIBILITY_HIDDEN void
+npy_xerbla_raise(const char *name, int info)
 {
         static const char format[] = "On entry to %.*s" \
                 " parameter number %d had an illegal value";
         char buf[sizeof(format) + 6 + 4];   /* 6 for name, 4 for param. num. */
-
-        int len = 0; /* length of subroutine name*/
 #ifdef WITH_THREAD
         PyGILState_STATE save;
-#endif
 
-        while( len<6 && srname[len]!='\0' )
-                len++;
-        while( len && srname[len-1]==' ' )
-                len--;
-#ifdef WITH_THREAD
         save = PyGILState_Ensure();
 #endif
-        PyOS_snprintf(buf, sizeof(buf), format, len, srname, (int)*info);
+        PyOS_snprintf(buf, sizeof(buf), format, 6, name, info);
         PyErr_SetString(PyExc_ValueError, buf);
 #ifdef WITH_THREAD
         PyGILState_Release(save);
 #endif
+}
+
+NPY_VISIBILITY_HIDDEN int
+npy_xerbla_redirect(char *name, int *info)
+{
+#if XERBLA_REDIRECT
+        redirect_name = name;
+        redirect_info = info;
+        return 0;
+#else
+        return -1;
+#endif
+}
+
+CBLAS_INT BLAS_FUNC(xerbla)(char *srname, CBLAS_INT *info)
+{
+        char name[7];
+        int len = 0; /* length of subroutine name*/
+
+        while( len<6 && srname[len]!='\0' )
+                len++;
+        while( len && srname[len-1]==' ' )
+                len--;
+        memcpy(name, srname, len);
+        name[len] = '\0';
+#if XERBLA_REDIRECT
+        if (redirect_info != NULL) {
+                memcpy(redirect_name, name, len + 1);
+                *redirect_info = (int)*info;
+                return 0;
+        }
+#endif
+        npy_xerbla_raise(name, (int)*info);
 
         return 0;
 }
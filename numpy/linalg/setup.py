@@ -37,12 +37,13 @@ def configuration(parent_package='', top_path=None):
         # is being used to numpy.__config__
         class numpy_linalg_lapack_lite(system_info):
             def calc_info(self):
-                info = {'language': 'c'}
+                info = {'language': 'c',
+                        'define_macros': [('NPY_LAPACK_LITE', None)]}
                 if sys.maxsize > 2**32:
                     # Build lapack-lite in 64-bit integer mode.
                     # The suffix is arbitrary (lapack_lite symbols follow it),
                     # but use the "64_" convention here.
-                    info['define_macros'] = [
+                    info['define_macros'] += [
                         ('HAVE_BLAS_ILP64', None),
                         ('BLAS_SYMBOL_SUFFIX', '64_')
                     ]
@@ -50,12 +51,14 @@ def calc_info(self):
 
         lapack_info = numpy_linalg_lapack_lite().get_info(2)
 
+    use_python_xerbla = use_lapack_lite or sys.platform != 'win32'
+
     def get_lapack_lite_sources(ext, build_dir):
         if use_lapack_lite:
             print("### Warning:  Using unoptimized lapack ###")
             return all_sources
         else:
-            if sys.platform == 'win32':
+            if not use_python_xerbla:
                 print("### Warning:  python_xerbla.c is disabled ###")
                 return []
             return [all_sources[0]]
@@ -72,6 +75,8 @@ def get_lapack_lite_sources(ext, build_dir):
         '_umath_linalg',
         sources=['umath_linalg.c.src', get_lapack_lite_sources],
         depends=['lapack_lite/f2c.h'],
+        define_macros=([('NPY_PYTHON_XERBLA', None)]
+                       if use_python_xerbla else []),
         extra_info=lapack_info,
         libraries=['npymath'],
     )
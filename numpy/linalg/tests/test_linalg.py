@@ -8,6 +8,7 @@
 import traceback
 import textwrap
 import subprocess
+import warnings
 import pytest
 
 import numpy as np
@@ -1817,6 +1818,85 @@ class ArraySubclass(np.ndarray):
         assert_(isinstance(res, np.ndarray))
 
 
+class TestSmallStacked:
+    # Stacks of real matrices up to 4x4 do not use LAPACK, compare them with
+    # LAPACK results for the same matrices embedded in larger ones.
+
+    def embed(self, a, size=6):
+        res = np.zeros(a.shape[:-2] + (size, size), dtype=a.dtype)
+        res[...] = np.eye(size)
+        n = a.shape[-1]
+        res[..., :n, :n] = a
+        return res
+
+    @pytest.mark.parametrize('dtype', [np.float32, np.float64])
+    @pytest.mark.parametrize('n', [1, 2, 3, 4])
+    @pytest.mark.parametrize('nbatch', [1, 5, 8, 19])
+    def test_stacked(self, dtype, n, nbatch):
+        rtol = get_rtol(dtype)
+        rng = np.random.default_rng(1234)
+        a = rng.standard_normal((nbatch, n, n)).astype(dtype)
+        b = rng.standard_normal((nbatch, n, 3)).astype(dtype)
+        v = rng.standard_normal((nbatch, n)).astype(dtype)
+        big = self.embed(a)
+
+        assert_allclose(linalg.det(a), linalg.det(big), rtol=rtol)
+        sign, logdet = linalg.slogdet(a)
+        assert_equal(sign, linalg.slogdet(big)[0])
+        assert_allclose(logdet, linalg.slogdet(big)[1], rtol=rtol, atol=rtol)
+        assert_allclose(linalg.inv(a), linalg.inv(big)[:, :n, :n],
+                        rtol=rtol, atol=rtol)
+        x = linalg.solve(a, b)
+        assert_(x.dtype == dtype)
+        assert_allclose(matmul(a, x), b, rtol=10 * rtol, atol=10 * rtol)
+        x = linalg.solve(a, v)
+        assert_allclose(matmul(a, x[..., None])[..., 0], v,
+                        rtol=10 * rtol, atol=10 * rtol)
+
+        spd = matmul(a, a.swapaxes(-1, -2)) + n * np.eye(n, dtype=dtype)
+        c = linalg.cholesky(spd)
+        assert_equal(np.triu(c, 1), 0)
+        assert_allclose(c, linalg.cholesky(self.embed(spd))[:, :n, :n],
+                        rtol=rtol, atol=rtol)
+
+        # non-contiguous stacks
+        at = a.swapaxes(-1, -2)[::-1]
+        assert_allclose(linalg.det(at), linalg.det(big)[::-1], rtol=rtol)
+        assert_allclose(linalg.inv(at),
+                        linalg.inv(big)[::-1, :n, :n].swapaxes(-1, -2),
+                        rtol=rtol, atol=rtol)
+
+    @pytest.mark.parametrize('dtype', [np.float32, np.float64])
+    @pytest.mark.parametrize('n', [1, 2, 3, 4])
+    def test_singular(self, dtype, n):
+        a = np.tile(np.eye(n, dtype=dtype), (11, 1, 1))
+        a[7] = 0
+        det = linalg.det(a)
+        assert_equal(det[7], 0)
+        assert_equal(np.delete(det, 7), 1)
+        sign, logdet = linalg.slogdet(a)
+        assert_equal(sign[7], 0)
+        assert_equal(logdet[7], -inf)
+        assert_raises(LinAlgError, linalg.inv, a)
+        assert_raises(LinAlgError, linalg.solve, a, a)
+        assert_raises(LinAlgError, linalg.cholesky, a)
+        assert_raises(LinAlgError, linalg.cholesky, -a[:1])
+
+        # a zero pivot that is not the first
+        a[7] = np.eye(n)
+        a[7, -1, -1] = 0
+        assert_equal(linalg.det(a)[7], 0)
+        assert_raises(LinAlgError, linalg.inv, a)
+
+    def test_no_spurious_warnings(self):
+        a = np.zeros((9, 3, 3))
+        a[::2] = np.eye(3)
+        with warnings.catch_warnings():
+            warnings.simplefilter('error')
+            linalg.det(a)
+            linalg.slogdet(a)
+
+
 def test_byteorder_check():
     # Byte order check should pass for native order
     if sys.byteorder == 'little':
@@ -1852,6 +1932,41 @@ def test_generalized_raise_multiloop():
     assert_raises(np.linalg.LinAlgError, np.linalg.inv, x)
 
 
+@pytest.mark.parametrize("func", [
+    linalg.inv, linalg.det, linalg.slogdet, linalg.eigvals, linalg.eigh,
+    linalg.svd, linalg.qr, linalg.pinv,
+    lambda a: linalg.solve(a, a[..., :2]),
+    lambda a: linalg.cholesky(a @ a.conj().swapaxes(-1, -2) + np.eye(7)),
+])
+@pytest.mark.parametrize("dtype", [np.float32, np.float64, np.complex128])
+def test_parallel_stack(func, dtype):
+    # stacks split across threads give bit-identical results
+    rng = np.random.default_rng(1234)
+    a = rng.standard_normal((37, 7, 7))
+    if dtype == np.complex128:
+        a = a + 1j*rng.standard_normal(a.shape)
+    a = a.astype(dtype)
+    expected = func(a)
+    for threads in [2, 3, 8]:
+        with np.parallelstate(threads=threads, threshold=1, linalg=True):
+            res = func(a)
+        if isinstance(expected, tuple):
+            for r, e in zip(res, expected):
+                assert_array_equal(r, e)
+        else:
+            assert_array_equal(res, expected)
+
+
+def test_parallel_stack_raise():
+    # an error in any chunk is reported
+    a = np.tile(np.eye(3), (20, 1, 1))
+    a[13] = 0
+    with np.parallelstate(threads=4, threshold=1, linalg=True):
+        assert_raises(LinAlgError, linalg.inv, a)
+        assert_equal(linalg.det(a)[13], 0)
+        assert_equal(linalg.det(a)[:13], 1)
+
+
 def test_xerbla_override():
     # Check that our xerbla has been successfully linked in. If it is not,
     # the default xerbla routine is called, which prints a message to stdout
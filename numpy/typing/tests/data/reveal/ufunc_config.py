@@ -23,3 +23,15 @@ def write(self, value: str) -> None: ...
 
 reveal_type(np.errstate(call=func, all="call"))  # E: numpy.errstate[def (a: builtins.str, b: builtins.int)]
 reveal_type(np.errstate(call=Write(), divide="log", over="log"))  # E: numpy.errstate[ufunc_config.Write]
+
+reveal_type(np.setparallel(threads=2))  # E: TypedDict('numpy.core._ufunc_config._ParallelDict'
+reveal_type(np.getparallel())  # E: TypedDict('numpy.core._ufunc_config._ParallelDict'
+reveal_type(np.parallelstate(threads=2, threshold=1000))  # E: numpy.parallelstate
+
+reveal_type(np.setallocator("aligned_allocator"))  # E: Any
+reveal_type(np.getallocator())  # E: str
+reveal_type(np.allocatorstate("arena_allocator"))  # E: numpy.allocatorstate
+
+reveal_type(np.setmempool(max_bytes=0))  # E: TypedDict('numpy.core._ufunc_config._MemPoolDict'
+reveal_type(np.getmempool())  # E: TypedDict('numpy.core._ufunc_config._MemPoolDict'
+reveal_type(np.mempoolstats())  # E: TypedDict('numpy.core._ufunc_config._MemPoolStatsDict'